@@ -0,0 +1,332 @@
+/* Copyright (c) 2020 [Rick de Bondt] - PacketPath_Benchmark.cpp
+ *
+ * Micro-benchmarks of everything a frame passes through on its way over the bridge. Frames come from the test captures
+ * and from synthetic frames of every size the PSP sends, results are written to a JSON file so they can be compared
+ * between releases, for example with compare.py from Google Benchmark.
+ *
+ * */
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../Includes/Logger.h"
+#include "../Includes/MappedPCapReader.h"
+#include "../Includes/PacketConverter.h"
+#include "../Includes/XLinkKaiConnection.h"
+
+using namespace RadioTap_Constants;
+
+namespace
+{
+    constexpr std::string_view cInputDirectory{"../Tests/Input/"};
+    constexpr std::string_view cDefaultOutput{"benchmarks.json"};
+    constexpr uint64_t         cBSSID{0x0123456789ab};
+    constexpr uint16_t         cEtherType{0x88c8};
+
+    // Smallest ethernet frame up to the largest frame that fits in a WiFi data frame without fragmentation.
+    constexpr std::array<int64_t, 6> cFrameSizes{64, 128, 256, 512, 1024, 1500};
+
+    /**
+     * Frames to benchmark with, read once from the test captures.
+     */
+    struct Corpus
+    {
+        std::vector<std::string> MonitorFrames{};  /**< Everything captured in monitor mode, with radiotap header. */
+        std::vector<std::string> DataFrames{};     /**< 802.11 data frames out of MonitorFrames. */
+        std::vector<std::string> Beacons{};        /**< 802.11 beacons out of MonitorFrames. */
+        std::vector<std::string> EthernetFrames{}; /**< 802.3 frames as XLink Kai sends them. */
+    };
+
+    std::vector<std::string> ReadFrames(std::string_view aFileName)
+    {
+        std::vector<std::string> lReturn{};
+        MappedPCapReader         lReader{};
+
+        if (lReader.Open(std::string(cInputDirectory) + std::string(aFileName), cChannel)) {
+            while (lReader.ReadNextData()) {
+                lReturn.emplace_back(lReader.GetFrame().Data);
+            }
+            lReader.Close();
+        }
+
+        return lReturn;
+    }
+
+    const Corpus& GetCorpus()
+    {
+        static const Corpus lCorpus{[] {
+            Corpus          lReturn{};
+            PacketConverter lConverter{true};
+
+            for (const auto& lFileName : {"MonitorHelloWorld.pcapng", "MonitorBeaconChange_Expected.pcap"}) {
+                for (auto& lFrame : ReadFrames(lFileName)) {
+                    lConverter.Update(lFrame);
+                    if (lConverter.Is80211Beacon(lFrame)) {
+                        lReturn.Beacons.emplace_back(lFrame);
+                    } else if (lConverter.Is80211Data(lFrame)) {
+                        lReturn.DataFrames.emplace_back(lFrame);
+                    }
+                    lReturn.MonitorFrames.emplace_back(std::move(lFrame));
+                }
+            }
+            lReturn.EthernetFrames = ReadFrames("PromiscuousHelloWorld.pcapng");
+
+            return lReturn;
+        }()};
+
+        return lCorpus;
+    }
+
+    // A broadcast from the PSP, padded with a pattern up to the requested size.
+    std::string MakeEthernetFrame(std::size_t aSize)
+    {
+        std::string lReturn(aSize, '\0');
+
+        std::fill_n(lReturn.begin(), 6, static_cast<char>(0xff));
+        for (std::size_t lIndex = 6; lIndex < 12; lIndex++) {
+            lReturn.at(lIndex) = static_cast<char>(lIndex);
+        }
+        lReturn.at(12) = static_cast<char>(cEtherType >> 8U);
+        lReturn.at(13) = static_cast<char>(cEtherType & 0xffU);
+        for (std::size_t lIndex = 14; lIndex < aSize; lIndex++) {
+            lReturn.at(lIndex) = static_cast<char>(lIndex);
+        }
+
+        return lReturn;
+    }
+
+    std::string MakeMonitorFrame(std::size_t aSize)
+    {
+        PacketConverter lConverter{true};
+        return lConverter.ConvertPacketTo80211(MakeEthernetFrame(aSize), cBSSID, cChannel, cRateFlags);
+    }
+
+    void SetProcessed(benchmark::State& aState, std::size_t aFrames, std::size_t aBytes)
+    {
+        aState.SetItemsProcessed(static_cast<int64_t>(aState.iterations() * aFrames));
+        if (aBytes > 0) {
+            aState.SetBytesProcessed(static_cast<int64_t>(aState.iterations() * aBytes));
+        }
+    }
+
+    std::size_t GetTotalSize(const std::vector<std::string>& aFrames)
+    {
+        std::size_t lReturn{0};
+        for (const auto& lFrame : aFrames) {
+            lReturn += lFrame.size();
+        }
+        return lReturn;
+    }
+
+    void FrameSizes(benchmark::internal::Benchmark* aBenchmark)
+    {
+        for (int64_t lSize : cFrameSizes) {
+            aBenchmark->Arg(lSize);
+        }
+    }
+}  // namespace
+
+static void ConvertPacketTo8023(benchmark::State& aState)
+{
+    PacketConverter lConverter{true};
+    std::string     lFrame{MakeMonitorFrame(aState.range(0))};
+
+    for (auto _ : aState) {
+        lConverter.Update(lFrame);
+        benchmark::DoNotOptimize(lConverter.ConvertPacketTo8023(lFrame));
+    }
+    SetProcessed(aState, 1, lFrame.size());
+}
+BENCHMARK(ConvertPacketTo8023)->Apply(FrameSizes);
+
+static void ConvertPacketTo8023Corpus(benchmark::State& aState)
+{
+    PacketConverter                 lConverter{true};
+    const std::vector<std::string>& lFrames{GetCorpus().DataFrames};
+
+    for (auto _ : aState) {
+        for (const auto& lFrame : lFrames) {
+            lConverter.Update(lFrame);
+            benchmark::DoNotOptimize(lConverter.ConvertPacketTo8023(lFrame));
+        }
+    }
+    SetProcessed(aState, lFrames.size(), GetTotalSize(lFrames));
+}
+BENCHMARK(ConvertPacketTo8023Corpus);
+
+static void ConvertPacketTo80211(benchmark::State& aState)
+{
+    PacketConverter lConverter{true};
+    std::string     lFrame{MakeEthernetFrame(aState.range(0))};
+
+    for (auto _ : aState) {
+        benchmark::DoNotOptimize(lConverter.ConvertPacketTo80211(lFrame, cBSSID, cChannel, cRateFlags));
+    }
+    SetProcessed(aState, 1, lFrame.size());
+}
+BENCHMARK(ConvertPacketTo80211)->Apply(FrameSizes);
+
+static void ConvertPacketTo80211Corpus(benchmark::State& aState)
+{
+    PacketConverter                 lConverter{true};
+    const std::vector<std::string>& lFrames{GetCorpus().EthernetFrames};
+
+    for (auto _ : aState) {
+        for (const auto& lFrame : lFrames) {
+            benchmark::DoNotOptimize(lConverter.ConvertPacketTo80211(lFrame, cBSSID, cChannel, cRateFlags));
+        }
+    }
+    SetProcessed(aState, lFrames.size(), GetTotalSize(lFrames));
+}
+BENCHMARK(ConvertPacketTo80211Corpus);
+
+static void ConstructAcknowledgementFrame(benchmark::State& aState)
+{
+    PacketConverter        lConverter{true};
+    std::array<uint8_t, 6> lReceiver{0x00, 0x01, 0x02, 0x03, 0x04, 0x05};
+
+    for (auto _ : aState) {
+        benchmark::DoNotOptimize(lConverter.ConstructAcknowledgementFrame(lReceiver, cChannel, cRateFlags));
+    }
+    SetProcessed(aState, 1, 0);
+}
+BENCHMARK(ConstructAcknowledgementFrame);
+
+static void FillWiFiInformation(benchmark::State& aState)
+{
+    PacketConverter                              lConverter{true};
+    IPCapDevice_Constants::WiFiBeaconInformation lInformation{};
+    const std::vector<std::string>&              lFrames{GetCorpus().Beacons};
+
+    if (lFrames.empty()) {
+        aState.SkipWithError("No beacons in the test captures");
+    }
+
+    for (auto _ : aState) {
+        for (const auto& lFrame : lFrames) {
+            lConverter.Update(lFrame);
+            benchmark::DoNotOptimize(lConverter.FillWiFiInformation(lFrame, lInformation));
+        }
+    }
+    SetProcessed(aState, lFrames.size(), GetTotalSize(lFrames));
+}
+BENCHMARK(FillWiFiInformation);
+
+static void FillRadioTapParameters(benchmark::State& aState)
+{
+    RadioTapReader                  lReader{};
+    const std::vector<std::string>& lFrames{GetCorpus().MonitorFrames};
+
+    for (auto _ : aState) {
+        for (const auto& lFrame : lFrames) {
+            lReader.FillRadioTapParameters(lFrame);
+            benchmark::DoNotOptimize(lReader.GetLength());
+        }
+    }
+    SetProcessed(aState, lFrames.size(), GetTotalSize(lFrames));
+}
+BENCHMARK(FillRadioTapParameters);
+
+static void MacToInt(benchmark::State& aState)
+{
+    std::string lMac{"01:23:45:67:AB:CD"};
+
+    for (auto _ : aState) {
+        benchmark::DoNotOptimize(PacketConverter::MacToInt(lMac));
+    }
+    SetProcessed(aState, 1, 0);
+}
+BENCHMARK(MacToInt);
+
+// What the receiver does with a datagram from XLink Kai before handing the frame on.
+static void ParseXLinkKaiDatagram(benchmark::State& aState)
+{
+    std::string lDatagram{cEthernetDataString + MakeEthernetFrame(aState.range(0))};
+
+    for (auto _ : aState) {
+        std::string_view lData{lDatagram};
+        if (ParseCommand(lData) == Command::EthernetData) {
+            lData.remove_prefix(GetCommandPrefix(Command::EthernetData).size());
+        }
+        benchmark::DoNotOptimize(lData);
+    }
+    SetProcessed(aState, 1, lDatagram.size());
+}
+BENCHMARK(ParseXLinkKaiDatagram)->Apply(FrameSizes);
+
+// Keepalives go through the whole command table before they match.
+static void ParseXLinkKaiKeepAlive(benchmark::State& aState)
+{
+    std::string lDatagram{cKeepAliveString};
+
+    for (auto _ : aState) {
+        benchmark::DoNotOptimize(ParseCommand(lDatagram));
+    }
+    SetProcessed(aState, 1, lDatagram.size());
+}
+BENCHMARK(ParseXLinkKaiKeepAlive);
+
+// Messages below the log level, as on every frame in a normal run.
+static void LogDisabled(benchmark::State& aState)
+{
+    Logger&     lLogger{Logger::GetInstance()};
+    std::size_t lSize{1500};
+
+    for (auto _ : aState) {
+        lLogger.Log<Logger::Level::TRACE>("Packet # {}, {} bytes", aState.iterations(), lSize);
+    }
+    SetProcessed(aState, 1, 0);
+}
+BENCHMARK(LogDisabled);
+
+// Messages at the log level, formatted and queued for the writer thread.
+static void LogEnabled(benchmark::State& aState)
+{
+    Logger&     lLogger{Logger::GetInstance()};
+    std::size_t lSize{1500};
+    uint64_t    lDropped{lLogger.GetDroppedCount()};
+
+    for (auto _ : aState) {
+        lLogger.Log<Logger::Level::INFO>("Packet # {}, {} bytes", aState.iterations(), lSize);
+    }
+    SetProcessed(aState, 1, 0);
+
+    // The writer cannot keep up with a loop like this, messages that did not fit in the queue cost less.
+    aState.counters["dropped"] = static_cast<double>(lLogger.GetDroppedCount() - lDropped);
+}
+BENCHMARK(LogEnabled);
+
+int main(int argc, char* argv[])
+{
+    std::vector<char*> lArguments{argv, argv + argc};
+    std::string        lOutput{"--benchmark_out=" + std::string(cDefaultOutput)};
+    std::string        lFormat{"--benchmark_out_format=json"};
+
+    // Results always end up in a JSON file as well, unless another output file is given.
+    if (std::none_of(lArguments.begin(), lArguments.end(), [](const char* aArgument) {
+            return std::string_view(aArgument).starts_with("--benchmark_out=");
+        })) {
+        lArguments.push_back(lOutput.data());
+        lArguments.push_back(lFormat.data());
+    }
+
+    int lCount{static_cast<int>(lArguments.size())};
+    benchmark::Initialize(&lCount, lArguments.data());
+    if (benchmark::ReportUnrecognizedArguments(lCount, lArguments.data())) {
+        return 1;
+    }
+
+    // Nothing is written anywhere, only the cost of formatting and queueing is measured.
+    Logger::GetInstance().Init(Logger::Level::INFO, false, "");
+    Logger::GetInstance().SetLogToScreen(false);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    Logger::GetInstance().Close();
+
+    return 0;
+}
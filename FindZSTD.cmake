@@ -0,0 +1,52 @@
+# - Try to find zstd include dirs and libraries, zstd is optional
+#
+# Usage of this module as follows:
+#
+#     include(FindZSTD.cmake)
+#
+# Variables used by this module, they can change the default behaviour and need
+# to be set before calling find_package:
+#
+#  ZSTD_ROOT_DIR             Set this variable to the root installation of
+#                            zstd if the module has problems finding the
+#                            proper installation path.
+#
+# Variables defined by this module:
+#
+#  ZSTD_FOUND                System has zstd, include and library dirs found
+#  ZSTD_INCLUDE_DIR          The zstd include directories.
+#  ZSTD_LIBRARIES            The zstd library, empty if zstd was not found so
+#                            it can always be linked against.
+#
+# When found, HAVE_ZSTD is defined so compressed captures can be read and written.
+
+find_path(ZSTD_INCLUDE_DIR
+    NAMES zstd.h
+    HINTS ${ZSTD_ROOT_DIR}/include
+)
+
+find_library(ZSTD_LIBRARY
+    NAMES zstd zstd_static
+    HINTS ${ZSTD_ROOT_DIR}/lib
+)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(ZSTD DEFAULT_MSG
+    ZSTD_LIBRARY
+    ZSTD_INCLUDE_DIR
+)
+
+if (ZSTD_FOUND)
+    include_directories(${ZSTD_INCLUDE_DIR})
+    add_definitions(-DHAVE_ZSTD)
+    set(ZSTD_LIBRARIES ${ZSTD_LIBRARY})
+else ()
+    message("zstd not found, compressed captures will not be supported")
+    set(ZSTD_LIBRARIES "")
+endif ()
+
+mark_as_advanced(
+    ZSTD_ROOT_DIR
+    ZSTD_INCLUDE_DIR
+    ZSTD_LIBRARY
+)
@@ -0,0 +1,194 @@
+#pragma once
+
+/* Copyright (c) 2020 [Rick de Bondt] - CaptureAnalyzer.h
+ *
+ * This file contains functions to summarize whole capture files, to diagnose a session without opening Wireshark.
+ *
+ * */
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "CaptureScanner.h"
+#include "Histogram.h"
+#include "MappedPCapReader.h"
+#include "PacketConverter.h"
+
+namespace CaptureAnalyzer_Constants
+{
+    // Frames handed to a worker at once, large enough that handing them over is cheap compared to scanning them.
+    static constexpr unsigned int cDefaultChunkSize{16384};
+    // Chunks scanned ahead per thread, limits memory use for compressed captures that need copies of the frames.
+    static constexpr unsigned int              cChunksInFlightPerThread{4};
+    static constexpr std::chrono::milliseconds cDefaultGapThreshold{250};
+    static constexpr std::chrono::milliseconds cDefaultRateInterval{1000};
+
+    // Inter-arrival times in nanoseconds are kept in log-linear buckets.
+    static constexpr std::size_t cIntervalBuckets{Histogram_Constants::GetBucketCount(64)};
+
+    // Frame types of ethernet frames are their EtherType with this bit set, 802.11 ones are (type << 4) | subtype.
+    static constexpr uint32_t cEtherTypeFlag{0x10000};
+
+    struct Settings
+    {
+        unsigned int             Threads{0}; /**< 0 uses all cores. */
+        unsigned int             ChunkSize{cDefaultChunkSize};
+        std::chrono::nanoseconds GapThreshold{cDefaultGapThreshold}; /**< Silences longer than this are reported. */
+        std::chrono::nanoseconds RateInterval{cDefaultRateInterval}; /**< Length of the intervals rates are kept of. */
+    };
+
+    struct Counters
+    {
+        uint64_t Frames{0};
+        uint64_t Bytes{0}; /**< Length on the wire. */
+    };
+
+    /**
+     * Statistics of a transmitter, for 802.11 the second address and for ethernet the source address.
+     */
+    struct Station
+    {
+        uint64_t Frames{0};
+        uint64_t Bytes{0};
+        uint64_t Retries{0};
+        int64_t  SignalSum{0}; /**< Sum of the antenna signal in dBm of the frames that have one. */
+        uint64_t SignalFrames{0};
+    };
+
+    struct Gap
+    {
+        std::chrono::nanoseconds Start{0}; /**< Timestamp of the frame before the gap. */
+        std::chrono::nanoseconds Length{0};
+    };
+
+    struct Report
+    {
+        uint64_t                 Frames{0};
+        uint64_t                 Bytes{0};
+        uint64_t                 Malformed{0}; /**< Too short to read the headers of. */
+        uint64_t                 WirelessFrames{0};
+        uint64_t                 Retries{0};
+        uint64_t                 Duplicates{0}; /**< Retries of a frame that had already been captured. */
+        std::chrono::nanoseconds FirstTimeStamp{0};
+        std::chrono::nanoseconds LastTimeStamp{0};
+        std::chrono::nanoseconds MaxInterval{0};
+
+        std::map<uint64_t, Counters> BSSIDs{};
+        std::map<uint64_t, Station>  Stations{};
+        std::map<uint32_t, Counters> FrameTypes{};
+        std::map<int64_t, Counters>  Rates{}; /**< Per RateInterval since the first frame. */
+
+        std::array<uint64_t, 256>              Signals{}; /**< Frames per antenna signal, index is dBm + 128. */
+        std::array<uint64_t, cIntervalBuckets> Intervals{};
+        std::vector<Gap>                       Gaps{};
+
+        uint64_t                 Chunks{0};
+        std::chrono::nanoseconds Duration{0}; /**< Time the analysis took. */
+    };
+}  // namespace CaptureAnalyzer_Constants
+
+/**
+ * Summarizes capture files: traffic per BSSID, transmitter and frame type, rates over time, retries and duplicates,
+ * inter-arrival times, signal strength and gaps in the traffic. The file is split in chunks that are scanned on a pool
+ * of threads, what depends on frames before a chunk is resolved once all chunks are done.
+ * */
+class CaptureAnalyzer
+{
+public:
+    explicit CaptureAnalyzer(CaptureAnalyzer_Constants::Settings aSettings);
+
+    /**
+     * Analyzes a capture file.
+     * @param aInput - Path to a pcap or pcapng file, optionally zstd compressed.
+     * @return true if the file could be read.
+     */
+    bool Analyze(std::string_view aInput);
+
+    /**
+     * Gets the results of the last analysis.
+     * @return The report.
+     */
+    [[nodiscard]] const CaptureAnalyzer_Constants::Report& GetReport() const;
+
+    /**
+     * Gets an inter-arrival time percentile from a report.
+     * @param aReport - The report.
+     * @param aPercentile - Percentile between 0 and 100.
+     * @return The inter-arrival time, 0 if the report has less than 2 frames.
+     */
+    static std::chrono::nanoseconds GetIntervalPercentile(const CaptureAnalyzer_Constants::Report& aReport,
+                                                          double                                   aPercentile);
+
+    /**
+     * Gets an antenna signal percentile from a report.
+     * @param aReport - The report.
+     * @param aPercentile - Percentile between 0 and 100.
+     * @return The signal in dBm, 0 if no frame had a signal.
+     */
+    static int GetSignalPercentile(const CaptureAnalyzer_Constants::Report& aReport, double aPercentile);
+
+    /**
+     * Gets a readable name for a frame type from the report.
+     * @param aFrameType - The frame type.
+     * @return The name.
+     */
+    static std::string GetFrameTypeName(uint32_t aFrameType);
+
+private:
+    // What is needed of a transmitter to find duplicates over the start of a chunk.
+    struct SequenceEdge
+    {
+        uint16_t FirstSequence{0};
+        bool     FirstRetry{false};
+        uint16_t LastSequence{0};
+    };
+
+    // The parts of a chunk that depend on the frames before it.
+    struct Edge
+    {
+        bool                                       Empty{true};
+        std::chrono::nanoseconds                   FirstTimeStamp{0};
+        std::chrono::nanoseconds                   LastTimeStamp{0};
+        std::unordered_map<uint64_t, SequenceEdge> Sequences{};
+    };
+
+    /**
+     * Scans a chunk on a worker thread and adds the results to the report.
+     * @param aChunk - The chunk to scan.
+     */
+    void ScanChunk(const CaptureScanner_Constants::Chunk& aChunk);
+
+    /**
+     * Adds the time between two frames to a report.
+     * @param aReport - Report to add to.
+     * @param aPrevious - Timestamp of the first frame.
+     * @param aNext - Timestamp of the second frame.
+     */
+    void AddInterval(CaptureAnalyzer_Constants::Report& aReport,
+                     std::chrono::nanoseconds           aPrevious,
+                     std::chrono::nanoseconds           aNext) const;
+
+    /**
+     * Adds the results of a chunk to the report.
+     * @param aReport - Results of the chunk.
+     */
+    void Merge(CaptureAnalyzer_Constants::Report& aReport);
+
+    /**
+     * Resolves the intervals and duplicates over the chunk boundaries, once all chunks are done.
+     */
+    void ResolveEdges();
+
+    CaptureAnalyzer_Constants::Settings mSettings;
+    CaptureAnalyzer_Constants::Report   mReport{};
+    std::chrono::nanoseconds            mCaptureStart{0};
+    std::vector<Edge>                   mEdges{};
+    std::mutex                          mMutex{};
+};
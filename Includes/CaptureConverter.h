@@ -0,0 +1,122 @@
+#pragma once
+
+/* Copyright (c) 2020 [Rick de Bondt] - CaptureConverter.h
+ *
+ * This file contains functions to convert whole capture files between monitor mode and promiscuous mode formats.
+ *
+ * */
+
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CaptureScanner.h"
+#include "IPCapDevice.h"
+#include "MappedPCapReader.h"
+#include "PacketConverter.h"
+
+namespace CaptureConverter_Constants
+{
+    // Frames handed to a worker at once, large enough that handing them over is cheap compared to converting them.
+    static constexpr unsigned int cDefaultChunkSize{4096};
+    // Chunks converted ahead of the writer per thread, limits memory use when writing is slower than converting.
+    static constexpr unsigned int cChunksInFlightPerThread{4};
+    static constexpr uint32_t     cSnapLength{65535};
+
+    enum class Direction
+    {
+        MonitorTo8023 = 0, /**< 802.11 with radiotap to ethernet, like the bridge does towards XLink Kai. */
+        PromiscuousTo80211 /**< Ethernet to 802.11 with radiotap, like the bridge does towards the monitor device. */
+    };
+
+    struct Settings
+    {
+        Direction                ConversionDirection{Direction::MonitorTo8023};
+        uint64_t                 BSSID{0}; /**< Fixed BSSID, if 0 it is taken from beacons matching the filter. */
+        std::vector<std::string> SSIDFilter{};
+        uint16_t                 Frequency{RadioTap_Constants::cChannel};
+        uint8_t                  MaxRate{RadioTap_Constants::cRateFlags};
+        unsigned int             Threads{0}; /**< 0 uses all cores. */
+        unsigned int             ChunkSize{cDefaultChunkSize};
+    };
+
+    struct Statistics
+    {
+        uint64_t                 FramesRead{0};
+        uint64_t                 FramesWritten{0};
+        uint64_t                 Chunks{0};
+        std::chrono::nanoseconds Duration{0};
+    };
+}  // namespace CaptureConverter_Constants
+
+/**
+ * Converts capture files using the same conversions as the bridge. The file is split in chunks that get converted on
+ * a pool of threads, and the results are written in their original order.
+ * */
+class CaptureConverter
+{
+public:
+    explicit CaptureConverter(CaptureConverter_Constants::Settings aSettings);
+
+    /**
+     * Converts a capture file.
+     * @param aInput - Path to a pcap or pcapng file to read.
+     * @param aOutput - Path of the pcap file to write.
+     * @return true if the whole file was converted.
+     */
+    bool Convert(std::string_view aInput, std::string_view aOutput);
+
+    /**
+     * Gets statistics of the last conversion.
+     * @return The statistics.
+     */
+    [[nodiscard]] const CaptureConverter_Constants::Statistics& GetStatistics() const;
+
+private:
+    /**
+     * Applies a frame to the WiFi state the same way the bridge does, and converts it if it should be forwarded.
+     * Frames of another link type than the direction converts from, or too short for their headers, are skipped.
+     * @param aFrame - The frame.
+     * @param aLinkType - Link type of the interface the frame was captured on.
+     * @param aConverter - Converter to use, Update gets called on it.
+     * @param aWifiInformation - State that is updated by beacons.
+     * @param aConvert - If false, only the state gets updated.
+     * @return The converted frame, empty if it should not be forwarded.
+     */
+    std::string ProcessFrame(std::string_view                              aFrame,
+                             uint16_t                                      aLinkType,
+                             PacketConverter&                              aConverter,
+                             IPCapDevice_Constants::WiFiBeaconInformation& aWifiInformation,
+                             bool                                          aConvert) const;
+
+    /**
+     * Converts a chunk into pcap records, runs on a worker thread.
+     * @param aChunk - The chunk to convert.
+     */
+    void ConvertChunk(const CaptureScanner_Constants::Chunk& aChunk);
+
+    /**
+     * Writes converted chunks in order as they come in, until all chunks have been written.
+     * @param aScanner - Scanner reading the chunks, told when a chunk has been written.
+     */
+    void WriteChunks(CaptureScanner& aScanner);
+
+    CaptureConverter_Constants::Settings                             mSettings;
+    CaptureConverter_Constants::Statistics                           mStatistics{};
+    std::ofstream                                                    mOutput{};
+    std::mutex                                                       mMutex{};
+    std::condition_variable                                          mCondition{};
+    // Records and frame count per converted chunk, until it gets written.
+    std::map<uint64_t, std::pair<std::string, uint64_t>>             mConverted{};
+    // WiFi state at the start of every chunk, until the chunk gets converted.
+    std::map<uint64_t, IPCapDevice_Constants::WiFiBeaconInformation> mStartStates{};
+    uint64_t                                                         mChunksWritten{0};
+    uint64_t                                                         mChunksTotal{0};
+    bool                                                             mScanDone{false};
+};
@@ -0,0 +1,148 @@
+#pragma once
+
+/* Copyright (c) 2020 [Rick de Bondt] - CaptureIndex.h
+ *
+ * This file contains an index of a capture file, so it can be read from any point in time without scanning it.
+ *
+ * */
+
+#include <chrono>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MappedPCapReader.h"
+#include "PacketConverter.h"
+
+namespace CaptureIndex_Constants
+{
+    static constexpr std::string_view cIndexExtension{".idx"};
+    static constexpr std::string_view cIndexMagic{"MDPCIDX2"};
+    // Packets between two index entries, seeking reads at most this many packets after a lookup.
+    static constexpr uint32_t cDefaultInterval{1024};
+
+    /**
+     * A point in the capture file.
+     */
+    struct Position
+    {
+        uint64_t                 Packet{0}; /**< Number of the packet, starting at 0. */
+        std::chrono::nanoseconds TimeStamp{0};
+        uint64_t                 Offset{0}; /**< Offset of the record in the capture file. */
+        uint32_t                 Section{0};
+    };
+}  // namespace CaptureIndex_Constants
+
+/**
+ * Index of a capture file, stored next to the capture as a sidecar file. Holds a position every so many packets,
+ * and the first position every BSSID and MAC address was seen at.
+ * */
+class CaptureIndex
+{
+public:
+    /**
+     * Builds the index in a single pass over the capture.
+     * @param aCapturePath - Path to the pcap or pcapng file.
+     * @param aInterval - Amount of packets between two index entries.
+     * @return true if the capture could be read.
+     */
+    bool Build(std::string_view aCapturePath, uint32_t aInterval = CaptureIndex_Constants::cDefaultInterval);
+
+    /**
+     * Writes the index to a sidecar file.
+     * @param aPath - Path to write to.
+     * @return true if successful.
+     */
+    bool Save(std::string_view aPath) const;
+
+    /**
+     * Reads an index from a sidecar file.
+     * @param aPath - Path to read from.
+     * @param aCaptureSize - Size of the capture the index is for, indexes of other sizes are rejected as outdated.
+     * @param aCaptureTime - Modification time of the capture, see GetModificationTime, other times are outdated too.
+     * @return true if the index could be read completely and is for this capture, if not it has to be built again.
+     */
+    bool Load(std::string_view aPath, uint64_t aCaptureSize, std::chrono::nanoseconds aCaptureTime);
+
+    /**
+     * Gets the path of the sidecar file for a capture.
+     * @param aCapturePath - Path of the capture.
+     * @return Path of the index.
+     */
+    static std::string GetIndexPath(std::string_view aCapturePath);
+
+    /**
+     * Gets the modification time of a capture, to tell whether an index is still for it.
+     * @param aCapturePath - Path of the capture.
+     * @return The time, 0 if it could not be read.
+     */
+    static std::chrono::nanoseconds GetModificationTime(std::string_view aCapturePath);
+
+    /**
+     * Finds the last index entry at or before a point in time.
+     * @param aTimeStamp - Capture time in nanoseconds since epoch.
+     * @return The entry, or the first entry if the time is before the capture started.
+     */
+    [[nodiscard]] std::optional<CaptureIndex_Constants::Position> FindTime(std::chrono::nanoseconds aTimeStamp) const;
+
+    /**
+     * Finds the last index entry at or before a packet.
+     * @param aPacket - Number of the packet, starting at 0.
+     * @return The entry, nothing if the packet is not in the capture.
+     */
+    [[nodiscard]] std::optional<CaptureIndex_Constants::Position> FindPacket(uint64_t aPacket) const;
+
+    /**
+     * Finds where a BSSID was seen first in an 802.11 capture.
+     * @param aBSSID - The BSSID.
+     * @return The position, nothing if the BSSID is not in the capture.
+     */
+    [[nodiscard]] std::optional<CaptureIndex_Constants::Position> FindBSSID(uint64_t aBSSID) const;
+
+    /**
+     * Finds where a source MAC address was seen first.
+     * @param aMac - The MAC address.
+     * @return The position, nothing if the address is not in the capture.
+     */
+    [[nodiscard]] std::optional<CaptureIndex_Constants::Position> FindMac(uint64_t aMac) const;
+
+    /**
+     * Gets the section information needed to start reading at a position.
+     * @param aPosition - Position from this index.
+     * @return The section the position is in.
+     */
+    [[nodiscard]] const MappedPCapReader_Constants::Section& GetSection(
+        const CaptureIndex_Constants::Position& aPosition) const;
+
+    [[nodiscard]] uint64_t                 GetPacketCount() const;
+    [[nodiscard]] uint64_t                 GetCaptureSize() const;
+    [[nodiscard]] std::chrono::nanoseconds GetCaptureTime() const;
+
+    [[nodiscard]] const std::vector<CaptureIndex_Constants::Position>&        GetEntries() const;
+    [[nodiscard]] const std::map<uint64_t, CaptureIndex_Constants::Position>& GetBSSIDs() const;
+    [[nodiscard]] const std::map<uint64_t, CaptureIndex_Constants::Position>& GetMacs() const;
+
+private:
+    /**
+     * Notes the addresses in a frame the first time they are seen.
+     * @param aFrame - The frame.
+     * @param aLinkType - Link type of the interface the frame was captured on.
+     * @param aPosition - Position of the frame.
+     * @param aConverter - Converter to read 802.11 headers with.
+     */
+    void AddAddresses(std::string_view                        aFrame,
+                      uint16_t                                aLinkType,
+                      const CaptureIndex_Constants::Position& aPosition,
+                      PacketConverter&                        aConverter);
+
+    uint64_t                                             mCaptureSize{0};
+    std::chrono::nanoseconds                             mCaptureTime{0};
+    uint32_t                                             mInterval{CaptureIndex_Constants::cDefaultInterval};
+    uint64_t                                             mPacketCount{0};
+    std::vector<MappedPCapReader_Constants::Section>     mSections{};
+    std::vector<CaptureIndex_Constants::Position>        mEntries{};
+    std::map<uint64_t, CaptureIndex_Constants::Position> mBSSIDs{};
+    std::map<uint64_t, CaptureIndex_Constants::Position> mMacs{};
+};
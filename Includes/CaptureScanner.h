@@ -0,0 +1,83 @@
+#pragma once
+
+/* Copyright (c) 2020 [Rick de Bondt] - CaptureScanner.h
+ *
+ * This file contains functions to split a capture file in chunks of frames and process them on a pool of threads.
+ *
+ * */
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "MappedPCapReader.h"
+
+namespace CaptureScanner_Constants
+{
+    struct Chunk
+    {
+        uint64_t                                       Number{0};
+        std::vector<MappedPCapReader_Constants::Frame> Frames{};
+        std::vector<uint16_t>                          LinkTypes{}; /**< Link type of every frame. */
+        // Frames of compressed captures point in here, shared so they stay valid when the chunk is copied.
+        std::shared_ptr<std::deque<std::string>>       Storage{std::make_shared<std::deque<std::string>>()};
+    };
+}  // namespace CaptureScanner_Constants
+
+/**
+ * Reads a capture file in chunks of frames and hands every chunk to a pool of threads. Only a limited amount of chunks
+ * is read ahead of the ones that are done, so memory use stays bounded when processing is slower than reading.
+ * */
+class CaptureScanner
+{
+public:
+    /**
+     * Called on the reading thread for every frame, before it gets added to its chunk.
+     * @param aFrame - The frame.
+     * @param aLinkType - Link type of the interface the frame was captured on.
+     * @param aChunk - The chunk the frame goes in, without frames yet for the first frame of a chunk.
+     */
+    using FrameCallback = std::function<void(const MappedPCapReader_Constants::Frame& aFrame,
+                                             uint16_t                                 aLinkType,
+                                             const CaptureScanner_Constants::Chunk&   aChunk)>;
+
+    /**
+     * Called on a worker thread for every chunk, ChunkDone has to be called once the chunk is finished with.
+     * @param aChunk - The chunk.
+     */
+    using ChunkCallback = std::function<void(const CaptureScanner_Constants::Chunk& aChunk)>;
+
+    /**
+     * Constructor of CaptureScanner.
+     * @param aThreads - Amount of worker threads, 0 uses all cores.
+     * @param aChunkSize - Frames per chunk.
+     * @param aChunksInFlightPerThread - Chunks that can be read ahead of the ones that are done, per thread.
+     */
+    CaptureScanner(unsigned int aThreads, unsigned int aChunkSize, unsigned int aChunksInFlightPerThread);
+
+    /**
+     * Reads all frames from a reader and processes them in chunks, returns once every chunk has been processed.
+     * @param aReader - An opened reader.
+     * @param aFrameCallback - Function to call for every frame on the reading thread, can be nullptr.
+     * @param aChunkCallback - Function to process a chunk with on a worker thread.
+     * @return The amount of chunks.
+     */
+    uint64_t Scan(MappedPCapReader& aReader, const FrameCallback& aFrameCallback, const ChunkCallback& aChunkCallback);
+
+    /**
+     * Marks a chunk as finished with, so the next one can be read. Safe to call from any thread.
+     */
+    void ChunkDone();
+
+private:
+    unsigned int            mThreads;
+    unsigned int            mChunkSize;
+    unsigned int            mChunksInFlight;
+    std::mutex              mMutex{};
+    std::condition_variable mCondition{};
+    uint64_t                mChunksDone{0};
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+/* Copyright (c) 2020 [Rick de Bondt] - ControlServer.h
+ *
+ * This file contains a local socket that other programs can use to control the engine and read its statistics.
+ *
+ * */
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/thread.hpp>
+
+#include "Statistics.h"
+
+namespace ControlServer_Constants
+{
+    // Requests are one line of words separated by spaces. Every reply is zero or more lines of data, followed by a line
+    // with cOk or cError and a message.
+    static constexpr std::string_view cOk{"OK"};
+    static constexpr std::string_view cError{"ERROR"};
+    static constexpr char             cLineEnd{'\n'};
+
+    static constexpr std::size_t cMaxLineLength{1024};
+    static constexpr std::size_t cMaxConnections{8};
+
+    // The server is only there for monitoring and control, so it should never take time from the bridge.
+    static constexpr int cNiceness{10};
+
+    /**
+     * Reply to a request.
+     */
+    struct Reply
+    {
+        bool                     Success{true};
+        std::vector<std::string> Lines{}; /**< Data on success, only the first line is used as message on failure. */
+    };
+
+    using Handler = std::function<Reply(const std::vector<std::string>& aArguments)>;
+}  // namespace ControlServer_Constants
+
+/**
+ * Class that listens on a Unix domain socket and answers requests on a thread of its own, with a lower priority than
+ * the threads bridging traffic. What a request does is up to the handler, which is called on that thread.
+ */
+class ControlServer
+{
+public:
+    explicit ControlServer(ControlServer_Constants::Handler aHandler);
+    ~ControlServer();
+    ControlServer(const ControlServer& aControlServer) = delete;
+    ControlServer& operator=(const ControlServer& aControlServer) = delete;
+
+    /**
+     * Creates the socket, only the user running the program can connect to it. A socket left behind at the same path
+     * is replaced.
+     * @param aPath - Path of the socket.
+     * @return true if successful.
+     */
+    bool Open(std::string_view aPath);
+
+    /**
+     * Starts answering requests.
+     * @return true if successful.
+     */
+    bool StartThread();
+
+    /**
+     * Stops the thread, closes all connections and removes the socket.
+     */
+    void Close();
+
+    /**
+     * Splits a request into its words.
+     * @param aLine - The request, without line end.
+     * @return The words, empty for an empty request.
+     */
+    static std::vector<std::string> SplitRequest(std::string_view aLine);
+
+    /**
+     * Puts a reply into the form it is sent in.
+     * @param aReply - The reply.
+     * @return The lines of the reply, each ending in a line end.
+     */
+    static std::string FormatReply(const ControlServer_Constants::Reply& aReply);
+
+    /**
+     * Puts a snapshot of the statistics into lines of a name and a value, latencies in nanoseconds.
+     * @param aSnapshot - The snapshot.
+     * @return The lines.
+     */
+    static std::vector<std::string> FormatSnapshot(const Statistics_Constants::Snapshot& aSnapshot);
+
+private:
+    class Connection;
+
+    void Accept();
+
+    ControlServer_Constants::Handler         mHandler;
+    std::string                              mPath{};
+    std::shared_ptr<boost::asio::io_service> mIoService{std::make_shared<boost::asio::io_service>()};
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+    std::shared_ptr<boost::asio::local::stream_protocol::acceptor> mAcceptor{nullptr};
+#endif
+    std::vector<std::weak_ptr<Connection>> mConnections{}; /**< Only touched by the thread, or after it stopped. */
+    std::shared_ptr<boost::thread>         mThread{nullptr};
+};
@@ -0,0 +1,298 @@
+#pragma once
+
+/* Copyright (c) 2020 [Rick de Bondt] - FakeXLinkKaiEngine.h
+ *
+ * This file contains a stand-in for the XLink Kai engine, so connections to XLink Kai can be tested without one.
+ *
+ * */
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/thread.hpp>
+
+#include "Statistics.h"
+#include "XLinkKaiConnection.h"
+
+namespace FakeXLinkKaiEngine_Constants
+{
+    /**
+     * Types of messages a client can send to the XLink Kai engine.
+     */
+    enum class ClientCommand
+    {
+        Connect = 0,
+        KeepAlive,
+        EthernetData,
+        Disconnect,
+        Unknown
+    };
+
+    static constexpr std::size_t cClientCommandCount{static_cast<std::size_t>(ClientCommand::Unknown) + 1};
+    /** Amount of messages kept for inspection by default, older messages are only counted. */
+    static constexpr std::size_t cDefaultMessageLogSize{1024};
+
+    /**
+     * A count per type of message.
+     */
+    using MessageCounts = std::array<uint64_t, cClientCommandCount>;
+
+    /**
+     * What the engine knows about one client, every client has an endpoint of its own.
+     */
+    struct ClientState
+    {
+        std::string   Name{};
+        bool          Connected{false};
+        MessageCounts ReceivedCounts{};
+    };
+
+    using ClientMap = std::map<boost::asio::ip::udp::endpoint, ClientState>;
+
+    /**
+     * Reads the time a frame was sent from the frame itself.
+     * @param aFrame - Ethernet frame as received, without the protocol prefix.
+     * @return The send time, nothing if the frame does not carry one.
+     */
+    using TimeStampReader =
+        std::function<std::optional<std::chrono::steady_clock::time_point>(std::string_view aFrame)>;
+
+    /**
+     * A message received from a client, timestamped on arrival.
+     */
+    struct ReceivedMessage
+    {
+        std::chrono::steady_clock::time_point TimeStamp{};
+        ClientCommand                         Type{ClientCommand::Unknown};
+        std::string                           Data{};
+        std::string                           Client{}; /**< Name of the sender, empty if it never asked to connect. */
+    };
+
+    /**
+     * A message the engine should send, after waiting for the given delay.
+     */
+    struct ScriptedMessage
+    {
+        std::chrono::microseconds Delay{0};
+        std::string               Data{};
+    };
+
+    /**
+     * Converts a message from a client to the command it contains.
+     * @param aData - Message as received from the client.
+     * @return The command, ClientCommand::Unknown if not recognized.
+     */
+    ClientCommand ParseClientCommand(std::string_view aData);
+}  // namespace FakeXLinkKaiEngine_Constants
+
+/**
+ * Stand-in for the XLink Kai engine, speaks just enough of the UDP protocol to connect clients, keep them alive and
+ * exchange ethernet data with them. Counts everything it receives and keeps the most recent messages, so tests and
+ * benchmarks can inspect it without the engine growing during long runs. Clients are told apart by their endpoint,
+ * functions taking a client name address that client, an empty name addresses the last client that sent a message.
+ */
+class FakeXLinkKaiEngine
+{
+public:
+    FakeXLinkKaiEngine() = default;
+    ~FakeXLinkKaiEngine();
+    FakeXLinkKaiEngine(const FakeXLinkKaiEngine& aFakeXLinkKaiEngine) = delete;
+    FakeXLinkKaiEngine& operator=(const FakeXLinkKaiEngine& aFakeXLinkKaiEngine) = delete;
+
+    /**
+     * Opens the engine on the loopback interface.
+     * @param aPort - Port to listen on, 0 picks a free port, see GetPort.
+     * @return True if successful.
+     */
+    bool Open(unsigned int aPort = 0);
+
+    /**
+     * Starts answering and recording messages from clients.
+     * @return True if successful.
+     */
+    bool StartReceiverThread();
+
+    /**
+     * Stops the engine.
+     */
+    void Close();
+
+    /**
+     * Gets the port the engine listens on.
+     * @return The port.
+     */
+    [[nodiscard]] unsigned int GetPort() const;
+
+    /**
+     * Sets whether the engine confirms connection requests, can be used to test connection timeouts.
+     * @param aAccept - True to confirm connections.
+     */
+    void SetAcceptConnections(bool aAccept);
+
+    /**
+     * Sets how long the engine waits before confirming a connection request, so frames sent while connecting can be
+     * tested.
+     * @param aDelay - Time to wait, 0 to confirm right away.
+     */
+    void SetConnectDelay(std::chrono::milliseconds aDelay);
+
+    /**
+     * Sets how many of the most recent messages are kept for GetReceivedMessages, all messages are counted regardless.
+     * @param aSize - Amount of messages to keep, 0 to keep none.
+     */
+    void SetMessageLogSize(std::size_t aSize);
+
+    /**
+     * Sets a function that reads the send time from received ethernet frames, the time between sending and arrival is
+     * then counted in the latency histogram, see GetLatencies.
+     * @param aReader - The function, nullptr to stop measuring.
+     */
+    void SetTimeStampReader(FakeXLinkKaiEngine_Constants::TimeStampReader aReader);
+
+    /**
+     * Sends a raw message to a client.
+     * @param aData - Message to send.
+     * @param aClientName - Client to send to.
+     * @return True if successful.
+     */
+    bool SendRaw(std::string_view aData, std::string_view aClientName = "");
+
+    /**
+     * Sends an ethernet frame to a client.
+     * @param aFrame - Frame to send.
+     * @param aClientName - Client to send to.
+     * @return True if successful.
+     */
+    bool SendEthernetData(std::string_view aFrame, std::string_view aClientName = "");
+
+    /**
+     * Sends a keepalive to a client.
+     * @param aClientName - Client to send to.
+     * @return True if successful.
+     */
+    bool SendKeepAlive(std::string_view aClientName = "");
+
+    /**
+     * Tells a client it has been disconnected.
+     * @param aClientName - Client to disconnect.
+     * @return True if successful.
+     */
+    bool SendDisconnected(std::string_view aClientName = "");
+
+    /**
+     * Sends the same ethernet frame to the client at a fixed rate, blocks until done.
+     * @param aFrame - Frame to send.
+     * @param aCount - Amount of times to send it.
+     * @param aInterval - Time between frames, 0 to send as fast as possible.
+     * @return Amount of frames sent successfully.
+     */
+    unsigned int InjectEthernetData(std::string_view aFrame, unsigned int aCount, std::chrono::nanoseconds aInterval);
+
+    /**
+     * Sends a list of messages to the client, blocks until done.
+     * @param aScript - Messages to send.
+     * @return Amount of messages sent successfully.
+     */
+    unsigned int RunScript(const std::vector<FakeXLinkKaiEngine_Constants::ScriptedMessage>& aScript);
+
+    /**
+     * Waits until a client has connected.
+     * @param aTimeout - Maximum time to wait.
+     * @param aClientName - Client to wait for.
+     * @return True if the client is connected.
+     */
+    bool WaitForConnection(std::chrono::milliseconds aTimeout, std::string_view aClientName = "");
+
+    /**
+     * Waits until a certain amount of messages of a type has been received.
+     * @param aType - Type of message to count.
+     * @param aCount - Amount to wait for.
+     * @param aTimeout - Maximum time to wait.
+     * @param aClientName - Only count messages from this client, empty to count messages from all clients.
+     * @return True if the amount has been reached.
+     */
+    bool WaitForMessages(FakeXLinkKaiEngine_Constants::ClientCommand aType,
+                         std::size_t                                 aCount,
+                         std::chrono::milliseconds                   aTimeout,
+                         std::string_view                            aClientName = "");
+
+    /**
+     * Gets a copy of the most recent messages received, see SetMessageLogSize.
+     * @return Received messages in order of arrival.
+     */
+    std::vector<FakeXLinkKaiEngine_Constants::ReceivedMessage> GetReceivedMessages();
+
+    /**
+     * Counts the received messages of a type.
+     * @param aType - Type of message to count.
+     * @param aClientName - Only count messages from this client, empty to count messages from all clients.
+     * @return Amount of messages.
+     */
+    std::size_t GetReceivedCount(FakeXLinkKaiEngine_Constants::ClientCommand aType, std::string_view aClientName = "");
+
+    /**
+     * Gets the amount of bytes received in messages of a type, including the protocol prefix.
+     * @param aType - Type of message to count.
+     * @return Amount of bytes.
+     */
+    uint64_t GetReceivedBytes(FakeXLinkKaiEngine_Constants::ClientCommand aType);
+
+    /**
+     * Gets the latencies of the ethernet frames received so far, see SetTimeStampReader.
+     * @return The latencies.
+     */
+    Statistics_Constants::LatencyHistogram GetLatencies();
+
+    /**
+     * Forgets all messages, counts and latencies received so far.
+     */
+    void ClearReceivedMessages();
+
+    /**
+     * Gets the name the last client that sent a message identified itself with.
+     * @return The locally unique name of the client, empty if none connected.
+     */
+    std::string GetClientName();
+
+    /**
+     * Gets the names of all clients that are connected.
+     * @return The locally unique names, sorted.
+     */
+    std::vector<std::string> GetConnectedClients();
+
+private:
+    void StartReceiving();
+    void ReceiveCallback(const boost::system::error_code& aError, size_t aBytesReceived);
+    void ConfirmConnection(const boost::asio::ip::udp::endpoint& aClient);
+    bool SendTo(const boost::asio::ip::udp::endpoint& aClient, std::string_view aData);
+    std::optional<boost::asio::ip::udp::endpoint> FindClient(std::string_view aClientName) const;
+    std::size_t CountMessages(FakeXLinkKaiEngine_Constants::ClientCommand aType, std::string_view aClientName) const;
+
+    bool                                                      mAcceptConnections{true};
+    std::chrono::milliseconds                                 mConnectDelay{0};
+    std::array<char, cMaxLength>                              mData{};
+    std::deque<FakeXLinkKaiEngine_Constants::ReceivedMessage> mReceivedMessages{};
+    std::size_t                                               mMessageLogSize{
+        FakeXLinkKaiEngine_Constants::cDefaultMessageLogSize};
+    FakeXLinkKaiEngine_Constants::MessageCounts               mReceivedCounts{};
+    FakeXLinkKaiEngine_Constants::MessageCounts               mReceivedBytes{};
+    FakeXLinkKaiEngine_Constants::TimeStampReader             mTimeStampReader{nullptr};
+    Statistics_Constants::LatencyHistogram                    mLatencies{};
+    std::mutex                                                mMutex{};
+    std::condition_variable                                   mMessageReceived{};
+    boost::asio::io_service                                   mIoService{};
+    boost::asio::ip::udp::socket                              mSocket{mIoService};
+    boost::asio::ip::udp::endpoint                            mSender{};
+    boost::asio::ip::udp::endpoint                            mClient{};
+    FakeXLinkKaiEngine_Constants::ClientMap                   mClients{};
+    std::shared_ptr<boost::thread>                            mReceiverThread{nullptr};
+};
@@ -0,0 +1,140 @@
+#pragma once
+
+/* Copyright (c) 2020 [Rick de Bondt] - FlightRecorder.h
+ *
+ * This file contains a recorder that keeps the last frames and events in memory, to be dumped when something fails.
+ *
+ * */
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <boost/thread.hpp>
+
+#include "Logger.h"
+#include "SessionRecorder.h"
+
+namespace FlightRecorder_Constants
+{
+    static constexpr std::string_view cDefaultPath{"flightrecorder"};
+    static constexpr std::string_view cEventExtension{".log"};
+
+    // Enough for an 802.11 frame with radiotap header, longer frames are cut off.
+    static constexpr std::size_t          cMaxFrameLength{2400};
+    static constexpr std::size_t          cMaxEventLength{256};
+    static constexpr std::size_t          cDefaultFramesPerDirection{1024};
+    static constexpr std::size_t          cDefaultEvents{256};
+    static constexpr std::chrono::seconds cDefaultMinDumpInterval{10};
+
+    struct Settings
+    {
+        std::string          Path{cDefaultPath}; /**< Dumps are named <Path>_<time>_<number>.pcapng and .log. */
+        std::size_t          FramesPerDirection{cDefaultFramesPerDirection};
+        std::size_t          Events{cDefaultEvents};
+        std::chrono::seconds MinDumpInterval{cDefaultMinDumpInterval}; /**< Triggers within this time are ignored. */
+    };
+}  // namespace FlightRecorder_Constants
+
+/**
+ * Keeps the last frames in both directions through the bridge and the last engine events in preallocated rings.
+ * Recording overwrites the oldest entry in place and never allocates or waits, so it can always be on. When something
+ * goes wrong the rings get dumped to a pcapng file with the same layout as a session recording, and an event log.
+ * */
+class FlightRecorder
+{
+public:
+    explicit FlightRecorder(FlightRecorder_Constants::Settings aSettings = {});
+    ~FlightRecorder();
+    FlightRecorder(const FlightRecorder& aFlightRecorder) = delete;
+    FlightRecorder& operator=(const FlightRecorder& aFlightRecorder) = delete;
+
+    /**
+     * Starts the thread that handles dump requests from Trigger.
+     * @return true if successful.
+     */
+    bool StartDumpThread();
+
+    /**
+     * Stops the dump thread, requests that have not been handled yet are dropped.
+     */
+    void Close();
+
+    /**
+     * Keeps a copy of a frame, safe to call from any thread.
+     * @param aDirection - Direction the frame went through the bridge.
+     * @param aData - The frame.
+     */
+    void Record(SessionRecorder_Constants::Direction aDirection, std::string_view aData);
+
+    /**
+     * Keeps an event, safe to call from any thread.
+     * @param aText - Description of the event.
+     * @param aLevel - Level the event was logged at.
+     */
+    void RecordEvent(std::string_view aText, Logger::Level aLevel = Logger::Level::INFO);
+
+    /**
+     * Requests a dump on the dump thread, safe to call from any thread. Requests shortly after a dump are ignored, so
+     * a burst of errors results in a single dump.
+     * @param aReason - Why the dump is requested, added to the event log.
+     */
+    void Trigger(std::string_view aReason);
+
+    /**
+     * Writes the frames and events kept to files right away.
+     * @param aReason - Why the dump is made, added to the event log.
+     * @return Path of the pcapng file, empty if it could not be written.
+     */
+    std::string Dump(std::string_view aReason);
+
+    /**
+     * Gets the amount of dumps written.
+     * @return The amount.
+     */
+    [[nodiscard]] uint64_t GetDumpCount() const;
+
+private:
+    // Slots are claimed with a flag instead of a lock, so recording never waits for a dump that is copying a slot.
+    struct FrameSlot
+    {
+        std::atomic<bool>                                           Busy{false};
+        std::chrono::nanoseconds                                    TimeStamp{0}; /**< 0 while not used yet. */
+        uint32_t                                                    Length{0};
+        uint32_t                                                    StoredLength{0};
+        std::array<char, FlightRecorder_Constants::cMaxFrameLength> Data{};
+    };
+
+    struct EventSlot
+    {
+        std::atomic<bool>                                           Busy{false};
+        std::chrono::nanoseconds                                    TimeStamp{0};
+        Logger::Level                                               Level{Logger::Level::INFO};
+        uint32_t                                                    Length{0};
+        std::array<char, FlightRecorder_Constants::cMaxEventLength> Text{};
+    };
+
+    /**
+     * Handles dump requests until the recorder is closed.
+     */
+    void HandleDumpRequests();
+
+    FlightRecorder_Constants::Settings    mSettings;
+    std::array<std::vector<FrameSlot>, 2> mFrames;
+    std::array<std::atomic<uint64_t>, 2>  mFramePositions{};
+    std::vector<EventSlot>                mEvents;
+    std::atomic<uint64_t>                 mEventPosition{0};
+    std::atomic<uint64_t>                 mDumpCount{0};
+    std::atomic<int64_t>                  mLastDump{0}; /**< Steady clock time in nanoseconds, 0 before any dump. */
+    std::mutex                            mDumpMutex{};
+    std::condition_variable               mDumpCondition{};
+    std::string                           mDumpReason{};
+    bool                                  mRunning{false};
+    std::shared_ptr<boost::thread>        mDumpThread{nullptr};
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+/* Copyright (c) 2020 [Rick de Bondt] - Histogram.h
+ *
+ * This file contains functions to keep values in log-linear histogram buckets and read percentiles from them.
+ *
+ * */
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+namespace Histogram_Constants
+{
+    // Values are kept in buckets of 1/16th of a power of two, enough for percentiles within about 6%.
+    static constexpr unsigned int cSubBucketBits{4};
+
+    /**
+     * Gets the amount of buckets needed to keep values up to a number of bits.
+     * @param aValueBits - Bits of the largest value.
+     * @return The amount of buckets.
+     */
+    constexpr std::size_t GetBucketCount(unsigned int aValueBits)
+    {
+        return (aValueBits - cSubBucketBits + 1) << cSubBucketBits;
+    }
+
+    /**
+     * Gets the bucket a value is kept in: exact below 16, above that 16 buckets for every power of two.
+     * @param aValue - The value.
+     * @return Index of the bucket.
+     */
+    constexpr std::size_t GetBucket(uint64_t aValue)
+    {
+        std::size_t lReturn{aValue};
+
+        if (aValue >= (1U << cSubBucketBits)) {
+            auto lExponent{static_cast<unsigned int>(std::bit_width(aValue) - 1)};
+            auto lMantissa{
+                static_cast<std::size_t>((aValue >> (lExponent - cSubBucketBits)) & ((1U << cSubBucketBits) - 1))};
+            lReturn = ((lExponent - cSubBucketBits + 1) << cSubBucketBits) + lMantissa;
+        }
+
+        return lReturn;
+    }
+
+    /**
+     * Gets the lowest value that ends up in a bucket.
+     * @param aBucket - Index of the bucket.
+     * @return The value.
+     */
+    constexpr uint64_t GetBucketValue(std::size_t aBucket)
+    {
+        uint64_t lReturn{aBucket};
+
+        if (aBucket >= (1U << cSubBucketBits)) {
+            unsigned int lExponent{static_cast<unsigned int>(aBucket >> cSubBucketBits) + cSubBucketBits - 1};
+            uint64_t     lMantissa{(aBucket & ((1U << cSubBucketBits) - 1)) | (1U << cSubBucketBits)};
+            lReturn = lMantissa << (lExponent - cSubBucketBits);
+        }
+
+        return lReturn;
+    }
+
+    static_assert(GetBucket(15) == 15);
+    static_assert(GetBucketValue(GetBucket(1000)) <= 1000);
+    static_assert(GetBucketValue(GetBucket(1000) + 1) > 1000);
+    static_assert(GetBucket(UINT64_MAX) == GetBucketCount(64) - 1);
+
+    /**
+     * Gets the index of the bucket that holds a percentile, works for any kind of buckets that are in order.
+     * @param aBuckets - Counts per bucket.
+     * @param aPercentile - Percentile between 0 and 100.
+     * @return Index of the bucket, 0 if there is nothing in the buckets.
+     */
+    template<typename Buckets> std::size_t GetPercentileBucket(const Buckets& aBuckets, double aPercentile)
+    {
+        std::size_t lReturn{0};
+        uint64_t    lTotal{0};
+
+        for (auto lCount : aBuckets) {
+            lTotal += lCount;
+        }
+
+        if (lTotal > 0) {
+            // Index of the entry that holds the percentile when all entries are counted in order.
+            auto lRank{static_cast<uint64_t>(std::ceil(std::clamp(aPercentile, 0.0, 100.0) / 100.0 * lTotal))};
+            lRank = std::max<uint64_t>(lRank, 1);
+
+            uint64_t lSeen{0};
+            for (std::size_t lBucket = 0; lBucket < aBuckets.size(); lBucket++) {
+                lSeen += aBuckets[lBucket];
+                if (lSeen >= lRank) {
+                    lReturn = lBucket;
+                    break;
+                }
+            }
+        }
+
+        return lReturn;
+    }
+}  // namespace Histogram_Constants
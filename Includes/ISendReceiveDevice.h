@@ -6,6 +6,7 @@
  *
  **/
 
+#include <chrono>
 #include <memory>
 #include <string>
 
@@ -39,6 +40,18 @@ public:
      */
     virtual bool Send(std::string_view aData) = 0;
 
+    /**
+     * Sends data that arrived at the bridge at a known time, devices that hand it to the network count how long it
+     * spent in the bridge. Others send it like any other data.
+     * @param aData - Data to send.
+     * @param aArrival - Time the data was captured or arrived at the bridge.
+     * @return true if successful, false on failure or unsupported.
+     */
+    virtual bool Send(std::string_view aData, std::chrono::system_clock::time_point /*aArrival*/)
+    {
+        return Send(aData);
+    }
+
     /**
      * Allows sending or receiving over different device.
      * @param aDevice - Device to use.
@@ -8,7 +8,15 @@
  * */
 
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
 
 // Does not exist in Visual Studio yet, https://github.com/microsoft/STL/pull/664
 #if defined(__GNUC__) || defined(__GNUG__)
@@ -18,9 +26,16 @@
 #include <sstream>
 #include <string>
 
+#include <boost/thread.hpp>
+
+// Messages below this level are left out at compile time, 0 (trace) to 4 (error). Set with MINIMUM_LOG_LEVEL in CMake.
+#if !defined(LOGGER_MINIMUM_LEVEL)
+#define LOGGER_MINIMUM_LEVEL 0
+#endif
 
 /**
- * Logger class, can log text to file or stdout.
+ * Logger class, can log text to file or stdout. After Init log calls only queue the message, a writer thread formats
+ * and writes them in batches, so logging from the capture and network threads is cheap and safe.
  */
 class Logger
 {
@@ -48,6 +63,63 @@ public:
      */
     static constexpr std::array<std::string_view, 5> cLevelTexts{"Trace", "Debug", "Info", "Warning", "Error"};
 
+    /**
+     * Lowest level that is compiled in, log calls below it do nothing.
+     */
+    static constexpr Level cMinimumLevel{static_cast<Level>(LOGGER_MINIMUM_LEVEL)};
+
+    /**
+     * Format string of a log message, every "{}" is replaced by the next argument, "{{" and "}}" give a single brace.
+     * Converted from a string literal at the call, which also records where the message comes from.
+     */
+    struct Format
+    {
+#if defined(__GNUC__) || defined(__GNUG__)
+        Format(const char*                               aText,
+               const std::experimental::source_location& aLocation = std::experimental::source_location::current()) :
+            Text(aText), File(aLocation.file_name()), Line(static_cast<unsigned int>(aLocation.line()))
+        {}
+#else
+        Format(const char* aText) : Text(aText) {}
+#endif
+
+        std::string_view Text{};
+        const char*      File{nullptr};
+        unsigned int     Line{0};
+    };
+
+    /**
+     * Token bucket for a call site that can fire at packet rate, see LogLimited. Safe to share between threads.
+     */
+    class RateLimit
+    {
+    public:
+        /**
+         * @param aInterval - Time it takes to earn back a message.
+         * @param aBurst - Messages that can be logged at once after a quiet period.
+         */
+        explicit RateLimit(std::chrono::nanoseconds aInterval = std::chrono::seconds(10), unsigned int aBurst = 1);
+
+        /**
+         * Takes a message from the bucket.
+         * @param aSuppressed - Set to the amount of messages suppressed since the last one that was allowed.
+         * @return true if the message may be logged.
+         */
+        bool Allow(uint64_t& aSuppressed);
+
+    private:
+        std::chrono::nanoseconds mInterval;
+        std::chrono::nanoseconds mBurstLength; /**< How far ahead of now the bucket may be emptied. */
+        // Time at which the bucket is full again, one interval further for every message.
+        std::atomic<int64_t>  mFullAt{0};
+        std::atomic<uint64_t> mSuppressed{0};
+    };
+
+    /**
+     * Function that gets every message at or above the observer level, regardless of the log level.
+     */
+    using Observer = std::function<void(std::string_view aText, Level aLevel)>;
+
     /**
      * Gets the Logger singleton.
      * @return The Logger object.
@@ -59,7 +131,7 @@ public:
     }
 
     /**
-     * Initializes the logger singleton.
+     * Initializes the logger singleton and starts the writer thread. Before this messages are written right away.
      * @param aLevel - Loglevel to set the logger to.
      * @param aLogToDisk - Whether we should log to disk or not.
      * @param aFileName - Filename to use for logging.
@@ -67,18 +139,66 @@ public:
     void Init(Level aLevel, bool aLogToDisk, const std::string& aFileName);
 
     /**
-     * Logs given text to file.
-     * @param aText - Text to be logged.
-     * @param aLevel - Loglevel to use.
-     * @param aLocation - Source location (keep empty).
+     * Writes everything still queued and stops the writer thread, messages logged after this are written right away.
      */
-#if defined(__GNUC__) || defined(__GNUG__)
-    void Log(const std::string&                        aText,
-             Level                                     aLevel,
-             const std::experimental::source_location& aLocation = std::experimental::source_location::current());
-#else
-    void Log(const std::string& aText, Level aLevel);
-#endif
+    void Close();
+
+    /**
+     * Waits until every message logged before this call has been written.
+     */
+    void Flush();
+
+    /**
+     * Gets the amount of messages that were thrown away because the queue was full.
+     * @return The amount of messages.
+     */
+    [[nodiscard]] uint64_t GetDroppedCount() const;
+
+    /**
+     * Logs a message. The arguments are only formatted when the level is logged or observed, otherwise this costs a
+     * single comparison, and levels below cMinimumLevel cost nothing.
+     * Example: Log<Logger::Level::TRACE>("Packet # {}, {} bytes", lCount, lData.size());
+     * @param aFormat - Format string, see Format.
+     * @param aArguments - Strings, numbers or anything that can be written to an ostream.
+     */
+    template<Level tLevel, typename... Arguments> void Log(Format aFormat, const Arguments&... aArguments)
+    {
+        if constexpr (tLevel >= cMinimumLevel) {
+            if (tLevel >= mThreshold.load(std::memory_order_relaxed)) {
+                std::string lText{};
+                AppendFormatted(lText, aFormat.Text, aArguments...);
+                Submit(lText, tLevel, aFormat.File, aFormat.Line);
+            }
+        }
+    }
+
+    /**
+     * Logs a message like Log, unless the call site has logged too often recently. The first message after messages
+     * were suppressed says how many, so a flood turns into a periodic summary.
+     * Example:
+     *   static Logger::RateLimit lLimit{};
+     *   Logger::GetInstance().LogLimited<Logger::Level::DEBUG>(lLimit, "Packet Timeout");
+     * @param aLimit - Rate limit of the call site.
+     * @param aFormat - Format string, see Format.
+     * @param aArguments - Strings, numbers or anything that can be written to an ostream.
+     */
+    template<Level tLevel, typename... Arguments>
+    void LogLimited(RateLimit& aLimit, Format aFormat, const Arguments&... aArguments)
+    {
+        if constexpr (tLevel >= cMinimumLevel) {
+            uint64_t lSuppressed{0};
+
+            if ((tLevel >= mThreshold.load(std::memory_order_relaxed)) && aLimit.Allow(lSuppressed)) {
+                std::string lText{};
+                AppendFormatted(lText, aFormat.Text, aArguments...);
+                if (lSuppressed > 0) {
+                    lText += " (suppressed " + std::to_string(lSuppressed) + " similar messages)";
+                }
+                Submit(lText, tLevel, aFormat.File, aFormat.Line);
+            }
+        }
+    }
+
     /**
      * Gets the loglevel
      */
@@ -123,13 +243,149 @@ public:
      */
     void SetLogToScreen(bool aLoggingToScreenEnabled);
 
+    /**
+     * Sets a function that gets messages even when they are not logged, for example to keep recent events around.
+     * Can be replaced while other threads log, calls that already started may still run the previous function.
+     * @param aObserver - The function, nullptr to remove it.
+     * @param aLevel - Lowest level of messages the function gets.
+     */
+    void SetObserver(Observer aObserver, Level aLevel = Level::DEBUG);
+
 private:
-    Logger() = default;
+    // Messages that can be queued before the writer catches up, more are dropped instead of blocking the caller.
+    static constexpr std::size_t cQueueSize{4096};
+    // How often the writer thread writes out the queue when it is not filling up.
+    static constexpr std::chrono::milliseconds cWriteInterval{50};
+
+    /**
+     * A queued message. The text keeps its capacity when the slot is reused, so queueing does not allocate once every
+     * slot has seen a message of that length.
+     */
+    struct Record
+    {
+        std::atomic<uint64_t>    Sequence{0}; /**< Position in the queue this slot is ready for, see Enqueue. */
+        Level                    RecordLevel{Level::ERROR};
+        std::chrono::nanoseconds TimeStamp{0};
+        const char*              File{nullptr};
+        unsigned int             Line{0};
+        std::string              Text{};
+    };
+
+    Logger();
     ~Logger();
 
-    std::string   mFileName{"log.txt"};
-    Level         mLogLevel{Logger::Level::ERROR};
-    std::ofstream mLogOutputStream{};
-    bool          mLogToDisk{false};
-    bool          mLogToScreen{false};
+    /**
+     * Appends the format string up to the first placeholder, replacing escaped braces.
+     * @return Position in the format string after the placeholder, npos if there was none.
+     */
+    static std::size_t AppendUntilPlaceholder(std::string& aBuffer, std::string_view aFormat);
+
+    // Placeholders left without an argument are kept as they are, arguments left without a placeholder are ignored.
+    static void AppendFormatted(std::string& aBuffer, std::string_view aFormat)
+    {
+        std::size_t lNext{AppendUntilPlaceholder(aBuffer, aFormat)};
+
+        while (lNext != std::string_view::npos) {
+            aBuffer += "{}";
+            aFormat.remove_prefix(lNext);
+            lNext = AppendUntilPlaceholder(aBuffer, aFormat);
+        }
+    }
+
+    template<typename First, typename... Rest>
+    static void
+    AppendFormatted(std::string& aBuffer, std::string_view aFormat, const First& aFirst, const Rest&... aRest)
+    {
+        std::size_t lNext{AppendUntilPlaceholder(aBuffer, aFormat)};
+
+        if (lNext != std::string_view::npos) {
+            AppendArgument(aBuffer, aFirst);
+            AppendFormatted(aBuffer, aFormat.substr(lNext), aRest...);
+        }
+    }
+
+    template<typename Type> static void AppendArgument(std::string& aBuffer, const Type& aArgument)
+    {
+        if constexpr (std::is_convertible_v<const Type&, std::string_view>) {
+            aBuffer += std::string_view(aArgument);
+        } else if constexpr (std::is_same_v<Type, bool>) {
+            aBuffer += aArgument ? "true" : "false";
+        } else if constexpr (std::is_same_v<Type, char>) {
+            aBuffer += aArgument;
+        } else if constexpr (std::is_integral_v<Type>) {
+            aBuffer += std::to_string(aArgument);
+        } else {
+            std::ostringstream lStream{};
+            lStream << aArgument;
+            aBuffer += lStream.str();
+        }
+    }
+
+    /**
+     * Hands a formatted message to the observer and, if the level is logged, to the writer.
+     */
+    void Submit(std::string_view aText, Level aLevel, const char* aFile, unsigned int aLine);
+
+    /**
+     * Sets the level log calls have to reach to be formatted at all.
+     */
+    void UpdateThreshold();
+
+    /**
+     * Queues a message, can be called from any thread.
+     * @return false if the queue is full.
+     */
+    bool Enqueue(std::string_view aText, Level aLevel, const char* aFile, unsigned int aLine);
+
+    /**
+     * Formats a message and appends it, with a newline, to a buffer.
+     */
+    static void FormatEntry(std::string&             aBuffer,
+                            std::string_view         aText,
+                            Level                    aLevel,
+                            std::chrono::nanoseconds aTimeStamp,
+                            const char*              aFile,
+                            unsigned int             aLine);
+
+    /**
+     * Formats everything in the queue and writes it out, only called by one thread at a time.
+     * @return true if anything was written.
+     */
+    bool WriteQueue();
+
+    /**
+     * Writes formatted messages to the screen and/or file.
+     * @param aBuffer - The formatted messages.
+     */
+    void Write(std::string_view aBuffer);
+
+    void HandleQueue();
+
+    std::string        mFileName{"log.txt"};
+    std::atomic<Level> mLogLevel{Logger::Level::ERROR};
+    std::atomic<Level> mThreshold{Logger::Level::ERROR}; /**< Lowest of the log level and the observer level. */
+    std::ofstream      mLogOutputStream{};
+    bool               mLogToDisk{false};
+    bool               mLogToScreen{false};
+    // Copied out under the mutex and called without holding it, so the observer can be replaced while in use.
+    std::mutex                      mObserverMutex{};
+    std::shared_ptr<const Observer> mObserver{nullptr};
+    Level                           mObserverLevel{Logger::Level::DEBUG};
+
+    // Bounded multi-producer queue, the writer thread is the only consumer.
+    std::unique_ptr<Record[]> mQueue{};
+    std::atomic<uint64_t>     mEnqueuePosition{0};
+    uint64_t                  mDequeuePosition{0};
+    std::atomic<uint64_t>     mWrittenPosition{0};
+    std::atomic<uint64_t>     mDropped{0};
+    uint64_t                  mDroppedReported{0};
+    std::string               mWriteBuffer{};
+
+    std::atomic<bool>              mRunning{false};
+    std::shared_ptr<boost::thread> mWriterThread{nullptr};
+    std::mutex                     mWriterMutex{};
+    std::condition_variable        mWriterCondition{};
+    std::condition_variable        mFlushCondition{};
+    // Held while writing to the outputs, and while changing them.
+    std::mutex mOutputMutex{};
 };
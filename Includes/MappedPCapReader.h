@@ -0,0 +1,252 @@
+#pragma once
+
+/* Copyright (c) 2020 [Rick de Bondt] - MappedPCapReader.h
+ *
+ * This file contains a pcap and pcapng file reader that maps the file into memory instead of using libpcap.
+ * Files ending in .zst are decompressed while reading.
+ *
+ * */
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "IPCapDevice.h"
+#include "ZstdStream.h"
+
+namespace MappedPCapReader_Constants
+{
+    // Classic pcap, as written in the byte order of the machine that made the capture.
+    static constexpr uint32_t    cPCapMagic{0xa1b2c3d4};
+    static constexpr uint32_t    cPCapNanoMagic{0xa1b23c4d};
+    static constexpr std::size_t cPCapHeaderLength{24};
+    static constexpr std::size_t cPCapRecordHeaderLength{16};
+
+    // PCapNG, see https://tools.ietf.org/id/draft-tuexen-opsawg-pcapng-02.html
+    static constexpr uint32_t    cSectionHeaderBlock{0x0a0d0d0a};
+    static constexpr uint32_t    cByteOrderMagic{0x1a2b3c4d};
+    static constexpr uint32_t    cInterfaceDescriptionBlock{1};
+    static constexpr uint32_t    cPacketBlock{2};
+    static constexpr uint32_t    cSimplePacketBlock{3};
+    static constexpr uint32_t    cEnhancedPacketBlock{6};
+    static constexpr uint16_t    cOptionEnd{0};
+    static constexpr uint16_t    cOptionTimeStampResolution{9};
+    static constexpr uint8_t     cDefaultTimeStampResolution{6};
+    static constexpr std::size_t cBlockHeaderLength{8};
+    static constexpr std::size_t cMinimumBlockLength{12};
+
+    // Decompressed data kept of a compressed file, a record or block has to fit in here.
+    static constexpr std::size_t cStreamWindowSize{4 * 1024 * 1024};
+
+    enum class Format
+    {
+        Unknown = 0,
+        PCap,
+        PCapNG
+    };
+
+    /**
+     * A frame in the capture file, Data points into the mapped file and stays valid until the reader is closed.
+     * For compressed files Data points into the decompressed window, and is only valid until the next read.
+     */
+    struct Frame
+    {
+        std::string_view         Data{};
+        uint32_t                 Length{0}; /**< Length on the wire, Data can be shorter if the capture was cut off. */
+        std::chrono::nanoseconds TimeStamp{0};
+        uint32_t                 Interface{0};
+        uint64_t                 Offset{0}; /**< Offset of the record in the (decompressed) file. */
+    };
+
+    /**
+     * Interface information from the file, classic pcap files have one.
+     */
+    struct Interface
+    {
+        uint16_t LinkType{0};
+        uint32_t SnapLength{0};
+        uint8_t  TimeStampResolution{cDefaultTimeStampResolution}; /**< pcapng if_tsresol. */
+    };
+
+    /**
+     * What is needed to read frames of a section, pcapng files can have several with their own byte order.
+     */
+    struct Section
+    {
+        uint32_t               Number{0};
+        bool                   Swapped{false};
+        std::vector<Interface> Interfaces{};
+    };
+}  // namespace MappedPCapReader_Constants
+
+/**
+ * Reads pcap and pcapng files by mapping them into memory and walking the blocks directly, frames are handed out
+ * without copying. Can be used wherever a PCapReader is used for reading.
+ * Compressed files are mapped as well, and decompressed into a fixed size window as the blocks are walked, so memory
+ * use does not grow with the size of the file. These can only be read front to back.
+ * */
+class MappedPCapReader : public IPCapDevice
+{
+public:
+    void Close() override;
+
+    /**
+     * Maps a capture file into memory.
+     * @param aName - Path to the pcap or pcapng file, optionally zstd compressed with a .zst extension.
+     * @param aFrequency - Unused, kept so this can replace a PCapReader.
+     * @return true if the file could be mapped and has a known format.
+     */
+    bool Open(std::string_view aName, uint16_t aFrequency);
+
+    bool Open(std::string_view aName, std::vector<std::string>& aSSIDFilter, uint16_t aFrequency) override;
+
+    bool ReadNextData() override;
+
+    /**
+     * Gets the last read frame, without copying it.
+     * @return The frame, with an empty view if nothing has been read yet.
+     */
+    [[nodiscard]] const MappedPCapReader_Constants::Frame& GetFrame() const;
+
+    const unsigned char* GetData() override;
+
+    const pcap_pkthdr* GetHeader() override;
+
+    std::string DataToString(const unsigned char* aData, const pcap_pkthdr* aHeader) override;
+
+    std::string LastDataToString() override;
+
+    /**
+     * Gets the format of the opened file.
+     * @return The format, Unknown if nothing is opened.
+     */
+    [[nodiscard]] MappedPCapReader_Constants::Format GetFormat() const;
+
+    /**
+     * Gets the interfaces seen so far, pcapng files can describe new interfaces anywhere in the file.
+     * @return The interfaces in order of their id.
+     */
+    [[nodiscard]] const std::vector<MappedPCapReader_Constants::Interface>& GetInterfaces() const;
+
+    /**
+     * Gets the offset in the file where the next block will be read.
+     * @return The offset in bytes.
+     */
+    [[nodiscard]] uint64_t GetOffset() const;
+
+    /**
+     * Continues reading at a given offset, the offset has to be the start of a record that has been read before, for
+     * pcapng the interfaces of its section have to be known already. For compressed files it has to be the record
+     * that was read last.
+     * @param aOffset - Offset of the record.
+     * @return true if the offset is inside the file.
+     */
+    bool SetOffset(uint64_t aOffset);
+
+    /**
+     * Continues reading at a given offset in a section that may not have been read yet, for example from an index.
+     * @param aOffset - Offset of the record.
+     * @param aSection - The section the record is in.
+     * @return true if the offset is inside the file.
+     */
+    bool SetOffset(uint64_t aOffset, const MappedPCapReader_Constants::Section& aSection);
+
+    /**
+     * Gets the number of the section being read, starting at 0, classic pcap files only have one.
+     * @return The section number.
+     */
+    [[nodiscard]] uint32_t GetSectionNumber() const;
+
+    /**
+     * Gets the byte order and interfaces of the section being read.
+     * @return A copy of the section information.
+     */
+    [[nodiscard]] MappedPCapReader_Constants::Section GetSection() const;
+
+    /**
+     * Gets the size of the mapped file.
+     * @return The size in bytes, compressed for compressed files.
+     */
+    [[nodiscard]] uint64_t GetSize() const;
+
+    /**
+     * Checks if the opened file is being decompressed while reading.
+     * @return true if the file is compressed.
+     */
+    [[nodiscard]] bool IsCompressed() const;
+
+    bool Send(std::string_view aData) override;
+
+    bool Send(std::string_view aData, IPCapDevice_Constants::WiFiBeaconInformation& aWiFiInformation) override;
+
+    void SetSendReceiveDevice(std::shared_ptr<ISendReceiveDevice> aDevice) override;
+
+private:
+    // Read a value in the byte order of the file, callers make sure the offset is available.
+    [[nodiscard]] uint16_t Read16(uint64_t aOffset) const;
+    [[nodiscard]] uint32_t Read32(uint64_t aOffset) const;
+
+    /**
+     * Gets the data at an offset in the file, callers make sure the offset is available.
+     * @param aOffset - Offset in the (decompressed) file.
+     * @return Pointer to the data.
+     */
+    [[nodiscard]] const char* At(uint64_t aOffset) const;
+
+    /**
+     * Makes sure the data from the current offset up to a given offset can be read. For compressed files data before
+     * the current offset may get thrown away to make room, so earlier frames are no longer valid after this.
+     * @param aEnd - Offset right after the data that is needed.
+     * @return false if the file is not that long.
+     */
+    bool Available(uint64_t aEnd);
+
+    bool ReadPCapHeader();
+    bool ReadPCapRecord();
+
+    /**
+     * Reads one pcapng block and moves past it.
+     * @param aIsFrame - Set to true if the block contained a frame.
+     * @return false at the end of the file or when the block is malformed.
+     */
+    bool ReadPCapNGBlock(bool& aIsFrame);
+    bool ReadSectionHeader(uint64_t aBlockOffset);
+    void ReadInterfaceDescription(uint64_t aBodyOffset, uint64_t aBodyEnd);
+
+    bool SetFrame(uint64_t aRecordOffset,
+                  uint64_t aDataOffset,
+                  uint32_t aCapturedLength,
+                  uint32_t aLength,
+                  uint32_t aInterface,
+                  uint64_t aTimeStamp);
+
+    /**
+     * Converts a timestamp in units of the interface resolution to nanoseconds.
+     * @param aTimeStamp - The timestamp from the file.
+     * @param aInterface - Interface the frame was captured on.
+     * @return Nanoseconds since epoch.
+     */
+    [[nodiscard]] std::chrono::nanoseconds ConvertTimeStamp(uint64_t aTimeStamp, uint32_t aInterface) const;
+
+    boost::interprocess::file_mapping                  mFile{};
+    boost::interprocess::mapped_region                 mRegion{};
+    const char*                                        mBegin{nullptr}; /**< Data at mBase. */
+    uint64_t                                           mBase{0};
+    uint64_t                                           mEnd{0}; /**< Offset right after the data that can be read. */
+    uint64_t                                           mSize{0};
+    bool                                               mCompressed{false};
+    std::vector<char>                                  mWindow{};
+    ZstdDecompressor                                   mDecompressor{};
+    uint64_t                                           mOffset{0};
+    bool                                               mSwapped{false};
+    uint32_t                                           mSectionNumber{0};
+    MappedPCapReader_Constants::Format                 mFormat{MappedPCapReader_Constants::Format::Unknown};
+    std::vector<MappedPCapReader_Constants::Interface> mInterfaces{};
+    MappedPCapReader_Constants::Frame                  mFrame{};
+    pcap_pkthdr                                        mHeader{};
+    std::shared_ptr<ISendReceiveDevice>                mSendReceiveDevice{nullptr};
+};
@@ -0,0 +1,172 @@
+#pragma once
+
+/* Copyright (c) 2020 [Rick de Bondt] - MetricsExporter.h
+ *
+ * This file contains an exporter that makes the statistics of the engine available to Prometheus.
+ *
+ * */
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <boost/asio.hpp>
+#include <boost/thread.hpp>
+
+#include "Statistics.h"
+
+namespace MetricsExporter_Constants
+{
+    static constexpr std::string_view cPrefix{"mondevtopromisc_"};
+    static constexpr std::string_view cContentType{"text/plain; version=0.0.4; charset=utf-8"};
+    static constexpr std::string_view cPath{"/metrics"};
+
+    static constexpr std::chrono::seconds cDefaultInterval{15};
+    static constexpr std::size_t          cMaxRequestLength{4096};
+
+    // Same as the control server, exporting should never take time from the bridge.
+    static constexpr int cNiceness{10};
+
+    // Latency buckets are powers of two nanoseconds, which line up exactly with buckets of the statistics. From about a
+    // microsecond up to the longest latency that is kept.
+    static constexpr unsigned int cFirstLatencyBucketBits{10};
+
+    // Digits of the bucket bounds and latency sums, enough for nanoseconds in over an hour.
+    static constexpr int cPrecision{13};
+
+    /**
+     * A counter exported with a label telling it apart from the other counters of the same metric.
+     */
+    struct LabeledCounter
+    {
+        std::string_view              Label;
+        Statistics_Constants::Counter Counter;
+    };
+
+    /**
+     * A metric made up of one or more counters.
+     */
+    struct CounterMetric
+    {
+        std::string_view              Name;
+        std::string_view              Help;
+        std::string_view              LabelName; /**< Empty for a metric of a single counter. */
+        std::array<LabeledCounter, 5> Counters;
+        std::size_t                   CounterCount;
+    };
+
+    static constexpr std::array<CounterMetric, 6> cCounterMetrics{
+        {{"frames_total",
+          "Frames bridged, by direction.",
+          "direction",
+          {{{"to_xlink_kai", Statistics_Constants::Counter::ForwardedToXLinkKai},
+            {"to_monitor", Statistics_Constants::Counter::Injected}}},
+          2},
+         {"bytes_total",
+          "Bytes bridged, by direction.",
+          "direction",
+          {{{"to_xlink_kai", Statistics_Constants::Counter::BytesToXLinkKai},
+            {"to_monitor", Statistics_Constants::Counter::BytesToMonitor}}},
+          2},
+         {"captured_frames_total",
+          "Frames captured by the monitor devices.",
+          "",
+          {{{"", Statistics_Constants::Counter::FramesCaptured}}},
+          1},
+         {"dropped_frames_total",
+          "Frames dropped, by reason. Kernel and interface drops are reported by pcap.",
+          "reason",
+          {{{"kernel", Statistics_Constants::Counter::KernelDrops},
+            {"interface", Statistics_Constants::Counter::InterfaceDrops},
+            {"queue", Statistics_Constants::Counter::QueueDrops},
+            {"conversion", Statistics_Constants::Counter::ConversionFailures},
+            {"inject", Statistics_Constants::Counter::InjectFailures}}},
+          5},
+         {"xlink_kai_reconnects_total",
+          "Connections to XLink Kai made again after one got lost.",
+          "",
+          {{{"", Statistics_Constants::Counter::XLinkKaiReconnects}}},
+          1},
+         {"bssid_switches_total",
+          "Times a monitor device started following another BSSID.",
+          "",
+          {{{"", Statistics_Constants::Counter::BSSIDSwitches}}},
+          1}}};
+}  // namespace MetricsExporter_Constants
+
+/**
+ * Class that exports the statistics in the Prometheus text format, either to scrapers connecting over HTTP on the
+ * loopback interface, or to a file for the textfile collector of the node exporter. Both take a snapshot of the
+ * statistics when exporting, on a thread of their own with a lower priority than the bridge.
+ */
+class MetricsExporter
+{
+public:
+    MetricsExporter() = default;
+    ~MetricsExporter();
+    MetricsExporter(const MetricsExporter& aMetricsExporter) = delete;
+    MetricsExporter& operator=(const MetricsExporter& aMetricsExporter) = delete;
+
+    /**
+     * Listens for scrapes over HTTP on the loopback interface.
+     * @param aPort - Port to listen on, 0 picks a free one.
+     * @return true if successful.
+     */
+    bool Listen(unsigned short aPort);
+
+    /**
+     * Gets the port scrapes are listened for on.
+     * @return The port, 0 when not listening.
+     */
+    [[nodiscard]] unsigned short GetPort() const;
+
+    /**
+     * Writes the metrics to a file at an interval, replacing the file at once so it is never read half written.
+     * @param aPath - Path of the file, should end in .prom for the textfile collector.
+     * @param aInterval - Time between writes, at least a second.
+     */
+    void SetTextFile(std::string_view     aPath,
+                     std::chrono::seconds aInterval = MetricsExporter_Constants::cDefaultInterval);
+
+    /**
+     * Starts exporting.
+     * @return true if successful.
+     */
+    bool StartThread();
+
+    /**
+     * Stops exporting, the text file is left as it was last written.
+     */
+    void Close();
+
+    /**
+     * Puts a snapshot of the statistics into the Prometheus text format.
+     * @param aSnapshot - The snapshot.
+     * @return The metrics.
+     */
+    static std::string Format(const Statistics_Constants::Snapshot& aSnapshot);
+
+    /**
+     * Writes text to a temporary file next to a path first and then renames it, so the file at the path is replaced
+     * at once.
+     * @param aPath - Path to write to.
+     * @param aText - Text to write.
+     * @return true if successful.
+     */
+    static bool WriteFileAtomically(const std::string& aPath, std::string_view aText);
+
+private:
+    class Connection;
+
+    void Accept();
+    void WriteTextFile();
+
+    std::shared_ptr<boost::asio::io_service>        mIoService{std::make_shared<boost::asio::io_service>()};
+    std::shared_ptr<boost::asio::ip::tcp::acceptor> mAcceptor{nullptr};
+    std::shared_ptr<boost::asio::steady_timer>      mTimer{nullptr};
+    std::string                                     mTextFilePath{};
+    std::chrono::seconds                            mInterval{MetricsExporter_Constants::cDefaultInterval};
+    std::shared_ptr<boost::thread>                  mThread{nullptr};
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+/* Copyright (c) 2020 [Rick de Bondt] - MonitorFrameHandler.h
+ *
+ * This file contains the handling of frames captured by a monitor mode device, shared by the real and virtual device.
+ *
+ * */
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "FlightRecorder.h"
+#include "IPCapDevice.h"
+#include "PacketConverter.h"
+#include "SessionRecorder.h"
+
+namespace MonitorFrameHandler_Constants
+{
+    /**
+     * What a captured frame turned out to be.
+     */
+    enum class FrameType
+    {
+        Beacon = 0,
+        Data,         /**< Data frame for the network that is followed, from an accepted source. */
+        FilteredData, /**< Data frame for another network or from another source. */
+        Other
+    };
+}  // namespace MonitorFrameHandler_Constants
+
+/**
+ * Classifies frames captured by a monitor mode device, follows the beacons of the network matching the SSID filter,
+ * and converts data frames for that network to 802.3 to forward them to the send/receive device. Everything is
+ * counted in the statistics. Frames are handled on one thread, the network that is followed can be read from any.
+ */
+class MonitorFrameHandler
+{
+public:
+    /**
+     * Handles a captured frame up to the point it can be forwarded, follows beacons matching the SSID filter.
+     * After this, the frame is loaded in the converter, see GetConverter.
+     * @param aData - The frame, with radiotap header.
+     * @return What the frame turned out to be.
+     */
+    MonitorFrameHandler_Constants::FrameType Classify(std::string_view aData);
+
+    /**
+     * Converts a data frame classified as MonitorFrameHandler_Constants::FrameType::Data to 802.3 and sends it to the
+     * send/receive device, retransmissions are skipped.
+     * @param aData - The frame, with radiotap header.
+     * @param aCaptured - Time the frame was captured, the time since then is counted as monitor to XLink Kai latency.
+     * @return true if the frame has been sent.
+     */
+    bool Forward(std::string_view aData, std::chrono::system_clock::time_point aCaptured);
+
+    /**
+     * Gets the converter the last classified frame is loaded in, only to be used on the thread handling frames.
+     * @return The converter.
+     */
+    PacketConverter& GetConverter();
+
+    /**
+     * Gets the network currently followed, safe to call from any thread.
+     * @return Copy of the SSID, BSSID and frequency in use.
+     */
+    IPCapDevice_Constants::WiFiBeaconInformation GetWifiInformation();
+
+    /**
+     * Sets the SSIDs to follow, set before handling frames.
+     * @param aSSIDFilter - The SSIDs, a beacon matches if its SSID contains one of them.
+     */
+    void SetSSIDFilter(std::vector<std::string> aSSIDFilter);
+
+    /**
+     * Only accepts data frames from this MAC address, set before handling frames.
+     * @param aMac - The MAC address, 0 to accept data frames from any source.
+     */
+    void SetSourceMACToFilter(uint64_t aMac);
+
+    /**
+     * Sets the SSID of the network currently followed.
+     * @param aSSID - The SSID.
+     */
+    void SetSSID(std::string_view aSSID);
+
+    /**
+     * Sets the BSSID to accept data frames for, without having to wait for a matching beacon.
+     * @param aBSSID - The BSSID.
+     */
+    void SetBSSID(uint64_t aBSSID);
+
+    /**
+     * Sets the frequency to inject on, until a matching beacon tells otherwise.
+     * @param aFrequency - The frequency.
+     */
+    void SetFrequency(uint16_t aFrequency);
+
+    /**
+     * Sets the device data frames are forwarded to, set before handling frames.
+     * @param aDevice - The device.
+     */
+    void SetSendReceiveDevice(std::shared_ptr<ISendReceiveDevice> aDevice);
+
+    /**
+     * Records forwarded frames, set before handling frames.
+     * @param aRecorder - The recorder, nullptr to stop recording.
+     */
+    void SetSessionRecorder(std::shared_ptr<SessionRecorder> aRecorder);
+
+    /**
+     * Keeps the last forwarded frames in a flight recorder, set before handling frames.
+     * @param aRecorder - The recorder, nullptr to stop recording.
+     */
+    void SetFlightRecorder(std::shared_ptr<FlightRecorder> aRecorder);
+
+private:
+    PacketConverter                              mConverter{true};
+    std::vector<std::string>                     mSSIDFilter{};
+    uint64_t                                     mSourceMACToFilter{0};
+    std::shared_ptr<ISendReceiveDevice>          mSendReceiveDevice{nullptr};
+    std::shared_ptr<SessionRecorder>             mSessionRecorder{nullptr};
+    std::shared_ptr<FlightRecorder>              mFlightRecorder{nullptr};
+    IPCapDevice_Constants::WiFiBeaconInformation mWifiInformation{};
+    // Guards writes to mWifiInformation and reads from other threads than the one handling frames.
+    std::mutex mWifiInformationMutex{};
+};
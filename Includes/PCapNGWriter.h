@@ -0,0 +1,62 @@
+#pragma once
+
+/* Copyright (c) 2020 [Rick de Bondt] - PCapNGWriter.h
+ *
+ * This file contains functions to build pcapng blocks in memory, so they can be written out in large batches.
+ *
+ * */
+
+#include <chrono>
+#include <string>
+#include <string_view>
+
+namespace PCapNGWriter_Constants
+{
+    static constexpr uint16_t cVersionMajor{1};
+    static constexpr uint16_t cVersionMinor{0};
+    static constexpr int64_t  cUnknownSectionLength{-1};
+    static constexpr uint16_t cOptionInterfaceName{2};
+    // Timestamps are written in nanoseconds, if_tsresol is a power of 10.
+    static constexpr uint8_t cNanosecondResolution{9};
+}  // namespace PCapNGWriter_Constants
+
+/**
+ * Builds pcapng blocks in the byte order of this machine, see
+ * https://tools.ietf.org/id/draft-tuexen-opsawg-pcapng-02.html for the format.
+ * */
+class PCapNGWriter
+{
+public:
+    /**
+     * Appends a section header block, has to be the start of every file.
+     * @param aBuffer - Buffer to append to.
+     */
+    static void AppendSectionHeader(std::string& aBuffer);
+
+    /**
+     * Appends an interface description block with nanosecond timestamps, interfaces are numbered in the order they
+     * are appended after the section header.
+     * @param aBuffer - Buffer to append to.
+     * @param aLinkType - Link type of the interface, for example DLT_EN10MB.
+     * @param aSnapLength - Maximum length of the frames stored.
+     * @param aName - Name of the interface.
+     */
+    static void AppendInterface(std::string&     aBuffer,
+                                uint16_t         aLinkType,
+                                uint32_t         aSnapLength,
+                                std::string_view aName);
+
+    /**
+     * Appends an enhanced packet block.
+     * @param aBuffer - Buffer to append to.
+     * @param aInterface - Number of the interface the frame belongs to.
+     * @param aTimeStamp - Time since epoch.
+     * @param aData - The frame as stored.
+     * @param aOriginalLength - Length of the frame before it was cut off to fit.
+     */
+    static void AppendPacket(std::string&             aBuffer,
+                             uint32_t                 aInterface,
+                             std::chrono::nanoseconds aTimeStamp,
+                             std::string_view         aData,
+                             uint32_t                 aOriginalLength);
+};
@@ -6,12 +6,47 @@
  *
  * */
 
+#include <chrono>
+#include <functional>
+
+#include "CaptureIndex.h"
 #include "IPCapDevice.h"
+#include "MappedPCapReader.h"
 #include "PacketConverter.h"
 #include "XLinkKaiConnection.h"
 
+namespace PCapReader_Constants
+{
+    // Time before a deadline where replay stops sleeping and starts spinning, adjusted to the measured oversleep.
+    static constexpr std::chrono::microseconds cDefaultSpinTime{200};
+    static constexpr std::chrono::microseconds cMinSpinTime{20};
+    static constexpr std::chrono::microseconds cMaxSpinTime{2000};
+
+    /**
+     * How packets should be paced during a replay.
+     */
+    struct ReplaySettings
+    {
+        double                   Speed{1.0};           /**< Multiplier for replay speed, 2.0 replays twice as fast. */
+        bool                     MaxThroughput{false}; /**< Ignore timestamps and send as fast as possible. */
+        std::chrono::nanoseconds Length{0};            /**< Capture time to replay, 0 replays until the end. */
+    };
+
+    /**
+     * How accurately the last replay matched the timing of the capture.
+     */
+    struct ReplayStatistics
+    {
+        unsigned int             Packets{0};
+        std::chrono::nanoseconds Duration{0};
+        std::chrono::nanoseconds MeanError{0}; /**< Average lateness compared to the scheduled send time. */
+        std::chrono::nanoseconds MaxError{0};
+    };
+}  // namespace PCapReader_Constants
+
 /**
  * This class contains the necessary components to read a PCap file.
+ * Files are memory mapped and read through MappedPCapReader when possible, libpcap is used for anything else.
  * */
 class PCapReader : public IPCapDevice
 {
@@ -42,15 +77,53 @@ public:
     /**
      * Replays packets from file to injection device / XLink Kai.
      * Assumes no packets have been read from the opened file yet.
+     * Packets are scheduled against absolute deadlines from the start of the replay, so lateness does not build up.
      * Tip: Put into separate thread for better timing accuracy.
      * @param aMonitorCapture - If the file was captured in monitor mode.
      * @param aHasRadioTap - If the file has radiotap headers.
+     * @param aSettings - Speed of the replay.
      * @return pair with amount of packets sent and whether it has fully replayed them or not.
      */
-    std::pair<bool, unsigned int> ReplayPackets(bool aMonitorCapture = false, bool aHasRadioTap = false);
+    std::pair<bool, unsigned int> ReplayPackets(bool                                        aMonitorCapture = false,
+                                                bool                                        aHasRadioTap    = false,
+                                                const PCapReader_Constants::ReplaySettings& aSettings       = {});
+
+    /**
+     * Gets the timing accuracy of the last replay.
+     * @return The statistics of the last call to ReplayPackets.
+     */
+    [[nodiscard]] const PCapReader_Constants::ReplayStatistics& GetReplayStatistics() const;
 
     void SetSendReceiveDevice(std::shared_ptr<ISendReceiveDevice> aDevice) override;
 
+    /**
+     * Loads the index sidecar of the opened capture, needed for seeking. Only memory mapped captures can be indexed.
+     * @param aBuild - Build and save the index if there is none or it is outdated.
+     * @return true if an index is available.
+     */
+    bool LoadIndex(bool aBuild = true);
+
+    /**
+     * Moves to the first packet at or after a point in time, the next ReadNextData or ReplayPackets starts there.
+     * Needs an index, see LoadIndex.
+     * @param aTimeStamp - Capture time in nanoseconds since epoch.
+     * @return true if there is such a packet.
+     */
+    bool SeekToTime(std::chrono::nanoseconds aTimeStamp);
+
+    /**
+     * Moves to a packet, the next ReadNextData or ReplayPackets starts there. Needs an index, see LoadIndex.
+     * @param aPacket - Number of the packet, starting at 0.
+     * @return true if there is such a packet.
+     */
+    bool SeekToPacket(uint64_t aPacket);
+
+    /**
+     * Gets the index of the opened capture.
+     * @return The index, empty if LoadIndex has not been called successfully.
+     */
+    [[nodiscard]] const CaptureIndex& GetIndex() const;
+
     /**
      * Constructs and replays a packet to given interface.
      * @param aData - The data to replay.
@@ -64,12 +137,57 @@ public:
                                                    PacketConverter      aPacketConverter,
                                                    bool                 aMonitorCapture);
 
+    /**
+     * Constructs and replays a packet to given interface, without copying it when it can be sent as is.
+     * @param aData - The packet, only has to stay valid during the call.
+     * @param aPacketConverter - A PacketConverter object.
+     * @param aMonitorCapture - Whether the capture was made in monitor mode.
+     * @return a pair containing, succesfully sent (or ignored) and whether the packet was useful enough to be sent.
+     */
+    std::pair<bool, bool> ConstructAndReplayPacket(std::string_view aData,
+                                                   PacketConverter& aPacketConverter,
+                                                   bool             aMonitorCapture);
+
 private:
+    /**
+     * Moves to an index position and then reads forward until the predicate matches a frame.
+     * @param aPosition - Position from the index to start at.
+     * @param aFound - Predicate that gets the packet number and the frame.
+     * @return true if a frame matched, the reader is then positioned right before it.
+     */
+    bool SeekFrom(const CaptureIndex_Constants::Position&                                        aPosition,
+                  const std::function<bool(uint64_t, const MappedPCapReader_Constants::Frame&)>& aFound);
+
+    /**
+     * Gets the last read packet, pointing into the capture file when it is memory mapped.
+     * @return The packet, empty if nothing has been read.
+     */
+    [[nodiscard]] std::string_view GetFrameData() const;
+
+    /**
+     * Gets the capture time of the last read packet, in nanoseconds when the capture has them.
+     * @return Time since epoch, 0 if nothing has been read.
+     */
+    [[nodiscard]] std::chrono::nanoseconds GetFrameTimeStamp() const;
+
+    /**
+     * Waits until the deadline, sleeps for most of the time and spins for the last part.
+     * @param aDeadline - Time to wait until.
+     */
+    void WaitUntil(std::chrono::steady_clock::time_point aDeadline);
+
     const unsigned char*                         mData{nullptr};
     pcap_t*                                      mHandler{nullptr};
-    pcap_pkthdr*                                 mHeader{nullptr};
+    const pcap_pkthdr*                           mHeader{nullptr};
+    MappedPCapReader                             mMappedReader{};
+    bool                                         mMapped{false};
+    std::string                                  mFileName{};
+    CaptureIndex                                 mIndex{};
+    bool                                         mIndexLoaded{false};
     std::vector<std::string>                     mSSIDFilter{};
     unsigned int                                 mPacketCount{0};
     std::shared_ptr<ISendReceiveDevice>          mSendReceiveDevice{nullptr};
     IPCapDevice_Constants::WiFiBeaconInformation mWifiInformation{};
+    PCapReader_Constants::ReplayStatistics       mReplayStatistics{};
+    std::chrono::nanoseconds                     mSpinTime{PCapReader_Constants::cDefaultSpinTime};
 };
@@ -40,6 +40,13 @@ public:
      */
     static uint64_t MacToInt(std::string_view aMac);
 
+    /**
+     * Converts a mac address as returned by MacToInt back to a string in format (xx:xx:xx:xx:xx:xx).
+     * @param aMac - The mac address to convert.
+     * @return string with the mac address.
+     */
+    static std::string IntToMac(uint64_t aMac);
+
     /**
      * Swaps endianness of Mac.
      * @param aMac - Mac to swap.
@@ -165,6 +172,13 @@ public:
      */
     static int ConvertChannelToFrequency(int aChannel);
 
+    /**
+     * Converts a frequency into a channel.
+     * @param aFrequency - Frequency to convert.
+     * @return channel as int or -1 if invalid.
+     */
+    static int ConvertFrequencyToChannel(int aFrequency);
+
     /**
      * Creaetes an acknowledgement frame based on MAC-address.
      * @param aReceiverMac - MAC address to fill in.
@@ -184,6 +198,11 @@ public:
      */
     bool IsFromMac(std::string_view aData, uint64_t aMac);
 
+    /**
+     * Gets the radiotap information of the packet passed to the last Update call.
+     * @return The radiotap reader.
+     */
+    [[nodiscard]] const RadioTapReader& GetRadioTapReader() const;
 
 private:
     void InsertRadioTapHeader(char* aPacket, uint16_t aFrequency, uint8_t aMaxRate) const;
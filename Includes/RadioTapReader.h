@@ -70,6 +70,20 @@ public:
      */
     [[nodiscard]] uint16_t GetChannelFlags() const;
 
+    /**
+     * Checks if the radiotap header contains the antenna signal.
+     * @note Has to be called after running FillRadioTapParameters.
+     * @return true if GetSignal returns a measured value.
+     */
+    [[nodiscard]] bool HasSignal() const;
+
+    /**
+     * Gets the antenna signal in the radiotap header.
+     * @note Has to be called after running FillRadioTapParameters.
+     * @return the signal strength in dBm.
+     */
+    [[nodiscard]] int8_t GetSignal() const;
+
 private:
     uint16_t mLength{0};
     uint32_t mPresentFlags{RadioTap_Constants::cSendPresentFlags};
@@ -77,4 +91,6 @@ private:
     uint8_t  mDataRate{RadioTap_Constants::cRateFlags};
     uint16_t mFrequency{RadioTap_Constants::cChannel};
     uint16_t mChannelFlags{RadioTap_Constants::cChannelFlags};
+    bool     mHasSignal{false};
+    int8_t   mSignal{0};
 };
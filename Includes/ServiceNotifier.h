@@ -0,0 +1,78 @@
+#pragma once
+
+/* Copyright (c) 2020 [Rick de Bondt] - ServiceNotifier.h
+ *
+ * This file contains functions to tell a service manager, such as systemd, what state the program is in.
+ *
+ * */
+
+#include <string>
+#include <string_view>
+
+namespace ServiceNotifier_Constants
+{
+    // Environment variable the service manager passes its socket in, abstract sockets start with an @.
+    static constexpr std::string_view cSocketVariable{"NOTIFY_SOCKET"};
+
+    static constexpr std::string_view cReady{"READY=1"};
+    static constexpr std::string_view cReloading{"RELOADING=1"};
+    static constexpr std::string_view cStopping{"STOPPING=1"};
+    static constexpr std::string_view cStatus{"STATUS="};
+    static constexpr std::string_view cMonotonicTime{"MONOTONIC_USEC="};
+}  // namespace ServiceNotifier_Constants
+
+/**
+ * Class that sends readiness, reload and status notifications to the service manager. It speaks the datagram
+ * protocol of sd_notify directly, so no systemd library is needed. When the program was not started by a service
+ * manager nothing is sent.
+ */
+class ServiceNotifier
+{
+public:
+    /**
+     * Reads the socket to notify from the environment.
+     */
+    ServiceNotifier();
+
+    /**
+     * Gets whether there is a service manager to notify.
+     * @return true if the program was started by a service manager.
+     */
+    [[nodiscard]] bool IsEnabled() const;
+
+    /**
+     * Tells the service manager the program has started, or has finished reloading.
+     * @param aStatus - Status text to show next to it, empty for none.
+     * @return true if the notification was sent.
+     */
+    bool NotifyReady(std::string_view aStatus = "");
+
+    /**
+     * Tells the service manager the program is reloading its configuration, NotifyReady has to follow.
+     * @return true if the notification was sent.
+     */
+    bool NotifyReloading();
+
+    /**
+     * Tells the service manager the program is shutting down.
+     * @return true if the notification was sent.
+     */
+    bool NotifyStopping();
+
+    /**
+     * Sends a status text to show for the service.
+     * @param aStatus - Status text, a single line.
+     * @return true if the notification was sent.
+     */
+    bool NotifyStatus(std::string_view aStatus);
+
+    /**
+     * Sends a notification to the service manager.
+     * @param aState - One or more newline separated VARIABLE=value assignments.
+     * @return true if the notification was sent.
+     */
+    bool Notify(std::string_view aState);
+
+private:
+    std::string mSocketPath{};
+};
@@ -0,0 +1,183 @@
+#pragma once
+
+/* Copyright (c) 2020 [Rick de Bondt] - SessionRecorder.h
+ *
+ * This file contains a recorder that writes the traffic crossing the bridge to pcapng files in the background.
+ *
+ * */
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <boost/thread.hpp>
+#include <pcap/pcap.h>
+
+#include "ZstdStream.h"
+
+namespace SessionRecorder_Constants
+{
+    static constexpr std::string_view cDefaultPath{"session"};
+    static constexpr std::string_view cExtension{".pcapng"};
+
+    // Has to be a power of two, about a second of traffic for a busy session.
+    static constexpr std::size_t               cDefaultQueueSize{8192};
+    static constexpr uint64_t                  cDefaultMaxFileSize{64ULL * 1024 * 1024};
+    static constexpr std::chrono::seconds      cDefaultMaxFileDuration{3600};
+    static constexpr std::size_t               cBatchSize{256 * 1024};
+    static constexpr std::chrono::milliseconds cFlushInterval{500};
+    static constexpr std::chrono::milliseconds cIdleTime{2};
+    static constexpr uint32_t                  cSnapLength{65535};
+
+    /**
+     * Direction of a frame through the bridge, every direction is a separate interface in the recording.
+     */
+    enum class Direction
+    {
+        ToXLinkKai = 0, /**< Captured by the monitor device and converted to ethernet. */
+        ToMonitor       /**< Received from XLink Kai and injected as 802.11. */
+    };
+
+    static constexpr std::array<std::string_view, 2> cDirectionTexts{"to_xlink_kai", "to_monitor"};
+    static constexpr std::array<uint16_t, 2>         cDirectionLinkTypes{DLT_EN10MB, DLT_IEEE802_11_RADIO};
+
+    struct Settings
+    {
+        std::string          Path{cDefaultPath}; /**< Files are named <Path>_<start time>_<number>.pcapng. */
+        uint64_t             MaxFileSize{cDefaultMaxFileSize}; /**< Size on disk, so compressed when compressing. */
+        std::chrono::seconds MaxFileDuration{cDefaultMaxFileDuration};
+        unsigned int         MaxFiles{0}; /**< Oldest files get removed above this amount, 0 keeps all. */
+        std::size_t          QueueSize{cDefaultQueueSize};
+        bool                 Compress{false}; /**< Compresses the files with zstd, .zst gets added to the names. */
+    };
+}  // namespace SessionRecorder_Constants
+
+/**
+ * Records frames in both directions through the bridge to pcapng files. Recording a frame only moves it onto a
+ * lock-free queue, a background thread writes them out in large batches and rotates the files by size and age.
+ * When the queue is full frames are dropped instead of slowing the bridge down.
+ * */
+class SessionRecorder
+{
+public:
+    explicit SessionRecorder(SessionRecorder_Constants::Settings aSettings = {});
+    ~SessionRecorder();
+    SessionRecorder(const SessionRecorder& aSessionRecorder) = delete;
+    SessionRecorder& operator=(const SessionRecorder& aSessionRecorder) = delete;
+
+    /**
+     * Opens the first file and starts the background writer.
+     * @return true if successful, false if compression is requested but not available in this build.
+     */
+    bool Open();
+
+    /**
+     * Writes out everything still queued, closes the file and stops the background writer.
+     */
+    void Close();
+
+    /**
+     * Queues a frame to be recorded, safe to call from any thread.
+     * @param aDirection - Direction the frame went through the bridge.
+     * @param aData - The frame, moved in so it does not get copied.
+     * @return false if the frame was dropped because the queue is full or the recorder is not open.
+     */
+    bool Record(SessionRecorder_Constants::Direction aDirection, std::string aData);
+
+    /**
+     * Gets the amount of frames queued for recording since opening.
+     * @return The amount.
+     */
+    [[nodiscard]] uint64_t GetRecordedCount() const;
+
+    /**
+     * Gets the amount of frames dropped because the queue was full since opening.
+     * @return The amount.
+     */
+    [[nodiscard]] uint64_t GetDroppedCount() const;
+
+    /**
+     * Gets the files written since opening that have not been removed, oldest first.
+     * @return Paths of the files.
+     */
+    [[nodiscard]] std::vector<std::string> GetFiles() const;
+
+    /**
+     * Appends the section header and the interface for every direction, the start of every recording.
+     * @param aBuffer - Buffer to append to.
+     */
+    static void AppendFileHeader(std::string& aBuffer);
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t>                Sequence{0};
+        std::chrono::nanoseconds             TimeStamp{0};
+        SessionRecorder_Constants::Direction FrameDirection{SessionRecorder_Constants::Direction::ToXLinkKai};
+        std::string                          Data{};
+    };
+
+    /**
+     * Takes the oldest frame off the queue, only called by the writer.
+     * @param aSlot - Slot to move the frame into.
+     * @return false if the queue is empty.
+     */
+    bool Dequeue(Slot& aSlot);
+
+    /**
+     * Runs on the writer thread until the recorder is closed and the queue is empty.
+     */
+    void WriteFrames();
+
+    /**
+     * Adds a frame to the batch, rotating to a new file first if the current one is full or too old.
+     * @param aSlot - The frame.
+     */
+    void AppendFrame(const Slot& aSlot);
+
+    /**
+     * Writes the batch to the current file.
+     */
+    void Flush();
+
+    /**
+     * Closes the current file and starts a new one with its own section and interface blocks.
+     * @return true if successful.
+     */
+    bool OpenFile();
+
+    /**
+     * Ends the compressed frame if compressing, and closes the current file.
+     */
+    void CloseFile();
+
+    SessionRecorder_Constants::Settings mSettings;
+    std::vector<Slot>                   mSlots;
+    uint64_t                            mMask;
+    std::atomic<uint64_t>               mEnqueuePosition{0};
+    uint64_t                            mDequeuePosition{0};
+    std::atomic<bool>                   mRunning{false};
+    std::atomic<uint64_t>               mRecordedCount{0};
+    std::atomic<uint64_t>               mDroppedCount{0};
+    std::shared_ptr<boost::thread>      mWriterThread{nullptr};
+
+    // Only used by the writer thread, or while it is not running.
+    std::ofstream                         mFile{};
+    std::string                           mBatch{};
+    ZstdCompressor                        mCompressor{};
+    std::string                           mCompressed{};
+    uint64_t                              mFileSize{0};
+    unsigned int                          mFileNumber{0};
+    std::string                           mStartTime{};
+    std::chrono::steady_clock::time_point mFileOpened{};
+    std::chrono::steady_clock::time_point mLastFlush{};
+
+    mutable std::mutex       mFilesMutex{};
+    std::vector<std::string> mFiles{};
+};
@@ -0,0 +1,268 @@
+#pragma once
+
+/* Copyright (c) 2020 [Rick de Bondt] - Statistics.h
+ *
+ * This file contains the counters the engine keeps about the traffic going through it.
+ *
+ * */
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string_view>
+
+#include "Histogram.h"
+
+namespace Statistics_Constants
+{
+    /**
+     * Everything that is counted, frames unless stated otherwise.
+     */
+    enum class Counter
+    {
+        FramesCaptured = 0,
+        BeaconFrames,
+        DataFrames,
+        OtherFrames,
+        FilteredBSSID,      /**< Data frames for another BSSID. */
+        FilteredMAC,        /**< Data frames from another MAC than the one to filter on. */
+        FilteredSSID,       /**< Beacons with an SSID that does not match the filter. */
+        Converted,          /**< In both directions. */
+        ConversionFailures, /**< In both directions. */
+        ForwardedToXLinkKai,
+        ReceivedFromXLinkKai,
+        Injected,
+        InjectFailures,
+        AcknowledgementsSent,
+        KernelDrops,    /**< Dropped by the capture buffer, as reported by pcap_stats. */
+        InterfaceDrops, /**< Dropped by the network interface, as reported by pcap_stats. */
+        QueueDrops,     /**< Dropped by queues in the engine. */
+        BytesToXLinkKai,
+        BytesToMonitor,
+        XLinkKaiReconnects, /**< Connections to XLink Kai made again after one got lost. */
+        BSSIDSwitches,      /**< Times a monitor device started following another BSSID. */
+        Count
+    };
+
+    static constexpr std::size_t cCounterCount{static_cast<std::size_t>(Counter::Count)};
+
+    // Names fit for exporting, in the same order as the counters.
+    static constexpr std::array<std::string_view, cCounterCount> cCounterNames{"frames_captured",
+                                                                               "beacon_frames",
+                                                                               "data_frames",
+                                                                               "other_frames",
+                                                                               "filtered_bssid",
+                                                                               "filtered_mac",
+                                                                               "filtered_ssid",
+                                                                               "converted",
+                                                                               "conversion_failures",
+                                                                               "forwarded_to_xlink_kai",
+                                                                               "received_from_xlink_kai",
+                                                                               "injected",
+                                                                               "inject_failures",
+                                                                               "acknowledgements_sent",
+                                                                               "kernel_drops",
+                                                                               "interface_drops",
+                                                                               "queue_drops",
+                                                                               "bytes_to_xlink_kai",
+                                                                               "bytes_to_monitor",
+                                                                               "xlink_kai_reconnects",
+                                                                               "bssid_switches"};
+
+    /**
+     * Time frames spend in the bridge, from capture or arrival until they are handed to be sent.
+     */
+    enum class Latency
+    {
+        MonitorToXLinkKai = 0,
+        XLinkKaiToMonitor,
+        Acknowledgement, /**< From capturing a data frame until its acknowledgement is injected. */
+        Count
+    };
+
+    static constexpr std::size_t cLatencyCount{static_cast<std::size_t>(Latency::Count)};
+
+    static constexpr std::array<std::string_view, cLatencyCount> cLatencyNames{
+        "monitor_to_xlink_kai", "xlink_kai_to_monitor", "acknowledgement"};
+
+    // Latencies are kept in nanoseconds up to about 68 seconds, anything longer is counted as that.
+    static constexpr unsigned int cLatencyBits{36};
+    static constexpr std::size_t  cLatencyBuckets{Histogram_Constants::GetBucketCount(cLatencyBits)};
+
+    static constexpr std::size_t cCacheLineSize{64};
+
+    /**
+     * Latencies of one kind, counted per bucket.
+     */
+    struct LatencyHistogram
+    {
+        std::array<uint64_t, cLatencyBuckets> Buckets{};
+        uint64_t                              Count{0};
+        std::chrono::nanoseconds              Sum{0};
+        std::chrono::nanoseconds              Max{0};
+
+        /**
+         * Counts a latency, for histograms kept outside of the registry. Not thread safe.
+         * @param aDuration - The latency, everything beyond the last bucket is counted in the last bucket.
+         */
+        void Add(std::chrono::nanoseconds aDuration)
+        {
+            std::chrono::nanoseconds lDuration{std::max(aDuration, std::chrono::nanoseconds(0))};
+            auto                     lValue{static_cast<uint64_t>(lDuration.count())};
+            Buckets.at(std::min(Histogram_Constants::GetBucket(lValue), cLatencyBuckets - 1))++;
+            Count++;
+            Sum += lDuration;
+            Max = std::max(Max, lDuration);
+        }
+
+        /**
+         * Gets a percentile, as precise as the buckets it is kept in.
+         * @param aPercentile - Percentile between 0 and 100.
+         * @return The latency, 0 if nothing has been counted.
+         */
+        [[nodiscard]] std::chrono::nanoseconds GetPercentile(double aPercentile) const
+        {
+            std::size_t lBucket{Histogram_Constants::GetPercentileBucket(Buckets, aPercentile)};
+            return std::min(std::chrono::nanoseconds(Histogram_Constants::GetBucketValue(lBucket)), Max);
+        }
+    };
+
+    /**
+     * All counters and latencies at one point in time.
+     */
+    struct Snapshot
+    {
+        std::chrono::steady_clock::time_point       TimeStamp{};
+        std::array<uint64_t, cCounterCount>         Counters{};
+        std::array<LatencyHistogram, cLatencyCount> Latencies{};
+
+        /**
+         * Gets the value of a counter.
+         * @param aCounter - The counter.
+         * @return The value.
+         */
+        [[nodiscard]] uint64_t Get(Counter aCounter) const
+        {
+            return Counters.at(static_cast<std::size_t>(aCounter));
+        }
+
+        /**
+         * Gets the latencies of one kind.
+         * @param aLatency - The kind of latency.
+         * @return The latencies.
+         */
+        [[nodiscard]] const LatencyHistogram& Get(Latency aLatency) const
+        {
+            return Latencies.at(static_cast<std::size_t>(aLatency));
+        }
+    };
+}  // namespace Statistics_Constants
+
+/**
+ * Engine wide registry of counters and latency histograms. Every thread that counts gets a block of counters of its
+ * own, on cache lines of its own, so counting never contends with other threads: it is a plain load and store without
+ * a lock or read-modify-write. The blocks are only added up when a snapshot is taken.
+ * */
+class Statistics
+{
+public:
+    static Statistics& GetInstance()
+    {
+        static Statistics lInstance;
+        return lInstance;
+    }
+
+    Statistics(const Statistics& aStatistics) = delete;
+    Statistics& operator=(const Statistics& aStatistics) = delete;
+
+    /**
+     * Adds to a counter, safe to call from any thread.
+     * @param aCounter - The counter to add to.
+     * @param aAmount - Amount to add.
+     */
+    void Add(Statistics_Constants::Counter aCounter, uint64_t aAmount = 1)
+    {
+        AddOwned(GetBlock().Counters[static_cast<std::size_t>(aCounter)], aAmount);
+    }
+
+    /**
+     * Counts the time a frame spent in the bridge, safe to call from any thread.
+     * @param aLatency - The kind of latency.
+     * @param aDuration - The time, negative times (the clock was set back) are counted as 0.
+     */
+    void AddLatency(Statistics_Constants::Latency aLatency, std::chrono::nanoseconds aDuration);
+
+    /**
+     * Counts the time a frame spent in the bridge up till now, safe to call from any thread.
+     * @param aLatency - The kind of latency.
+     * @param aArrival - Time the frame was captured or arrived.
+     */
+    void AddLatency(Statistics_Constants::Latency aLatency, std::chrono::system_clock::time_point aArrival)
+    {
+        AddLatency(aLatency, std::chrono::system_clock::now() - aArrival);
+    }
+
+    /**
+     * Adds up the counters and latencies of all threads, safe to call from any thread.
+     * @return The counters and latencies.
+     */
+    [[nodiscard]] Statistics_Constants::Snapshot GetSnapshot() const;
+
+private:
+    using AtomicBuckets = std::array<std::atomic<uint64_t>, Statistics_Constants::cLatencyBuckets>;
+
+    struct alignas(Statistics_Constants::cCacheLineSize) Block
+    {
+        std::array<std::atomic<uint64_t>, Statistics_Constants::cCounterCount> Counters{};
+        std::array<AtomicBuckets, Statistics_Constants::cLatencyCount>         LatencyBuckets{};
+        std::array<std::atomic<int64_t>, Statistics_Constants::cLatencyCount>  LatencySum{}; /**< In nanoseconds. */
+        std::array<std::atomic<int64_t>, Statistics_Constants::cLatencyCount>  LatencyMax{}; /**< In nanoseconds. */
+        bool                                                                   InUse{false};
+    };
+
+    /**
+     * Adds to a value in the block of the calling thread. Only this thread writes to it, so there is no need for a
+     * read-modify-write, the atomic is only there so snapshots can read the value while it changes.
+     * @param aValue - The value to add to.
+     * @param aAmount - Amount to add.
+     */
+    template<typename Value> static void AddOwned(std::atomic<Value>& aValue, Value aAmount)
+    {
+        aValue.store(aValue.load(std::memory_order_relaxed) + aAmount, std::memory_order_relaxed);
+    }
+
+    // Hands the block of a thread back when the thread exits, the counts in it are kept.
+    class BlockHandle
+    {
+    public:
+        explicit BlockHandle(Statistics& aStatistics);
+        ~BlockHandle();
+        BlockHandle(const BlockHandle& aBlockHandle) = delete;
+        BlockHandle& operator=(const BlockHandle& aBlockHandle) = delete;
+
+        Statistics& mStatistics;
+        Block&      mBlock;
+    };
+
+    Statistics() = default;
+
+    Block& GetBlock()
+    {
+        thread_local BlockHandle lHandle{*this};
+        return lHandle.mBlock;
+    }
+
+    /**
+     * Gets a block no running thread uses, reusing the block of a thread that has exited if there is one.
+     * @return The block.
+     */
+    Block& AcquireBlock();
+
+    void ReleaseBlock(Block& aBlock);
+
+    mutable std::mutex mBlocksMutex{};
+    std::deque<Block>  mBlocks{}; /**< A deque so blocks stay in place when one gets added. */
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+/* Copyright (c) 2020 [Rick de Bondt] - ThreadName.h
+ *
+ * This file contains a function to name threads, so they can be told apart in top, a debugger or /proc.
+ *
+ * */
+
+#include <string>
+#include <string_view>
+
+#if defined(__linux__)
+#include <pthread.h>
+#endif
+
+namespace ThreadName_Constants
+{
+    // Linux does not allow longer names, not counting the terminator.
+    static constexpr std::size_t cMaxNameLength{15};
+
+    /**
+     * Names the calling thread, does nothing on platforms that do not support naming threads.
+     * @param aName - Name of the thread, cut off at cMaxNameLength characters.
+     */
+    inline void SetCurrentThreadName(std::string_view aName)
+    {
+#if defined(__linux__)
+        std::string lName{aName.substr(0, cMaxNameLength)};
+        pthread_setname_np(pthread_self(), lName.c_str());
+#endif
+    }
+}  // namespace ThreadName_Constants
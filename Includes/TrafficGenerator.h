@@ -0,0 +1,145 @@
+#pragma once
+
+/* Copyright (c) 2020 [Rick de Bondt] - TrafficGenerator.h
+ *
+ * This file contains functions to synthesise traffic of multiple virtual consoles, for load testing.
+ *
+ * */
+
+#include <array>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "NetworkingHeaders.h"
+#include "PacketConverter.h"
+
+namespace TrafficGenerator_Constants
+{
+    // Local experimental EtherType, so generated frames never get mistaken for game traffic.
+    static constexpr uint16_t cEtherType{0x88b5};
+    static constexpr uint32_t cMagic{0x444e4f4d};
+    static constexpr uint64_t cBroadcastMac{0xFFFFFFFFFFFF};
+    // Locally administered MAC range, the console number gets added to it.
+    static constexpr uint64_t cBaseMac{0x020000000000};
+    static constexpr uint64_t cDefaultBSSID{0x02000000ffff};
+
+    static constexpr unsigned int cMinFrameSize{64};
+    static constexpr unsigned int cMaxFrameSize{1500};
+
+    // Where the generated payload starts in an 802.3 frame and in an 802.11 frame with radiotap header.
+    static constexpr unsigned int c8023PayloadIndex{Net_8023_Constants::cHeaderLength};
+    static constexpr unsigned int c80211PayloadIndex{RadioTap_Constants::cRadioTapSize + sizeof(ieee80211_hdr) +
+                                                     Net_80211_Constants::cLLCLength};
+
+    /**
+     * How frame sizes are picked between the minimum and maximum size.
+     */
+    enum class SizeDistribution
+    {
+        Fixed = 0, /**< Always the minimum size. */
+        Uniform,   /**< Evenly spread between minimum and maximum. */
+        Bimodal    /**< Mostly small frames with some frames at maximum size, like most games send. */
+    };
+
+    static constexpr std::array<std::string_view, 3> cSizeDistributionTexts{"fixed", "uniform", "bimodal"};
+
+    /**
+     * Settings for the traffic to generate.
+     */
+    struct Settings
+    {
+        unsigned int     Consoles{8};
+        double           PacketsPerSecond{100.0}; /**< Per console. */
+        unsigned int     MinSize{cMinFrameSize};
+        unsigned int     MaxSize{512};
+        SizeDistribution Distribution{SizeDistribution::Uniform};
+        double           BroadcastRatio{0.1};
+        uint64_t         BSSID{cDefaultBSSID};
+        uint16_t         Frequency{RadioTap_Constants::cChannel};
+        unsigned int     Seed{0};
+    };
+
+    /**
+     * Information embedded in every generated frame.
+     */
+    struct FrameInformation
+    {
+        bool                                  Valid{false};
+        uint16_t                              Console{0};
+        uint32_t                              Sequence{0};
+        std::chrono::steady_clock::time_point TimeStamp{};
+    };
+}  // namespace TrafficGenerator_Constants
+
+/**
+ * Synthesises ethernet (802.3) and wireless (802.11) frames as sent by a group of virtual consoles. Every frame carries
+ * the sending console, a sequence number and a send timestamp, so the receiving side can measure drops and latency.
+ */
+class TrafficGenerator
+{
+public:
+    explicit TrafficGenerator(const TrafficGenerator_Constants::Settings& aSettings);
+
+    /**
+     * Generates the next frame in 802.3 format, the consoles take turns sending.
+     * @param aTimeStamp - Send time to embed in the frame.
+     * @return The frame.
+     */
+    std::string Generate8023Frame(std::chrono::steady_clock::time_point aTimeStamp);
+
+    /**
+     * Generates the next frame in 802.11 format with radiotap header, as captured by a monitor mode device.
+     * @param aTimeStamp - Send time to embed in the frame.
+     * @return The frame.
+     */
+    std::string Generate80211Frame(std::chrono::steady_clock::time_point aTimeStamp);
+
+    /**
+     * Reads the information embedded by the generator from a frame.
+     * @param aFrame - The frame to read.
+     * @param aPayloadIndex - Where the payload starts, see c8023PayloadIndex and c80211PayloadIndex.
+     * @return The information, Valid is false if the frame was not made by a TrafficGenerator.
+     */
+    static TrafficGenerator_Constants::FrameInformation ReadFrameInformation(std::string_view aFrame,
+                                                                             unsigned int     aPayloadIndex);
+
+    /**
+     * Gets the MAC address of a virtual console.
+     * @param aConsole - Number of the console.
+     * @return The MAC address.
+     */
+    static uint64_t GetConsoleMac(uint16_t aConsole);
+
+    /**
+     * Gets the time between two frames of the whole group, to reach the configured rate.
+     * @return The interval.
+     */
+    [[nodiscard]] std::chrono::nanoseconds GetInterval() const;
+
+    /**
+     * Gets the amount of frames generated so far.
+     * @return The amount of frames.
+     */
+    [[nodiscard]] uint64_t GetFramesGenerated() const;
+
+    /**
+     * Converts a size distribution name to a size distribution.
+     * @param aDistribution - Name of the distribution.
+     * @return The distribution, SizeDistribution::Uniform if not recognized.
+     */
+    static TrafficGenerator_Constants::SizeDistribution ConvertStringToSizeDistribution(std::string_view aDistribution);
+
+private:
+    unsigned int PickSize();
+
+    TrafficGenerator_Constants::Settings    mSettings;
+    std::mt19937                            mRandom;
+    std::uniform_real_distribution<double>  mChance{0.0, 1.0};
+    std::uniform_int_distribution<unsigned> mSize;
+    std::vector<uint32_t>                   mSequences;
+    uint16_t                                mNextConsole{0};
+    uint64_t                                mFramesGenerated{0};
+    PacketConverter                         mPacketConverter{true};
+};
@@ -72,6 +72,18 @@ public:
      */
     virtual void SetName(std::string_view aName) = 0;
 
+    /**
+     * Gets whether the object changed since it was last drawn.
+     * @return true if the object has to be drawn again.
+     */
+    [[nodiscard]] virtual bool IsDirty() const = 0;
+
+    /**
+     * Marks the object as changed, or as drawn.
+     * @param aDirty - Whether the object has to be drawn again.
+     */
+    virtual void SetDirty(bool aDirty) = 0;
+
     /**
      * Handles key sent to the object.
      * @param aKeyCode - Key code to be handled.
@@ -24,11 +24,28 @@ public:
      */
     virtual void SetUp() = 0;
 
+    /**
+     * Brings the window up to date with the model, marking it dirty when that changes what is shown.
+     */
+    virtual void Update() = 0;
+
     /**
      * Draws window on screen.
      */
     virtual void Draw() = 0;
 
+    /**
+     * Gets whether the window or any of its objects changed since it was last drawn.
+     * @return true if the window has to be drawn again.
+     */
+    virtual bool IsDirty() = 0;
+
+    /**
+     * Marks the window as changed, or as drawn.
+     * @param aDirty - Whether the window has to be drawn again.
+     */
+    virtual void SetDirty(bool aDirty) = 0;
+
     /**
      * Add objects to window.
      */
@@ -45,7 +62,7 @@ public:
     virtual void DrawString(int aYCoord, int aXCoord, int aColorPair, std::string_view aString) = 0;
 
     /**
-     * Refreshes window.
+     * Copies window to the virtual screen, the physical screen is updated once for all windows with doupdate.
      */
     virtual void Refresh() = 0;
 
@@ -142,6 +159,12 @@ public:
      */
     virtual bool IsVisible() = 0;
 
+    /**
+     * Gets if window has anything that can be selected, windows that only show information can not be tabbed to.
+     * @return true if selectable.
+     */
+    virtual bool IsSelectable() = 0;
+
     /**
      * Clears a line, up to length.
      * @param aYCoord - Y coord to clear the line at.
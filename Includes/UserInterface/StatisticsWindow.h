@@ -0,0 +1,110 @@
+#pragma once
+
+/* Copyright (c) 2020 [Rick de Bondt] - StatisticsWindow.h
+ *
+ * This file contains an class for a userinterface statistics window.
+ *
+ **/
+
+#include <array>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "../Statistics.h"
+#include "Window.h"
+
+namespace StatisticsWindow_Constants
+{
+    // Border, network and XLink Kai state, one line per direction, drops and latencies.
+    static constexpr int cWindowHeight{7};
+    static constexpr int cTextXCoord{2};
+
+    // Amount of samples kept for the sparklines, one per status update.
+    static constexpr std::size_t cHistoryLength{200};
+
+    // From no traffic up to the most traffic in the visible history, plain ASCII so every curses implementation can
+    // show it.
+    static constexpr std::string_view cSparklineLevels{" .:-=+*#%@"};
+
+    static constexpr std::string_view cSSIDPrefix{"SSID: "};
+    static constexpr std::string_view cBSSIDPrefix{"  BSSID: "};
+    static constexpr std::string_view cChannelPrefix{"  Channel: "};
+    static constexpr std::string_view cXLinkKaiPrefix{"  XLink Kai: "};
+    static constexpr std::string_view cUnknownMessage{"-"};
+    static constexpr std::string_view cPacketsUnit{" pkt/s "};
+    static constexpr std::string_view cBytesUnit{"B/s  "};
+    static constexpr std::string_view cDropsMessage{"Drops:"};
+    static constexpr std::string_view cLatencyMessage{"Latency p50/p99/p99.9:"};
+
+    /**
+     * The counters and latency shown for one direction through the bridge.
+     */
+    struct Direction
+    {
+        std::string_view              Name;
+        Statistics_Constants::Counter Frames;
+        Statistics_Constants::Counter Bytes;
+    };
+
+    static constexpr std::array<Direction, 2> cDirections{
+        {{"To XLink Kai: ",
+          Statistics_Constants::Counter::ForwardedToXLinkKai,
+          Statistics_Constants::Counter::BytesToXLinkKai},
+         {"To monitor:   ", Statistics_Constants::Counter::Injected, Statistics_Constants::Counter::BytesToMonitor}}};
+
+    static constexpr std::array<std::pair<std::string_view, Statistics_Constants::Counter>, 5> cDrops{
+        {{" kernel ", Statistics_Constants::Counter::KernelDrops},
+         {"  interface ", Statistics_Constants::Counter::InterfaceDrops},
+         {"  queue ", Statistics_Constants::Counter::QueueDrops},
+         {"  conversion ", Statistics_Constants::Counter::ConversionFailures},
+         {"  inject ", Statistics_Constants::Counter::InjectFailures}}};
+
+    static constexpr std::array<std::string_view, Statistics_Constants::cLatencyCount> cLatencyTexts{
+        " to Kai ", "  to monitor ", "  ack "};
+}  // namespace StatisticsWindow_Constants
+
+/**
+ * Class that will setup and draw a window with live statistics of the engine. The statistics are sampled every time
+ * the statuses in the model are updated, only the cells that changed since the last time are drawn again.
+ **/
+class StatisticsWindow : public Window
+{
+public:
+    StatisticsWindow(WindowModel& aModel, std::string_view aTitle, const std::function<Dimensions()>& aCalculation);
+
+    void Update() override;
+    void Draw() override;
+    bool Scale() override;
+
+private:
+    /**
+     * Takes a snapshot of the statistics and works out the rates and latencies since the previous one.
+     */
+    void Sample();
+
+    /**
+     * Puts together the text of every line from the last update, fitted to the width of the window.
+     */
+    void BuildLines();
+
+    /**
+     * Draws the parts of the lines that differ from what is on screen.
+     */
+    void DrawLines();
+
+    [[nodiscard]] std::string BuildSparkline(const std::deque<double>& aHistory, std::size_t aWidth) const;
+
+    using Rates       = std::array<double, StatisticsWindow_Constants::cDirections.size()>;
+    using RateHistory = std::array<std::deque<double>, StatisticsWindow_Constants::cDirections.size()>;
+    using Latencies   = std::array<Statistics_Constants::LatencyHistogram, Statistics_Constants::cLatencyCount>;
+
+    unsigned int                   mLastStatusUpdate{0};
+    Statistics_Constants::Snapshot mLastSnapshot{};
+    Rates                          mPacketRates{};
+    Rates                          mByteRates{};
+    RateHistory                    mPacketRateHistory{};
+    Latencies                      mRecentLatencies{}; /**< Latencies since the previous sample. */
+    std::vector<std::string>       mLines{};
+    std::vector<std::string>       mDrawnLines{};
+};
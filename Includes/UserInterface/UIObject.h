@@ -33,6 +33,8 @@ public:
     [[nodiscard]] int  GetXCoord() const override;
     std::string_view   GetName() override;
     void               SetName(std::string_view) override;
+    [[nodiscard]] bool IsDirty() const override;
+    void               SetDirty(bool aDirty) override;
     bool               HandleKey(unsigned int aKeyCode) override;
 
 protected:
@@ -46,4 +48,5 @@ private:
     int                         mYCoord;
     int                         mXCoord;
     std::function<Dimensions()> mScaleCalculation;
+    bool                        mDirty;
 };
\ No newline at end of file
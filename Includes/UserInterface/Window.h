@@ -56,8 +56,14 @@ public:
 
     void ClearWindow() override;
 
+    void Update() override;
+
     void Draw() override;
 
+    bool IsDirty() override;
+
+    void SetDirty(bool aDirty) override;
+
     void DrawString(int aYCoord, int aXCoord, int aColorPair, std::string_view aString) override;
 
     void AddObject(std::shared_ptr<IUIObject> aObject) override;
@@ -94,6 +100,8 @@ public:
 
     bool IsVisible() override;
 
+    bool IsSelectable() override;
+
     bool HandleKey(unsigned int aKeyCode) override;
 
 protected:
@@ -114,4 +122,5 @@ private:
     bool                        mVisible;
     int                         mSelectedObject;
     ObjectList                  mObjects;
+    bool                        mDirty;
 };
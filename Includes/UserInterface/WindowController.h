@@ -11,6 +11,8 @@
 #include "IWindow.h"
 #undef timeout
 
+#include <array>
+#include <chrono>
 #include <cmath>
 #include <functional>
 #include <memory>
@@ -51,20 +53,50 @@ public:
     bool SetUp();
 
     /**
-     * Redraws and handles windows.
+     * Draws the windows that changed, then waits for a key press or an event and handles the keys.
+     * @param aTimeout - Longest time to wait for a key press or event.
      * @return true if still processing
      */
-    bool Process();
+    bool Process(std::chrono::milliseconds aTimeout);
+
+    /**
+     * Wakes up Process when it is waiting, so changes to the model are shown right away. Safe to call from any thread.
+     */
+    void Notify();
+
+    /**
+     * Marks every window to be drawn again, for when the model got changed behind the back of the user interface.
+     */
+    void SetDirty();
 
 private:
     void AdvanceWindow();
 
+    /**
+     * Draws the windows that changed and puts them on screen with a single update.
+     */
+    void Render();
+
+    /**
+     * Updates a window and draws it when it changed.
+     * @param aWindow - The window.
+     * @return true if the window was drawn.
+     */
+    bool RenderWindow(IWindow& aWindow);
+
+    /**
+     * Waits until a key is pressed, Notify is called or the timeout passes.
+     * @param aTimeout - Longest time to wait.
+     */
+    void WaitForEvent(std::chrono::milliseconds aTimeout);
+
     NCursesWindow                            mMainCanvas;
     int                                      mHeight;
     int                                      mWidth;
-    bool                                     mDimensionsChanged;
+    bool                                     mRepaint; /**< Everything has to be drawn again, after a resize. */
     WindowList                               mWindows;
     bool                                     mExclusiveWindow;
     std::pair<int, std::shared_ptr<IWindow>> mWindowSelector;
     WindowModel&                             mModel;
+    std::array<int, 2>                       mEventPipe; /**< Read and write end, Notify writes to wake Process up. */
 };
@@ -33,7 +33,7 @@ public:
     XLinkWindow(WindowModel& aModel, std::string_view aTitle, const std::function<Dimensions()>& aCalculation);
 
     void SetUp() override;
-    void Draw() override;
+    void Update() override;
 
 private:
     WindowModel_Constants::EngineStatus mOldEngineStatus;
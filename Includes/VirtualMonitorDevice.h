@@ -0,0 +1,142 @@
+#pragma once
+
+/* Copyright (c) 2020 [Rick de Bondt] - VirtualMonitorDevice.h
+ *
+ * This file contains a stand-in for a wireless device in monitor mode, so the bridge can be run without radios.
+ *
+ * */
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "IPCapDevice.h"
+#include "FlightRecorder.h"
+#include "MonitorFrameHandler.h"
+#include "PacketConverter.h"
+#include "SessionRecorder.h"
+
+namespace VirtualMonitorDevice_Constants
+{
+    using InjectCallback = std::function<void(std::string_view aData)>;
+}  // namespace VirtualMonitorDevice_Constants
+
+/**
+ * Stand-in for WirelessMonitorDevice. Frames are "captured" from a capture file or handed over with Receive, and
+ * filtered and converted the same way as a real monitor device would. Frames that would be injected can be written to
+ * a capture file and/or handed to a callback.
+ */
+class VirtualMonitorDevice : public IPCapDevice
+{
+public:
+    VirtualMonitorDevice() = default;
+    ~VirtualMonitorDevice();
+    VirtualMonitorDevice(const VirtualMonitorDevice& aVirtualMonitorDevice) = delete;
+    VirtualMonitorDevice& operator=(const VirtualMonitorDevice& aVirtualMonitorDevice) = delete;
+
+    /**
+     * Opens the device, opening it again with a capture file starts reading that file from the start.
+     * @param aName - Capture file to read frames from with ReadNextData, empty if frames are handed over with Receive.
+     * @param aSSIDFilter - The SSIDS to listen to.
+     * @param aFrequency - The frequency to inject on.
+     * @return true if successful.
+     */
+    bool Open(std::string_view aName, std::vector<std::string>& aSSIDFilter, uint16_t aFrequency) override;
+
+    void Close() override;
+
+    /**
+     * Reads the next frame from the capture file and handles it like a captured frame.
+     * @return true if a frame has been read, false at the end of the file or when no file is open.
+     */
+    bool ReadNextData() override;
+
+    /**
+     * Handles a frame as if it had been captured by a monitor mode device.
+     * @param aData - The frame, with radiotap header.
+     * @return true if the frame was a data frame for our BSSID.
+     */
+    bool Receive(std::string_view aData);
+
+    const unsigned char* GetData() override;
+    const pcap_pkthdr*   GetHeader() override;
+    std::string          DataToString(const unsigned char* aData, const pcap_pkthdr* aHeader) override;
+    std::string          LastDataToString() override;
+
+    bool Send(std::string_view aData) override;
+    bool Send(std::string_view aData, IPCapDevice_Constants::WiFiBeaconInformation& aWiFiInformation) override;
+    bool Send(std::string_view aData, std::chrono::system_clock::time_point aArrival) override;
+
+    void SetSendReceiveDevice(std::shared_ptr<ISendReceiveDevice> aDevice) override;
+
+    /**
+     * Sets the BSSID to accept data frames for, without having to wait for a matching beacon.
+     * @param aBSSID - The BSSID.
+     */
+    void SetBSSID(uint64_t aBSSID);
+
+    /**
+     * Writes every frame that would be injected to a capture file.
+     * @param aPath - Path of the capture file.
+     * @return true if successful.
+     */
+    bool SetInjectionFile(std::string_view aPath);
+
+    /**
+     * Sets a function to call with every frame that would be injected.
+     * @param aCallback - The function.
+     */
+    void SetInjectCallback(VirtualMonitorDevice_Constants::InjectCallback aCallback);
+
+    /**
+     * Records frames forwarded to the send/receive device and frames that would be injected.
+     * @param aRecorder - The recorder, nullptr to stop recording.
+     */
+    void SetSessionRecorder(std::shared_ptr<SessionRecorder> aRecorder);
+
+    /**
+     * Keeps the last frames forwarded and injected in a flight recorder, set before starting to receive.
+     * @param aRecorder - The recorder, nullptr to stop recording.
+     */
+    void SetFlightRecorder(std::shared_ptr<FlightRecorder> aRecorder);
+
+    /**
+     * Gets the amount of frames forwarded to the send/receive device, frames it failed to send are not counted.
+     * @return The amount.
+     */
+    [[nodiscard]] uint64_t GetForwardedCount() const;
+
+    /**
+     * Gets the amount of frames that would have been injected.
+     * @return The amount.
+     */
+    [[nodiscard]] uint64_t GetInjectedCount() const;
+
+private:
+    /**
+     * Converts a frame to 802.11 and "injects" it.
+     * @param aData - The frame.
+     * @param aWiFiInformation - Information needed to convert the frame.
+     * @param aArrival - Time the frame arrived at the bridge, counted as XLink Kai to monitor latency if set.
+     * @return true if successful.
+     */
+    bool Send(std::string_view                              aData,
+              IPCapDevice_Constants::WiFiBeaconInformation& aWiFiInformation,
+              std::chrono::system_clock::time_point         aArrival);
+
+    MonitorFrameHandler                            mFrameHandler{};
+    PacketConverter                                mSendConverter{true};
+    pcap_t*                                        mHandler{nullptr};
+    pcap_t*                                        mInjectionHandler{nullptr};
+    pcap_dumper_t*                                 mInjectionDumper{nullptr};
+    std::mutex                                     mInjectionMutex{};
+    const unsigned char*                           mData{nullptr};
+    pcap_pkthdr*                                   mHeader{nullptr};
+    std::atomic<uint64_t>                          mForwardedCount{0};
+    std::atomic<uint64_t>                          mInjectedCount{0};
+    VirtualMonitorDevice_Constants::InjectCallback mInjectCallback{nullptr};
+    std::shared_ptr<SessionRecorder>               mSessionRecorder{nullptr};
+    std::shared_ptr<FlightRecorder>                mFlightRecorder{nullptr};
+};
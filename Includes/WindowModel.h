@@ -1,7 +1,11 @@
 #pragma once
 
 #include <array>
+#include <chrono>
 #include <string>
+#include <vector>
+
+#include <boost/program_options/options_description.hpp>
 
 #include "../Includes/Logger.h"
 
@@ -19,6 +23,10 @@ namespace WindowModel_Constants
     static constexpr std::string_view cSaveXLinkPort{"XLinkPort"};
     static constexpr std::string_view cSaveAcknowledgeDataFrames{"AckDataFrames"};
     static constexpr std::string_view cSaveOnlyAcceptFromMac{"OnlyAcceptFromMac"};
+    static constexpr std::string_view cSaveAdditionalSessions{"AdditionalSessions"};
+    static constexpr std::string_view cSaveRecordSession{"RecordSession"};
+    static constexpr std::string_view cSaveRecordingPath{"RecordingPath"};
+    static constexpr std::string_view cSaveCompressRecording{"CompressRecording"};
 
     static constexpr Logger::Level    cDefaultLogLevel{Logger::Level::ERROR};
     static constexpr bool             cDefaultAutoDiscoverPSPVita{false};
@@ -30,6 +38,23 @@ namespace WindowModel_Constants
     static constexpr std::string_view cDefaultXLinkPort{"34523"};
     static constexpr std::string_view cDefaultAcknowledgeDataFrames{"AckDataFrames"};
     static constexpr std::string_view cDefaultOnlyAcceptFromMac{"OnlyAcceptFromMac"};
+    static constexpr bool             cDefaultRecordSession{false};
+    static constexpr std::string_view cDefaultRecordingPath{"session"};
+    static constexpr bool             cDefaultCompressRecording{false};
+
+    // Additional sessions are saved as "name,adapter,channel" entries separated by cSessionSeparator.
+    static constexpr char cSessionSeparator{';'};
+    static constexpr char cSessionFieldSeparator{','};
+
+    /**
+     * Settings for an XLink Kai session next to the main one, bridging a different monitor device.
+     */
+    struct SessionSetting
+    {
+        std::string LocallyUniqueName{};
+        std::string WifiAdapter{};
+        std::string Channel{cDefaultChannel};
+    };
 
     enum class EngineStatus
     {
@@ -40,6 +65,9 @@ namespace WindowModel_Constants
 
     static constexpr std::array<std::string_view, 3> cEngineStatusTexts{"Idle", "Running", "Error"};
 
+    // How often the statuses below the engine status are updated and the statistics pane is redrawn.
+    static constexpr std::chrono::seconds cStatusInterval{1};
+
     enum class Command
     {
         StartEngine = 0,
@@ -63,6 +91,15 @@ public:
     bool          mAcknowledgeDataFrames{false};
     std::string   mOnlyAcceptFromMac{};
 
+    // Extra XLink Kai sessions, see WindowModel_Constants::SessionSetting for the format.
+    std::string mAdditionalSessions{};
+
+    // Records the traffic through the bridge to <mRecordingPath>_<start time>_<number>.pcapng files, with .zst
+    // appended when compressed.
+    bool        mRecordSession{WindowModel_Constants::cDefaultRecordSession};
+    std::string mRecordingPath{WindowModel_Constants::cDefaultRecordingPath};
+    bool        mCompressRecording{WindowModel_Constants::cDefaultCompressRecording};
+
     // Channel as a string because of the textfield this is bound to.
     std::string mChannel{WindowModel_Constants::cDefaultChannel};
     std::string mXLinkIp{WindowModel_Constants::cDefaultXLinkIp};
@@ -71,6 +108,13 @@ public:
     // Statuses
     WindowModel_Constants::EngineStatus mEngineStatus{WindowModel_Constants::EngineStatus::Idle};
 
+    // Network followed by the main monitor device and state of the main XLink Kai session, empty when not running.
+    std::string  mCurrentSSID{};
+    std::string  mCurrentBSSID{};
+    int          mCurrentChannel{-1};
+    std::string  mXLinkKaiConnectionState{};
+    unsigned int mStatusUpdates{0}; /**< Counts the status updates, so windows know when there is something new. */
+
     // Commands
     WindowModel_Constants::Command mCommand{WindowModel_Constants::Command::NoCommand};
 
@@ -89,4 +133,17 @@ public:
      * @return true if successful.
      */
     bool LoadFromFile(std::string_view aPath);
+
+    /**
+     * Parses the additional sessions setting, malformed entries are skipped.
+     * @return List of sessions to set up next to the main one.
+     */
+    [[nodiscard]] std::vector<WindowModel_Constants::SessionSetting> GetAdditionalSessions() const;
+
+    /**
+     * Adds an option for every setting, bound to the members of this WindowModel. Options only overwrite a setting
+     * when given, so notifying after LoadFromFile lets the command line take precedence over the config file.
+     * @param aDescription - Description to add the options to.
+     */
+    void AddCommandLineOptions(boost::program_options::options_description& aDescription);
 };
@@ -6,18 +6,26 @@
  *
  * */
 
+#include <chrono>
 #include <memory>
+#include <mutex>
 
 #include <boost/thread.hpp>
 
 #include "IPCapDevice.h"
+#include "FlightRecorder.h"
+#include "MonitorFrameHandler.h"
 #include "PacketConverter.h"
+#include "SessionRecorder.h"
 
 
 namespace WirelessMonitorDevice_Constants
 {
     static constexpr unsigned int cSnapshotLength{65535};
     static constexpr unsigned int cTimeout{10};
+
+    // How often the drop counts of the capture buffer are added to the statistics.
+    static constexpr std::chrono::seconds cKernelDropsInterval{1};
 }  // namespace WirelessMonitorDevice_Constants
 
 using namespace WirelessMonitorDevice_Constants;
@@ -44,18 +52,40 @@ public:
 
     void SetSSID(std::string_view aSSID);
 
+    /**
+     * Gets the network the device is currently following, safe to call while receiving.
+     * @return Copy of the SSID, BSSID and frequency in use.
+     */
+    IPCapDevice_Constants::WiFiBeaconInformation GetWifiInformation();
+
     // Only use if you're planning to use the internal wifi information
     bool Send(std::string_view aData) override;
 
     bool Send(std::string_view aData, IPCapDevice_Constants::WiFiBeaconInformation& aWiFiInformation) override;
 
-    // Extra function which will make it possible to send without converting to 802.11 specifically.
+    bool Send(std::string_view aData, std::chrono::system_clock::time_point aArrival) override;
+
+    // Extra function which will make it possible to send without converting to 802.11 specifically. When aArrival is
+    // set the time since then is counted as XLink Kai to monitor latency.
     bool Send(std::string_view                              aData,
               IPCapDevice_Constants::WiFiBeaconInformation& aWiFiInformation,
-              bool                                          aConvertData);
+              bool                                          aConvertData,
+              std::chrono::system_clock::time_point         aArrival = {});
 
     void SetSendReceiveDevice(std::shared_ptr<ISendReceiveDevice> aDevice) override;
 
+    /**
+     * Records frames forwarded to the send/receive device and frames injected, set before starting to receive.
+     * @param aRecorder - The recorder, nullptr to stop recording.
+     */
+    void SetSessionRecorder(std::shared_ptr<SessionRecorder> aRecorder);
+
+    /**
+     * Keeps the last frames forwarded and injected in a flight recorder, set before starting to receive.
+     * @param aRecorder - The recorder, nullptr to stop recording.
+     */
+    void SetFlightRecorder(std::shared_ptr<FlightRecorder> aRecorder);
+
     // TODO: Put in ISendReceiveDevice, all types of devices can use this.
     /**
      * Starts receiving network messages from monitor device.
@@ -64,18 +94,25 @@ public:
     bool StartReceiverThread();
 
 private:
-    bool                                         ReadCallback(const unsigned char* aData, const pcap_pkthdr* aHeader);
-    bool                                         mSendReceivedData{false};
-    bool                                         mConnected{false};
-    bool                                         mAcknowledgePackets{false};
-    PacketConverter                              mPacketConverter{true};
-    uint64_t                                     mSourceMACToFilter{0};
-    const unsigned char*                         mData{nullptr};
-    std::vector<std::string>                     mSSIDFilter;
-    pcap_t*                                      mHandler{nullptr};
-    const pcap_pkthdr*                           mHeader{nullptr};
-    unsigned int                                 mPacketCount{0};
-    std::shared_ptr<ISendReceiveDevice>          mSendReceiveDevice{nullptr};
-    std::shared_ptr<boost::thread>               mReceiverThread{nullptr};
-    IPCapDevice_Constants::WiFiBeaconInformation mWifiInformation{};
+    bool ReadCallback(const unsigned char* aData, const pcap_pkthdr* aHeader);
+
+    /**
+     * Adds the frames dropped by the capture buffer and the interface since the last update to the statistics.
+     */
+    void UpdateKernelDrops();
+
+    // Captured frames are handled on the receiver thread, frames from XLink Kai are converted on its own thread.
+    bool                             mSendReceivedData{false};
+    bool                             mConnected{false};
+    bool                             mAcknowledgePackets{false};
+    MonitorFrameHandler              mFrameHandler{};
+    PacketConverter                  mSendConverter{true};
+    const unsigned char*             mData{nullptr};
+    pcap_t*                          mHandler{nullptr};
+    const pcap_pkthdr*               mHeader{nullptr};
+    unsigned int                     mPacketCount{0};
+    pcap_stat                        mLastPCapStatistics{};
+    std::shared_ptr<boost::thread>   mReceiverThread{nullptr};
+    std::shared_ptr<SessionRecorder> mSessionRecorder{nullptr};
+    std::shared_ptr<FlightRecorder>  mFlightRecorder{nullptr};
 };
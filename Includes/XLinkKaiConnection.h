@@ -6,7 +6,13 @@
  *
  * */
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <string_view>
 
 #include <boost/asio.hpp>
 #include <boost/thread.hpp>
@@ -24,10 +30,30 @@ namespace XLinkKai_Constants
     static constexpr std::string_view     cDisconnectFormat{"disconnect"};
     static constexpr std::string_view     cDisconnectedFormat{"disconnected"};
     static constexpr std::string_view     cEthernetDataFormat{"e"};
+    static constexpr std::string_view     cSettingFormat{"setting"};
+    static constexpr std::string_view     cChatFormat{"chat"};
     static constexpr std::string_view     cLocallyUniqueName{"PSP"};
     static constexpr std::string_view     cEmulatorName{"Real_PSP"};
     static constexpr unsigned int         cPort{34523};
     static constexpr std::chrono::seconds cConnectionTimeout{10};
+    static constexpr std::chrono::seconds cReconnectInterval{1};
+
+    // Amount of frames kept while (re)connecting, older frames get dropped first when this fills up.
+    static constexpr std::size_t cPreConnectQueueSize{256};
+
+    /**
+     * States the connection to XLink Kai can be in.
+     */
+    enum class ConnectionState
+    {
+        Disconnected = 0,
+        Connecting,
+        Connected,
+        Closing
+    };
+
+    static constexpr std::array<std::string_view, 4> cConnectionStateTexts{
+        "Disconnected", "Connecting", "Connected", "Closing"};
 
     static const std::string cConnectString{std::string(cConnectFormat) + cSeparator.data() +
                                             cLocallyUniqueName.data() + cSeparator.data() + cEmulatorName.data() +
@@ -45,6 +71,98 @@ namespace XLinkKai_Constants
 
     static const std::string cEthernetDataString{std::string(cEthernetDataFormat) + cSeparator.data() +
                                                  cEthernetDataFormat.data() + cSeparator.data()};
+
+    /**
+     * Commands that can be received from XLink Kai.
+     */
+    enum class Command
+    {
+        EthernetData = 0,
+        KeepAlive,
+        Connected,
+        Disconnected,
+        Setting,
+        Chat,
+        Unknown
+    };
+
+    /**
+     * Links the prefix of an XLink Kai message to the command it represents.
+     */
+    struct CommandEntry
+    {
+        std::string_view Prefix;
+        Command          Type;
+    };
+
+    /**
+     * Joins string constants at compile time, so the command table is built from the same formats as the messages.
+     */
+    template<const std::string_view&... tParts> struct JoinedString
+    {
+        static constexpr std::array<char, (tParts.size() + ...)> cCharacters{[] {
+            std::array<char, (tParts.size() + ...)> lReturn{};
+            auto                                    lNext{lReturn.begin()};
+            ((lNext = std::copy(tParts.begin(), tParts.end(), lNext)), ...);
+            return lReturn;
+        }()};
+
+        static constexpr std::string_view cValue{cCharacters.data(), cCharacters.size()};
+    };
+
+    // Ethernet data makes up nearly all of the traffic, so it should always stay at the top of this table.
+    static constexpr std::array<CommandEntry, 6> cCommandTable{
+        {{JoinedString<cEthernetDataFormat, cSeparator, cEthernetDataFormat, cSeparator>::cValue,
+          Command::EthernetData},
+         {JoinedString<cKeepAliveFormat, cSeparator>::cValue, Command::KeepAlive},
+         {JoinedString<cConnectedFormat, cSeparator>::cValue, Command::Connected},
+         {JoinedString<cDisconnectedFormat, cSeparator>::cValue, Command::Disconnected},
+         {JoinedString<cSettingFormat, cSeparator>::cValue, Command::Setting},
+         {JoinedString<cChatFormat, cSeparator>::cValue, Command::Chat}}};
+
+    /**
+     * Finds out which command an XLink Kai message contains, without copying the message.
+     * @param aData - The message as received from XLink Kai.
+     * @return The command matching the start of the message, Command::Unknown if none matches.
+     */
+    constexpr Command ParseCommand(std::string_view aData)
+    {
+        Command lReturn{Command::Unknown};
+
+        for (const auto& lEntry : cCommandTable) {
+            if (aData.starts_with(lEntry.Prefix)) {
+                lReturn = lEntry.Type;
+                break;
+            }
+        }
+
+        return lReturn;
+    }
+
+    /**
+     * Gets the prefix belonging to a command.
+     * @param aCommand - The command to get the prefix for.
+     * @return The prefix, empty if the command is unknown.
+     */
+    constexpr std::string_view GetCommandPrefix(Command aCommand)
+    {
+        std::string_view lReturn{};
+
+        for (const auto& lEntry : cCommandTable) {
+            if (lEntry.Type == aCommand) {
+                lReturn = lEntry.Prefix;
+                break;
+            }
+        }
+
+        return lReturn;
+    }
+
+    static_assert(ParseCommand("e;e;data") == Command::EthernetData);
+    static_assert(ParseCommand("connected;PSP") == Command::Connected);
+    static_assert(ParseCommand("disconnected;PSP") == Command::Disconnected);
+    static_assert(ParseCommand("e;") == Command::Unknown);
+    static_assert(GetCommandPrefix(Command::KeepAlive) == "keepalive;");
 }  // namespace XLinkKai_Constants
 
 using namespace XLinkKai_Constants;
@@ -56,6 +174,14 @@ class XLinkKaiConnection : public ISendReceiveDevice
 {
 public:
     XLinkKaiConnection() = default;
+
+    /**
+     * Creates a connection that runs on an event loop shared with other connections, see XLinkKaiSessionManager.
+     * Connections created this way do not start a receiver thread of their own.
+     * @param aIoService - The event loop to run this connection on.
+     */
+    explicit XLinkKaiConnection(std::shared_ptr<boost::asio::io_service> aIoService);
+
     ~XLinkKaiConnection();
     XLinkKaiConnection(const XLinkKaiConnection& aXLinkKaiConnection) = delete;
     XLinkKaiConnection& operator=(const XLinkKaiConnection& aXLinkKaiConnection) = delete;
@@ -89,11 +215,24 @@ public:
     std::string LastDataToString() override;
 
     /**
-     * Starts receiving network messages from XLink Kai.
+     * Starts receiving network messages from XLink Kai, on a thread of its own if the event loop is not shared.
      * @return True if successful.
      */
     bool StartReceiverThread();
 
+    /**
+     * Queues an asynchronous receive of the next message from XLink Kai on the event loop.
+     * @return True if successful.
+     */
+    bool StartReceiving();
+
+    /**
+     * (Re)connects to XLink Kai when the connection has been lost and checks whether a connection attempt has timed
+     * out. Has to be called periodically from the thread running the event loop.
+     * @return False if a connection attempt has timed out.
+     */
+    bool UpdateConnectionState();
+
     /**
      * Sends a message to Xlink Kai.
      * @param aCommand - Command that should be added to the XLink Kai message (for example connect).
@@ -104,6 +243,8 @@ public:
 
     bool Send(std::string_view aData) override;
 
+    bool Send(std::string_view aData, std::chrono::system_clock::time_point aArrival) override;
+
     void Close() final;
 
     /**
@@ -112,6 +253,26 @@ public:
      */
     void SetPort(unsigned int aPort);
 
+    /**
+     * Sets the name this connection identifies itself with to XLink Kai, has to be unique for every connection to the
+     * same XLink Kai engine. Takes effect on the next connection attempt.
+     * @param aLocallyUniqueName - Name to identify with.
+     * @param aEmulatorName - Name of the emulator to report to XLink Kai.
+     */
+    void SetLocallyUniqueName(std::string_view aLocallyUniqueName, std::string_view aEmulatorName = cEmulatorName);
+
+    /**
+     * Gets the state of the connection to XLink Kai, safe to call from any thread.
+     * @return The connection state.
+     */
+    [[nodiscard]] ConnectionState GetConnectionState() const;
+
+    /**
+     * Gets the name this connection identifies itself with to XLink Kai.
+     * @return The locally unique name.
+     */
+    [[nodiscard]] const std::string& GetLocallyUniqueName() const;
+
     void SetSendReceiveDevice(std::shared_ptr<ISendReceiveDevice> aDevice) override;
 
 private:
@@ -120,24 +281,71 @@ private:
      */
     void ReceiveCallback(const boost::system::error_code& aError, size_t aBytesReceived);
 
+    /**
+     * Sends a message to Xlink Kai.
+     * @param aCommand - Command that should be added to the XLink Kai message (for example connect).
+     * @param aData - Data to be sent to XLink Kai.
+     * @param aArrival - Time the data arrived at the bridge, counted as monitor to XLink Kai latency if set.
+     * @return True if successful.
+     */
+    bool Send(std::string_view aCommand, std::string_view aData, std::chrono::system_clock::time_point aArrival);
+
     /**
      * Sends a keepalive back to the XLink Kai engine, call this function when a keepalive is received.
      * @return True if all bytes have been sent over successfully.
      */
     bool HandleKeepAlive();
 
-    bool                                               mConnected{false};
-    bool                                               mConnectInitiated{false};
+    /**
+     * Sends a message to XLink Kai whatever the state of the connection.
+     * @param aCommand - Command that should be added to the XLink Kai message.
+     * @param aData - Data to be sent to XLink Kai.
+     * @param aArrival - Time the data arrived at the bridge, counted as monitor to XLink Kai latency if set.
+     * @return True if successful.
+     */
+    bool SendToSocket(std::string_view                      aCommand,
+                      std::string_view                      aData,
+                      std::chrono::system_clock::time_point aArrival);
+
+    /**
+     * Keeps a frame until XLink Kai has (re)connected, call only when not connected.
+     * @param aData - Frame to keep.
+     * @param aArrival - Time the frame arrived at the bridge, sent along with it to measure its latency.
+     * @return True if the frame has been kept or sent.
+     */
+    bool QueuePreConnectFrame(std::string_view aData, std::chrono::system_clock::time_point aArrival);
+
+    /**
+     * Sends all frames that came in while XLink Kai was (re)connecting, and only then marks the connection as
+     * connected, so newer frames cannot get ahead of them.
+     */
+    void FlushPreConnectQueue();
+
+    // Written by the receiver thread, read on every frame sent by the capture thread.
+    std::atomic<ConnectionState> mState{ConnectionState::Disconnected};
+    std::mutex                   mPreConnectQueueMutex{};
+
+    // Frames with the time they arrived at the bridge.
+    std::deque<std::pair<std::string, std::chrono::system_clock::time_point>> mPreConnectQueue{};
+
     std::chrono::time_point<std::chrono::system_clock> mConnectionTimerStart{std::chrono::seconds{0}};
+    std::chrono::time_point<std::chrono::system_clock> mLastConnectAttempt{std::chrono::seconds{0}};
+    bool mConnectedBefore{false}; /**< Set by the receiver thread once connected, later connections are reconnects. */
+
+    std::string mLocallyUniqueName{cLocallyUniqueName};
+    std::string mConnectString{cConnectString};
+    std::string mConnectedString{cConnectedString};
+    std::string mDisconnectedString{cDisconnectedString};
 
     std::array<char, cMaxLength> mData{};
     // Raw ethernet data received from XLink Kai
-    std::string                         mEthernetData{};
-    std::string                         mIp{cIp};
-    unsigned int                        mPort{cPort};
-    boost::asio::io_service             mIoService{};
-    boost::asio::ip::udp::socket        mSocket{mIoService};
-    boost::asio::ip::udp::endpoint      mRemote{};
-    std::shared_ptr<boost::thread>      mReceiverThread{nullptr};
-    std::shared_ptr<ISendReceiveDevice> mSendReceiveDevice{nullptr};
+    std::string                              mEthernetData{};
+    std::string                              mIp{cIp};
+    unsigned int                             mPort{cPort};
+    bool                                     mSharedIoService{false};
+    std::shared_ptr<boost::asio::io_service> mIoService{std::make_shared<boost::asio::io_service>()};
+    boost::asio::ip::udp::socket             mSocket{*mIoService};
+    boost::asio::ip::udp::endpoint           mRemote{};
+    std::shared_ptr<boost::thread>           mReceiverThread{nullptr};
+    std::shared_ptr<ISendReceiveDevice>      mSendReceiveDevice{nullptr};
 };
@@ -0,0 +1,66 @@
+#pragma once
+
+/* Copyright (c) 2020 [Rick de Bondt] - XLinkKaiSessionManager.h
+ *
+ * This file contains functions to run multiple XLink Kai connections on a single event loop.
+ *
+ * */
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/thread.hpp>
+
+#include "XLinkKaiConnection.h"
+
+namespace XLinkKaiSessionManager_Constants
+{
+    // How long the event loop may wait for traffic before connection states are checked again.
+    static constexpr std::chrono::milliseconds cStateCheckInterval{100};
+}  // namespace XLinkKaiSessionManager_Constants
+
+/**
+ * Class that runs multiple XLink Kai connections (sessions) on one event loop and one thread, so multiple ad-hoc
+ * groups can be bridged from a single process. Every session identifies itself with its own locally unique name.
+ */
+class XLinkKaiSessionManager
+{
+public:
+    XLinkKaiSessionManager() = default;
+    ~XLinkKaiSessionManager();
+    XLinkKaiSessionManager(const XLinkKaiSessionManager& aXLinkKaiSessionManager) = delete;
+    XLinkKaiSessionManager& operator=(const XLinkKaiSessionManager& aXLinkKaiSessionManager) = delete;
+
+    /**
+     * Adds a session to the event loop, the session still has to be opened before it can be used.
+     * Sessions can only be added while the receiver thread is not running.
+     * @param aLocallyUniqueName - Name the session identifies itself with to XLink Kai.
+     * @return The created session, nullptr if the name is already in use or the receiver thread is running.
+     */
+    std::shared_ptr<XLinkKaiConnection> AddSession(std::string_view aLocallyUniqueName);
+
+    /**
+     * Gets all sessions added to this manager.
+     * @return List of sessions.
+     */
+    [[nodiscard]] const std::vector<std::shared_ptr<XLinkKaiConnection>>& GetSessions() const;
+
+    /**
+     * Starts receiving on all sessions and starts the thread running the event loop.
+     * @return True if all sessions started receiving successfully.
+     */
+    bool StartReceiverThread();
+
+    /**
+     * Stops the event loop and closes and removes all sessions.
+     */
+    void Close();
+
+private:
+    std::shared_ptr<boost::asio::io_service>         mIoService{std::make_shared<boost::asio::io_service>()};
+    std::vector<std::shared_ptr<XLinkKaiConnection>> mSessions{};
+    std::shared_ptr<boost::thread>                   mReceiverThread{nullptr};
+};
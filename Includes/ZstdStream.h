@@ -0,0 +1,110 @@
+#pragma once
+
+/* Copyright (c) 2020 [Rick de Bondt] - ZstdStream.h
+ *
+ * This file contains streaming zstd compression and decompression, used for compressed capture files.
+ *
+ * */
+
+#include <string>
+#include <string_view>
+
+// Declared here so this header can be used without zstd installed, see HAVE_ZSTD.
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+
+namespace ZstdStream_Constants
+{
+    static constexpr std::string_view cExtension{".zst"};
+    // Fast enough to keep up with a busy session on a single core, and still about a third of the size.
+    static constexpr int cDefaultLevel{3};
+}  // namespace ZstdStream_Constants
+
+/**
+ * Compresses data in steps into a single zstd frame.
+ * */
+class ZstdCompressor
+{
+public:
+    ZstdCompressor() = default;
+    ~ZstdCompressor();
+    ZstdCompressor(const ZstdCompressor& aZstdCompressor) = delete;
+    ZstdCompressor& operator=(const ZstdCompressor& aZstdCompressor) = delete;
+
+    /**
+     * Checks if this build can read and write zstd files.
+     * @return true if zstd support is compiled in.
+     */
+    static bool IsAvailable();
+
+    /**
+     * Checks if a path has the extension of a zstd file.
+     * @param aPath - The path to check.
+     * @return true if the path ends in .zst.
+     */
+    static bool IsCompressedPath(std::string_view aPath);
+
+    /**
+     * Starts a new frame, a frame that was not finished yet is thrown away.
+     * @param aLevel - Compression level.
+     * @return true if successful.
+     */
+    bool Open(int aLevel = ZstdStream_Constants::cDefaultLevel);
+
+    void Close();
+
+    /**
+     * Compresses data and appends everything zstd has ready to the output.
+     * @param aData - The data to compress.
+     * @param aOutput - Buffer to append the compressed data to.
+     * @param aFinish - Ends the frame, the output is then a complete file. Otherwise the data is flushed, so the
+     * output can be decompressed up to here even if the program stops.
+     * @return true if successful.
+     */
+    bool Compress(std::string_view aData, std::string& aOutput, bool aFinish = false);
+
+private:
+    ZSTD_CCtx_s* mContext{nullptr};
+};
+
+/**
+ * Decompresses one or more consecutive zstd frames into a buffer of the caller, in steps.
+ * */
+class ZstdDecompressor
+{
+public:
+    ZstdDecompressor() = default;
+    ~ZstdDecompressor();
+    ZstdDecompressor(const ZstdDecompressor& aZstdDecompressor) = delete;
+    ZstdDecompressor& operator=(const ZstdDecompressor& aZstdDecompressor) = delete;
+
+    /**
+     * Starts decompressing compressed data, the data has to stay valid until closed.
+     * @param aInput - All compressed data, for example a mapped file.
+     * @return true if successful.
+     */
+    bool Open(std::string_view aInput);
+
+    void Close();
+
+    /**
+     * Decompresses as much as fits in the output.
+     * @param aOutput - Where to decompress to.
+     * @param aCapacity - Space available at aOutput.
+     * @param aProduced - Set to the amount of bytes decompressed.
+     * @return false on corrupt data.
+     */
+    bool Decompress(char* aOutput, std::size_t aCapacity, std::size_t& aProduced);
+
+    /**
+     * Checks if all compressed data has been decompressed.
+     * @return true if there is nothing more to decompress.
+     */
+    [[nodiscard]] bool IsFinished() const;
+
+private:
+    ZSTD_DCtx_s*     mContext{nullptr};
+    std::string_view mInput{};
+    std::size_t      mInputPosition{0};
+    bool             mFrameDone{true}; /**< No frame is partially decompressed. */
+};
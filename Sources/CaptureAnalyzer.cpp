@@ -0,0 +1,396 @@
+#include "../Includes/CaptureAnalyzer.h"
+
+/* Copyright (c) 2020 [Rick de Bondt] - CaptureAnalyzer.cpp */
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include "../Includes/Logger.h"
+#include "../Includes/NetworkingHeaders.h"
+
+using namespace CaptureAnalyzer_Constants;
+using namespace std::chrono;
+
+namespace
+{
+    constexpr uint8_t  cFrameControlRetry{0x08};
+    constexpr uint8_t  cFrameControlToDS{0x01};
+    constexpr uint8_t  cFrameControlFromDS{0x02};
+    constexpr uint8_t  cControlType{1};
+
+    constexpr std::array<std::array<std::string_view, 16>, 4> cFrameTypeNames{
+        {{"Association request",
+          "Association response",
+          "Reassociation request",
+          "Reassociation response",
+          "Probe request",
+          "Probe response",
+          "Timing advertisement",
+          "Management 7",
+          "Beacon",
+          "ATIM",
+          "Disassociation",
+          "Authentication",
+          "Deauthentication",
+          "Action",
+          "Action no ack",
+          "Management 15"},
+         {"Control 0",
+          "Control 1",
+          "Trigger",
+          "TACK",
+          "Beamforming report poll",
+          "NDP announcement",
+          "Control frame extension",
+          "Control wrapper",
+          "Block ack request",
+          "Block ack",
+          "PS-Poll",
+          "RTS",
+          "CTS",
+          "Ack",
+          "CF-End",
+          "CF-End + CF-Ack"},
+         {"Data",
+          "Data + CF-Ack",
+          "Data + CF-Poll",
+          "Data + CF-Ack + CF-Poll",
+          "Null",
+          "CF-Ack",
+          "CF-Poll",
+          "CF-Ack + CF-Poll",
+          "QoS data",
+          "QoS data + CF-Ack",
+          "QoS data + CF-Poll",
+          "QoS data + CF-Ack + CF-Poll",
+          "QoS null",
+          "Data 13",
+          "QoS CF-Poll",
+          "QoS CF-Ack + CF-Poll"},
+         {}}};
+
+    uint64_t ReadMac(std::string_view aData, std::size_t aIndex)
+    {
+        uint64_t lReturn{0};
+        for (std::size_t lByte = 0; lByte < 6; lByte++) {
+            lReturn = (lReturn << 8U) | static_cast<uint8_t>(aData[aIndex + lByte]);
+        }
+        return lReturn;
+    }
+}  // namespace
+
+CaptureAnalyzer::CaptureAnalyzer(Settings aSettings) : mSettings(std::move(aSettings))
+{
+    if (mSettings.RateInterval.count() <= 0) {
+        mSettings.RateInterval = cDefaultRateInterval;
+    }
+}
+
+bool CaptureAnalyzer::Analyze(std::string_view aInput)
+{
+    bool             lReturn{false};
+    MappedPCapReader lReader{};
+    auto             lStart{steady_clock::now()};
+
+    mReport = {};
+    mEdges.clear();
+
+    if (lReader.Open(aInput, 0)) {
+        CaptureScanner lScanner{mSettings.Threads, mSettings.ChunkSize, cChunksInFlightPerThread};
+
+        uint64_t lChunksTotal{lScanner.Scan(
+            lReader,
+            [this](const MappedPCapReader_Constants::Frame& aFrame,
+                   uint16_t /*aLinkType*/,
+                   const CaptureScanner_Constants::Chunk& aChunk) {
+                if (aChunk.Frames.empty()) {
+                    // Rates are counted from the first frame, so every chunk needs to know when that was.
+                    if (aChunk.Number == 0) {
+                        mCaptureStart = aFrame.TimeStamp;
+                    }
+
+                    std::lock_guard<std::mutex> lLock{mMutex};
+                    mEdges.emplace_back();
+                }
+            },
+            [&](const CaptureScanner_Constants::Chunk& aChunk) {
+                ScanChunk(aChunk);
+                lScanner.ChunkDone();
+            })};
+
+        ResolveEdges();
+        mReport.Chunks = lChunksTotal;
+
+        lReader.Close();
+        lReturn = true;
+    } else {
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Could not analyze {}", aInput);
+    }
+
+    mReport.Duration = steady_clock::now() - lStart;
+
+    return lReturn;
+}
+
+void CaptureAnalyzer::ScanChunk(const CaptureScanner_Constants::Chunk& aChunk)
+{
+    Report          lReport{};
+    Edge            lEdge{};
+    PacketConverter lConverter{true};
+
+    for (std::size_t lIndex = 0; lIndex < aChunk.Frames.size(); lIndex++) {
+        const MappedPCapReader_Constants::Frame& lFrame{aChunk.Frames.at(lIndex)};
+        uint16_t                                 lLinkType{aChunk.LinkTypes.at(lIndex)};
+        std::string_view                         lData{lFrame.Data};
+
+        lReport.Frames++;
+        lReport.Bytes += lFrame.Length;
+
+        int64_t lRateIndex{(lFrame.TimeStamp - mCaptureStart) / mSettings.RateInterval};
+        if (lFrame.TimeStamp < mCaptureStart) {
+            // Rounded towards the past, like for frames after the start.
+            lRateIndex -= ((lFrame.TimeStamp - mCaptureStart) % mSettings.RateInterval).count() != 0 ? 1 : 0;
+        }
+        lReport.Rates[lRateIndex].Frames++;
+        lReport.Rates[lRateIndex].Bytes += lFrame.Length;
+
+        if (lEdge.Empty) {
+            lEdge.Empty          = false;
+            lEdge.FirstTimeStamp = lFrame.TimeStamp;
+        } else {
+            AddInterval(lReport, lEdge.LastTimeStamp, lFrame.TimeStamp);
+        }
+        lEdge.LastTimeStamp = lFrame.TimeStamp;
+
+        if ((lLinkType == DLT_IEEE802_11_RADIO) || (lLinkType == DLT_IEEE802_11)) {
+            lConverter.SetRadioTap(lLinkType == DLT_IEEE802_11_RADIO);
+
+            uint16_t lHeader{0};
+            if (lLinkType == DLT_IEEE802_11_RADIO) {
+                // The converter assumes the radiotap header is there, so check that first.
+                if ((lData.size() >= sizeof(RadioTapHeader)) &&
+                    (static_cast<uint16_t>(static_cast<uint8_t>(lData[RadioTap_Constants::cLengthIndex]) |
+                                           (static_cast<uint8_t>(lData[RadioTap_Constants::cLengthIndex + 1]) << 8U)) <=
+                     std::min<std::size_t>(lData.size(), RadioTap_Constants::cMaxLength))) {
+                    lConverter.Update(lData);
+                    lHeader = lConverter.GetRadioTapReader().GetLength();
+                } else {
+                    lHeader = UINT16_MAX;
+                }
+            } else {
+                lConverter.Update(lData);
+            }
+
+            // Control frames can be as short as 10 bytes, everything else has the full header with sequence control.
+            bool    lValid{(lHeader != UINT16_MAX) && (lData.size() >= lHeader + 10U)};
+            uint8_t lType{static_cast<uint8_t>(lValid ? (static_cast<uint8_t>(lData[lHeader]) >> 2U) & 0x3U : 0U)};
+            bool    lFullHeader{lValid &&
+                             (lData.size() >= lHeader + std::size_t{Net_80211_Constants::c80211DataHeaderLength})};
+
+            if (lValid && ((lType == cControlType) || lFullHeader)) {
+                auto     lFrameControl{static_cast<uint8_t>(lData[lHeader])};
+                auto     lFlags{static_cast<uint8_t>(lData[lHeader + 1])};
+                bool     lRetry{(lFlags & cFrameControlRetry) != 0};
+                uint32_t lFrameType{static_cast<uint32_t>((lType << 4U) | (lFrameControl >> 4U))};
+
+                lReport.WirelessFrames++;
+                lReport.FrameTypes[lFrameType].Frames++;
+                lReport.FrameTypes[lFrameType].Bytes += lFrame.Length;
+                lReport.Retries += lRetry ? 1 : 0;
+
+                const RadioTapReader& lRadioTap{lConverter.GetRadioTapReader()};
+                bool lSignal{(lLinkType == DLT_IEEE802_11_RADIO) && lRadioTap.HasSignal()};
+                if (lSignal) {
+                    lReport.Signals.at(static_cast<std::size_t>(lRadioTap.GetSignal() + 128))++;
+                }
+
+                // Control frames like acks do not have a transmitter address.
+                if (lFullHeader) {
+                    uint64_t lTransmitter{lConverter.GetSourceMac(lData)};
+                    Station& lStation{lReport.Stations[lTransmitter]};
+                    lStation.Frames++;
+                    lStation.Bytes += lFrame.Length;
+                    lStation.Retries += lRetry ? 1 : 0;
+                    if (lSignal) {
+                        lStation.SignalSum += lRadioTap.GetSignal();
+                        lStation.SignalFrames++;
+                    }
+
+                    // The BSSID is in a different address depending on the direction, ad-hoc has it in the third.
+                    uint64_t lBSSID{lConverter.GetBSSID(lData)};
+                    if ((lFlags & (cFrameControlToDS | cFrameControlFromDS)) == cFrameControlToDS) {
+                        lBSSID = lConverter.GetDestinationMac(lData);
+                    } else if ((lFlags & (cFrameControlToDS | cFrameControlFromDS)) == cFrameControlFromDS) {
+                        lBSSID = lTransmitter;
+                    }
+                    if ((lFlags & (cFrameControlToDS | cFrameControlFromDS)) !=
+                        (cFrameControlToDS | cFrameControlFromDS)) {
+                        lReport.BSSIDs[lBSSID].Frames++;
+                        lReport.BSSIDs[lBSSID].Bytes += lFrame.Length;
+                    }
+
+                    // A retry with the same sequence number as the last frame means the original was captured too.
+                    auto lSequence{static_cast<uint16_t>(
+                        static_cast<uint8_t>(lData[lHeader + Net_80211_Constants::cFragmentNumberIndex]) |
+                        (static_cast<uint8_t>(lData[lHeader + Net_80211_Constants::cFragmentNumberIndex + 1]) << 8U))};
+                    auto [lEntry, lNew] = lEdge.Sequences.try_emplace(lTransmitter, SequenceEdge{lSequence, lRetry});
+                    if (!lNew && lRetry && (lEntry->second.LastSequence == lSequence)) {
+                        lReport.Duplicates++;
+                    }
+                    lEntry->second.LastSequence = lSequence;
+                }
+            } else {
+                lReport.Malformed++;
+            }
+        } else if (lLinkType == DLT_EN10MB) {
+            if (lData.size() >= Net_8023_Constants::cHeaderLength) {
+                auto lEtherType{
+                    static_cast<uint32_t>((static_cast<uint8_t>(lData[Net_8023_Constants::cEtherTypeIndex]) << 8U) |
+                                          static_cast<uint8_t>(lData[Net_8023_Constants::cEtherTypeIndex + 1]))};
+                Station& lStation{lReport.Stations[ReadMac(lData, Net_8023_Constants::cSourceAddressIndex)]};
+
+                lStation.Frames++;
+                lStation.Bytes += lFrame.Length;
+                lReport.FrameTypes[cEtherTypeFlag | lEtherType].Frames++;
+                lReport.FrameTypes[cEtherTypeFlag | lEtherType].Bytes += lFrame.Length;
+            } else {
+                lReport.Malformed++;
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lLock{mMutex};
+        Merge(lReport);
+        mEdges.at(aChunk.Number) = std::move(lEdge);
+    }
+}
+
+void CaptureAnalyzer::AddInterval(Report& aReport, nanoseconds aPrevious, nanoseconds aNext) const
+{
+    // Frames are not always in order in a capture, those count as arriving together.
+    nanoseconds lInterval{std::max(aNext - aPrevious, nanoseconds(0))};
+
+    aReport.Intervals.at(Histogram_Constants::GetBucket(static_cast<uint64_t>(lInterval.count())))++;
+    aReport.MaxInterval = std::max(aReport.MaxInterval, lInterval);
+
+    if (lInterval > mSettings.GapThreshold) {
+        aReport.Gaps.push_back({aPrevious, lInterval});
+    }
+}
+
+void CaptureAnalyzer::Merge(Report& aReport)
+{
+    mReport.Frames += aReport.Frames;
+    mReport.Bytes += aReport.Bytes;
+    mReport.Malformed += aReport.Malformed;
+    mReport.WirelessFrames += aReport.WirelessFrames;
+    mReport.Retries += aReport.Retries;
+    mReport.Duplicates += aReport.Duplicates;
+    mReport.MaxInterval = std::max(mReport.MaxInterval, aReport.MaxInterval);
+
+    for (auto& [lBSSID, lCounters] : aReport.BSSIDs) {
+        mReport.BSSIDs[lBSSID].Frames += lCounters.Frames;
+        mReport.BSSIDs[lBSSID].Bytes += lCounters.Bytes;
+    }
+
+    for (auto& [lMac, lStation] : aReport.Stations) {
+        Station& lTotal{mReport.Stations[lMac]};
+        lTotal.Frames += lStation.Frames;
+        lTotal.Bytes += lStation.Bytes;
+        lTotal.Retries += lStation.Retries;
+        lTotal.SignalSum += lStation.SignalSum;
+        lTotal.SignalFrames += lStation.SignalFrames;
+    }
+
+    for (auto& [lFrameType, lCounters] : aReport.FrameTypes) {
+        mReport.FrameTypes[lFrameType].Frames += lCounters.Frames;
+        mReport.FrameTypes[lFrameType].Bytes += lCounters.Bytes;
+    }
+
+    for (auto& [lRateIndex, lCounters] : aReport.Rates) {
+        mReport.Rates[lRateIndex].Frames += lCounters.Frames;
+        mReport.Rates[lRateIndex].Bytes += lCounters.Bytes;
+    }
+
+    for (std::size_t lIndex = 0; lIndex < mReport.Signals.size(); lIndex++) {
+        mReport.Signals.at(lIndex) += aReport.Signals.at(lIndex);
+    }
+
+    for (std::size_t lIndex = 0; lIndex < mReport.Intervals.size(); lIndex++) {
+        mReport.Intervals.at(lIndex) += aReport.Intervals.at(lIndex);
+    }
+
+    mReport.Gaps.insert(mReport.Gaps.end(), aReport.Gaps.begin(), aReport.Gaps.end());
+}
+
+void CaptureAnalyzer::ResolveEdges()
+{
+    std::unordered_map<uint64_t, uint16_t> lLastSequences{};
+    Edge*                                  lPrevious{nullptr};
+
+    for (auto& lEdge : mEdges) {
+        if (!lEdge.Empty) {
+            if (lPrevious == nullptr) {
+                mReport.FirstTimeStamp = lEdge.FirstTimeStamp;
+            } else {
+                AddInterval(mReport, lPrevious->LastTimeStamp, lEdge.FirstTimeStamp);
+            }
+
+            for (auto& [lTransmitter, lSequences] : lEdge.Sequences) {
+                auto lLast{lLastSequences.find(lTransmitter)};
+                if (lSequences.FirstRetry && (lLast != lLastSequences.end()) &&
+                    (lLast->second == lSequences.FirstSequence)) {
+                    mReport.Duplicates++;
+                }
+                lLastSequences[lTransmitter] = lSequences.LastSequence;
+            }
+
+            mReport.LastTimeStamp = lEdge.LastTimeStamp;
+            lPrevious             = &lEdge;
+        }
+    }
+
+    // Chunks finish in any order.
+    std::sort(mReport.Gaps.begin(), mReport.Gaps.end(), [](const Gap& aFirst, const Gap& aSecond) {
+        return aFirst.Start < aSecond.Start;
+    });
+}
+
+const Report& CaptureAnalyzer::GetReport() const
+{
+    return mReport;
+}
+
+nanoseconds CaptureAnalyzer::GetIntervalPercentile(const Report& aReport, double aPercentile)
+{
+    std::size_t lBucket{Histogram_Constants::GetPercentileBucket(aReport.Intervals, aPercentile)};
+    return std::min(nanoseconds(Histogram_Constants::GetBucketValue(lBucket)), aReport.MaxInterval);
+}
+
+int CaptureAnalyzer::GetSignalPercentile(const Report& aReport, double aPercentile)
+{
+    int lReturn{0};
+
+    if (std::any_of(aReport.Signals.begin(), aReport.Signals.end(), [](uint64_t aCount) { return aCount > 0; })) {
+        lReturn = static_cast<int>(Histogram_Constants::GetPercentileBucket(aReport.Signals, aPercentile)) - 128;
+    }
+
+    return lReturn;
+}
+
+std::string CaptureAnalyzer::GetFrameTypeName(uint32_t aFrameType)
+{
+    std::ostringstream lReturn{};
+
+    if ((aFrameType & cEtherTypeFlag) != 0) {
+        lReturn << "EtherType 0x" << std::hex << std::setw(4) << std::setfill('0') << (aFrameType & 0xffffU);
+    } else if (auto lName{cFrameTypeNames.at((aFrameType >> 4U) & 0x3U).at(aFrameType & 0xfU)}; !lName.empty()) {
+        lReturn << lName;
+    } else {
+        lReturn << "Extension " << (aFrameType & 0xfU);
+    }
+
+    return lReturn.str();
+}
@@ -0,0 +1,237 @@
+#include "../Includes/CaptureConverter.h"
+
+/* Copyright (c) 2020 [Rick de Bondt] - CaptureConverter.cpp */
+
+#include <algorithm>
+
+#include <boost/thread.hpp>
+
+#include "../Includes/Logger.h"
+#include "../Includes/NetworkingHeaders.h"
+
+using namespace CaptureConverter_Constants;
+using namespace std::chrono;
+
+namespace
+{
+    constexpr uint32_t cPCapMagic{0xa1b2c3d4};
+    constexpr uint16_t cPCapVersionMajor{2};
+    constexpr uint16_t cPCapVersionMinor{4};
+
+    template<typename Type> void Append(std::string& aBuffer, Type aValue)
+    {
+        aBuffer.append(reinterpret_cast<const char*>(&aValue), sizeof(aValue));
+    }
+
+    // Classic pcap record, in the byte order of this machine like libpcap writes them.
+    void AppendRecord(std::string& aBuffer, nanoseconds aTimeStamp, std::string_view aData)
+    {
+        Append<uint32_t>(aBuffer, static_cast<uint32_t>(duration_cast<seconds>(aTimeStamp).count()));
+        Append<uint32_t>(aBuffer, static_cast<uint32_t>(duration_cast<microseconds>(aTimeStamp).count() % 1000000));
+        Append<uint32_t>(aBuffer, static_cast<uint32_t>(aData.size()));
+        Append<uint32_t>(aBuffer, static_cast<uint32_t>(aData.size()));
+        aBuffer.append(aData);
+    }
+
+    // Length of the radiotap header, UINT16_MAX if the frame is too short for the header it claims to have.
+    uint16_t ReadRadioTapLength(std::string_view aData)
+    {
+        uint16_t lReturn{UINT16_MAX};
+
+        if (aData.size() >= sizeof(RadioTapHeader)) {
+            auto lLength{static_cast<uint16_t>(
+                static_cast<uint8_t>(aData[RadioTap_Constants::cLengthIndex]) |
+                (static_cast<uint8_t>(aData[RadioTap_Constants::cLengthIndex + 1]) << 8U))};
+            if (lLength <= std::min<std::size_t>(aData.size(), RadioTap_Constants::cMaxLength)) {
+                lReturn = lLength;
+            }
+        }
+
+        return lReturn;
+    }
+}  // namespace
+
+CaptureConverter::CaptureConverter(Settings aSettings) : mSettings(std::move(aSettings)) {}
+
+bool CaptureConverter::Convert(std::string_view aInput, std::string_view aOutput)
+{
+    bool             lReturn{false};
+    MappedPCapReader lReader{};
+    auto             lStart{steady_clock::now()};
+
+    mStatistics    = {};
+    mChunksWritten = 0;
+    mChunksTotal   = 0;
+    mScanDone      = false;
+    mConverted.clear();
+    mStartStates.clear();
+
+    if (lReader.Open(aInput, mSettings.Frequency)) {
+        mOutput.open(std::string(aOutput), std::ios::binary | std::ios::trunc);
+    }
+
+    if (mOutput.is_open()) {
+        std::string lFileHeader{};
+        Append<uint32_t>(lFileHeader, cPCapMagic);
+        Append<uint16_t>(lFileHeader, cPCapVersionMajor);
+        Append<uint16_t>(lFileHeader, cPCapVersionMinor);
+        Append<int32_t>(lFileHeader, 0);
+        Append<uint32_t>(lFileHeader, 0);
+        Append<uint32_t>(lFileHeader, cSnapLength);
+        Append<uint32_t>(lFileHeader,
+                         mSettings.ConversionDirection == Direction::MonitorTo8023 ? DLT_EN10MB : DLT_IEEE802_11_RADIO);
+        mOutput.write(lFileHeader.data(), lFileHeader.size());
+
+        CaptureScanner lScanner{mSettings.Threads, mSettings.ChunkSize, cChunksInFlightPerThread};
+        boost::thread  lWriter{[&] { WriteChunks(lScanner); }};
+
+        // Only beacons change state, and only when the BSSID is not fixed. Reading them here is cheap compared to
+        // converting, and gives every chunk the state it starts with.
+        bool lTrackBeacons{(mSettings.ConversionDirection == Direction::MonitorTo8023) && (mSettings.BSSID == 0)};
+
+        PacketConverter                              lConverter{true};
+        IPCapDevice_Constants::WiFiBeaconInformation lWifiInformation{};
+        lWifiInformation.Frequency = mSettings.Frequency;
+
+        uint64_t lChunksTotal{lScanner.Scan(
+            lReader,
+            [&](const MappedPCapReader_Constants::Frame& aFrame,
+                uint16_t                                 aLinkType,
+                const CaptureScanner_Constants::Chunk&   aChunk) {
+                if (aChunk.Frames.empty()) {
+                    std::lock_guard<std::mutex> lLock{mMutex};
+                    mStartStates.emplace(aChunk.Number, lWifiInformation);
+                }
+                mStatistics.FramesRead++;
+
+                if (lTrackBeacons) {
+                    ProcessFrame(aFrame.Data, aLinkType, lConverter, lWifiInformation, false);
+                }
+            },
+            [this](const CaptureScanner_Constants::Chunk& aChunk) { ConvertChunk(aChunk); })};
+
+        {
+            std::lock_guard<std::mutex> lLock{mMutex};
+            mChunksTotal = lChunksTotal;
+            mScanDone    = true;
+        }
+        mCondition.notify_all();
+
+        lWriter.join();
+        mStatistics.Chunks = mChunksTotal;
+
+        lReturn = mOutput.good();
+        mOutput.close();
+    } else {
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Could not convert {} to {}", aInput, aOutput);
+    }
+
+    lReader.Close();
+    mStatistics.Duration = steady_clock::now() - lStart;
+
+    return lReturn;
+}
+
+std::string CaptureConverter::ProcessFrame(std::string_view                              aFrame,
+                                           uint16_t                                      aLinkType,
+                                           PacketConverter&                              aConverter,
+                                           IPCapDevice_Constants::WiFiBeaconInformation& aWifiInformation,
+                                           bool                                          aConvert) const
+{
+    std::string lReturn{};
+
+    if (mSettings.ConversionDirection == Direction::MonitorTo8023) {
+        // The converter does not check lengths, so make sure the radiotap and full 802.11 header are there first.
+        uint16_t lHeader{aLinkType == DLT_IEEE802_11_RADIO ? ReadRadioTapLength(aFrame) :
+                                                             static_cast<uint16_t>(UINT16_MAX)};
+        if ((lHeader != UINT16_MAX) &&
+            (aFrame.size() >= lHeader + std::size_t{Net_80211_Constants::c80211DataHeaderLength})) {
+            // Same handling as WirelessMonitorDevice::ReadCallback.
+            aConverter.Update(aFrame);
+
+            if (aConverter.Is80211Beacon(aFrame)) {
+                // The SSID is the first parameter after the fixed ones, and has to fit as well.
+                std::size_t lSSIDIndex{lHeader + Net_80211_Constants::cFixedParameterTypeSSIDIndex + 2U};
+                if ((aFrame.size() >= lSSIDIndex) &&
+                    (aFrame.size() >= lSSIDIndex + static_cast<uint8_t>(aFrame[lSSIDIndex - 1]))) {
+                    std::string lSSID{aConverter.GetBeaconSSID(aFrame)};
+
+                    for (auto& lFilter : mSettings.SSIDFilter) {
+                        if ((lSSID.find(lFilter) != std::string::npos) && (lSSID != aWifiInformation.SSID)) {
+                            aConverter.FillWiFiInformation(aFrame, aWifiInformation);
+                        }
+                    }
+                }
+            } else if (aConvert && aConverter.Is80211Data(aFrame) &&
+                       aConverter.IsForBSSID(aFrame,
+                                             mSettings.BSSID != 0 ? mSettings.BSSID : aWifiInformation.BSSID)) {
+                lReturn = aConverter.ConvertPacketTo8023(aFrame);
+            }
+        }
+    } else if (aConvert && (aLinkType == DLT_EN10MB)) {
+        lReturn = aConverter.ConvertPacketTo80211(aFrame, mSettings.BSSID, mSettings.Frequency, mSettings.MaxRate);
+    }
+
+    return lReturn;
+}
+
+void CaptureConverter::ConvertChunk(const CaptureScanner_Constants::Chunk& aChunk)
+{
+    PacketConverter                              lConverter{true};
+    IPCapDevice_Constants::WiFiBeaconInformation lWifiInformation{};
+    std::string                                  lRecords{};
+    uint64_t                                     lFrames{0};
+
+    {
+        std::lock_guard<std::mutex> lLock{mMutex};
+        auto                        lStartState{mStartStates.find(aChunk.Number)};
+        lWifiInformation = lStartState->second;
+        mStartStates.erase(lStartState);
+    }
+
+    for (std::size_t lIndex = 0; lIndex < aChunk.Frames.size(); lIndex++) {
+        const MappedPCapReader_Constants::Frame& lFrame{aChunk.Frames.at(lIndex)};
+        std::string                              lConverted{
+            ProcessFrame(lFrame.Data, aChunk.LinkTypes.at(lIndex), lConverter, lWifiInformation, true)};
+        if (!lConverted.empty()) {
+            AppendRecord(lRecords, lFrame.TimeStamp, lConverted);
+            lFrames++;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lLock{mMutex};
+        mConverted.emplace(aChunk.Number, std::make_pair(std::move(lRecords), lFrames));
+    }
+    mCondition.notify_all();
+}
+
+void CaptureConverter::WriteChunks(CaptureScanner& aScanner)
+{
+    std::unique_lock<std::mutex> lLock{mMutex};
+
+    while (!mScanDone || (mChunksWritten < mChunksTotal)) {
+        mCondition.wait(lLock, [&] {
+            return (mConverted.count(mChunksWritten) > 0) || (mScanDone && (mChunksWritten == mChunksTotal));
+        });
+
+        // Chunks can finish in any order, but only the next one in line gets written.
+        if (auto lChunk = mConverted.find(mChunksWritten); lChunk != mConverted.end()) {
+            auto [lRecords, lFrames] = std::move(lChunk->second);
+            mConverted.erase(lChunk);
+
+            lLock.unlock();
+            mOutput.write(lRecords.data(), lRecords.size());
+            lLock.lock();
+
+            mStatistics.FramesWritten += lFrames;
+            mChunksWritten++;
+            aScanner.ChunkDone();
+        }
+    }
+}
+
+const Statistics& CaptureConverter::GetStatistics() const
+{
+    return mStatistics;
+}
@@ -0,0 +1,394 @@
+#include "../Includes/CaptureIndex.h"
+
+/* Copyright (c) 2020 [Rick de Bondt] - CaptureIndex.cpp */
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include <boost/endian/conversion.hpp>
+
+#include "../Includes/Logger.h"
+#include "../Includes/PacketConverter.h"
+
+using namespace CaptureIndex_Constants;
+using namespace MappedPCapReader_Constants;
+
+namespace
+{
+    constexpr uint16_t    cMacLength{6};
+    constexpr std::size_t cSourceMacIndex{6};
+    // Version, padding and length of a radiotap header.
+    constexpr std::size_t cRadioTapHeaderLength{4};
+    // Sizes of the records in the sidecar, used to check counts against what is left of the file before reading.
+    constexpr uint64_t cSectionSize{sizeof(uint8_t) + sizeof(uint32_t)};
+    constexpr uint64_t cInterfaceSize{sizeof(uint16_t) + sizeof(uint32_t) + sizeof(uint8_t)};
+    constexpr uint64_t cPositionSize{sizeof(uint64_t) + sizeof(int64_t) + sizeof(uint64_t) + sizeof(uint32_t)};
+    constexpr uint64_t cAddressSize{sizeof(uint64_t) + cPositionSize};
+
+    // The sidecar is always stored little endian, so it can be moved between machines with the capture.
+    template<typename Type> void Write(std::ofstream& aStream, Type aValue)
+    {
+        aValue = boost::endian::native_to_little(aValue);
+        aStream.write(reinterpret_cast<const char*>(&aValue), sizeof(aValue));
+    }
+
+    template<typename Type> Type Read(std::ifstream& aStream)
+    {
+        Type lValue{0};
+        aStream.read(reinterpret_cast<char*>(&lValue), sizeof(lValue));
+        return boost::endian::little_to_native(lValue);
+    }
+
+    void WritePosition(std::ofstream& aStream, const Position& aPosition)
+    {
+        Write<uint64_t>(aStream, aPosition.Packet);
+        Write<int64_t>(aStream, aPosition.TimeStamp.count());
+        Write<uint64_t>(aStream, aPosition.Offset);
+        Write<uint32_t>(aStream, aPosition.Section);
+    }
+
+    Position ReadPosition(std::ifstream& aStream)
+    {
+        Position lPosition{};
+        lPosition.Packet    = Read<uint64_t>(aStream);
+        lPosition.TimeStamp = std::chrono::nanoseconds(Read<int64_t>(aStream));
+        lPosition.Offset    = Read<uint64_t>(aStream);
+        lPosition.Section   = Read<uint32_t>(aStream);
+        return lPosition;
+    }
+
+    void WriteAddresses(std::ofstream& aStream, const std::map<uint64_t, Position>& aAddresses)
+    {
+        Write<uint64_t>(aStream, aAddresses.size());
+        for (auto& [lAddress, lPosition] : aAddresses) {
+            Write<uint64_t>(aStream, lAddress);
+            WritePosition(aStream, lPosition);
+        }
+    }
+
+    // Whether a count read from the sidecar can be right, a corrupt one could otherwise make us allocate gigabytes.
+    bool Fits(std::ifstream& aStream, uint64_t aFileSize, uint64_t aCount, uint64_t aRecordSize)
+    {
+        auto lOffset{static_cast<uint64_t>(aStream.tellg())};
+        return aStream.good() && (lOffset <= aFileSize) && (aCount <= (aFileSize - lOffset) / aRecordSize);
+    }
+
+    bool ReadAddresses(std::ifstream&                aStream,
+                       uint64_t                      aFileSize,
+                       uint32_t                      aSections,
+                       std::map<uint64_t, Position>& aAddresses)
+    {
+        bool     lReturn{true};
+        uint64_t lCount{Read<uint64_t>(aStream)};
+
+        lReturn = Fits(aStream, aFileSize, lCount, cAddressSize);
+        for (uint64_t lIndex = 0; lReturn && (lIndex < lCount); lIndex++) {
+            uint64_t lAddress{Read<uint64_t>(aStream)};
+            Position lPosition{ReadPosition(aStream)};
+            lReturn = aStream.good() && (lPosition.Section < aSections);
+            aAddresses.emplace(lAddress, lPosition);
+        }
+
+        return lReturn;
+    }
+
+    uint64_t ReadMac(std::string_view aData, std::size_t aIndex)
+    {
+        uint64_t lReturn{0};
+        for (std::size_t lCount = 0; lCount < cMacLength; lCount++) {
+            lReturn = (lReturn << 8U) + static_cast<uint8_t>(aData.at(aIndex + lCount));
+        }
+        return lReturn;
+    }
+
+    uint16_t ReadRadioTapLength(std::string_view aData)
+    {
+        uint16_t lReturn{0};
+        memcpy(&lReturn, aData.data() + RadioTap_Constants::cLengthIndex, sizeof(lReturn));
+        return boost::endian::little_to_native(lReturn);
+    }
+}  // namespace
+
+bool CaptureIndex::Build(std::string_view aCapturePath, uint32_t aInterval)
+{
+    bool             lReturn{false};
+    MappedPCapReader lReader{};
+
+    *this     = CaptureIndex{};
+    mInterval = std::max<uint32_t>(aInterval, 1);
+
+    if (ZstdCompressor::IsCompressedPath(aCapturePath)) {
+        // Seeking needs random access, compressed captures can only be read front to back.
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Compressed captures cannot be indexed: {}", aCapturePath);
+    } else if (lReader.Open(aCapturePath, 0)) {
+        PacketConverter          lConverter{true};
+        std::size_t              lInterfaceCount{0};
+        std::chrono::nanoseconds lLatest{0};
+        mCaptureSize = lReader.GetSize();
+        mCaptureTime = GetModificationTime(aCapturePath);
+
+        while (lReader.ReadNextData()) {
+            const Frame& lFrame{lReader.GetFrame()};
+
+            // Keep the section information complete, interfaces can be added anywhere in a section.
+            if (mSections.empty() || (lReader.GetSectionNumber() >= mSections.size()) ||
+                (lReader.GetInterfaces().size() != lInterfaceCount)) {
+                Section lSection{lReader.GetSection()};
+                lInterfaceCount = lSection.Interfaces.size();
+                mSections.resize(lSection.Number + 1);
+                mSections.at(lSection.Number) = lSection;
+            }
+
+            // Captures are not always in order, so entries note the latest time seen to keep them searchable.
+            lLatest = std::max(lLatest, lFrame.TimeStamp);
+            Position lPosition{mPacketCount, lLatest, lFrame.Offset, lReader.GetSectionNumber()};
+
+            if (mPacketCount % mInterval == 0) {
+                mEntries.emplace_back(lPosition);
+            }
+
+            lPosition.TimeStamp = lFrame.TimeStamp;
+            AddAddresses(lFrame.Data, lReader.GetInterfaces().at(lFrame.Interface).LinkType, lPosition, lConverter);
+            mPacketCount++;
+        }
+
+        lReader.Close();
+        lReturn = true;
+        Logger::GetInstance().Log<Logger::Level::DEBUG>("Indexed {} packets of {}", mPacketCount, aCapturePath);
+    }
+
+    return lReturn;
+}
+
+void CaptureIndex::AddAddresses(std::string_view aFrame,
+                                uint16_t         aLinkType,
+                                const Position&  aPosition,
+                                PacketConverter& aConverter)
+{
+    if ((aLinkType == DLT_EN10MB) && (aFrame.size() >= Net_8023_Constants::cHeaderLength)) {
+        mMacs.try_emplace(ReadMac(aFrame, cSourceMacIndex), aPosition);
+    } else if ((aLinkType == DLT_IEEE802_11_RADIO) && (aFrame.size() >= cRadioTapHeaderLength)) {
+        // The converter does not check lengths, so make sure a full header is there.
+        if (aFrame.size() >= ReadRadioTapLength(aFrame) + sizeof(ieee80211_hdr) + sizeof(uint64_t)) {
+            aConverter.Update(aFrame);
+            if (aConverter.Is80211Beacon(aFrame) || aConverter.Is80211Data(aFrame)) {
+                mBSSIDs.try_emplace(aConverter.GetBSSID(aFrame), aPosition);
+                mMacs.try_emplace(aConverter.GetSourceMac(aFrame), aPosition);
+            }
+        }
+    }
+}
+
+bool CaptureIndex::Save(std::string_view aPath) const
+{
+    bool          lReturn{false};
+    std::ofstream lFile(std::string(aPath), std::ios::binary | std::ios::trunc);
+
+    if (lFile.is_open()) {
+        lFile.write(cIndexMagic.data(), cIndexMagic.size());
+        Write<uint64_t>(lFile, mCaptureSize);
+        Write<int64_t>(lFile, mCaptureTime.count());
+        Write<uint32_t>(lFile, mInterval);
+        Write<uint64_t>(lFile, mPacketCount);
+
+        Write<uint32_t>(lFile, mSections.size());
+        for (auto& lSection : mSections) {
+            Write<uint8_t>(lFile, lSection.Swapped ? 1 : 0);
+            Write<uint32_t>(lFile, lSection.Interfaces.size());
+            for (auto& lInterface : lSection.Interfaces) {
+                Write<uint16_t>(lFile, lInterface.LinkType);
+                Write<uint32_t>(lFile, lInterface.SnapLength);
+                Write<uint8_t>(lFile, lInterface.TimeStampResolution);
+            }
+        }
+
+        Write<uint64_t>(lFile, mEntries.size());
+        for (auto& lEntry : mEntries) {
+            WritePosition(lFile, lEntry);
+        }
+
+        WriteAddresses(lFile, mBSSIDs);
+        WriteAddresses(lFile, mMacs);
+
+        lReturn = lFile.good();
+    }
+
+    if (!lReturn) {
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Could not write index {}", aPath);
+    }
+
+    return lReturn;
+}
+
+bool CaptureIndex::Load(std::string_view aPath, uint64_t aCaptureSize, std::chrono::nanoseconds aCaptureTime)
+{
+    bool            lReturn{false};
+    std::error_code lError{};
+    uint64_t        lFileSize{std::filesystem::file_size(aPath, lError)};
+    std::ifstream   lFile(std::string(aPath), std::ios::binary);
+
+    *this = CaptureIndex{};
+
+    if (!lError && lFile.is_open()) {
+        std::string lMagic(cIndexMagic.size(), '\0');
+        lFile.read(lMagic.data(), lMagic.size());
+        mCaptureSize = Read<uint64_t>(lFile);
+        mCaptureTime = std::chrono::nanoseconds(Read<int64_t>(lFile));
+
+        // A capture that was written again since indexing likely has another size, and otherwise another time.
+        if ((lMagic == cIndexMagic) && (mCaptureSize == aCaptureSize) && (mCaptureTime == aCaptureTime)) {
+            mInterval    = std::max<uint32_t>(Read<uint32_t>(lFile), 1);
+            mPacketCount = Read<uint64_t>(lFile);
+
+            uint32_t lSections{Read<uint32_t>(lFile)};
+            lReturn = Fits(lFile, lFileSize, lSections, cSectionSize);
+            if (lReturn) {
+                mSections.resize(lSections);
+            }
+
+            for (uint32_t lNumber = 0; lReturn && (lNumber < mSections.size()); lNumber++) {
+                Section& lSection{mSections.at(lNumber)};
+                lSection.Number  = lNumber;
+                lSection.Swapped = Read<uint8_t>(lFile) != 0;
+
+                uint32_t lInterfaces{Read<uint32_t>(lFile)};
+                lReturn = Fits(lFile, lFileSize, lInterfaces, cInterfaceSize);
+                if (lReturn) {
+                    lSection.Interfaces.resize(lInterfaces);
+                }
+
+                for (auto& lInterface : lSection.Interfaces) {
+                    lInterface.LinkType            = Read<uint16_t>(lFile);
+                    lInterface.SnapLength          = Read<uint32_t>(lFile);
+                    lInterface.TimeStampResolution = Read<uint8_t>(lFile);
+                }
+            }
+
+            // Every packet has to have an entry at or before it, see FindPacket.
+            uint64_t lEntries{Read<uint64_t>(lFile)};
+            lReturn = lReturn && (lEntries == (mPacketCount + mInterval - 1) / mInterval) &&
+                      Fits(lFile, lFileSize, lEntries, cPositionSize);
+            for (uint64_t lIndex = 0; lReturn && (lIndex < lEntries); lIndex++) {
+                mEntries.emplace_back(ReadPosition(lFile));
+                lReturn = (mEntries.back().Packet == lIndex * mInterval) && (mEntries.back().Section < lSections);
+            }
+
+            lReturn = lReturn && ReadAddresses(lFile, lFileSize, lSections, mBSSIDs) &&
+                      ReadAddresses(lFile, lFileSize, lSections, mMacs) && lFile.good();
+
+            if (!lReturn) {
+                Logger::GetInstance().Log<Logger::Level::WARNING>("Index {} is damaged", aPath);
+            }
+        } else {
+            Logger::GetInstance().Log<Logger::Level::DEBUG>("Index {} is not for this capture", aPath);
+        }
+    }
+
+    if (!lReturn) {
+        *this = CaptureIndex{};
+    }
+
+    return lReturn;
+}
+
+std::string CaptureIndex::GetIndexPath(std::string_view aCapturePath)
+{
+    return std::string(aCapturePath) + std::string(cIndexExtension);
+}
+
+std::optional<Position> CaptureIndex::FindTime(std::chrono::nanoseconds aTimeStamp) const
+{
+    std::optional<Position> lReturn{};
+
+    if (!mEntries.empty()) {
+        auto lEntry{std::upper_bound(mEntries.begin(),
+                                     mEntries.end(),
+                                     aTimeStamp,
+                                     [](std::chrono::nanoseconds aTime, const Position& aPosition) {
+                                         return aTime < aPosition.TimeStamp;
+                                     })};
+
+        lReturn = (lEntry == mEntries.begin()) ? *lEntry : *std::prev(lEntry);
+    }
+
+    return lReturn;
+}
+
+std::optional<Position> CaptureIndex::FindPacket(uint64_t aPacket) const
+{
+    std::optional<Position> lReturn{};
+
+    if (aPacket < mPacketCount) {
+        lReturn = mEntries.at(aPacket / mInterval);
+    }
+
+    return lReturn;
+}
+
+std::optional<Position> CaptureIndex::FindBSSID(uint64_t aBSSID) const
+{
+    std::optional<Position> lReturn{};
+
+    if (auto lPosition = mBSSIDs.find(aBSSID); lPosition != mBSSIDs.end()) {
+        lReturn = lPosition->second;
+    }
+
+    return lReturn;
+}
+
+std::optional<Position> CaptureIndex::FindMac(uint64_t aMac) const
+{
+    std::optional<Position> lReturn{};
+
+    if (auto lPosition = mMacs.find(aMac); lPosition != mMacs.end()) {
+        lReturn = lPosition->second;
+    }
+
+    return lReturn;
+}
+
+const Section& CaptureIndex::GetSection(const Position& aPosition) const
+{
+    return mSections.at(aPosition.Section);
+}
+
+uint64_t CaptureIndex::GetPacketCount() const
+{
+    return mPacketCount;
+}
+
+uint64_t CaptureIndex::GetCaptureSize() const
+{
+    return mCaptureSize;
+}
+
+std::chrono::nanoseconds CaptureIndex::GetCaptureTime() const
+{
+    return mCaptureTime;
+}
+
+std::chrono::nanoseconds CaptureIndex::GetModificationTime(std::string_view aCapturePath)
+{
+    std::error_code lError{};
+    auto            lTime{std::filesystem::last_write_time(aCapturePath, lError)};
+
+    return lError ? std::chrono::nanoseconds(0) :
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(lTime.time_since_epoch());
+}
+
+const std::vector<Position>& CaptureIndex::GetEntries() const
+{
+    return mEntries;
+}
+
+const std::map<uint64_t, Position>& CaptureIndex::GetBSSIDs() const
+{
+    return mBSSIDs;
+}
+
+const std::map<uint64_t, Position>& CaptureIndex::GetMacs() const
+{
+    return mMacs;
+}
@@ -0,0 +1,80 @@
+#include "../Includes/CaptureScanner.h"
+
+/* Copyright (c) 2020 [Rick de Bondt] - CaptureScanner.cpp */
+
+#include <algorithm>
+#include <thread>
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+using namespace CaptureScanner_Constants;
+
+CaptureScanner::CaptureScanner(unsigned int aThreads, unsigned int aChunkSize, unsigned int aChunksInFlightPerThread) :
+    mThreads{aThreads > 0 ? aThreads : std::max(std::thread::hardware_concurrency(), 1U)},
+    mChunkSize{std::max(aChunkSize, 1U)}, mChunksInFlight{mThreads * std::max(aChunksInFlightPerThread, 1U)}
+{}
+
+uint64_t CaptureScanner::Scan(MappedPCapReader&    aReader,
+                              const FrameCallback& aFrameCallback,
+                              const ChunkCallback& aChunkCallback)
+{
+    uint64_t                 lChunksTotal{0};
+    Chunk                    lChunk{};
+    boost::asio::thread_pool lPool{mThreads};
+
+    {
+        std::lock_guard<std::mutex> lLock{mMutex};
+        mChunksDone = 0;
+    }
+
+    auto lSubmit = [&] {
+        {
+            std::unique_lock<std::mutex> lLock{mMutex};
+            mCondition.wait(lLock, [&] { return (lChunksTotal - mChunksDone) < mChunksInFlight; });
+        }
+        lChunksTotal++;
+
+        boost::asio::post(lPool, [&aChunkCallback, lFullChunk = std::move(lChunk)] { aChunkCallback(lFullChunk); });
+        lChunk        = Chunk{};
+        lChunk.Number = lChunksTotal;
+    };
+
+    while (aReader.ReadNextData()) {
+        const MappedPCapReader_Constants::Frame& lFrame{aReader.GetFrame()};
+        uint16_t                                 lLinkType{aReader.GetInterfaces().at(lFrame.Interface).LinkType};
+
+        if (aFrameCallback != nullptr) {
+            aFrameCallback(lFrame, lLinkType, lChunk);
+        }
+
+        lChunk.Frames.emplace_back(lFrame);
+        lChunk.LinkTypes.emplace_back(lLinkType);
+
+        // The reader reuses its buffer for compressed captures, so the chunk needs its own copy.
+        if (aReader.IsCompressed()) {
+            lChunk.Frames.back().Data = lChunk.Storage->emplace_back(lFrame.Data);
+        }
+
+        if (lChunk.Frames.size() >= mChunkSize) {
+            lSubmit();
+        }
+    }
+
+    if (!lChunk.Frames.empty()) {
+        lSubmit();
+    }
+
+    lPool.join();
+
+    return lChunksTotal;
+}
+
+void CaptureScanner::ChunkDone()
+{
+    {
+        std::lock_guard<std::mutex> lLock{mMutex};
+        mChunksDone++;
+    }
+    mCondition.notify_all();
+}
@@ -0,0 +1,313 @@
+#include "../Includes/ControlServer.h"
+
+/* Copyright (c) 2020 [Rick de Bondt] - ControlServer.cpp */
+
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
+
+#if not defined(_MSC_VER) && not defined(__MINGW32__)
+#include <stdlib.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#endif
+
+#include "../Includes/Logger.h"
+#include "../Includes/ThreadName.h"
+
+using namespace ControlServer_Constants;
+using namespace Statistics_Constants;
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+using boost::asio::local::stream_protocol;
+
+/**
+ * A client connected to the server, answers its requests one at a time.
+ */
+class ControlServer::Connection : public std::enable_shared_from_this<ControlServer::Connection>
+{
+public:
+    Connection(boost::asio::io_service& aIoService, const Handler& aHandler) :
+        mSocket{aIoService}, mHandler{aHandler}, mBuffer{cMaxLineLength}
+    {}
+
+    void Start()
+    {
+        Read();
+    }
+
+    void Close()
+    {
+        boost::system::error_code lError{};
+        mSocket.close(lError);
+    }
+
+    stream_protocol::socket mSocket;
+
+private:
+    void Read()
+    {
+        boost::asio::async_read_until(mSocket,
+                                      mBuffer,
+                                      cLineEnd,
+                                      [lThis = shared_from_this()](const boost::system::error_code& aError,
+                                                                   std::size_t) { lThis->HandleRead(aError); });
+    }
+
+    void HandleRead(const boost::system::error_code& aError)
+    {
+        if (!aError) {
+            std::istream lStream{&mBuffer};
+            std::string  lLine{};
+            std::getline(lStream, lLine, cLineEnd);
+            if (!lLine.empty() && lLine.back() == '\r') {
+                lLine.pop_back();
+            }
+
+            std::vector<std::string> lArguments{SplitRequest(lLine)};
+            Reply                    lReply{};
+            if (lArguments.empty()) {
+                lReply = {false, {"Empty request"}};
+            } else {
+                try {
+                    lReply = mHandler(lArguments);
+                } catch (std::exception& aException) {
+                    lReply = {false, {aException.what()}};
+                }
+            }
+
+            mReply = FormatReply(lReply);
+            boost::asio::async_write(mSocket,
+                                     boost::asio::buffer(mReply),
+                                     [lThis = shared_from_this()](const boost::system::error_code& aWriteError,
+                                                                  std::size_t) {
+                                         if (!aWriteError) {
+                                             lThis->Read();
+                                         }
+                                     });
+        } else if (aError == boost::asio::error::not_found) {
+            // The line did not fit in the buffer, there is no telling where the next request starts.
+            mReply = FormatReply({false, {"Request too long"}});
+            boost::asio::async_write(
+                mSocket, boost::asio::buffer(mReply), [lThis = shared_from_this()](const auto&, std::size_t) {
+                    lThis->Close();
+                });
+        }
+    }
+
+    const Handler&         mHandler;
+    boost::asio::streambuf mBuffer;
+    std::string            mReply{};
+};
+#else
+class ControlServer::Connection
+{
+public:
+    void Close() {}
+};
+#endif
+
+ControlServer::ControlServer(Handler aHandler) : mHandler{std::move(aHandler)} {}
+
+ControlServer::~ControlServer()
+{
+    Close();
+}
+
+bool ControlServer::Open(std::string_view aPath)
+{
+    bool lReturn{false};
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+    std::filesystem::path lPath{aPath};
+    std::filesystem::path lBindPath{lPath};
+    std::filesystem::path lPrivateDirectory{};
+    bool                  lCanBind{true};
+
+#if not defined(_MSC_VER) && not defined(__MINGW32__)
+    // Binding creates the socket with the umask of the program, so bind it in a directory only the owner can enter
+    // and move it into place once it is owner only. Changing the umask instead would affect files other threads create.
+    std::string lTemplate{(lPath.parent_path() / ("." + lPath.filename().string() + ".XXXXXX")).string()};
+    if (mkdtemp(lTemplate.data()) != nullptr) {
+        lPrivateDirectory = lTemplate;
+        lBindPath         = lPrivateDirectory / lPath.filename();
+    } else {
+        Logger::GetInstance().Log<Logger::Level::ERROR>(
+            "Could not open control socket {}: no private directory to bind it in", aPath.data());
+        lCanBind = false;
+    }
+#endif
+
+    if (lCanBind) {
+        try {
+            // A socket left behind by a previous run would make binding fail, anything else is not ours to replace.
+            if (std::filesystem::is_socket(lPath)) {
+                std::filesystem::remove(lPath);
+            } else if (std::filesystem::exists(lPath)) {
+                throw std::filesystem::filesystem_error(
+                    "Path is taken", lPath, std::make_error_code(std::errc::file_exists));
+            }
+
+            mAcceptor =
+                std::make_shared<stream_protocol::acceptor>(*mIoService, stream_protocol::endpoint(lBindPath.string()));
+            std::filesystem::permissions(lBindPath,
+                                         std::filesystem::perms::owner_read | std::filesystem::perms::owner_write);
+            if (lBindPath != lPath) {
+                std::filesystem::rename(lBindPath, lPath);
+            }
+            mPath   = aPath;
+            lReturn = true;
+        } catch (std::exception& aException) {
+            Logger::GetInstance().Log<Logger::Level::ERROR>(
+                "Could not open control socket {}: {}", aPath.data(), aException.what());
+            mAcceptor = nullptr;
+        }
+    }
+
+    if (!lPrivateDirectory.empty()) {
+        std::error_code lRemoveError{};
+        std::filesystem::remove_all(lPrivateDirectory, lRemoveError);
+    }
+#else
+    Logger::GetInstance().Log<Logger::Level::ERROR>("Control sockets are not supported on this platform");
+#endif
+
+    return lReturn;
+}
+
+bool ControlServer::StartThread()
+{
+    bool lReturn{false};
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+    if (mAcceptor != nullptr && mThread == nullptr) {
+        mIoService->restart();
+        Accept();
+
+        mThread = std::make_shared<boost::thread>([&] {
+            ThreadName_Constants::SetCurrentThreadName("control");
+#if defined(__linux__)
+            // Only Linux sets the niceness of the calling thread, elsewhere this would lower the whole program.
+            setpriority(PRIO_PROCESS, 0, cNiceness);
+#endif
+            mIoService->run();
+        });
+        lReturn = true;
+    }
+#endif
+
+    return lReturn;
+}
+
+void ControlServer::Close()
+{
+    if (mThread != nullptr) {
+        mIoService->stop();
+        mThread->join();
+        mThread = nullptr;
+    }
+
+    for (auto& lConnection : mConnections) {
+        if (auto lLockedConnection{lConnection.lock()}) {
+            lLockedConnection->Close();
+        }
+    }
+    mConnections.clear();
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+    if (mAcceptor != nullptr) {
+        boost::system::error_code lError{};
+        mAcceptor->close(lError);
+        mAcceptor = nullptr;
+
+        std::error_code lRemoveError{};
+        std::filesystem::remove(mPath, lRemoveError);
+    }
+#endif
+}
+
+void ControlServer::Accept()
+{
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+    auto lConnection{std::make_shared<Connection>(*mIoService, mHandler)};
+
+    mAcceptor->async_accept(lConnection->mSocket, [this, lConnection](const boost::system::error_code& aError) {
+        if (!aError) {
+            mConnections.erase(std::remove_if(mConnections.begin(),
+                                              mConnections.end(),
+                                              [](const auto& aConnection) { return aConnection.expired(); }),
+                               mConnections.end());
+
+            if (mConnections.size() < cMaxConnections) {
+                mConnections.emplace_back(lConnection);
+                lConnection->Start();
+            } else {
+                Logger::GetInstance().Log<Logger::Level::WARNING>("Too many control connections, refusing one");
+                lConnection->Close();
+            }
+        }
+
+        if (aError != boost::asio::error::operation_aborted) {
+            Accept();
+        }
+    });
+#endif
+}
+
+std::vector<std::string> ControlServer::SplitRequest(std::string_view aLine)
+{
+    std::vector<std::string> lReturn{};
+    std::istringstream       lStream{std::string(aLine)};
+    std::string              lWord{};
+
+    while (lStream >> lWord) {
+        lReturn.emplace_back(lWord);
+    }
+
+    return lReturn;
+}
+
+std::string ControlServer::FormatReply(const Reply& aReply)
+{
+    std::string lReturn{};
+
+    if (aReply.Success) {
+        for (const auto& lLine : aReply.Lines) {
+            lReturn.append(lLine).push_back(cLineEnd);
+        }
+        lReturn.append(cOk);
+    } else {
+        lReturn.append(cError);
+        if (!aReply.Lines.empty()) {
+            lReturn.append(" ").append(aReply.Lines.front());
+        }
+    }
+    lReturn.push_back(cLineEnd);
+
+    return lReturn;
+}
+
+std::vector<std::string> ControlServer::FormatSnapshot(const Snapshot& aSnapshot)
+{
+    std::vector<std::string> lReturn{};
+
+    for (std::size_t lIndex = 0; lIndex < cCounterCount; lIndex++) {
+        lReturn.emplace_back(std::string(cCounterNames.at(lIndex)) + " " +
+                             std::to_string(aSnapshot.Counters.at(lIndex)));
+    }
+
+    for (std::size_t lIndex = 0; lIndex < cLatencyCount; lIndex++) {
+        const LatencyHistogram& lHistogram{aSnapshot.Latencies.at(lIndex)};
+        std::string             lName{std::string(cLatencyNames.at(lIndex)) + "_latency"};
+
+        lReturn.emplace_back(lName + "_count " + std::to_string(lHistogram.Count));
+        lReturn.emplace_back(lName + "_p50_ns " + std::to_string(lHistogram.GetPercentile(50).count()));
+        lReturn.emplace_back(lName + "_p99_ns " + std::to_string(lHistogram.GetPercentile(99).count()));
+        lReturn.emplace_back(lName + "_p999_ns " + std::to_string(lHistogram.GetPercentile(99.9).count()));
+        lReturn.emplace_back(lName + "_max_ns " + std::to_string(lHistogram.Max.count()));
+    }
+
+    return lReturn;
+}
@@ -0,0 +1,469 @@
+#include "../Includes/FakeXLinkKaiEngine.h"
+
+/* Copyright (c) 2020 [Rick de Bondt] - FakeXLinkKaiEngine.cpp */
+
+#include <algorithm>
+#include <thread>
+
+#include "../Includes/Logger.h"
+#include "../Includes/ThreadName.h"
+
+using namespace boost::asio;
+using namespace FakeXLinkKaiEngine_Constants;
+
+ClientCommand FakeXLinkKaiEngine_Constants::ParseClientCommand(std::string_view aData)
+{
+    ClientCommand lReturn{ClientCommand::Unknown};
+
+    if (aData.starts_with(cEthernetDataString)) {
+        lReturn = ClientCommand::EthernetData;
+    } else if (aData.starts_with(cKeepAliveString)) {
+        lReturn = ClientCommand::KeepAlive;
+    } else if (aData.starts_with(std::string(cConnectFormat) + cSeparator.data())) {
+        lReturn = ClientCommand::Connect;
+    } else if (aData.starts_with(cDisconnectString)) {
+        lReturn = ClientCommand::Disconnect;
+    }
+
+    return lReturn;
+}
+
+FakeXLinkKaiEngine::~FakeXLinkKaiEngine()
+{
+    Close();
+}
+
+bool FakeXLinkKaiEngine::Open(unsigned int aPort)
+{
+    bool lReturn{true};
+
+    try {
+        mSocket.open(ip::udp::v4());
+        mSocket.bind(ip::udp::endpoint(ip::address::from_string(cIp.data()), aPort));
+    } catch (const boost::system::system_error& lException) {
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Failed to open fake XLink Kai engine: {}", lException.what());
+        lReturn = false;
+    }
+
+    return lReturn;
+}
+
+bool FakeXLinkKaiEngine::StartReceiverThread()
+{
+    bool lReturn{true};
+
+    if (mSocket.is_open()) {
+        StartReceiving();
+        if (mReceiverThread == nullptr) {
+            mReceiverThread = std::make_shared<boost::thread>([&] {
+                ThreadName_Constants::SetCurrentThreadName("fake-xlink-kai");
+                mIoService.restart();
+                mIoService.run();
+            });
+        }
+    } else {
+        Logger::GetInstance().Log<Logger::Level::ERROR>(
+            "Can't start the fake XLink Kai engine without an opened socket!");
+        lReturn = false;
+    }
+
+    return lReturn;
+}
+
+void FakeXLinkKaiEngine::StartReceiving()
+{
+    mSocket.async_receive_from(
+        buffer(mData, cMaxLength),
+        mSender,
+        boost::bind(&FakeXLinkKaiEngine::ReceiveCallback, this, placeholders::error, placeholders::bytes_transferred));
+}
+
+void FakeXLinkKaiEngine::ReceiveCallback(const boost::system::error_code& aError, size_t aBytesReceived)
+{
+    // When the socket gets closed the pending receive is aborted, nothing to handle then.
+    if (aError != boost::asio::error::operation_aborted) {
+        auto                      lArrival{std::chrono::steady_clock::now()};
+        std::string_view          lData{mData.data(), aBytesReceived};
+        ClientCommand             lType{ParseClientCommand(lData)};
+        ip::udp::endpoint         lClient{mSender};
+        bool                      lConfirm{false};
+        std::chrono::milliseconds lDelay{0};
+
+        {
+            std::lock_guard<std::mutex> lLock{mMutex};
+            mClient = lClient;
+            ClientState& lState{mClients[lClient]};
+
+            switch (lType) {
+                case ClientCommand::Connect: {
+                    // connect;<name>;<emulator>; gets answered with connected;<name>
+                    std::string_view lName{lData};
+                    lName.remove_prefix(cConnectFormat.size() + cSeparator.size());
+                    lName = lName.substr(0, lName.find(cSeparator));
+
+                    // A client that comes back from another endpoint takes its history along.
+                    for (auto lIterator = mClients.begin(); lIterator != mClients.end();) {
+                        if (lIterator->first != lClient && lIterator->second.Name == lName) {
+                            for (std::size_t lIndex = 0; lIndex < cClientCommandCount; lIndex++) {
+                                lState.ReceivedCounts.at(lIndex) += lIterator->second.ReceivedCounts.at(lIndex);
+                            }
+                            lIterator = mClients.erase(lIterator);
+                        } else {
+                            lIterator++;
+                        }
+                    }
+
+                    lState.Name = lName;
+                    if (mAcceptConnections) {
+                        lConfirm = true;
+                        lDelay   = mConnectDelay;
+                    }
+                    break;
+                }
+                case ClientCommand::Disconnect:
+                    lState.Connected = false;
+                    break;
+                case ClientCommand::EthernetData:
+                    if (mTimeStampReader != nullptr) {
+                        auto lSent{mTimeStampReader(lData.substr(cEthernetDataString.size()))};
+                        if (lSent.has_value()) {
+                            mLatencies.Add(lArrival - lSent.value());
+                        }
+                    }
+                    break;
+                case ClientCommand::KeepAlive:
+                case ClientCommand::Unknown:
+                    break;
+            }
+
+            auto lIndex{static_cast<std::size_t>(lType)};
+            mReceivedCounts.at(lIndex)++;
+            mReceivedBytes.at(lIndex) += aBytesReceived;
+            lState.ReceivedCounts.at(lIndex)++;
+
+            // Only the most recent messages are kept, so long runs do not grow the engine without bounds.
+            if (mMessageLogSize > 0) {
+                if (mReceivedMessages.size() >= mMessageLogSize) {
+                    mReceivedMessages.pop_front();
+                }
+                mReceivedMessages.emplace_back(ReceivedMessage{lArrival, lType, std::string(lData), lState.Name});
+            }
+        }
+        mMessageReceived.notify_all();
+
+        if (lConfirm) {
+            if (lDelay.count() > 0) {
+                auto lTimer{std::make_shared<steady_timer>(mIoService, lDelay)};
+                lTimer->async_wait([this, lTimer, lClient](const boost::system::error_code& aTimerError) {
+                    if (!aTimerError) {
+                        ConfirmConnection(lClient);
+                    }
+                });
+            } else {
+                ConfirmConnection(lClient);
+            }
+        }
+
+        StartReceiving();
+    }
+}
+
+void FakeXLinkKaiEngine::ConfirmConnection(const ip::udp::endpoint& aClient)
+{
+    std::string lReply{};
+
+    {
+        std::lock_guard<std::mutex> lLock{mMutex};
+        auto                        lState{mClients.find(aClient)};
+        // The client may have come back from another endpoint in the meantime.
+        if (lState != mClients.end()) {
+            lReply = std::string(cConnectedFormat) + cSeparator.data() + lState->second.Name;
+        }
+    }
+
+    // Only counts as connected once the reply is out, so anything sent after WaitForConnection arrives after it.
+    if (!lReply.empty() && SendTo(aClient, lReply)) {
+        {
+            std::lock_guard<std::mutex> lLock{mMutex};
+            if (auto lState = mClients.find(aClient); lState != mClients.end()) {
+                lState->second.Connected = true;
+            }
+        }
+        mMessageReceived.notify_all();
+    }
+}
+
+std::optional<ip::udp::endpoint> FakeXLinkKaiEngine::FindClient(std::string_view aClientName) const
+{
+    std::optional<ip::udp::endpoint> lReturn{std::nullopt};
+
+    if (aClientName.empty()) {
+        lReturn = mClient;
+    } else {
+        auto lClient{std::find_if(
+            mClients.begin(), mClients.end(), [&](const auto& aClient) { return aClient.second.Name == aClientName; })};
+        if (lClient != mClients.end()) {
+            lReturn = lClient->first;
+        }
+    }
+
+    return lReturn;
+}
+
+void FakeXLinkKaiEngine::Close()
+{
+    try {
+        if (mReceiverThread != nullptr) {
+            mIoService.stop();
+            mReceiverThread->join();
+            mReceiverThread = nullptr;
+        }
+
+        if (mSocket.is_open()) {
+            mSocket.close();
+        }
+    } catch (...) {
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Failed to close fake XLink Kai engine: {}",
+                                                        boost::current_exception_diagnostic_information());
+    }
+
+    std::lock_guard<std::mutex> lLock{mMutex};
+    for (auto& lClient : mClients) {
+        lClient.second.Connected = false;
+    }
+}
+
+unsigned int FakeXLinkKaiEngine::GetPort() const
+{
+    unsigned int lReturn{0};
+
+    if (mSocket.is_open()) {
+        lReturn = mSocket.local_endpoint().port();
+    }
+
+    return lReturn;
+}
+
+void FakeXLinkKaiEngine::SetAcceptConnections(bool aAccept)
+{
+    std::lock_guard<std::mutex> lLock{mMutex};
+    mAcceptConnections = aAccept;
+}
+
+void FakeXLinkKaiEngine::SetConnectDelay(std::chrono::milliseconds aDelay)
+{
+    std::lock_guard<std::mutex> lLock{mMutex};
+    mConnectDelay = aDelay;
+}
+
+void FakeXLinkKaiEngine::SetMessageLogSize(std::size_t aSize)
+{
+    std::lock_guard<std::mutex> lLock{mMutex};
+    mMessageLogSize = aSize;
+    while (mReceivedMessages.size() > mMessageLogSize) {
+        mReceivedMessages.pop_front();
+    }
+}
+
+void FakeXLinkKaiEngine::SetTimeStampReader(TimeStampReader aReader)
+{
+    std::lock_guard<std::mutex> lLock{mMutex};
+    mTimeStampReader = std::move(aReader);
+}
+
+bool FakeXLinkKaiEngine::SendRaw(std::string_view aData, std::string_view aClientName)
+{
+    bool lReturn{false};
+
+    std::optional<ip::udp::endpoint> lClient{};
+    {
+        std::lock_guard<std::mutex> lLock{mMutex};
+        lClient = FindClient(aClientName);
+    }
+
+    if (lClient.has_value()) {
+        lReturn = SendTo(lClient.value(), aData);
+    } else {
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Fake XLink Kai engine does not know client {}", aClientName);
+    }
+
+    return lReturn;
+}
+
+bool FakeXLinkKaiEngine::SendTo(const ip::udp::endpoint& aClient, std::string_view aData)
+{
+    bool lReturn{true};
+
+    try {
+        mSocket.send_to(buffer(aData.data(), aData.size()), aClient);
+    } catch (const boost::system::system_error& lException) {
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Fake XLink Kai engine could not send: {}", lException.what());
+        lReturn = false;
+    }
+
+    return lReturn;
+}
+
+bool FakeXLinkKaiEngine::SendEthernetData(std::string_view aFrame, std::string_view aClientName)
+{
+    return SendRaw(cEthernetDataString + std::string(aFrame), aClientName);
+}
+
+bool FakeXLinkKaiEngine::SendKeepAlive(std::string_view aClientName)
+{
+    return SendRaw(cKeepAliveString, aClientName);
+}
+
+bool FakeXLinkKaiEngine::SendDisconnected(std::string_view aClientName)
+{
+    std::string lName{};
+
+    {
+        std::lock_guard<std::mutex> lLock{mMutex};
+        auto                        lClient{FindClient(aClientName)};
+        if (lClient.has_value() && mClients.contains(lClient.value())) {
+            ClientState& lState{mClients.at(lClient.value())};
+            lState.Connected = false;
+            lName            = lState.Name;
+        }
+    }
+
+    return SendRaw(std::string(cDisconnectedFormat) + cSeparator.data() + lName, aClientName);
+}
+
+unsigned int FakeXLinkKaiEngine::InjectEthernetData(std::string_view         aFrame,
+                                                    unsigned int             aCount,
+                                                    std::chrono::nanoseconds aInterval)
+{
+    unsigned int lSent{0};
+    std::string  lMessage{cEthernetDataString + std::string(aFrame)};
+    auto         lDeadline{std::chrono::steady_clock::now()};
+
+    for (unsigned int lCount = 0; lCount < aCount; lCount++) {
+        if (SendRaw(lMessage)) {
+            lSent++;
+        }
+
+        // Pace against absolute deadlines so oversleeping does not add up.
+        if (aInterval.count() > 0) {
+            lDeadline += aInterval;
+            std::this_thread::sleep_until(lDeadline);
+        }
+    }
+
+    return lSent;
+}
+
+unsigned int FakeXLinkKaiEngine::RunScript(const std::vector<ScriptedMessage>& aScript)
+{
+    unsigned int lSent{0};
+
+    for (const auto& lMessage : aScript) {
+        std::this_thread::sleep_for(lMessage.Delay);
+        if (SendRaw(lMessage.Data)) {
+            lSent++;
+        }
+    }
+
+    return lSent;
+}
+
+bool FakeXLinkKaiEngine::WaitForConnection(std::chrono::milliseconds aTimeout, std::string_view aClientName)
+{
+    std::unique_lock<std::mutex> lLock{mMutex};
+    return mMessageReceived.wait_for(lLock, aTimeout, [&] {
+        auto lClient{FindClient(aClientName)};
+        return lClient.has_value() && mClients.contains(lClient.value()) && mClients.at(lClient.value()).Connected;
+    });
+}
+
+bool FakeXLinkKaiEngine::WaitForMessages(ClientCommand             aType,
+                                         std::size_t               aCount,
+                                         std::chrono::milliseconds aTimeout,
+                                         std::string_view          aClientName)
+{
+    std::unique_lock<std::mutex> lLock{mMutex};
+    return mMessageReceived.wait_for(lLock, aTimeout, [&] { return CountMessages(aType, aClientName) >= aCount; });
+}
+
+std::vector<ReceivedMessage> FakeXLinkKaiEngine::GetReceivedMessages()
+{
+    std::lock_guard<std::mutex> lLock{mMutex};
+    return {mReceivedMessages.begin(), mReceivedMessages.end()};
+}
+
+std::size_t FakeXLinkKaiEngine::GetReceivedCount(ClientCommand aType, std::string_view aClientName)
+{
+    std::lock_guard<std::mutex> lLock{mMutex};
+    return CountMessages(aType, aClientName);
+}
+
+std::size_t FakeXLinkKaiEngine::CountMessages(ClientCommand aType, std::string_view aClientName) const
+{
+    std::size_t lReturn{0};
+    auto        lIndex{static_cast<std::size_t>(aType)};
+
+    if (aClientName.empty()) {
+        lReturn = mReceivedCounts.at(lIndex);
+    } else {
+        for (const auto& lClient : mClients) {
+            if (lClient.second.Name == aClientName) {
+                lReturn += lClient.second.ReceivedCounts.at(lIndex);
+            }
+        }
+    }
+
+    return lReturn;
+}
+
+uint64_t FakeXLinkKaiEngine::GetReceivedBytes(ClientCommand aType)
+{
+    std::lock_guard<std::mutex> lLock{mMutex};
+    return mReceivedBytes.at(static_cast<std::size_t>(aType));
+}
+
+Statistics_Constants::LatencyHistogram FakeXLinkKaiEngine::GetLatencies()
+{
+    std::lock_guard<std::mutex> lLock{mMutex};
+    return mLatencies;
+}
+
+void FakeXLinkKaiEngine::ClearReceivedMessages()
+{
+    std::lock_guard<std::mutex> lLock{mMutex};
+    mReceivedMessages.clear();
+    mReceivedCounts = {};
+    mReceivedBytes  = {};
+    mLatencies      = {};
+    for (auto& lClient : mClients) {
+        lClient.second.ReceivedCounts = {};
+    }
+}
+
+std::string FakeXLinkKaiEngine::GetClientName()
+{
+    std::lock_guard<std::mutex> lLock{mMutex};
+    std::string                 lReturn{};
+
+    auto lClient{mClients.find(mClient)};
+    if (lClient != mClients.end() && lClient->second.Connected) {
+        lReturn = lClient->second.Name;
+    }
+
+    return lReturn;
+}
+
+std::vector<std::string> FakeXLinkKaiEngine::GetConnectedClients()
+{
+    std::lock_guard<std::mutex> lLock{mMutex};
+    std::vector<std::string>    lReturn{};
+
+    for (const auto& lClient : mClients) {
+        if (lClient.second.Connected) {
+            lReturn.emplace_back(lClient.second.Name);
+        }
+    }
+    std::sort(lReturn.begin(), lReturn.end());
+
+    return lReturn;
+}
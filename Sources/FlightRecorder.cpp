@@ -0,0 +1,255 @@
+#include "../Includes/FlightRecorder.h"
+
+/* Copyright (c) 2020 [Rick de Bondt] - FlightRecorder.cpp */
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+#include "../Includes/PCapNGWriter.h"
+#include "../Includes/ThreadName.h"
+
+using namespace FlightRecorder_Constants;
+using namespace SessionRecorder_Constants;
+using namespace std::chrono;
+
+namespace
+{
+    struct DumpedFrame
+    {
+        nanoseconds TimeStamp{0};
+        Direction   FrameDirection{Direction::ToXLinkKai};
+        uint32_t    Length{0};
+        std::string Data{};
+    };
+
+    struct DumpedEvent
+    {
+        nanoseconds   TimeStamp{0};
+        Logger::Level Level{Logger::Level::INFO};
+        std::string   Text{};
+    };
+
+    // Waits for a slot that is being written to, recording only takes a copy so this is short.
+    template<typename Slot> void Lock(Slot& aSlot)
+    {
+        while (aSlot.Busy.exchange(true, std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+    std::string FormatTime(nanoseconds aTimeStamp, const char* aFormat)
+    {
+        std::time_t        lTime{static_cast<std::time_t>(duration_cast<seconds>(aTimeStamp).count())};
+        std::tm            lCalendar{};
+        std::ostringstream lReturn{};
+#if defined(_MSC_VER) || defined(__MINGW32__)
+        localtime_s(&lCalendar, &lTime);
+#else
+        localtime_r(&lTime, &lCalendar);
+#endif
+        lReturn << std::put_time(&lCalendar, aFormat);
+        return lReturn.str();
+    }
+}  // namespace
+
+FlightRecorder::FlightRecorder(FlightRecorder_Constants::Settings aSettings) :
+    mSettings(std::move(aSettings)),
+    mFrames{std::vector<FrameSlot>(std::max<std::size_t>(mSettings.FramesPerDirection, 1)),
+            std::vector<FrameSlot>(std::max<std::size_t>(mSettings.FramesPerDirection, 1))},
+    mEvents(std::max<std::size_t>(mSettings.Events, 1))
+{}
+
+FlightRecorder::~FlightRecorder()
+{
+    Close();
+}
+
+bool FlightRecorder::StartDumpThread()
+{
+    bool lReturn{true};
+
+    if (mDumpThread == nullptr) {
+        {
+            std::lock_guard<std::mutex> lLock{mDumpMutex};
+            mRunning = true;
+        }
+        mDumpThread = std::make_shared<boost::thread>([&] {
+            ThreadName_Constants::SetCurrentThreadName("flight-recorder");
+            HandleDumpRequests();
+        });
+    }
+
+    return lReturn;
+}
+
+void FlightRecorder::Close()
+{
+    if (mDumpThread != nullptr) {
+        {
+            std::lock_guard<std::mutex> lLock{mDumpMutex};
+            mRunning = false;
+        }
+        mDumpCondition.notify_all();
+        mDumpThread->join();
+        mDumpThread = nullptr;
+    }
+}
+
+void FlightRecorder::Record(Direction aDirection, std::string_view aData)
+{
+    auto       lIndex{static_cast<std::size_t>(aDirection)};
+    auto&      lRing{mFrames.at(lIndex)};
+    uint64_t   lPosition{mFramePositions.at(lIndex).fetch_add(1, std::memory_order_relaxed)};
+    FrameSlot& lSlot{lRing[lPosition % lRing.size()]};
+
+    // If a dump is copying this slot, losing this frame is better than waiting for it.
+    if (!lSlot.Busy.exchange(true, std::memory_order_acquire)) {
+        lSlot.TimeStamp    = duration_cast<nanoseconds>(system_clock::now().time_since_epoch());
+        lSlot.Length       = static_cast<uint32_t>(aData.size());
+        lSlot.StoredLength = static_cast<uint32_t>(std::min(aData.size(), cMaxFrameLength));
+        memcpy(lSlot.Data.data(), aData.data(), lSlot.StoredLength);
+        lSlot.Busy.store(false, std::memory_order_release);
+    }
+}
+
+void FlightRecorder::RecordEvent(std::string_view aText, Logger::Level aLevel)
+{
+    uint64_t   lPosition{mEventPosition.fetch_add(1, std::memory_order_relaxed)};
+    EventSlot& lSlot{mEvents[lPosition % mEvents.size()]};
+
+    if (!lSlot.Busy.exchange(true, std::memory_order_acquire)) {
+        lSlot.TimeStamp = duration_cast<nanoseconds>(system_clock::now().time_since_epoch());
+        lSlot.Level     = aLevel;
+        lSlot.Length    = static_cast<uint32_t>(std::min(aText.size(), cMaxEventLength));
+        memcpy(lSlot.Text.data(), aText.data(), lSlot.Length);
+        lSlot.Busy.store(false, std::memory_order_release);
+    }
+}
+
+void FlightRecorder::Trigger(std::string_view aReason)
+{
+    int64_t lNow{duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count()};
+    int64_t lLastDump{mLastDump.load(std::memory_order_relaxed)};
+
+    // Only the first trigger after the interval gets through, this also stops a failing dump from triggering itself.
+    if (((lLastDump == 0) || (nanoseconds(lNow - lLastDump) >= mSettings.MinDumpInterval)) &&
+        mLastDump.compare_exchange_strong(lLastDump, lNow, std::memory_order_relaxed)) {
+        std::unique_lock<std::mutex> lLock{mDumpMutex};
+        if (mRunning) {
+            mDumpReason = aReason;
+            lLock.unlock();
+            mDumpCondition.notify_all();
+        } else {
+            lLock.unlock();
+            Dump(aReason);
+        }
+    }
+}
+
+void FlightRecorder::HandleDumpRequests()
+{
+    std::unique_lock<std::mutex> lLock{mDumpMutex};
+
+    while (mRunning) {
+        mDumpCondition.wait(lLock, [&] { return !mRunning || !mDumpReason.empty(); });
+
+        if (mRunning) {
+            std::string lReason{std::move(mDumpReason)};
+            mDumpReason.clear();
+
+            lLock.unlock();
+            Dump(lReason);
+            lLock.lock();
+        }
+    }
+}
+
+std::string FlightRecorder::Dump(std::string_view aReason)
+{
+    std::string              lReturn{};
+    std::vector<DumpedFrame> lFrames{};
+    std::vector<DumpedEvent> lEvents{};
+    nanoseconds              lNow{duration_cast<nanoseconds>(system_clock::now().time_since_epoch())};
+
+    mLastDump = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+
+    for (std::size_t lDirection = 0; lDirection < mFrames.size(); lDirection++) {
+        for (auto& lSlot : mFrames.at(lDirection)) {
+            Lock(lSlot);
+            if (lSlot.TimeStamp.count() > 0) {
+                lFrames.push_back({lSlot.TimeStamp,
+                                   static_cast<Direction>(lDirection),
+                                   lSlot.Length,
+                                   std::string(lSlot.Data.data(), lSlot.StoredLength)});
+            }
+            lSlot.Busy.store(false, std::memory_order_release);
+        }
+    }
+
+    for (auto& lSlot : mEvents) {
+        Lock(lSlot);
+        if (lSlot.TimeStamp.count() > 0) {
+            lEvents.push_back({lSlot.TimeStamp, lSlot.Level, std::string(lSlot.Text.data(), lSlot.Length)});
+        }
+        lSlot.Busy.store(false, std::memory_order_release);
+    }
+
+    // The rings wrap around, and both directions go in the same file.
+    std::sort(lFrames.begin(), lFrames.end(), [](const DumpedFrame& aFirst, const DumpedFrame& aSecond) {
+        return aFirst.TimeStamp < aSecond.TimeStamp;
+    });
+    std::sort(lEvents.begin(), lEvents.end(), [](const DumpedEvent& aFirst, const DumpedEvent& aSecond) {
+        return aFirst.TimeStamp < aSecond.TimeStamp;
+    });
+
+    std::ostringstream lPath{};
+    lPath << mSettings.Path << "_" << FormatTime(lNow, "%Y%m%d_%H%M%S") << "_" << std::setw(4) << std::setfill('0')
+          << mDumpCount.load();
+
+    std::error_code       lError{};
+    std::filesystem::path lParent{std::filesystem::path(lPath.str()).parent_path()};
+    if (!lParent.empty()) {
+        std::filesystem::create_directories(lParent, lError);
+    }
+
+    std::string lCapture{};
+    SessionRecorder::AppendFileHeader(lCapture);
+    for (auto& lFrame : lFrames) {
+        PCapNGWriter::AppendPacket(
+            lCapture, static_cast<uint32_t>(lFrame.FrameDirection), lFrame.TimeStamp, lFrame.Data, lFrame.Length);
+    }
+
+    std::ofstream lCaptureFile(lPath.str() + std::string(cExtension), std::ios::binary | std::ios::trunc);
+    std::ofstream lEventFile(lPath.str() + std::string(cEventExtension), std::ios::trunc);
+    lCaptureFile.write(lCapture.data(), lCapture.size());
+
+    for (auto& lEvent : lEvents) {
+        lEventFile << FormatTime(lEvent.TimeStamp, "%Y-%m-%d %H:%M:%S") << "." << std::setw(3) << std::setfill('0')
+                   << duration_cast<milliseconds>(lEvent.TimeStamp).count() % 1000 << ": "
+                   << Logger::cLevelTexts.at(static_cast<std::size_t>(lEvent.Level)) << ": " << lEvent.Text
+                   << std::endl;
+    }
+    lEventFile << FormatTime(lNow, "%Y-%m-%d %H:%M:%S") << ": Dumped " << lFrames.size() << " frames, reason: "
+               << aReason << std::endl;
+
+    if (lCaptureFile.good() && lEventFile.good()) {
+        lReturn = lPath.str() + std::string(cExtension);
+        mDumpCount++;
+        Logger::GetInstance().Log<Logger::Level::INFO>("Flight recorder dumped to {}, reason: {}", lReturn, aReason);
+    } else {
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Could not write flight recorder dump {}", lPath.str());
+    }
+
+    return lReturn;
+}
+
+uint64_t FlightRecorder::GetDumpCount() const
+{
+    return mDumpCount;
+}
@@ -1,16 +1,52 @@
 #include "../Includes/Logger.h"
 
+#include "../Includes/ThreadName.h"
 #include "../Includes/WindowModel.h"
 
 /* Copyright (c) 2020 [Rick de Bondt] - Logger.cpp */
 
-#include <chrono>
+#include <algorithm>
 #include <ctime>
-#include <iomanip>
 #include <iostream>
 
+using namespace std::chrono;
+
+Logger::RateLimit::RateLimit(nanoseconds aInterval, unsigned int aBurst) :
+    mInterval(aInterval), mBurstLength(aInterval * std::max(aBurst, 1U))
+{}
+
+bool Logger::RateLimit::Allow(uint64_t& aSuppressed)
+{
+    bool    lReturn{false};
+    int64_t lNow{duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count()};
+    int64_t lFullAt{mFullAt.load(std::memory_order_relaxed)};
+
+    // Like a generic cell rate algorithm: a message is allowed while the bucket does not run more than a burst ahead.
+    while (!lReturn && ((lFullAt - lNow + mInterval.count()) <= mBurstLength.count())) {
+        lReturn = mFullAt.compare_exchange_weak(
+            lFullAt, std::max(lFullAt, lNow) + mInterval.count(), std::memory_order_relaxed);
+    }
+
+    if (lReturn) {
+        aSuppressed = mSuppressed.exchange(0, std::memory_order_relaxed);
+    } else {
+        mSuppressed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return lReturn;
+}
+
+Logger::Logger() : mQueue(std::make_unique<Record[]>(cQueueSize))
+{
+    for (std::size_t lIndex = 0; lIndex < cQueueSize; lIndex++) {
+        mQueue[lIndex].Sequence.store(lIndex, std::memory_order_relaxed);
+    }
+}
+
 Logger::~Logger()
 {
+    Close();
+
     if (mLogOutputStream.is_open()) {
         mLogOutputStream.close();
     }
@@ -21,16 +57,58 @@ void Logger::Init(Level aLevel, bool aLogToDisk, const std::string& aFileName =
     SetLogLevel(aLevel);
     SetFileName(aFileName);
     SetLogToDisk(aLogToDisk);
+
+    if (mWriterThread == nullptr) {
+        mRunning      = true;
+        mWriterThread = std::make_shared<boost::thread>([this] {
+            ThreadName_Constants::SetCurrentThreadName("logger");
+            HandleQueue();
+        });
+    }
+}
+
+void Logger::Close()
+{
+    if (mWriterThread != nullptr) {
+        {
+            std::lock_guard<std::mutex> lLock{mWriterMutex};
+            mRunning = false;
+        }
+        mWriterCondition.notify_all();
+        mWriterThread->join();
+        mWriterThread = nullptr;
+
+        // Messages queued while the writer was stopping.
+        WriteQueue();
+        mFlushCondition.notify_all();
+    }
+}
+
+void Logger::Flush()
+{
+    uint64_t lTarget{mEnqueuePosition.load(std::memory_order_acquire)};
+
+    std::unique_lock<std::mutex> lLock{mWriterMutex};
+    mWriterCondition.notify_one();
+    mFlushCondition.wait(lLock, [&] {
+        return !mRunning || (mWrittenPosition.load(std::memory_order_acquire) >= lTarget);
+    });
+}
+
+uint64_t Logger::GetDroppedCount() const
+{
+    return mDropped.load(std::memory_order_relaxed);
 }
 
 void Logger::SetFileName(const std::string& aFileName)
 {
+    std::lock_guard<std::mutex> lLock{mOutputMutex};
     mFileName = aFileName;
 }
 
 Logger::Level Logger::GetLogLevel()
 {
-    return mLogLevel;
+    return mLogLevel.load(std::memory_order_relaxed);
 }
 
 std::string Logger::ConvertLogLevelToString(Logger::Level aLogLevel)
@@ -40,7 +118,8 @@ std::string Logger::ConvertLogLevelToString(Logger::Level aLogLevel)
 
 void Logger::SetLogLevel(Level aLevel)
 {
-    mLogLevel = aLevel;
+    mLogLevel.store(aLevel, std::memory_order_relaxed);
+    UpdateThreshold();
 }
 
 Logger::Level Logger::ConvertLogLevelStringToLevel(std::string_view aLevel)
@@ -58,6 +137,8 @@ Logger::Level Logger::ConvertLogLevelStringToLevel(std::string_view aLevel)
 
 void Logger::SetLogToDisk(bool aLoggingToDiskEnabled)
 {
+    std::lock_guard<std::mutex> lLock{mOutputMutex};
+
     if (aLoggingToDiskEnabled && !mLogOutputStream.is_open() && !mFileName.empty()) {
         mLogOutputStream.open(mFileName);
         if (mLogOutputStream.fail()) {
@@ -72,38 +153,234 @@ void Logger::SetLogToDisk(bool aLoggingToDiskEnabled)
 
 void Logger::SetLogToScreen(bool aLoggingToScreenEnabled)
 {
+    std::lock_guard<std::mutex> lLock{mOutputMutex};
     mLogToScreen = aLoggingToScreenEnabled;
 }
 
-#if defined(__GNUC__) || defined(__GNUG__)
-void Logger::Log(const std::string& aText, Level aLevel, const std::experimental::source_location& aLocation)
-#else
-void Logger::Log(const std::string& aText, Level aLevel)
-#endif
+void Logger::SetObserver(Observer aObserver, Level aLevel)
+{
+    {
+        std::lock_guard<std::mutex> lLock{mObserverMutex};
+        mObserver      = (aObserver != nullptr) ? std::make_shared<const Observer>(std::move(aObserver)) : nullptr;
+        mObserverLevel = aLevel;
+    }
+    UpdateThreshold();
+}
+
+void Logger::Submit(std::string_view aText, Level aLevel, const char* aFile, unsigned int aLine)
+{
+    std::shared_ptr<const Observer> lObserver{nullptr};
+    {
+        std::lock_guard<std::mutex> lLock{mObserverMutex};
+        if (aLevel >= mObserverLevel) {
+            lObserver = mObserver;
+        }
+    }
+
+    if (lObserver != nullptr) {
+        (*lObserver)(aText, aLevel);
+    }
+
+    if (aLevel >= mLogLevel.load(std::memory_order_relaxed)) {
+        if (mRunning.load(std::memory_order_acquire)) {
+            if (!Enqueue(aText, aLevel, aFile, aLine)) {
+                mDropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        } else {
+            std::string lLogEntry{};
+            FormatEntry(lLogEntry,
+                        aText,
+                        aLevel,
+                        duration_cast<nanoseconds>(system_clock::now().time_since_epoch()),
+                        aFile,
+                        aLine);
+            Write(lLogEntry);
+        }
+    }
+}
+
+void Logger::UpdateThreshold()
+{
+    Level lThreshold{mLogLevel.load(std::memory_order_relaxed)};
+
+    std::lock_guard<std::mutex> lLock{mObserverMutex};
+    if (mObserver != nullptr) {
+        lThreshold = std::min(lThreshold, mObserverLevel);
+    }
+
+    mThreshold.store(lThreshold, std::memory_order_relaxed);
+}
+
+std::size_t Logger::AppendUntilPlaceholder(std::string& aBuffer, std::string_view aFormat)
+{
+    std::size_t lReturn{std::string_view::npos};
+    std::size_t lIndex{0};
+
+    while ((lIndex < aFormat.size()) && (lReturn == std::string_view::npos)) {
+        std::size_t lBrace{aFormat.find_first_of("{}", lIndex)};
+        aBuffer.append(aFormat.substr(lIndex, lBrace - lIndex));
+
+        if (lBrace == std::string_view::npos) {
+            lIndex = aFormat.size();
+        } else if (aFormat.substr(lBrace, 2) == "{}") {
+            lReturn = lBrace + 2;
+        } else {
+            // "{{" and "}}" are a single brace, a lone brace is kept.
+            aBuffer += aFormat[lBrace];
+            lIndex = lBrace + ((aFormat.substr(lBrace + 1, 1) == aFormat.substr(lBrace, 1)) ? 2 : 1);
+        }
+    }
+
+    return lReturn;
+}
+
+bool Logger::Enqueue(std::string_view aText, Level aLevel, const char* aFile, unsigned int aLine)
 {
-    std::stringstream lLogEntry;
+    bool     lReturn{false};
+    uint64_t lPosition{mEnqueuePosition.load(std::memory_order_relaxed)};
+    Record*  lRecord{nullptr};
+
+    // A slot is free for position P when its sequence is P, and holds a message for P when it is P + 1.
+    while (lRecord == nullptr) {
+        Record&  lCandidate{mQueue[lPosition & (cQueueSize - 1)]};
+        uint64_t lSequence{lCandidate.Sequence.load(std::memory_order_acquire)};
+
+        if (lSequence == lPosition) {
+            if (mEnqueuePosition.compare_exchange_weak(lPosition, lPosition + 1, std::memory_order_relaxed)) {
+                lRecord = &lCandidate;
+            }
+        } else if (lSequence < lPosition) {
+            // Still holds the message from a lap ago, the queue is full.
+            break;
+        } else {
+            lPosition = mEnqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
 
-    if (aLevel >= mLogLevel) {
-        auto lTime        = std::chrono::system_clock::now();
-        auto lTimeAsTimeT = std::chrono::system_clock::to_time_t(lTime);
-        auto lTimeMs      = std::chrono::duration_cast<std::chrono::milliseconds>(lTime.time_since_epoch()) % 1000;
+    if (lRecord != nullptr) {
+        lRecord->RecordLevel = aLevel;
+        lRecord->TimeStamp   = duration_cast<nanoseconds>(system_clock::now().time_since_epoch());
+        lRecord->File        = aFile;
+        lRecord->Line        = aLine;
+        lRecord->Text.assign(aText);
+        lRecord->Sequence.store(lPosition + 1, std::memory_order_release);
 
-#if defined(__GNUC__) || defined(__GNUG__)
-        lLogEntry << std::put_time(std::gmtime(&lTimeAsTimeT), "%H:%M:%S:") << std::setfill('0') << std::setw(3)
-                  << lTimeMs.count() << ": " << cLevelTexts.at(static_cast<unsigned long>(aLevel)) << ": "
-                  << aLocation.file_name() << ":" << aLocation.line() << ":" << aText;
+        // Normally the writer wakes up by itself, only hurry it when the queue fills up or something went wrong.
+        if ((aLevel == Level::ERROR) ||
+            ((lPosition - mWrittenPosition.load(std::memory_order_relaxed)) >= (cQueueSize / 2))) {
+            mWriterCondition.notify_one();
+        }
+        lReturn = true;
+    }
+
+    return lReturn;
+}
+
+void Logger::FormatEntry(std::string&     aBuffer,
+                         std::string_view aText,
+                         Level            aLevel,
+                         nanoseconds      aTimeStamp,
+                         const char*      aFile,
+                         unsigned int     aLine)
+{
+    std::time_t          lTime{static_cast<std::time_t>(duration_cast<seconds>(aTimeStamp).count())};
+    auto                 lMilliseconds{duration_cast<milliseconds>(aTimeStamp).count() % 1000};
+    std::tm              lCalendar{};
+    std::array<char, 16> lClock{};
+
+#if defined(_MSC_VER) || defined(__MINGW32__)
+    gmtime_s(&lCalendar, &lTime);
 #else
-        lLogEntry << std::put_time(std::gmtime(&lTimeAsTimeT), "%H:%M:%S:") << std::setfill('0') << std::setw(3)
-                  << lTimeMs.count() << ": " << mLogLevelTexts.at(static_cast<unsigned long>(aLevel)) << ":" << aText;
+    gmtime_r(&lTime, &lCalendar);
 #endif
 
-        if (mLogToScreen) {
-            std::cout << lLogEntry.str() << std::endl;
-        }
+    aBuffer.append(lClock.data(), std::strftime(lClock.data(), lClock.size(), "%H:%M:%S:", &lCalendar));
+    aBuffer += static_cast<char>('0' + lMilliseconds / 100);
+    aBuffer += static_cast<char>('0' + (lMilliseconds / 10) % 10);
+    aBuffer += static_cast<char>('0' + lMilliseconds % 10);
+    aBuffer += ": ";
+    aBuffer += cLevelTexts.at(static_cast<unsigned long>(aLevel));
+    aBuffer += ":";
+
+    if (aFile != nullptr) {
+        aBuffer += " ";
+        aBuffer += aFile;
+        aBuffer += ":";
+        aBuffer += std::to_string(aLine);
+        aBuffer += ":";
+    }
+
+    aBuffer += aText;
+    aBuffer += '\n';
+}
 
-        // Save message to log file
-        if (mLogToDisk && mLogOutputStream.is_open()) {
-            mLogOutputStream << lLogEntry.str() << std::endl;
+bool Logger::WriteQueue()
+{
+    bool lReturn{false};
+
+    mWriteBuffer.clear();
+
+    for (std::size_t lCount = 0; lCount < cQueueSize; lCount++) {
+        Record& lRecord{mQueue[mDequeuePosition & (cQueueSize - 1)]};
+
+        if (lRecord.Sequence.load(std::memory_order_acquire) != (mDequeuePosition + 1)) {
+            break;
         }
+
+        FormatEntry(mWriteBuffer, lRecord.Text, lRecord.RecordLevel, lRecord.TimeStamp, lRecord.File, lRecord.Line);
+        lRecord.Sequence.store(mDequeuePosition + cQueueSize, std::memory_order_release);
+        mDequeuePosition++;
+    }
+
+    uint64_t lDropped{mDropped.load(std::memory_order_relaxed)};
+    if (lDropped != mDroppedReported) {
+        FormatEntry(mWriteBuffer,
+                    "Log queue full, dropped " + std::to_string(lDropped - mDroppedReported) + " messages",
+                    Level::WARNING,
+                    duration_cast<nanoseconds>(system_clock::now().time_since_epoch()),
+                    nullptr,
+                    0);
+        mDroppedReported = lDropped;
+    }
+
+    if (!mWriteBuffer.empty()) {
+        Write(mWriteBuffer);
+        lReturn = true;
+    }
+
+    mWrittenPosition.store(mDequeuePosition, std::memory_order_release);
+
+    return lReturn;
+}
+
+void Logger::Write(std::string_view aBuffer)
+{
+    std::lock_guard<std::mutex> lLock{mOutputMutex};
+
+    if (mLogToScreen) {
+        std::cout.write(aBuffer.data(), static_cast<std::streamsize>(aBuffer.size()));
+        std::cout.flush();
+    }
+
+    // Save message to log file
+    if (mLogToDisk && mLogOutputStream.is_open()) {
+        mLogOutputStream.write(aBuffer.data(), static_cast<std::streamsize>(aBuffer.size()));
+        mLogOutputStream.flush();
+    }
+}
+
+void Logger::HandleQueue()
+{
+    std::unique_lock<std::mutex> lLock{mWriterMutex};
+
+    while (mRunning) {
+        mWriterCondition.wait_for(lLock, cWriteInterval);
+
+        // Keeps going while messages come in faster than they are written.
+        lLock.unlock();
+        while (WriteQueue()) {}
+        lLock.lock();
+
+        mFlushCondition.notify_all();
     }
 }
@@ -0,0 +1,516 @@
+#include "../Includes/MappedPCapReader.h"
+
+/* Copyright (c) 2020 [Rick de Bondt] - MappedPCapReader.cpp */
+
+#include <algorithm>
+#include <cstring>
+
+#include <boost/endian/conversion.hpp>
+
+#include "../Includes/Logger.h"
+
+using namespace MappedPCapReader_Constants;
+namespace ipc = boost::interprocess;
+
+namespace
+{
+    constexpr uint64_t cNanoSecondsPerSecond{1000000000};
+    constexpr uint8_t  cBinaryResolution{0x80};
+    // Above this many fraction bits the nanosecond calculation would overflow, nanoseconds only need 30 anyway.
+    constexpr uint8_t cMaxFractionBits{30};
+    // Largest resolutions a timestamp of 64 bits can have, 10^-19 and 2^-63 seconds.
+    constexpr uint8_t cMaxDecimalResolution{19};
+    constexpr uint8_t cMaxBinaryResolution{63};
+
+    uint64_t PowerOfTen(unsigned int aExponent)
+    {
+        uint64_t lReturn{1};
+        for (unsigned int lCount = 0; lCount < aExponent; lCount++) {
+            lReturn *= 10;
+        }
+        return lReturn;
+    }
+}  // namespace
+
+bool MappedPCapReader::Open(std::string_view aName, uint16_t /*aFrequency*/)
+{
+    bool lReturn{false};
+
+    Close();
+
+    try {
+        mFile   = ipc::file_mapping(std::string(aName).c_str(), ipc::read_only);
+        mRegion = ipc::mapped_region(mFile, ipc::read_only);
+        mSize   = mRegion.get_size();
+
+        // Captures are mostly read front to back, let the kernel read ahead.
+        mRegion.advise(ipc::mapped_region::advice_sequential);
+
+        if (!ZstdCompressor::IsCompressedPath(aName)) {
+            mBegin = static_cast<const char*>(mRegion.get_address());
+            mEnd   = mSize;
+        } else if (mDecompressor.Open(std::string_view(static_cast<const char*>(mRegion.get_address()), mSize))) {
+            mCompressed = true;
+            mWindow.resize(cStreamWindowSize);
+            mBegin = mWindow.data();
+        }
+
+        if ((mBegin != nullptr) && Available(sizeof(uint32_t))) {
+            uint32_t lMagic{0};
+            memcpy(&lMagic, At(0), sizeof(lMagic));
+
+            if (lMagic == cSectionHeaderBlock) {
+                // The byte order gets read from the section header itself.
+                mFormat = Format::PCapNG;
+                lReturn = true;
+            } else {
+                lReturn = ReadPCapHeader();
+            }
+        }
+
+        if (!lReturn) {
+            Logger::GetInstance().Log<Logger::Level::WARNING>("Not a pcap or pcapng file: {}", aName);
+            Close();
+        }
+    } catch (const ipc::interprocess_exception& lException) {
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Could not map {}: {}", aName, lException.what());
+        Close();
+    }
+
+    return lReturn;
+}
+
+bool MappedPCapReader::Open(std::string_view aName, std::vector<std::string>& /*aSSIDFilter*/, uint16_t aFrequency)
+{
+    return Open(aName, aFrequency);
+}
+
+void MappedPCapReader::Close()
+{
+    mRegion        = ipc::mapped_region();
+    mFile          = ipc::file_mapping();
+    mBegin         = nullptr;
+    mBase          = 0;
+    mEnd           = 0;
+    mSize          = 0;
+    mCompressed    = false;
+    mWindow        = {};
+    mOffset        = 0;
+    mSwapped       = false;
+    mSectionNumber = 0;
+    mFormat        = Format::Unknown;
+    mFrame         = {};
+    mHeader        = {};
+    mInterfaces.clear();
+    mDecompressor.Close();
+}
+
+bool MappedPCapReader::ReadNextData()
+{
+    bool lReturn{false};
+
+    if (mBegin != nullptr) {
+        if (mFormat == Format::PCap) {
+            lReturn = ReadPCapRecord();
+        } else {
+            // Skip over blocks without frames, like statistics and name resolution.
+            bool lIsFrame{false};
+            while (!lIsFrame && ReadPCapNGBlock(lIsFrame)) {}
+            lReturn = lIsFrame;
+        }
+    } else {
+        Logger::GetInstance().Log<Logger::Level::DEBUG>("File not mapped before call");
+    }
+
+    return lReturn;
+}
+
+const Frame& MappedPCapReader::GetFrame() const
+{
+    return mFrame;
+}
+
+const unsigned char* MappedPCapReader::GetData()
+{
+    return reinterpret_cast<const unsigned char*>(mFrame.Data.data());
+}
+
+const pcap_pkthdr* MappedPCapReader::GetHeader()
+{
+    return mFrame.Data.data() != nullptr ? &mHeader : nullptr;
+}
+
+std::string MappedPCapReader::DataToString(const unsigned char* aData, const pcap_pkthdr* aHeader)
+{
+    std::string lReturn{};
+
+    if ((aData != nullptr) && (aHeader != nullptr)) {
+        lReturn.assign(reinterpret_cast<const char*>(aData), aHeader->caplen);
+    }
+
+    return lReturn;
+}
+
+std::string MappedPCapReader::LastDataToString()
+{
+    return std::string(mFrame.Data);
+}
+
+Format MappedPCapReader::GetFormat() const
+{
+    return mFormat;
+}
+
+const std::vector<Interface>& MappedPCapReader::GetInterfaces() const
+{
+    return mInterfaces;
+}
+
+uint64_t MappedPCapReader::GetOffset() const
+{
+    return mOffset;
+}
+
+bool MappedPCapReader::SetOffset(uint64_t aOffset)
+{
+    bool lReturn{false};
+
+    if ((mBegin != nullptr) && (aOffset >= mBase) && (aOffset <= mEnd)) {
+        mOffset = aOffset;
+        lReturn = true;
+    }
+
+    return lReturn;
+}
+
+bool MappedPCapReader::SetOffset(uint64_t aOffset, const Section& aSection)
+{
+    bool lReturn{SetOffset(aOffset)};
+
+    if (lReturn) {
+        mSectionNumber = aSection.Number;
+        mSwapped       = aSection.Swapped;
+        mInterfaces    = aSection.Interfaces;
+    }
+
+    return lReturn;
+}
+
+uint32_t MappedPCapReader::GetSectionNumber() const
+{
+    return mSectionNumber;
+}
+
+Section MappedPCapReader::GetSection() const
+{
+    return {mSectionNumber, mSwapped, mInterfaces};
+}
+
+uint64_t MappedPCapReader::GetSize() const
+{
+    return mSize;
+}
+
+bool MappedPCapReader::IsCompressed() const
+{
+    return mCompressed;
+}
+
+const char* MappedPCapReader::At(uint64_t aOffset) const
+{
+    return mBegin + (aOffset - mBase);
+}
+
+bool MappedPCapReader::Available(uint64_t aEnd)
+{
+    if (mCompressed && (aEnd > mEnd)) {
+        if (aEnd - mOffset > mWindow.size()) {
+            Logger::GetInstance().Log<Logger::Level::ERROR>("Block at offset {} does not fit in the window", mOffset);
+        } else {
+            if (aEnd > mBase + mWindow.size()) {
+                // Everything before the current record has been read, move the rest to the front to make room.
+                memmove(mWindow.data(), At(mOffset), mEnd - mOffset);
+                mBase = mOffset;
+            }
+
+            // Fill the window as far as possible, so decompression happens in large steps.
+            bool lProgress{true};
+            while (lProgress && (mEnd < aEnd) && !mDecompressor.IsFinished()) {
+                std::size_t lUsed{mEnd - mBase};
+                std::size_t lProduced{0};
+                lProgress = mDecompressor.Decompress(mWindow.data() + lUsed, mWindow.size() - lUsed, lProduced) &&
+                            (lProduced > 0);
+                mEnd += lProduced;
+            }
+        }
+    }
+
+    return aEnd <= mEnd;
+}
+
+uint16_t MappedPCapReader::Read16(uint64_t aOffset) const
+{
+    uint16_t lReturn{0};
+    memcpy(&lReturn, At(aOffset), sizeof(lReturn));
+    return mSwapped ? boost::endian::endian_reverse(lReturn) : lReturn;
+}
+
+uint32_t MappedPCapReader::Read32(uint64_t aOffset) const
+{
+    uint32_t lReturn{0};
+    memcpy(&lReturn, At(aOffset), sizeof(lReturn));
+    return mSwapped ? boost::endian::endian_reverse(lReturn) : lReturn;
+}
+
+bool MappedPCapReader::ReadPCapHeader()
+{
+    bool      lReturn{false};
+    uint32_t  lMagic{0};
+    Interface lInterface{};
+
+    if (Available(cPCapHeaderLength)) {
+        memcpy(&lMagic, At(0), sizeof(lMagic));
+        mSwapped = (lMagic == boost::endian::endian_reverse(cPCapMagic)) ||
+                   (lMagic == boost::endian::endian_reverse(cPCapNanoMagic));
+        if (mSwapped) {
+            lMagic = boost::endian::endian_reverse(lMagic);
+        }
+
+        if ((lMagic == cPCapMagic) || (lMagic == cPCapNanoMagic)) {
+            lInterface.TimeStampResolution = (lMagic == cPCapNanoMagic) ? 9 : cDefaultTimeStampResolution;
+            lInterface.SnapLength          = Read32(16);
+            // The upper bits of the link type field hold FCS information.
+            lInterface.LinkType = static_cast<uint16_t>(Read32(20) & 0xffff);
+            mInterfaces.emplace_back(lInterface);
+
+            mFormat = Format::PCap;
+            mOffset = cPCapHeaderLength;
+            lReturn = true;
+        }
+    }
+
+    return lReturn;
+}
+
+bool MappedPCapReader::ReadPCapRecord()
+{
+    bool lReturn{false};
+
+    if (Available(mOffset + cPCapRecordHeaderLength)) {
+        uint64_t lSeconds{Read32(mOffset)};
+        uint64_t lFraction{Read32(mOffset + 4)};
+        uint32_t lCapturedLength{Read32(mOffset + 8)};
+        uint32_t lLength{Read32(mOffset + 12)};
+        uint64_t lTimeStamp{lSeconds * PowerOfTen(mInterfaces.front().TimeStampResolution) + lFraction};
+
+        lReturn = SetFrame(mOffset, mOffset + cPCapRecordHeaderLength, lCapturedLength, lLength, 0, lTimeStamp);
+        if (lReturn) {
+            mOffset += cPCapRecordHeaderLength + lCapturedLength;
+        }
+    }
+
+    return lReturn;
+}
+
+bool MappedPCapReader::ReadPCapNGBlock(bool& aIsFrame)
+{
+    bool     lReturn{false};
+    uint64_t lOffset{mOffset};
+
+    aIsFrame = false;
+
+    if (Available(lOffset + cMinimumBlockLength)) {
+        // A section header reads the same in both byte orders and sets the byte order for the rest of the section.
+        uint32_t lType{Read32(lOffset)};
+        bool     lValidByteOrder{(lType != cSectionHeaderBlock) || ReadSectionHeader(lOffset)};
+        uint32_t lLength{Read32(lOffset + 4)};
+
+        if (lValidByteOrder && (lLength >= cMinimumBlockLength) && (lLength % 4 == 0) &&
+            Available(lOffset + lLength)) {
+            uint64_t lBody{lOffset + cBlockHeaderLength};
+            uint64_t lBodyEnd{lOffset + lLength - sizeof(uint32_t)};
+            lReturn = true;
+
+            switch (lType) {
+                case cSectionHeaderBlock:
+                    // Interface ids start over in every section.
+                    if (lOffset > 0) {
+                        mSectionNumber++;
+                    }
+                    mInterfaces.clear();
+                    break;
+                case cInterfaceDescriptionBlock:
+                    ReadInterfaceDescription(lBody, lBodyEnd);
+                    break;
+                case cEnhancedPacketBlock:
+                case cPacketBlock:
+                    if (lBody + 20 <= lBodyEnd) {
+                        // The obsolete packet block has a 16 bit interface id followed by a drop counter.
+                        uint32_t lInterface{lType == cEnhancedPacketBlock ? Read32(lBody) : Read16(lBody)};
+                        uint64_t lTimeStamp{(static_cast<uint64_t>(Read32(lBody + 4)) << 32) | Read32(lBody + 8)};
+                        uint32_t lCapturedLength{Read32(lBody + 12)};
+                        uint32_t lLength{Read32(lBody + 16)};
+
+                        lReturn  = (lBody + 20 + lCapturedLength <= lBodyEnd) &&
+                                  SetFrame(lOffset, lBody + 20, lCapturedLength, lLength, lInterface, lTimeStamp);
+                        aIsFrame = lReturn;
+                    }
+                    break;
+                case cSimplePacketBlock:
+                    if ((lBody + 4 <= lBodyEnd) && !mInterfaces.empty()) {
+                        // Simple packet blocks do not store the captured length, it follows from the snap length.
+                        uint32_t lLength{Read32(lBody)};
+                        uint32_t lCapturedLength{
+                            static_cast<uint32_t>(std::min<uint64_t>(lLength, lBodyEnd - (lBody + 4)))};
+                        if (mInterfaces.front().SnapLength > 0) {
+                            lCapturedLength = std::min(lCapturedLength, mInterfaces.front().SnapLength);
+                        }
+
+                        lReturn  = SetFrame(lOffset, lBody + 4, lCapturedLength, lLength, 0, 0);
+                        aIsFrame = lReturn;
+                    }
+                    break;
+                default:
+                    // Nothing else is needed to get frames out.
+                    break;
+            }
+
+            if (lReturn) {
+                mOffset = lOffset + lLength;
+            }
+        }
+
+        if (!lReturn) {
+            Logger::GetInstance().Log<Logger::Level::ERROR>("Malformed pcapng block at offset {}", lOffset);
+        }
+    }
+
+    return lReturn;
+}
+
+bool MappedPCapReader::ReadSectionHeader(uint64_t aBlockOffset)
+{
+    bool     lReturn{true};
+    uint32_t lByteOrderMagic{0};
+    memcpy(&lByteOrderMagic, At(aBlockOffset + cBlockHeaderLength), sizeof(lByteOrderMagic));
+
+    if (lByteOrderMagic == cByteOrderMagic) {
+        mSwapped = false;
+    } else if (lByteOrderMagic == boost::endian::endian_reverse(cByteOrderMagic)) {
+        mSwapped = true;
+    } else {
+        lReturn = false;
+    }
+
+    return lReturn;
+}
+
+void MappedPCapReader::ReadInterfaceDescription(uint64_t aBodyOffset, uint64_t aBodyEnd)
+{
+    Interface lInterface{};
+
+    if (aBodyOffset + 8 <= aBodyEnd) {
+        lInterface.LinkType   = Read16(aBodyOffset);
+        lInterface.SnapLength = Read32(aBodyOffset + 4);
+
+        uint64_t lOption{aBodyOffset + 8};
+        while (lOption + 4 <= aBodyEnd) {
+            uint16_t lCode{Read16(lOption)};
+            uint16_t lLength{Read16(lOption + 2)};
+
+            if (lCode == cOptionEnd) {
+                break;
+            }
+
+            if ((lCode == cOptionTimeStampResolution) && (lLength >= 1) && (lOption + 4 < aBodyEnd)) {
+                auto lResolution{static_cast<uint8_t>(*At(lOption + 4))};
+                bool lBinary{(lResolution & cBinaryResolution) != 0};
+
+                if ((lBinary && ((lResolution & static_cast<uint8_t>(~cBinaryResolution)) <= cMaxBinaryResolution)) ||
+                    (!lBinary && (lResolution <= cMaxDecimalResolution))) {
+                    lInterface.TimeStampResolution = lResolution;
+                } else {
+                    Logger::GetInstance().Log<Logger::Level::WARNING>(
+                        "Invalid timestamp resolution {} at offset {}, using the default", lResolution, lOption);
+                }
+            }
+
+            // Options are padded to 32 bits.
+            lOption += 4 + ((lLength + 3U) & ~3U);
+        }
+    }
+
+    mInterfaces.emplace_back(lInterface);
+}
+
+bool MappedPCapReader::SetFrame(uint64_t aRecordOffset,
+                                uint64_t aDataOffset,
+                                uint32_t aCapturedLength,
+                                uint32_t aLength,
+                                uint32_t aInterface,
+                                uint64_t aTimeStamp)
+{
+    bool lReturn{false};
+
+    if (Available(aDataOffset + aCapturedLength) && (aInterface < mInterfaces.size())) {
+        mFrame.Data      = std::string_view(At(aDataOffset), aCapturedLength);
+        mFrame.Length    = aLength;
+        mFrame.TimeStamp = ConvertTimeStamp(aTimeStamp, aInterface);
+        mFrame.Interface = aInterface;
+        mFrame.Offset    = aRecordOffset;
+
+        // Keep a libpcap style header around for users of the IPCapDevice interface.
+        auto lNanoSeconds{static_cast<uint64_t>(mFrame.TimeStamp.count())};
+        mHeader.caplen     = aCapturedLength;
+        mHeader.len        = aLength;
+        mHeader.ts.tv_sec  = static_cast<decltype(mHeader.ts.tv_sec)>(lNanoSeconds / cNanoSecondsPerSecond);
+        mHeader.ts.tv_usec = static_cast<decltype(mHeader.ts.tv_usec)>((lNanoSeconds % cNanoSecondsPerSecond) / 1000);
+        lReturn            = true;
+    } else {
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Frame at offset {} is out of bounds", aRecordOffset);
+    }
+
+    return lReturn;
+}
+
+std::chrono::nanoseconds MappedPCapReader::ConvertTimeStamp(uint64_t aTimeStamp, uint32_t aInterface) const
+{
+    uint8_t  lResolution{mInterfaces.at(aInterface).TimeStampResolution};
+    uint64_t lReturn{0};
+
+    if ((lResolution & cBinaryResolution) != 0) {
+        // Resolution is 2^-n seconds.
+        unsigned int lBits{static_cast<unsigned int>(lResolution & static_cast<uint8_t>(~cBinaryResolution))};
+        uint64_t     lSeconds{lBits < 64 ? aTimeStamp >> lBits : 0};
+        uint64_t     lFraction{lBits < 64 ? aTimeStamp & ((uint64_t{1} << lBits) - 1) : aTimeStamp};
+
+        if (lBits > cMaxFractionBits) {
+            lFraction >>= (lBits - cMaxFractionBits);
+            lBits = cMaxFractionBits;
+        }
+        lReturn = lSeconds * cNanoSecondsPerSecond + ((lFraction * cNanoSecondsPerSecond) >> lBits);
+    } else if (lResolution <= 9) {
+        // Resolution is 10^-n seconds.
+        lReturn = aTimeStamp * PowerOfTen(9 - lResolution);
+    } else {
+        lReturn = aTimeStamp / PowerOfTen(lResolution - 9);
+    }
+
+    return std::chrono::nanoseconds(lReturn);
+}
+
+bool MappedPCapReader::Send(std::string_view /*aData*/)
+{
+    return false;
+}
+
+bool MappedPCapReader::Send(std::string_view /*aData*/,
+                            IPCapDevice_Constants::WiFiBeaconInformation& /*aWiFiInformation*/)
+{
+    return false;
+}
+
+void MappedPCapReader::SetSendReceiveDevice(std::shared_ptr<ISendReceiveDevice> aDevice)
+{
+    mSendReceiveDevice = aDevice;
+}
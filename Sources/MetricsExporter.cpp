@@ -0,0 +1,259 @@
+#include "../Includes/MetricsExporter.h"
+
+/* Copyright (c) 2020 [Rick de Bondt] - MetricsExporter.cpp */
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#endif
+
+#include "../Includes/Logger.h"
+#include "../Includes/ThreadName.h"
+
+using namespace MetricsExporter_Constants;
+using namespace Statistics_Constants;
+using boost::asio::ip::tcp;
+
+/**
+ * A scraper connected over HTTP, gets one response and is closed.
+ */
+class MetricsExporter::Connection : public std::enable_shared_from_this<MetricsExporter::Connection>
+{
+public:
+    explicit Connection(boost::asio::io_service& aIoService) : mSocket{aIoService}, mBuffer{cMaxRequestLength} {}
+
+    void Start()
+    {
+        boost::asio::async_read_until(mSocket,
+                                      mBuffer,
+                                      "\r\n\r\n",
+                                      [lThis = shared_from_this()](const boost::system::error_code& aError,
+                                                                   std::size_t) { lThis->HandleRequest(aError); });
+    }
+
+    tcp::socket mSocket;
+
+private:
+    void HandleRequest(const boost::system::error_code& aError)
+    {
+        if (!aError) {
+            std::istream lStream{&mBuffer};
+            std::string  lMethod{};
+            std::string  lTarget{};
+            lStream >> lMethod >> lTarget;
+
+            if (lMethod == "GET" && (lTarget == cPath || lTarget == "/")) {
+                mResponse = BuildResponse("200 OK", cContentType, Format(Statistics::GetInstance().GetSnapshot()));
+            } else {
+                mResponse = BuildResponse("404 Not Found", "text/plain", "Metrics are at /metrics\n");
+            }
+        } else {
+            mResponse = BuildResponse("400 Bad Request", "text/plain", "");
+        }
+
+        boost::asio::async_write(
+            mSocket, boost::asio::buffer(mResponse), [lThis = shared_from_this()](const auto&, std::size_t) {
+                boost::system::error_code lError{};
+                lThis->mSocket.shutdown(tcp::socket::shutdown_both, lError);
+                lThis->mSocket.close(lError);
+            });
+    }
+
+    static std::string BuildResponse(std::string_view aStatus, std::string_view aContentType, std::string_view aBody)
+    {
+        std::ostringstream lReturn{};
+        lReturn << "HTTP/1.0 " << aStatus << "\r\nContent-Type: " << aContentType
+                << "\r\nContent-Length: " << aBody.size() << "\r\nConnection: close\r\n\r\n"
+                << aBody;
+        return lReturn.str();
+    }
+
+    boost::asio::streambuf mBuffer;
+    std::string            mResponse{};
+};
+
+MetricsExporter::~MetricsExporter()
+{
+    Close();
+}
+
+bool MetricsExporter::Listen(unsigned short aPort)
+{
+    bool lReturn{false};
+
+    try {
+        // Only reachable from this machine, the metrics are not meant for the network.
+        mAcceptor = std::make_shared<tcp::acceptor>(
+            *mIoService, tcp::endpoint(boost::asio::ip::address_v4::loopback(), aPort));
+        lReturn = true;
+    } catch (const boost::system::system_error& lException) {
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Could not listen for metrics scrapes: {}", lException.what());
+        mAcceptor = nullptr;
+    }
+
+    return lReturn;
+}
+
+unsigned short MetricsExporter::GetPort() const
+{
+    return mAcceptor != nullptr ? mAcceptor->local_endpoint().port() : 0;
+}
+
+void MetricsExporter::SetTextFile(std::string_view aPath, std::chrono::seconds aInterval)
+{
+    mTextFilePath = aPath;
+    mInterval     = std::max(aInterval, std::chrono::seconds(1));
+}
+
+bool MetricsExporter::StartThread()
+{
+    bool lReturn{false};
+
+    if ((mAcceptor != nullptr || !mTextFilePath.empty()) && mThread == nullptr) {
+        mIoService->restart();
+
+        if (mAcceptor != nullptr) {
+            Accept();
+        }
+
+        if (!mTextFilePath.empty()) {
+            mTimer = std::make_shared<boost::asio::steady_timer>(*mIoService);
+            mIoService->post([this] { WriteTextFile(); });
+        }
+
+        mThread = std::make_shared<boost::thread>([&] {
+            ThreadName_Constants::SetCurrentThreadName("metrics");
+#if defined(__linux__)
+            // Per thread on Linux only, other systems would slow down the bridge along with the exporter.
+            setpriority(PRIO_PROCESS, 0, cNiceness);
+#endif
+            mIoService->run();
+        });
+        lReturn = true;
+    }
+
+    return lReturn;
+}
+
+void MetricsExporter::Close()
+{
+    if (mThread != nullptr) {
+        mIoService->stop();
+        mThread->join();
+        mThread = nullptr;
+    }
+
+    if (mAcceptor != nullptr) {
+        boost::system::error_code lError{};
+        mAcceptor->close(lError);
+        mAcceptor = nullptr;
+    }
+    mTimer = nullptr;
+}
+
+void MetricsExporter::Accept()
+{
+    auto lConnection{std::make_shared<Connection>(*mIoService)};
+
+    mAcceptor->async_accept(lConnection->mSocket, [this, lConnection](const boost::system::error_code& aError) {
+        if (!aError) {
+            lConnection->Start();
+        }
+
+        if (aError != boost::asio::error::operation_aborted) {
+            Accept();
+        }
+    });
+}
+
+void MetricsExporter::WriteTextFile()
+{
+    if (!WriteFileAtomically(mTextFilePath, Format(Statistics::GetInstance().GetSnapshot()))) {
+        Logger::GetInstance().Log<Logger::Level::WARNING>("Could not write metrics to {}", mTextFilePath);
+    }
+
+    mTimer->expires_after(mInterval);
+    mTimer->async_wait([this](const boost::system::error_code& aError) {
+        if (!aError) {
+            WriteTextFile();
+        }
+    });
+}
+
+std::string MetricsExporter::Format(const Snapshot& aSnapshot)
+{
+    std::ostringstream lReturn{};
+    lReturn << std::setprecision(cPrecision);
+
+    for (const auto& lMetric : cCounterMetrics) {
+        std::string lName{std::string(cPrefix) + std::string(lMetric.Name)};
+        lReturn << "# HELP " << lName << " " << lMetric.Help << "\n# TYPE " << lName << " counter\n";
+
+        for (std::size_t lIndex = 0; lIndex < lMetric.CounterCount; lIndex++) {
+            const LabeledCounter& lCounter{lMetric.Counters.at(lIndex)};
+            lReturn << lName;
+            if (!lMetric.LabelName.empty()) {
+                lReturn << "{" << lMetric.LabelName << "=\"" << lCounter.Label << "\"}";
+            }
+            lReturn << " " << aSnapshot.Get(lCounter.Counter) << "\n";
+        }
+    }
+
+    std::string lName{std::string(cPrefix) + "latency_seconds"};
+    lReturn << "# HELP " << lName << " Time frames spend in the bridge, by path.\n# TYPE " << lName << " histogram\n";
+
+    for (std::size_t lIndex = 0; lIndex < cLatencyCount; lIndex++) {
+        const LatencyHistogram& lHistogram{aSnapshot.Latencies.at(lIndex)};
+        std::string             lLabel{"path=\"" + std::string(cLatencyNames.at(lIndex)) + "\""};
+        uint64_t                lCumulative{0};
+        std::size_t             lBucket{0};
+
+        // Every bucket of the statistics below 2^bits nanoseconds holds only latencies below that. Except for the last
+        // one, which also holds everything longer, so it is only counted in +Inf.
+        for (unsigned int lBits = cFirstLatencyBucketBits; lBits <= cLatencyBits; lBits++) {
+            std::size_t lEnd{std::min(Histogram_Constants::GetBucket(uint64_t{1} << lBits), cLatencyBuckets - 1)};
+            for (; lBucket < lEnd; lBucket++) {
+                lCumulative += lHistogram.Buckets.at(lBucket);
+            }
+            lReturn << lName << "_bucket{" << lLabel << ",le=\""
+                    << static_cast<double>(uint64_t{1} << lBits) / 1000000000.0 << "\"} " << lCumulative << "\n";
+        }
+
+        lReturn << lName << "_bucket{" << lLabel << ",le=\"+Inf\"} " << lHistogram.Count << "\n";
+        lReturn << lName << "_sum{" << lLabel << "} "
+                << std::chrono::duration<double>(lHistogram.Sum).count() << "\n";
+        lReturn << lName << "_count{" << lLabel << "} " << lHistogram.Count << "\n";
+    }
+
+    return lReturn.str();
+}
+
+bool MetricsExporter::WriteFileAtomically(const std::string& aPath, std::string_view aText)
+{
+    bool          lReturn{false};
+    std::string   lTemporaryPath{aPath + ".tmp"};
+    std::ofstream lFile{lTemporaryPath, std::ios::binary | std::ios::trunc};
+
+    if (lFile.is_open()) {
+        lFile.write(aText.data(), static_cast<std::streamsize>(aText.size()));
+        lFile.close();
+
+        // A rename within the same directory replaces the file in one go.
+        std::error_code lError{};
+        if (lFile.good()) {
+            std::filesystem::rename(lTemporaryPath, aPath, lError);
+            lReturn = !lError;
+        }
+
+        if (!lReturn) {
+            std::filesystem::remove(lTemporaryPath, lError);
+        }
+    }
+
+    return lReturn;
+}
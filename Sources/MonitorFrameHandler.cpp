@@ -0,0 +1,151 @@
+#include "../Includes/MonitorFrameHandler.h"
+
+/* Copyright (c) 2020 [Rick de Bondt] - MonitorFrameHandler.cpp */
+
+#include "../Includes/Logger.h"
+#include "../Includes/Statistics.h"
+
+using namespace MonitorFrameHandler_Constants;
+using namespace Statistics_Constants;
+
+FrameType MonitorFrameHandler::Classify(std::string_view aData)
+{
+    FrameType   lReturn{FrameType::Other};
+    Statistics& lStatistics{Statistics::GetInstance()};
+    lStatistics.Add(Counter::FramesCaptured);
+
+    // Load information about this packet into the packet converter
+    mConverter.Update(aData);
+
+    if (mConverter.Is80211Beacon(aData)) {
+        // Try to match SSID to filter list
+        std::string lSSID = mConverter.GetBeaconSSID(aData);
+        bool        lMatched{false};
+        lStatistics.Add(Counter::BeaconFrames);
+        lReturn = FrameType::Beacon;
+
+        for (auto& lFilter : mSSIDFilter) {
+            if (lSSID.find(lFilter) != std::string::npos) {
+                lMatched = true;
+                std::lock_guard<std::mutex> lLock{mWifiInformationMutex};
+                if (lSSID != mWifiInformation.SSID) {
+                    uint64_t lBSSID{mWifiInformation.BSSID};
+                    mConverter.FillWiFiInformation(aData, mWifiInformation);
+                    if (mWifiInformation.BSSID != lBSSID) {
+                        lStatistics.Add(Counter::BSSIDSwitches);
+                    }
+                    Logger::GetInstance().Log<Logger::Level::DEBUG>("SSID switched:{}", lSSID);
+                }
+            }
+        }
+
+        if (!lMatched) {
+            lStatistics.Add(Counter::FilteredSSID);
+        }
+    } else if (mConverter.Is80211Data(aData)) {
+        uint64_t lBSSID{0};
+        {
+            std::lock_guard<std::mutex> lLock{mWifiInformationMutex};
+            lBSSID = mWifiInformation.BSSID;
+        }
+
+        lStatistics.Add(Counter::DataFrames);
+        if (!mConverter.IsForBSSID(aData, lBSSID)) {
+            lStatistics.Add(Counter::FilteredBSSID);
+            lReturn = FrameType::FilteredData;
+        } else if (mSourceMACToFilter != 0 && !mConverter.IsFromMac(aData, mSourceMACToFilter)) {
+            lStatistics.Add(Counter::FilteredMAC);
+            lReturn = FrameType::FilteredData;
+        } else {
+            lReturn = FrameType::Data;
+        }
+    } else {
+        lStatistics.Add(Counter::OtherFrames);
+    }
+
+    return lReturn;
+}
+
+bool MonitorFrameHandler::Forward(std::string_view aData, std::chrono::system_clock::time_point aCaptured)
+{
+    bool        lReturn{false};
+    Statistics& lStatistics{Statistics::GetInstance()};
+
+    if ((mSendReceiveDevice != nullptr) && !mConverter.Is80211QOSRetry(aData)) {
+        std::string lConvertedData = mConverter.ConvertPacketTo8023(aData);
+        if (!lConvertedData.empty()) {
+            lStatistics.Add(Counter::Converted);
+            if (mSendReceiveDevice->Send(lConvertedData, aCaptured)) {
+                lStatistics.Add(Counter::ForwardedToXLinkKai);
+                lStatistics.Add(Counter::BytesToXLinkKai, lConvertedData.size());
+                lReturn = true;
+            }
+
+            if (mFlightRecorder != nullptr) {
+                mFlightRecorder->Record(SessionRecorder_Constants::Direction::ToXLinkKai, lConvertedData);
+            }
+
+            if (mSessionRecorder != nullptr) {
+                mSessionRecorder->Record(SessionRecorder_Constants::Direction::ToXLinkKai, std::move(lConvertedData));
+            }
+        } else {
+            lStatistics.Add(Counter::ConversionFailures);
+        }
+    }
+
+    return lReturn;
+}
+
+PacketConverter& MonitorFrameHandler::GetConverter()
+{
+    return mConverter;
+}
+
+IPCapDevice_Constants::WiFiBeaconInformation MonitorFrameHandler::GetWifiInformation()
+{
+    std::lock_guard<std::mutex> lLock{mWifiInformationMutex};
+    return mWifiInformation;
+}
+
+void MonitorFrameHandler::SetSSIDFilter(std::vector<std::string> aSSIDFilter)
+{
+    mSSIDFilter = std::move(aSSIDFilter);
+}
+
+void MonitorFrameHandler::SetSourceMACToFilter(uint64_t aMac)
+{
+    mSourceMACToFilter = aMac;
+}
+
+void MonitorFrameHandler::SetSSID(std::string_view aSSID)
+{
+    std::lock_guard<std::mutex> lLock{mWifiInformationMutex};
+    mWifiInformation.SSID = aSSID;
+}
+
+void MonitorFrameHandler::SetBSSID(uint64_t aBSSID)
+{
+    std::lock_guard<std::mutex> lLock{mWifiInformationMutex};
+    mWifiInformation.BSSID = aBSSID;
+}
+
+void MonitorFrameHandler::SetFrequency(uint16_t aFrequency)
+{
+    std::lock_guard<std::mutex> lLock{mWifiInformationMutex};
+    mWifiInformation.Frequency = aFrequency;
+}
+
+void MonitorFrameHandler::SetSendReceiveDevice(std::shared_ptr<ISendReceiveDevice> aDevice)
+{
+    mSendReceiveDevice = std::move(aDevice);
+}
+
+void MonitorFrameHandler::SetSessionRecorder(std::shared_ptr<SessionRecorder> aRecorder)
+{
+    mSessionRecorder = std::move(aRecorder);
+}
+
+void MonitorFrameHandler::SetFlightRecorder(std::shared_ptr<FlightRecorder> aRecorder)
+{
+    mFlightRecorder = std::move(aRecorder);
+}
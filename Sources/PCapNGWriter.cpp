@@ -0,0 +1,94 @@
+#include "../Includes/PCapNGWriter.h"
+
+/* Copyright (c) 2020 [Rick de Bondt] - PCapNGWriter.cpp */
+
+#include <cstring>
+
+#include "../Includes/MappedPCapReader.h"
+
+using namespace PCapNGWriter_Constants;
+using namespace MappedPCapReader_Constants;
+
+namespace
+{
+    template<typename Type> void Append(std::string& aBuffer, Type aValue)
+    {
+        aBuffer.append(reinterpret_cast<const char*>(&aValue), sizeof(aValue));
+    }
+
+    // Blocks and options are padded to 32 bits.
+    void AppendPadding(std::string& aBuffer, std::size_t aLength)
+    {
+        aBuffer.append((4 - (aLength % 4)) % 4, '\0');
+    }
+
+    void AppendOption(std::string& aBuffer, uint16_t aCode, std::string_view aValue)
+    {
+        Append<uint16_t>(aBuffer, aCode);
+        Append<uint16_t>(aBuffer, static_cast<uint16_t>(aValue.size()));
+        aBuffer.append(aValue);
+        AppendPadding(aBuffer, aValue.size());
+    }
+
+    std::size_t StartBlock(std::string& aBuffer, uint32_t aType)
+    {
+        std::size_t lStart{aBuffer.size()};
+        Append<uint32_t>(aBuffer, aType);
+        Append<uint32_t>(aBuffer, 0);
+        return lStart;
+    }
+
+    // The block length is known after the body has been written, so it gets filled in at the end.
+    void FinishBlock(std::string& aBuffer, std::size_t aBlockStart)
+    {
+        auto lLength{static_cast<uint32_t>(aBuffer.size() - aBlockStart + sizeof(uint32_t))};
+        memcpy(aBuffer.data() + aBlockStart + sizeof(uint32_t), &lLength, sizeof(lLength));
+        Append<uint32_t>(aBuffer, lLength);
+    }
+}  // namespace
+
+void PCapNGWriter::AppendSectionHeader(std::string& aBuffer)
+{
+    std::size_t lStart{StartBlock(aBuffer, cSectionHeaderBlock)};
+    Append<uint32_t>(aBuffer, cByteOrderMagic);
+    Append<uint16_t>(aBuffer, cVersionMajor);
+    Append<uint16_t>(aBuffer, cVersionMinor);
+    Append<int64_t>(aBuffer, cUnknownSectionLength);
+    FinishBlock(aBuffer, lStart);
+}
+
+void PCapNGWriter::AppendInterface(std::string&     aBuffer,
+                                   uint16_t         aLinkType,
+                                   uint32_t         aSnapLength,
+                                   std::string_view aName)
+{
+    std::size_t lStart{StartBlock(aBuffer, cInterfaceDescriptionBlock)};
+    Append<uint16_t>(aBuffer, aLinkType);
+    Append<uint16_t>(aBuffer, 0);
+    Append<uint32_t>(aBuffer, aSnapLength);
+    AppendOption(aBuffer, cOptionInterfaceName, aName);
+    AppendOption(aBuffer,
+                 cOptionTimeStampResolution,
+                 std::string_view(reinterpret_cast<const char*>(&cNanosecondResolution), 1));
+    Append<uint32_t>(aBuffer, cOptionEnd);
+    FinishBlock(aBuffer, lStart);
+}
+
+void PCapNGWriter::AppendPacket(std::string&             aBuffer,
+                                uint32_t                 aInterface,
+                                std::chrono::nanoseconds aTimeStamp,
+                                std::string_view         aData,
+                                uint32_t                 aOriginalLength)
+{
+    auto        lTimeStamp{static_cast<uint64_t>(aTimeStamp.count())};
+    std::size_t lStart{StartBlock(aBuffer, cEnhancedPacketBlock)};
+
+    Append<uint32_t>(aBuffer, aInterface);
+    Append<uint32_t>(aBuffer, static_cast<uint32_t>(lTimeStamp >> 32U));
+    Append<uint32_t>(aBuffer, static_cast<uint32_t>(lTimeStamp));
+    Append<uint32_t>(aBuffer, static_cast<uint32_t>(aData.size()));
+    Append<uint32_t>(aBuffer, aOriginalLength);
+    aBuffer.append(aData);
+    AppendPadding(aBuffer, aData.size());
+    FinishBlock(aBuffer, lStart);
+}
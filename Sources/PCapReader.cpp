@@ -2,24 +2,32 @@
 
 /* Copyright (c) 2020 [Rick de Bondt] - PCapReader.cpp */
 
+#include <algorithm>
 #include <chrono>
 #include <functional>
 #include <iomanip>
 #include <iostream>
 #include <string>
+#include <thread>
 
 #include "../Includes/Logger.h"
 using namespace std::chrono;
+using namespace PCapReader_Constants;
 
 bool PCapReader::Open(std::string_view aName, uint16_t aFrequency)
 {
-    bool                               lReturn{true};
-    std::array<char, PCAP_ERRBUF_SIZE> lErrorBuffer{};
-    mHandler = pcap_open_offline(aName.data(), lErrorBuffer.data());
-    if (mHandler == nullptr) {
-        lReturn = false;
-        Logger::GetInstance().Log("pcap_open_offline failed, " + std::string(lErrorBuffer.data()),
-                                  Logger::Level::ERROR);
+    bool lReturn{true};
+    mMapped      = mMappedReader.Open(aName, aFrequency);
+    mFileName    = aName;
+    mIndexLoaded = false;
+
+    if (!mMapped) {
+        std::array<char, PCAP_ERRBUF_SIZE> lErrorBuffer{};
+        mHandler = pcap_open_offline(aName.data(), lErrorBuffer.data());
+        if (mHandler == nullptr) {
+            lReturn = false;
+            Logger::GetInstance().Log<Logger::Level::ERROR>("pcap_open_offline failed, {}", lErrorBuffer.data());
+        }
     }
     mWifiInformation.Frequency = aFrequency;
 
@@ -36,41 +44,52 @@ bool PCapReader::Open(std::string_view aName, std::vector<std::string>& aSSIDFil
 
 void PCapReader::Close()
 {
-    pcap_close(mHandler);
+    if (mMapped) {
+        mMappedReader.Close();
+        mMapped = false;
+    } else if (mHandler != nullptr) {
+        pcap_close(mHandler);
+        mHandler = nullptr;
+    }
     mData   = nullptr;
     mHeader = nullptr;
 }
 
 bool PCapReader::ReadNextData()
 {
-    bool lReturn = true;
+    bool lReturn = false;
 
-    if (mHandler != nullptr) {
-        if (pcap_next_ex(mHandler, &mHeader, &mData) >= 0) {
-            ++mPacketCount;
-            Logger::GetInstance().Log("Packet # " + std::to_string(mPacketCount), Logger::Level::TRACE);
-
-            // Show the size in bytes of the packet
-            Logger::GetInstance().Log("Packet size: " + std::to_string(mHeader->len) + " bytes", Logger::Level::TRACE);
+    if (mMapped) {
+        if (mMappedReader.ReadNextData()) {
+            mData   = mMappedReader.GetData();
+            mHeader = mMappedReader.GetHeader();
+            lReturn = true;
+        }
+    } else if (mHandler != nullptr) {
+        pcap_pkthdr* lHeader{nullptr};
+        if (pcap_next_ex(mHandler, &lHeader, &mData) >= 0) {
+            mHeader = lHeader;
+            lReturn = true;
+        }
+    } else {
+        Logger::GetInstance().Log<Logger::Level::DEBUG>("Handler not initialized before call");
+    }
 
+    if (lReturn) {
+        ++mPacketCount;
+        Logger::GetInstance().Log<Logger::Level::TRACE>("Packet # {}", mPacketCount);
 
-            // Show a warning if the length captured is different
-            if (mHeader->len != mHeader->caplen) {
-                Logger::GetInstance().Log(
-                    "Capture size different than packet size:" + std::to_string(mHeader->len) + " bytes",
-                    Logger::Level::WARNING);
-            }
+        // Show the size in bytes of the packet
+        Logger::GetInstance().Log<Logger::Level::TRACE>("Packet size: {} bytes", mHeader->len);
 
-            // Show Epoch Time
-            Logger::GetInstance().Log(
-                "Epoch time: " + std::to_string(mHeader->ts.tv_sec) + ":" + std::to_string(mHeader->ts.tv_usec),
-                Logger::Level::TRACE);
-        } else {
-            lReturn = false;
+        // Show a warning if the length captured is different
+        if (mHeader->len != mHeader->caplen) {
+            Logger::GetInstance().Log<Logger::Level::WARNING>("Capture size different than packet size:{} bytes",
+                                                              mHeader->len);
         }
-    } else {
-        Logger::GetInstance().Log("Handler not initialized before call", Logger::Level::DEBUG);
-        lReturn = false;
+
+        // Show Epoch Time
+        Logger::GetInstance().Log<Logger::Level::TRACE>("Epoch time: {}:{}", mHeader->ts.tv_sec, mHeader->ts.tv_usec);
     }
 
     return lReturn;
@@ -92,10 +111,7 @@ std::string PCapReader::DataToString(const unsigned char* aData, const pcap_pkth
     std::string lData{};
 
     if ((aData != nullptr) && (aHeader != nullptr)) {
-        lData.resize(aHeader->caplen);
-        for (unsigned int lCount = 0; lCount < aHeader->caplen; lCount++) {
-            lData.at(lCount) = aData[lCount];
-        }
+        lData.assign(reinterpret_cast<const char*>(aData), aHeader->caplen);
     }
 
     return lData;
@@ -110,36 +126,51 @@ std::pair<bool, bool> PCapReader::ConstructAndReplayPacket(const unsigned char*
                                                            const pcap_pkthdr*   aHeader,
                                                            PacketConverter      aPacketConverter,
                                                            bool                 aMonitorCapture)
+{
+    std::string_view lData{};
+
+    if ((aData != nullptr) && (aHeader != nullptr)) {
+        lData = std::string_view(reinterpret_cast<const char*>(aData), aHeader->caplen);
+    }
+
+    return ConstructAndReplayPacket(lData, aPacketConverter, aMonitorCapture);
+}
+
+std::pair<bool, bool> PCapReader::ConstructAndReplayPacket(std::string_view aData,
+                                                           PacketConverter& aPacketConverter,
+                                                           bool             aMonitorCapture)
 {
     bool lUsefulPacket{true};
     bool lSuccesfulPacket{true};
 
-    std::string lData{DataToString(aData, aHeader)};
-
     if (aMonitorCapture) {
         lUsefulPacket = false;
 
-        if (aPacketConverter.Is80211Beacon(lData)) {
+        if (aPacketConverter.Is80211Beacon(aData)) {
             // Try to match SSID to filter list
-            std::string lSSID = aPacketConverter.GetBeaconSSID(lData);
+            std::string lSSID = aPacketConverter.GetBeaconSSID(aData);
 
             for (auto& lFilter : mSSIDFilter) {
                 if (lSSID.find(lFilter) != std::string::npos) {
                     if (lSSID != mWifiInformation.SSID) {
-                        aPacketConverter.FillWiFiInformation(lData, mWifiInformation);
-                        Logger::GetInstance().Log("SSID switched:" + lSSID, Logger::Level::DEBUG);
+                        aPacketConverter.FillWiFiInformation(aData, mWifiInformation);
+                        Logger::GetInstance().Log<Logger::Level::DEBUG>("SSID switched:{}", lSSID);
                     }
                 }
             }
-        } else if (aPacketConverter.Is80211Data(lData) && aPacketConverter.IsForBSSID(lData, mWifiInformation.BSSID)) {
+        } else if (aPacketConverter.Is80211Data(aData) && aPacketConverter.IsForBSSID(aData, mWifiInformation.BSSID)) {
             ++mPacketCount;
             lUsefulPacket = true;
         }
     }
 
     if ((mSendReceiveDevice != nullptr) && lUsefulPacket) {
+        // Promiscuous captures are sent straight from the file, only monitor captures need a converted copy.
+        std::string      lConverted{};
+        std::string_view lData{aData};
         if (aMonitorCapture) {
-            lData = aPacketConverter.ConvertPacketTo8023(lData);
+            lConverted = aPacketConverter.ConvertPacketTo8023(aData);
+            lData      = lConverted;
         }
         if (!lData.empty()) {
             lUsefulPacket = true;
@@ -152,48 +183,206 @@ std::pair<bool, bool> PCapReader::ConstructAndReplayPacket(const unsigned char*
     return {lSuccesfulPacket, lUsefulPacket};
 }
 
-std::pair<bool, unsigned int> PCapReader::ReplayPackets(bool aMonitorCapture, bool aHasRadioTap)
+std::string_view PCapReader::GetFrameData() const
+{
+    std::string_view lReturn{};
+
+    if (mMapped) {
+        lReturn = mMappedReader.GetFrame().Data;
+    } else if ((mData != nullptr) && (mHeader != nullptr)) {
+        lReturn = std::string_view(reinterpret_cast<const char*>(mData), mHeader->caplen);
+    }
+
+    return lReturn;
+}
+
+nanoseconds PCapReader::GetFrameTimeStamp() const
+{
+    nanoseconds lReturn{0};
+
+    // The mapped reader keeps the nanoseconds of pcapng captures, the header only has microseconds.
+    if (mMapped) {
+        lReturn = mMappedReader.GetFrame().TimeStamp;
+    } else if (mHeader != nullptr) {
+        lReturn = seconds(mHeader->ts.tv_sec) + microseconds(mHeader->ts.tv_usec);
+    }
+
+    return lReturn;
+}
+
+void PCapReader::WaitUntil(steady_clock::time_point aDeadline)
+{
+    auto lWakeUp{aDeadline - mSpinTime};
+
+    if (steady_clock::now() < lWakeUp) {
+        std::this_thread::sleep_until(lWakeUp);
+
+        // Keep the spin window a bit larger than what the scheduler oversleeps, so the deadline is met by spinning.
+        nanoseconds lOversleep{steady_clock::now() - lWakeUp};
+        mSpinTime = std::clamp<nanoseconds>((mSpinTime * 7 + lOversleep * 2) / 8, cMinSpinTime, cMaxSpinTime);
+    }
+
+    while (steady_clock::now() < aDeadline) {
+        std::this_thread::yield();
+    }
+}
+
+std::pair<bool, unsigned int> PCapReader::ReplayPackets(bool                  aMonitorCapture,
+                                                        bool                  aHasRadioTap,
+                                                        const ReplaySettings& aSettings)
 {
     bool         lSuccesfulPacket{false};
     unsigned int lPacketsSent{0};
 
+    mReplayStatistics = {};
+
     if (mSendReceiveDevice != nullptr) {
         bool lUsefulPacket{true};
         // Read the first packet
         if (ReadNextData()) {
             PacketConverter lPacketConverter{aHasRadioTap};
-            microseconds    lTimeStamp{mHeader->ts.tv_sec * 1000000 + mHeader->ts.tv_usec};
+            nanoseconds     lFirstTimeStamp{GetFrameTimeStamp()};
+            auto            lStart{steady_clock::now()};
+            nanoseconds     lTotalError{0};
+            double          lSpeed{aSettings.Speed > 0 ? aSettings.Speed : 1.0};
 
-            std::tie(lSuccesfulPacket, lUsefulPacket) =
-                ConstructAndReplayPacket(mData, mHeader, lPacketConverter, aMonitorCapture);
+            do {
+                nanoseconds lOffset{GetFrameTimeStamp() - lFirstTimeStamp};
 
-            if (lSuccesfulPacket && lUsefulPacket) {
-                lPacketsSent++;
-            }
+                if ((aSettings.Length.count() > 0) && (lOffset > aSettings.Length)) {
+                    break;
+                }
 
-            while (ReadNextData()) {
-                // Get time offset.
-                microseconds lSleepFor{mHeader->ts.tv_sec * 1000000 + mHeader->ts.tv_usec - lTimeStamp.count()};
-                lTimeStamp = microseconds(mHeader->ts.tv_sec * 1000000 + mHeader->ts.tv_usec);
+                if (!aSettings.MaxThroughput) {
+                    // Deadlines are relative to the start of the replay, so oversleeping once does not shift the rest.
+                    auto lDeadline{lStart + duration_cast<nanoseconds>(lOffset / lSpeed)};
 
-                // Wait for next send.
-                std::this_thread::sleep_for(lSleepFor);
+                    WaitUntil(lDeadline);
+
+                    nanoseconds lError{steady_clock::now() - lDeadline};
+                    lTotalError += lError;
+                    mReplayStatistics.MaxError = std::max(mReplayStatistics.MaxError, lError);
+                }
 
                 std::tie(lSuccesfulPacket, lUsefulPacket) =
-                    ConstructAndReplayPacket(mData, mHeader, lPacketConverter, aMonitorCapture);
+                    ConstructAndReplayPacket(GetFrameData(), lPacketConverter, aMonitorCapture);
 
                 if (lSuccesfulPacket && lUsefulPacket) {
                     lPacketsSent++;
                 }
-            }
+                mReplayStatistics.Packets++;
+            } while (ReadNextData());
+
+            mReplayStatistics.Duration  = steady_clock::now() - lStart;
+            mReplayStatistics.MeanError = lTotalError / mReplayStatistics.Packets;
+
+            auto lToMicroseconds = [](nanoseconds aTime) { return duration_cast<microseconds>(aTime).count(); };
+            Logger::GetInstance().Log<Logger::Level::INFO>(
+                "Replayed {} packets in {}us, timing error mean: {}us max: {}us",
+                mReplayStatistics.Packets,
+                lToMicroseconds(mReplayStatistics.Duration),
+                lToMicroseconds(mReplayStatistics.MeanError),
+                lToMicroseconds(mReplayStatistics.MaxError));
         }
     } else {
-        Logger::GetInstance().Log("Cannot replay packets wihout a send/receive device set!", Logger::Level::ERROR);
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Cannot replay packets wihout a send/receive device set!");
     }
 
     return std::pair{lSuccesfulPacket, lPacketsSent};
 }
 
+bool PCapReader::LoadIndex(bool aBuild)
+{
+    mIndexLoaded = false;
+
+    if (mMapped && !mMappedReader.IsCompressed()) {
+        std::string lIndexPath{CaptureIndex::GetIndexPath(mFileName)};
+        mIndexLoaded =
+            mIndex.Load(lIndexPath, mMappedReader.GetSize(), CaptureIndex::GetModificationTime(mFileName));
+
+        if (!mIndexLoaded && aBuild) {
+            mIndexLoaded = mIndex.Build(mFileName);
+            // Not being able to save it only means it has to be built again next time.
+            if (mIndexLoaded) {
+                mIndex.Save(lIndexPath);
+            }
+        }
+    } else {
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Only uncompressed memory mapped captures can be indexed");
+    }
+
+    return mIndexLoaded;
+}
+
+bool PCapReader::SeekToTime(nanoseconds aTimeStamp)
+{
+    bool lReturn{false};
+
+    if (mIndexLoaded) {
+        if (auto lPosition = mIndex.FindTime(aTimeStamp); lPosition.has_value()) {
+            lReturn = SeekFrom(*lPosition, [&](uint64_t /*aPacket*/, const MappedPCapReader_Constants::Frame& aFrame) {
+                return aFrame.TimeStamp >= aTimeStamp;
+            });
+        }
+    } else {
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Cannot seek without an index, call LoadIndex first");
+    }
+
+    return lReturn;
+}
+
+bool PCapReader::SeekToPacket(uint64_t aPacket)
+{
+    bool lReturn{false};
+
+    if (mIndexLoaded) {
+        if (auto lPosition = mIndex.FindPacket(aPacket); lPosition.has_value()) {
+            lReturn = SeekFrom(*lPosition, [&](uint64_t aCurrentPacket, const MappedPCapReader_Constants::Frame&) {
+                return aCurrentPacket >= aPacket;
+            });
+        }
+    } else {
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Cannot seek without an index, call LoadIndex first");
+    }
+
+    return lReturn;
+}
+
+bool PCapReader::SeekFrom(const CaptureIndex_Constants::Position&                                        aPosition,
+                          const std::function<bool(uint64_t, const MappedPCapReader_Constants::Frame&)>& aFound)
+{
+    bool     lReturn{false};
+    uint64_t lPacket{aPosition.Packet};
+
+    if (mMappedReader.SetOffset(aPosition.Offset, mIndex.GetSection(aPosition))) {
+        // At most the interval of the index gets read here.
+        while (!lReturn && mMappedReader.ReadNextData()) {
+            if (aFound(lPacket, mMappedReader.GetFrame())) {
+                // Step back, so the next read returns this frame.
+                lReturn = mMappedReader.SetOffset(mMappedReader.GetFrame().Offset);
+            } else {
+                lPacket++;
+            }
+        }
+    }
+
+    // The packet count only counts useful packets that were read, seeking does not change it.
+    mData   = nullptr;
+    mHeader = nullptr;
+
+    return lReturn;
+}
+
+const CaptureIndex& PCapReader::GetIndex() const
+{
+    return mIndex;
+}
+
+const ReplayStatistics& PCapReader::GetReplayStatistics() const
+{
+    return mReplayStatistics;
+}
+
 bool PCapReader::Send(std::string_view /*aData*/, IPCapDevice_Constants::WiFiBeaconInformation& /*aWiFiInformation*/)
 {
     return false;
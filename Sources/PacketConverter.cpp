@@ -13,6 +13,7 @@
 
 #endif
 
+#include <iomanip>
 #include <iostream>
 #include <numeric>
 #include <regex>
@@ -62,6 +63,18 @@ uint64_t PacketConverter::MacToInt(std::string_view aMac)
     return lResult;
 }
 
+std::string PacketConverter::IntToMac(uint64_t aMac)
+{
+    std::ostringstream lStringStream{};
+    lStringStream << std::hex << std::setfill('0');
+
+    for (int lByte = 5; lByte >= 0; lByte--) {
+        lStringStream << std::setw(2) << ((aMac >> (lByte * 8U)) & 0xffU) << (lByte > 0 ? ":" : "");
+    }
+
+    return lStringStream.str();
+}
+
 int PacketConverter::ConvertChannelToFrequency(int aChannel)
 {
     int lReturn{-1};
@@ -74,11 +87,27 @@ int PacketConverter::ConvertChannelToFrequency(int aChannel)
     return lReturn;
 }
 
+int PacketConverter::ConvertFrequencyToChannel(int aFrequency)
+{
+    int lReturn{-1};
+
+    if (aFrequency >= 2412 && aFrequency <= 2472 && ((aFrequency - 2412) % 5) == 0) {
+        lReturn = ((aFrequency - 2412) / 5) + 1;
+    }
+
+    return lReturn;
+}
+
 PacketConverter::PacketConverter(bool aRadioTap)
 {
     mRadioTap = aRadioTap;
 }
 
+const RadioTapReader& PacketConverter::GetRadioTapReader() const
+{
+    return mRadioTapReader;
+}
+
 bool PacketConverter::Is80211Beacon(std::string_view aData)
 {
     bool lReturn{GetRawData<uint16_t>(aData, mRadioTapReader.GetLength()) == Net_80211_Constants::cBeaconType};
@@ -281,8 +310,9 @@ std::string PacketConverter::ConvertPacketTo8023(std::string_view aData)
 
             lConvertedPacket.append(aData.substr(lDataIndex, aData.size() - lDataIndex - lFCSLength));
         } else {
-            Logger::GetInstance().Log("The header has an invalid length, cannot convert the packet",
-                                      Logger::Level::WARNING);
+            static Logger::RateLimit lLimit{};
+            Logger::GetInstance().LogLimited<Logger::Level::WARNING>(
+                lLimit, "The header has an invalid length, cannot convert the packet");
         }
     }
     // [ Destination MAC | Source MAC | EtherType ] [ Payload ]
@@ -414,8 +444,9 @@ std::string PacketConverter::ConvertPacketTo80211(std::string_view aData,
 
         lReturn = std::string(lFullPacket.begin(), lFullPacket.end());
     } else {
-        Logger::GetInstance().Log("The header has an invalid length, cannot convert the packet",
-                                  Logger::Level::WARNING);
+        static Logger::RateLimit lLimit{};
+        Logger::GetInstance().LogLimited<Logger::Level::WARNING>(
+            lLimit, "The header has an invalid length, cannot convert the packet");
     }
 
     return lReturn;
@@ -9,6 +9,15 @@ template<typename Type> Type GetRawData(std::string_view aData, unsigned int aIn
     return (*reinterpret_cast<const Type*>(aData.data() + aIndex));
 }
 
+namespace
+{
+    // Radiotap fields are aligned to their natural size, counted from the start of the header.
+    unsigned int Align(unsigned int aIndex, unsigned int aAlignment)
+    {
+        return (aIndex + aAlignment - 1) & ~(aAlignment - 1);
+    }
+}  // namespace
+
 void RadioTapReader::Reset()
 {
     mLength       = 0;
@@ -17,6 +26,8 @@ void RadioTapReader::Reset()
     mDataRate     = RadioTap_Constants::cRateFlags;
     mFrequency    = RadioTap_Constants::cChannel;
     mChannelFlags = RadioTap_Constants::cChannelFlags;
+    mHasSignal    = false;
+    mSignal       = 0;
 }
 
 uint16_t RadioTapReader::GetLength() const
@@ -49,6 +60,16 @@ uint16_t RadioTapReader::GetFrequency() const
     return mFrequency;
 }
 
+bool RadioTapReader::HasSignal() const
+{
+    return mHasSignal;
+}
+
+int8_t RadioTapReader::GetSignal() const
+{
+    return mSignal;
+}
+
 void RadioTapReader::FillRadioTapParameters(std::string_view aData)
 {
     // Skip 2 bytes to skip header revision and header pad
@@ -60,8 +81,9 @@ void RadioTapReader::FillRadioTapParameters(std::string_view aData)
 
         // What fields do we have?
         mPresentFlags = GetRawData<uint32_t>(aData, RadioTap_Constants::cPresentFlagsIndex);
+        mHasSignal    = false;
 
-        uint8_t lIndex{RadioTap_Constants::cPresentFlagsIndex};
+        unsigned int lIndex{RadioTap_Constants::cPresentFlagsIndex};
 
         // If extended radiotap, skip past it
         while ((GetRawData<uint32_t>(aData, lIndex) & 0x20000000U) != 0) {
@@ -73,7 +95,7 @@ void RadioTapReader::FillRadioTapParameters(std::string_view aData)
 
         if ((mPresentFlags & 1U) == 1) {
             // TSFT, don't care, skip over it
-            lIndex += sizeof(uint64_t);
+            lIndex = Align(lIndex, sizeof(uint64_t)) + sizeof(uint64_t);
         }
         if (((mPresentFlags >> 1U) & 1U) == 1) {
             // Flags, contains important information like datapad and fcs at the end of a packet
@@ -87,9 +109,20 @@ void RadioTapReader::FillRadioTapParameters(std::string_view aData)
         }
         if (((mPresentFlags >> 3U) & 1U) == 1) {
             // Channel and channel flags
+            lIndex     = Align(lIndex, sizeof(uint16_t));
             mFrequency = GetRawData<uint16_t>(aData, lIndex);
             lIndex += sizeof(uint16_t);
             mChannelFlags = GetRawData<uint16_t>(aData, lIndex);
+            lIndex += sizeof(uint16_t);
+        }
+        if (((mPresentFlags >> 4U) & 1U) == 1) {
+            // FHSS, hop set and pattern
+            lIndex += sizeof(uint16_t);
+        }
+        if ((((mPresentFlags >> 5U) & 1U) == 1) && (lIndex < mLength)) {
+            // Antenna signal in dBm
+            mSignal    = GetRawData<int8_t>(aData, lIndex);
+            mHasSignal = true;
         }
 
         // Don't care about any of the other flags yet, so just don't read them yet
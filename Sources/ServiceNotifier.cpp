@@ -0,0 +1,109 @@
+#include "../Includes/ServiceNotifier.h"
+
+/* Copyright (c) 2020 [Rick de Bondt] - ServiceNotifier.cpp */
+
+#include <chrono>
+#include <cstdlib>
+
+#if not defined(_MSC_VER) && not defined(__MINGW32__)
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "../Includes/Logger.h"
+
+using namespace ServiceNotifier_Constants;
+
+ServiceNotifier::ServiceNotifier()
+{
+    const char* lSocketPath{std::getenv(cSocketVariable.data())};
+
+    if (lSocketPath != nullptr) {
+        mSocketPath = lSocketPath;
+    }
+}
+
+bool ServiceNotifier::IsEnabled() const
+{
+    return !mSocketPath.empty();
+}
+
+bool ServiceNotifier::NotifyReady(std::string_view aStatus)
+{
+    std::string lState{cReady};
+
+    if (!aStatus.empty()) {
+        lState.append("\n").append(cStatus).append(aStatus);
+    }
+
+    return Notify(lState);
+}
+
+bool ServiceNotifier::NotifyReloading()
+{
+    std::string lState{cReloading};
+
+#if not defined(_MSC_VER) && not defined(__MINGW32__)
+    // The service manager tells reloads apart by the time on the monotonic clock, which the steady clock uses here.
+    auto lTime{std::chrono::steady_clock::now().time_since_epoch()};
+    lState.append("\n").append(cMonotonicTime).append(
+        std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(lTime).count()));
+#endif
+
+    return Notify(lState);
+}
+
+bool ServiceNotifier::NotifyStopping()
+{
+    return Notify(cStopping);
+}
+
+bool ServiceNotifier::NotifyStatus(std::string_view aStatus)
+{
+    return Notify(std::string(cStatus) + std::string(aStatus));
+}
+
+bool ServiceNotifier::Notify(std::string_view aState)
+{
+    bool lReturn{false};
+
+#if not defined(_MSC_VER) && not defined(__MINGW32__)
+    sockaddr_un lAddress{};
+
+    if (IsEnabled() && mSocketPath.size() < sizeof(lAddress.sun_path)) {
+        int lSocket{socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0)};
+
+        if (lSocket != -1) {
+            lAddress.sun_family = AF_UNIX;
+            std::memcpy(lAddress.sun_path, mSocketPath.data(), mSocketPath.size());
+
+            // Abstract sockets have no name in the filesystem, their name starts with a NUL character instead.
+            if (lAddress.sun_path[0] == '@') {
+                lAddress.sun_path[0] = '\0';
+            }
+
+            auto    lLength{static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + mSocketPath.size())};
+            ssize_t lSent{sendto(lSocket,
+                                 aState.data(),
+                                 aState.size(),
+                                 MSG_NOSIGNAL,
+                                 reinterpret_cast<sockaddr*>(&lAddress),
+                                 lLength)};
+            lReturn = lSent == static_cast<ssize_t>(aState.size());
+            close(lSocket);
+        }
+
+        if (!lReturn) {
+            Logger::GetInstance().Log<Logger::Level::WARNING>("Could not notify the service manager: {}",
+                                                              std::strerror(errno));
+        }
+    }
+#endif
+
+    return lReturn;
+}
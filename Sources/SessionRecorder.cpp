@@ -0,0 +1,306 @@
+#include "../Includes/SessionRecorder.h"
+
+/* Copyright (c) 2020 [Rick de Bondt] - SessionRecorder.cpp */
+
+#include <bit>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+#include "../Includes/Logger.h"
+#include "../Includes/PCapNGWriter.h"
+#include "../Includes/ThreadName.h"
+
+using namespace SessionRecorder_Constants;
+using namespace std::chrono;
+
+SessionRecorder::SessionRecorder(Settings aSettings) :
+    mSettings(std::move(aSettings)), mSlots(std::bit_ceil(std::max<std::size_t>(mSettings.QueueSize, 2))),
+    mMask(mSlots.size() - 1)
+{}
+
+SessionRecorder::~SessionRecorder()
+{
+    Close();
+}
+
+bool SessionRecorder::Open()
+{
+    bool lReturn{false};
+
+    if (mSettings.Compress && !ZstdCompressor::IsAvailable()) {
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Built without zstd support, cannot record compressed");
+    } else if (!mRunning) {
+        for (uint64_t lIndex = 0; lIndex < mSlots.size(); lIndex++) {
+            mSlots.at(lIndex).Sequence.store(lIndex, std::memory_order_relaxed);
+            mSlots.at(lIndex).Data.clear();
+        }
+        mEnqueuePosition.store(0, std::memory_order_relaxed);
+        mDequeuePosition = 0;
+        mRecordedCount   = 0;
+        mDroppedCount    = 0;
+        mFileNumber      = 0;
+
+        {
+            std::lock_guard<std::mutex> lLock{mFilesMutex};
+            mFiles.clear();
+        }
+
+        std::time_t        lNow{system_clock::to_time_t(system_clock::now())};
+        std::tm            lCalendar{};
+        std::ostringstream lStartTime{};
+#if defined(_MSC_VER) || defined(__MINGW32__)
+        localtime_s(&lCalendar, &lNow);
+#else
+        localtime_r(&lNow, &lCalendar);
+#endif
+        lStartTime << std::put_time(&lCalendar, "%Y%m%d_%H%M%S");
+        mStartTime = lStartTime.str();
+
+        if (OpenFile()) {
+            mLastFlush    = steady_clock::now();
+            mRunning      = true;
+            mWriterThread = std::make_shared<boost::thread>([&] {
+                ThreadName_Constants::SetCurrentThreadName("session-rec");
+                WriteFrames();
+            });
+            lReturn       = true;
+        }
+    }
+
+    return lReturn;
+}
+
+void SessionRecorder::Close()
+{
+    if (mWriterThread != nullptr) {
+        mRunning = false;
+        mWriterThread->join();
+        mWriterThread = nullptr;
+
+        if (mDroppedCount > 0) {
+            Logger::GetInstance().Log<Logger::Level::WARNING>("Session recorder dropped {} of {} frames",
+                                                              mDroppedCount,
+                                                              mRecordedCount + mDroppedCount);
+        }
+    }
+}
+
+bool SessionRecorder::Record(Direction aDirection, std::string aData)
+{
+    bool lReturn{false};
+
+    if (mRunning.load(std::memory_order_relaxed)) {
+        // Bounded multi-producer queue: a slot is free for position P when its sequence equals P, and gets
+        // sequence P + 1 when filled so the writer knows it can take it.
+        uint64_t lPosition{mEnqueuePosition.load(std::memory_order_relaxed)};
+        Slot*    lSlot{nullptr};
+
+        while (lSlot == nullptr) {
+            Slot&   lCandidate{mSlots[lPosition & mMask]};
+            int64_t lDifference{static_cast<int64_t>(lCandidate.Sequence.load(std::memory_order_acquire)) -
+                                static_cast<int64_t>(lPosition)};
+
+            if (lDifference == 0) {
+                if (mEnqueuePosition.compare_exchange_weak(lPosition, lPosition + 1, std::memory_order_relaxed)) {
+                    lSlot = &lCandidate;
+                }
+            } else if (lDifference < 0) {
+                // The writer has not caught up, don't wait for it.
+                break;
+            } else {
+                lPosition = mEnqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        if (lSlot != nullptr) {
+            lSlot->TimeStamp      = duration_cast<nanoseconds>(system_clock::now().time_since_epoch());
+            lSlot->FrameDirection = aDirection;
+            lSlot->Data           = std::move(aData);
+            lSlot->Sequence.store(lPosition + 1, std::memory_order_release);
+            mRecordedCount.fetch_add(1, std::memory_order_relaxed);
+            lReturn = true;
+        } else {
+            mDroppedCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    return lReturn;
+}
+
+bool SessionRecorder::Dequeue(Slot& aSlot)
+{
+    bool  lReturn{false};
+    Slot& lSlot{mSlots[mDequeuePosition & mMask]};
+
+    if (lSlot.Sequence.load(std::memory_order_acquire) == mDequeuePosition + 1) {
+        aSlot.TimeStamp      = lSlot.TimeStamp;
+        aSlot.FrameDirection = lSlot.FrameDirection;
+        // Leaves the slot empty, so the buffer gets freed here and not on the thread recording into the slot next.
+        aSlot.Data = std::move(lSlot.Data);
+        lSlot.Data.clear();
+        lSlot.Sequence.store(mDequeuePosition + mSlots.size(), std::memory_order_release);
+        mDequeuePosition++;
+        lReturn = true;
+    }
+
+    return lReturn;
+}
+
+void SessionRecorder::WriteFrames()
+{
+    Slot lSlot{};
+    bool lRunning{true};
+
+    while (lRunning) {
+        // Read the flag before draining, so frames recorded before closing are always written.
+        lRunning = mRunning;
+        bool lIdle{true};
+
+        while (Dequeue(lSlot)) {
+            AppendFrame(lSlot);
+            lIdle = false;
+        }
+
+        if (!lRunning || (steady_clock::now() - mLastFlush >= cFlushInterval)) {
+            Flush();
+        }
+
+        if (lIdle && lRunning) {
+            std::this_thread::sleep_for(cIdleTime);
+        }
+    }
+
+    CloseFile();
+}
+
+void SessionRecorder::AppendFrame(const Slot& aSlot)
+{
+    // The batch only gets compressed when flushed, so when compressing only what is on disk can be compared. The
+    // file then goes over the maximum size by at most one compressed batch.
+    uint64_t lFileSize{mFileSize + (mSettings.Compress ? 0 : mBatch.size())};
+    if (mFile.is_open() && ((lFileSize >= mSettings.MaxFileSize) ||
+                            (steady_clock::now() - mFileOpened >= mSettings.MaxFileDuration))) {
+        Flush();
+        OpenFile();
+    }
+
+    if (mFile.is_open()) {
+        PCapNGWriter::AppendPacket(mBatch,
+                                   static_cast<uint32_t>(aSlot.FrameDirection),
+                                   aSlot.TimeStamp,
+                                   std::string_view(aSlot.Data).substr(0, cSnapLength),
+                                   static_cast<uint32_t>(aSlot.Data.size()));
+
+        if (mBatch.size() >= cBatchSize) {
+            Flush();
+        }
+    }
+}
+
+void SessionRecorder::Flush()
+{
+    if (mFile.is_open() && !mBatch.empty()) {
+        std::string_view lOutput{mBatch};
+
+        // Flushed as a whole, so a recording can be read up to the last flush even if the program stops.
+        if (mSettings.Compress) {
+            mCompressed.clear();
+            mCompressor.Compress(mBatch, mCompressed);
+            lOutput = mCompressed;
+        }
+
+        mFile.write(lOutput.data(), lOutput.size());
+        mFile.flush();
+        mFileSize += lOutput.size();
+
+        if (!mFile.good()) {
+            Logger::GetInstance().Log<Logger::Level::ERROR>("Failed to write session recording, stopped recording");
+            mFile.close();
+        }
+    }
+
+    mBatch.clear();
+    mLastFlush = steady_clock::now();
+}
+
+bool SessionRecorder::OpenFile()
+{
+    bool lReturn{false};
+
+    CloseFile();
+
+    std::ostringstream lPath{};
+    lPath << mSettings.Path << "_" << mStartTime << "_" << std::setw(4) << std::setfill('0') << mFileNumber++
+          << cExtension << (mSettings.Compress ? ZstdStream_Constants::cExtension : "");
+
+    std::error_code       lError{};
+    std::filesystem::path lParent{std::filesystem::path(lPath.str()).parent_path()};
+    if (!lParent.empty()) {
+        std::filesystem::create_directories(lParent, lError);
+    }
+
+    mFile.open(lPath.str(), std::ios::binary | std::ios::trunc);
+    if (mFile.is_open() && (!mSettings.Compress || mCompressor.Open())) {
+        mFileSize   = 0;
+        mFileOpened = steady_clock::now();
+        AppendFileHeader(mBatch);
+
+        {
+            std::lock_guard<std::mutex> lLock{mFilesMutex};
+            mFiles.emplace_back(lPath.str());
+            while ((mSettings.MaxFiles > 0) && (mFiles.size() > mSettings.MaxFiles)) {
+                std::remove(mFiles.front().c_str());
+                mFiles.erase(mFiles.begin());
+            }
+        }
+
+        lReturn = true;
+        Logger::GetInstance().Log<Logger::Level::INFO>("Recording session to {}", lPath.str());
+    } else {
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Could not open session recording {}", lPath.str());
+    }
+
+    return lReturn;
+}
+
+void SessionRecorder::CloseFile()
+{
+    if (mFile.is_open() && mSettings.Compress) {
+        mCompressed.clear();
+        mCompressor.Compress({}, mCompressed, true);
+        mFile.write(mCompressed.data(), mCompressed.size());
+    }
+
+    mFile.close();
+}
+
+void SessionRecorder::AppendFileHeader(std::string& aBuffer)
+{
+    PCapNGWriter::AppendSectionHeader(aBuffer);
+
+    // One interface per direction, in the order of the Direction enum so it can be used as interface number.
+    for (std::size_t lIndex = 0; lIndex < cDirectionTexts.size(); lIndex++) {
+        PCapNGWriter::AppendInterface(
+            aBuffer, cDirectionLinkTypes.at(lIndex), cSnapLength, cDirectionTexts.at(lIndex));
+    }
+}
+
+uint64_t SessionRecorder::GetRecordedCount() const
+{
+    return mRecordedCount;
+}
+
+uint64_t SessionRecorder::GetDroppedCount() const
+{
+    return mDroppedCount;
+}
+
+std::vector<std::string> SessionRecorder::GetFiles() const
+{
+    std::lock_guard<std::mutex> lLock{mFilesMutex};
+    return mFiles;
+}
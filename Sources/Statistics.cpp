@@ -0,0 +1,83 @@
+#include "../Includes/Statistics.h"
+
+/* Copyright (c) 2020 [Rick de Bondt] - Statistics.cpp */
+
+using namespace Statistics_Constants;
+using namespace std::chrono;
+
+Statistics::BlockHandle::BlockHandle(Statistics& aStatistics) :
+    mStatistics(aStatistics), mBlock(aStatistics.AcquireBlock())
+{}
+
+Statistics::BlockHandle::~BlockHandle()
+{
+    mStatistics.ReleaseBlock(mBlock);
+}
+
+void Statistics::AddLatency(Latency aLatency, nanoseconds aDuration)
+{
+    Block&                lBlock{GetBlock()};
+    auto                  lIndex{static_cast<std::size_t>(aLatency)};
+    int64_t               lDuration{std::max<int64_t>(aDuration.count(), 0)};
+    std::atomic<int64_t>& lMax{lBlock.LatencyMax.at(lIndex)};
+
+    std::size_t lBucket{std::min(Histogram_Constants::GetBucket(lDuration), cLatencyBuckets - 1)};
+    AddOwned<uint64_t>(lBlock.LatencyBuckets.at(lIndex).at(lBucket), 1);
+    AddOwned<int64_t>(lBlock.LatencySum.at(lIndex), lDuration);
+    if (lDuration > lMax.load(std::memory_order_relaxed)) {
+        lMax.store(lDuration, std::memory_order_relaxed);
+    }
+}
+
+Snapshot Statistics::GetSnapshot() const
+{
+    Snapshot                    lReturn{};
+    std::lock_guard<std::mutex> lLock{mBlocksMutex};
+
+    lReturn.TimeStamp = steady_clock::now();
+    for (const auto& lBlock : mBlocks) {
+        for (std::size_t lIndex = 0; lIndex < cCounterCount; lIndex++) {
+            lReturn.Counters.at(lIndex) += lBlock.Counters.at(lIndex).load(std::memory_order_relaxed);
+        }
+
+        for (std::size_t lIndex = 0; lIndex < cLatencyCount; lIndex++) {
+            LatencyHistogram& lHistogram{lReturn.Latencies.at(lIndex)};
+            for (std::size_t lBucket = 0; lBucket < cLatencyBuckets; lBucket++) {
+                uint64_t lCount{lBlock.LatencyBuckets.at(lIndex).at(lBucket).load(std::memory_order_relaxed)};
+                lHistogram.Buckets.at(lBucket) += lCount;
+                lHistogram.Count += lCount;
+            }
+            lHistogram.Sum += nanoseconds(lBlock.LatencySum.at(lIndex).load(std::memory_order_relaxed));
+            lHistogram.Max =
+                std::max(lHistogram.Max, nanoseconds(lBlock.LatencyMax.at(lIndex).load(std::memory_order_relaxed)));
+        }
+    }
+
+    return lReturn;
+}
+
+Statistics::Block& Statistics::AcquireBlock()
+{
+    std::lock_guard<std::mutex> lLock{mBlocksMutex};
+    Block*                      lReturn{nullptr};
+
+    for (auto& lBlock : mBlocks) {
+        if (!lBlock.InUse) {
+            lReturn = &lBlock;
+            break;
+        }
+    }
+
+    if (lReturn == nullptr) {
+        lReturn = &mBlocks.emplace_back();
+    }
+    lReturn->InUse = true;
+
+    return *lReturn;
+}
+
+void Statistics::ReleaseBlock(Block& aBlock)
+{
+    std::lock_guard<std::mutex> lLock{mBlocksMutex};
+    aBlock.InUse = false;
+}
@@ -0,0 +1,145 @@
+#include "../Includes/TrafficGenerator.h"
+
+/* Copyright (c) 2020 [Rick de Bondt] - TrafficGenerator.cpp */
+
+#include <algorithm>
+#include <cstring>
+
+using namespace TrafficGenerator_Constants;
+
+namespace
+{
+    // Payload: magic | console | sequence | timestamp
+    constexpr unsigned int cMagicIndex{0};
+    constexpr unsigned int cConsoleIndex{cMagicIndex + sizeof(uint32_t)};
+    constexpr unsigned int cSequenceIndex{cConsoleIndex + sizeof(uint16_t)};
+    constexpr unsigned int cTimeStampIndex{cSequenceIndex + sizeof(uint32_t)};
+    constexpr unsigned int cPayloadHeaderLength{cTimeStampIndex + sizeof(int64_t)};
+
+    // Bimodal distribution: this fraction of frames is at maximum size.
+    constexpr double cLargeFrameChance{0.2};
+
+    // Writes a MAC address in network order.
+    void WriteMac(char* aDestination, uint64_t aMac)
+    {
+        for (int lCount = 5; lCount >= 0; lCount--) {
+            aDestination[lCount] = static_cast<char>(aMac & 0xFFU);
+            aMac >>= 8U;
+        }
+    }
+}  // namespace
+
+TrafficGenerator::TrafficGenerator(const Settings& aSettings) :
+    mSettings{aSettings}, mRandom{aSettings.Seed},
+    mSize{std::clamp(aSettings.MinSize, cMinFrameSize, cMaxFrameSize),
+          std::clamp(std::max(aSettings.MinSize, aSettings.MaxSize), cMinFrameSize, cMaxFrameSize)},
+    mSequences(std::max(aSettings.Consoles, 1U), 0)
+{
+    mSettings.Consoles = std::max(aSettings.Consoles, 1U);
+    mSettings.MinSize  = mSize.min();
+    mSettings.MaxSize  = mSize.max();
+}
+
+unsigned int TrafficGenerator::PickSize()
+{
+    unsigned int lReturn{mSettings.MinSize};
+
+    switch (mSettings.Distribution) {
+        case SizeDistribution::Fixed:
+            break;
+        case SizeDistribution::Uniform:
+            lReturn = mSize(mRandom);
+            break;
+        case SizeDistribution::Bimodal:
+            lReturn = (mChance(mRandom) < cLargeFrameChance) ? mSettings.MaxSize : mSettings.MinSize;
+            break;
+    }
+
+    return lReturn;
+}
+
+std::string TrafficGenerator::Generate8023Frame(std::chrono::steady_clock::time_point aTimeStamp)
+{
+    std::string lFrame(PickSize(), '\0');
+    uint16_t    lConsole{mNextConsole};
+    mNextConsole = (mNextConsole + 1) % mSettings.Consoles;
+
+    // Unicast frames go to the next console in line, which is someone else as long as there are multiple consoles.
+    uint64_t lDestination{(mChance(mRandom) < mSettings.BroadcastRatio) ?
+                              cBroadcastMac :
+                              GetConsoleMac((lConsole + 1) % mSettings.Consoles)};
+
+    WriteMac(&lFrame[Net_8023_Constants::cDestinationAddressIndex], lDestination);
+    WriteMac(&lFrame[Net_8023_Constants::cSourceAddressIndex], GetConsoleMac(lConsole));
+    lFrame[Net_8023_Constants::cEtherTypeIndex]     = static_cast<char>(cEtherType >> 8U);
+    lFrame[Net_8023_Constants::cEtherTypeIndex + 1] = static_cast<char>(cEtherType & 0xFFU);
+
+    uint32_t lSequence{mSequences.at(lConsole)++};
+    int64_t  lTimeStamp{
+        std::chrono::duration_cast<std::chrono::nanoseconds>(aTimeStamp.time_since_epoch()).count()};
+    char*    lPayload{&lFrame[c8023PayloadIndex]};
+    memcpy(lPayload + cMagicIndex, &cMagic, sizeof(cMagic));
+    memcpy(lPayload + cConsoleIndex, &lConsole, sizeof(lConsole));
+    memcpy(lPayload + cSequenceIndex, &lSequence, sizeof(lSequence));
+    memcpy(lPayload + cTimeStampIndex, &lTimeStamp, sizeof(lTimeStamp));
+
+    mFramesGenerated++;
+    return lFrame;
+}
+
+std::string TrafficGenerator::Generate80211Frame(std::chrono::steady_clock::time_point aTimeStamp)
+{
+    return mPacketConverter.ConvertPacketTo80211(
+        Generate8023Frame(aTimeStamp), mSettings.BSSID, mSettings.Frequency, RadioTap_Constants::cRateFlags);
+}
+
+FrameInformation TrafficGenerator::ReadFrameInformation(std::string_view aFrame, unsigned int aPayloadIndex)
+{
+    FrameInformation lReturn{};
+
+    if (aFrame.size() >= aPayloadIndex + cPayloadHeaderLength) {
+        const char* lPayload{aFrame.data() + aPayloadIndex};
+        uint32_t    lMagic{0};
+        int64_t     lTimeStamp{0};
+        memcpy(&lMagic, lPayload + cMagicIndex, sizeof(lMagic));
+
+        if (lMagic == cMagic) {
+            memcpy(&lReturn.Console, lPayload + cConsoleIndex, sizeof(lReturn.Console));
+            memcpy(&lReturn.Sequence, lPayload + cSequenceIndex, sizeof(lReturn.Sequence));
+            memcpy(&lTimeStamp, lPayload + cTimeStampIndex, sizeof(lTimeStamp));
+            lReturn.TimeStamp = std::chrono::steady_clock::time_point(std::chrono::nanoseconds(lTimeStamp));
+            lReturn.Valid     = true;
+        }
+    }
+
+    return lReturn;
+}
+
+uint64_t TrafficGenerator::GetConsoleMac(uint16_t aConsole)
+{
+    return cBaseMac + aConsole + 1;
+}
+
+std::chrono::nanoseconds TrafficGenerator::GetInterval() const
+{
+    double lTotalRate{mSettings.PacketsPerSecond * mSettings.Consoles};
+    return std::chrono::nanoseconds(lTotalRate > 0 ? static_cast<int64_t>(1e9 / lTotalRate) : 0);
+}
+
+uint64_t TrafficGenerator::GetFramesGenerated() const
+{
+    return mFramesGenerated;
+}
+
+SizeDistribution TrafficGenerator::ConvertStringToSizeDistribution(std::string_view aDistribution)
+{
+    SizeDistribution lReturn{SizeDistribution::Uniform};
+
+    for (std::size_t lCount = 0; lCount < cSizeDistributionTexts.size(); lCount++) {
+        if (cSizeDistributionTexts.at(lCount) == aDistribution) {
+            lReturn = static_cast<SizeDistribution>(lCount);
+        }
+    }
+
+    return lReturn;
+}
@@ -37,7 +37,10 @@ bool Button::HandleKey(unsigned int aKeyCode)
 
 void Button::SetSelected(bool aSelected)
 {
-    mSelected = aSelected;
+    if (aSelected != mSelected) {
+        mSelected = aSelected;
+        SetDirty(true);
+    }
 }
 
 bool Button::IsSelected() const
@@ -31,6 +31,7 @@ bool CheckBox::HandleKey(unsigned int aKeyCode)
     if (aKeyCode == ' ') {
         mModelCheckBox = !mModelCheckBox;
         lReturn        = true;
+        SetDirty(true);
     }
 
     return lReturn;
@@ -39,6 +40,7 @@ bool CheckBox::HandleKey(unsigned int aKeyCode)
 void CheckBox::SetChecked(bool aChecked)
 {
     mModelCheckBox = aChecked;
+    SetDirty(true);
 }
 
 bool CheckBox::IsChecked() const
@@ -48,7 +50,10 @@ bool CheckBox::IsChecked() const
 
 void CheckBox::SetSelected(bool aSelected)
 {
-    mSelected = aSelected;
+    if (aSelected != mSelected) {
+        mSelected = aSelected;
+        SetDirty(true);
+    }
 }
 
 bool CheckBox::IsSelected() const
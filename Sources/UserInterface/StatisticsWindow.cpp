@@ -0,0 +1,237 @@
+#include "../../Includes/UserInterface/StatisticsWindow.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+/* Copyright (c) 2020 [Rick de Bondt] - StatisticsWindow.cpp */
+
+using namespace StatisticsWindow_Constants;
+using namespace Statistics_Constants;
+using namespace std::chrono;
+
+// Shortens an amount to at most 5 characters, using k, M and G for thousands, millions and billions.
+static std::string FormatAmount(double aAmount)
+{
+    static constexpr std::array<std::string_view, 4> cSuffixes{"", "k", "M", "G"};
+
+    std::ostringstream lReturn{};
+    std::size_t        lSuffix{0};
+
+    while (aAmount >= 1000.0 && lSuffix < cSuffixes.size() - 1) {
+        aAmount /= 1000.0;
+        lSuffix++;
+    }
+
+    lReturn << std::fixed << std::setprecision((lSuffix > 0 && aAmount < 100.0) ? 1 : 0) << aAmount
+            << cSuffixes.at(lSuffix);
+    return lReturn.str();
+}
+
+static std::string FormatLatency(nanoseconds aLatency)
+{
+    static constexpr std::array<std::string_view, 4> cUnits{"ns", "us", "ms", "s"};
+
+    std::ostringstream lReturn{};
+    auto               lLatency{static_cast<double>(aLatency.count())};
+    std::size_t        lUnit{0};
+
+    while (lLatency >= 1000.0 && lUnit < cUnits.size() - 1) {
+        lLatency /= 1000.0;
+        lUnit++;
+    }
+
+    lReturn << std::fixed << std::setprecision((lUnit > 0 && lLatency < 10.0) ? 1 : 0) << lLatency
+            << cUnits.at(lUnit);
+    return lReturn.str();
+}
+
+StatisticsWindow::StatisticsWindow(WindowModel&                       aModel,
+                                   std::string_view                   aTitle,
+                                   const std::function<Dimensions()>& aCalculation) :
+    Window(aModel, aTitle, aCalculation)
+{
+    // Get size of window so the lines fit.
+    GetSize();
+    mLastSnapshot = Statistics::GetInstance().GetSnapshot();
+    BuildLines();
+}
+
+void StatisticsWindow::Update()
+{
+    if (GetModel().mStatusUpdates != mLastStatusUpdate) {
+        Sample();
+        mLastStatusUpdate = GetModel().mStatusUpdates;
+    }
+
+    BuildLines();
+    if (mLines != mDrawnLines) {
+        SetDirty(true);
+    }
+}
+
+void StatisticsWindow::Draw()
+{
+    DrawLines();
+    Window::Draw();
+}
+
+bool StatisticsWindow::Scale()
+{
+    bool lReturn{Window::Scale()};
+
+    // Resizing clears the window, so everything has to be drawn again.
+    mDrawnLines.clear();
+    BuildLines();
+
+    return lReturn;
+}
+
+void StatisticsWindow::Sample()
+{
+    Snapshot lSnapshot{Statistics::GetInstance().GetSnapshot()};
+    double   lSeconds{duration<double>(lSnapshot.TimeStamp - mLastSnapshot.TimeStamp).count()};
+
+    for (std::size_t lIndex = 0; lIndex < cDirections.size(); lIndex++) {
+        const Direction& lDirection{cDirections.at(lIndex)};
+        if (lSeconds > 0) {
+            mPacketRates.at(lIndex) =
+                static_cast<double>(lSnapshot.Get(lDirection.Frames) - mLastSnapshot.Get(lDirection.Frames)) / lSeconds;
+            mByteRates.at(lIndex) =
+                static_cast<double>(lSnapshot.Get(lDirection.Bytes) - mLastSnapshot.Get(lDirection.Bytes)) / lSeconds;
+        }
+
+        std::deque<double>& lHistory{mPacketRateHistory.at(lIndex)};
+        lHistory.push_back(mPacketRates.at(lIndex));
+        if (lHistory.size() > cHistoryLength) {
+            lHistory.pop_front();
+        }
+    }
+
+    // Only what was counted since the previous sample, the largest latency can only be given since the start.
+    for (std::size_t lIndex = 0; lIndex < cLatencyCount; lIndex++) {
+        const LatencyHistogram& lCurrent{lSnapshot.Latencies.at(lIndex)};
+        const LatencyHistogram& lLast{mLastSnapshot.Latencies.at(lIndex)};
+        LatencyHistogram&       lRecent{mRecentLatencies.at(lIndex)};
+
+        for (std::size_t lBucket = 0; lBucket < cLatencyBuckets; lBucket++) {
+            lRecent.Buckets.at(lBucket) = lCurrent.Buckets.at(lBucket) - lLast.Buckets.at(lBucket);
+        }
+        lRecent.Count = lCurrent.Count - lLast.Count;
+        lRecent.Sum   = lCurrent.Sum - lLast.Sum;
+        lRecent.Max   = lCurrent.Max;
+    }
+
+    mLastSnapshot = lSnapshot;
+}
+
+std::string StatisticsWindow::BuildSparkline(const std::deque<double>& aHistory, std::size_t aWidth) const
+{
+    std::string lReturn{};
+    std::size_t lStart{aHistory.size() > aWidth ? aHistory.size() - aWidth : 0};
+    double      lMax{0};
+
+    for (std::size_t lIndex = lStart; lIndex < aHistory.size(); lIndex++) {
+        lMax = std::max(lMax, aHistory.at(lIndex));
+    }
+
+    for (std::size_t lIndex = lStart; lIndex < aHistory.size(); lIndex++) {
+        std::size_t lLevel{0};
+        if (aHistory.at(lIndex) > 0 && lMax > 0) {
+            // Anything at all gets the lowest visible level.
+            lLevel = 1 + static_cast<std::size_t>(std::floor(aHistory.at(lIndex) / lMax *
+                                                             static_cast<double>(cSparklineLevels.size() - 2)));
+        }
+        lReturn += cSparklineLevels.at(std::min(lLevel, cSparklineLevels.size() - 1));
+    }
+
+    return lReturn;
+}
+
+void StatisticsWindow::BuildLines()
+{
+    WindowModel&       lModel{GetModel()};
+    auto               lWidth{static_cast<std::size_t>(std::max(GetWidthReference() - cTextXCoord - 1, 0))};
+    std::ostringstream lNetwork{};
+
+    mLines.clear();
+
+    lNetwork << cSSIDPrefix << (lModel.mCurrentSSID.empty() ? cUnknownMessage : lModel.mCurrentSSID)
+             << cBSSIDPrefix << (lModel.mCurrentBSSID.empty() ? cUnknownMessage : lModel.mCurrentBSSID)
+             << cChannelPrefix
+             << (lModel.mCurrentChannel > 0 ? std::to_string(lModel.mCurrentChannel) : std::string(cUnknownMessage))
+             << cXLinkKaiPrefix
+             << (lModel.mXLinkKaiConnectionState.empty() ? cUnknownMessage : lModel.mXLinkKaiConnectionState);
+    mLines.emplace_back(lNetwork.str());
+
+    for (std::size_t lIndex = 0; lIndex < cDirections.size(); lIndex++) {
+        std::ostringstream lDirection{};
+        lDirection << cDirections.at(lIndex).Name << std::setw(5) << FormatAmount(mPacketRates.at(lIndex))
+                   << cPacketsUnit << std::setw(5) << FormatAmount(mByteRates.at(lIndex)) << cBytesUnit;
+
+        std::string lLine{lDirection.str()};
+        if (lLine.size() < lWidth) {
+            lLine += BuildSparkline(mPacketRateHistory.at(lIndex), lWidth - lLine.size());
+        }
+        mLines.emplace_back(lLine);
+    }
+
+    std::ostringstream lDrops{};
+    lDrops << cDropsMessage;
+    for (const auto& [lName, lCounter] : cDrops) {
+        lDrops << lName << FormatAmount(static_cast<double>(mLastSnapshot.Get(lCounter)));
+    }
+    mLines.emplace_back(lDrops.str());
+
+    std::ostringstream lLatencies{};
+    lLatencies << cLatencyMessage;
+    for (std::size_t lIndex = 0; lIndex < cLatencyCount; lIndex++) {
+        const LatencyHistogram& lHistogram{mRecentLatencies.at(lIndex)};
+        lLatencies << cLatencyTexts.at(lIndex);
+        if (lHistogram.Count > 0) {
+            lLatencies << FormatLatency(lHistogram.GetPercentile(50)) << "/"
+                       << FormatLatency(lHistogram.GetPercentile(99)) << "/"
+                       << FormatLatency(lHistogram.GetPercentile(99.9));
+        } else {
+            lLatencies << cUnknownMessage;
+        }
+    }
+    mLines.emplace_back(lLatencies.str());
+
+    // Every line covers the full width, so whatever was there before is overwritten.
+    for (auto& lLine : mLines) {
+        lLine.resize(lWidth, ' ');
+    }
+}
+
+void StatisticsWindow::DrawLines()
+{
+    auto lLines{static_cast<std::size_t>(std::max(GetHeightReference() - 2, 0))};
+
+    mDrawnLines.resize(mLines.size());
+    for (std::size_t lLine = 0; lLine < std::min(mLines.size(), lLines); lLine++) {
+        const std::string& lText{mLines.at(lLine)};
+        std::string&       lDrawnText{mDrawnLines.at(lLine)};
+        std::size_t        lColumn{0};
+
+        lDrawnText.resize(lText.size(), '\0');
+        while (lColumn < lText.size()) {
+            if (lText.at(lColumn) == lDrawnText.at(lColumn)) {
+                lColumn++;
+            } else {
+                // Draw the whole run of changed cells at once.
+                std::size_t lEnd{lColumn};
+                while (lEnd < lText.size() && lText.at(lEnd) != lDrawnText.at(lEnd)) {
+                    lEnd++;
+                }
+                DrawString(static_cast<int>(lLine) + 1,
+                           cTextXCoord + static_cast<int>(lColumn),
+                           1,
+                           lText.substr(lColumn, lEnd - lColumn));
+                std::copy(lText.begin() + lColumn, lText.begin() + lEnd, lDrawnText.begin() + lColumn);
+                lColumn = lEnd;
+            }
+        }
+    }
+}
@@ -19,5 +19,8 @@ void String::Draw()
 
 void String::SetColorPair(int aPair)
 {
-    mColorPair = aPair;
+    if (aPair != mColorPair) {
+        mColorPair = aPair;
+        SetDirty(true);
+    }
 }
\ No newline at end of file
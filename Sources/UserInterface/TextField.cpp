@@ -42,6 +42,7 @@ bool TextField::AddToText(char aCharacter)
     if (mTextReference.length() < mLength) {
         mTextReference += aCharacter;
         lReturn = true;
+        SetDirty(true);
     }
 
     return lReturn;
@@ -53,6 +54,7 @@ bool TextField::RemoveCharacter()
 
     if (mTextReference.length() > 0) {
         mTextReference.resize(mTextReference.length() - 1);
+        SetDirty(true);
     }
 
     return lReturn;
@@ -75,7 +77,10 @@ bool TextField::HandleKey(unsigned int aKeyCode)
 
 void TextField::SetSelected(bool aSelected)
 {
-    mSelected = aSelected;
+    if (aSelected != mSelected) {
+        mSelected = aSelected;
+        SetDirty(true);
+    }
 }
 
 bool TextField::IsSelected() const
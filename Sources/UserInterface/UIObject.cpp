@@ -11,7 +11,7 @@ UIObject::UIObject(IWindow&                    aWindow,
                    bool                        aSelectable) :
     mWindow(aWindow),
     mName(aName), mSelectable(aSelectable), mVisible(aVisible), mYCoord(0), mXCoord(0),
-    mScaleCalculation(std::move(aCalculation))
+    mScaleCalculation(std::move(aCalculation)), mDirty(true)
 {
     Dimensions lParameters{mScaleCalculation()};
     mYCoord = lParameters.at(0);
@@ -29,6 +29,9 @@ void UIObject::Scale()
     Dimensions lParameters{mScaleCalculation()};
     mYCoord = lParameters.at(0);
     mXCoord = lParameters.at(1);
+
+    // Scaling clears the window, so always draw again.
+    mDirty = true;
 }
 
 bool UIObject::IsSelected() const
@@ -44,11 +47,14 @@ void UIObject::SetSelected(bool /*aSelected*/)
 
 void UIObject::SetVisible(bool aVisible)
 {
-    mVisible = aVisible;
-
-    // Also clear the line that this is on.
-    if (!mVisible) {
-        mWindow.ClearLine(mYCoord, mWindow.GetSize().second);
+    if (aVisible != mVisible) {
+        mVisible = aVisible;
+        mDirty   = true;
+
+        // Also clear the line that this is on.
+        if (!mVisible) {
+            mWindow.ClearLine(mYCoord, mWindow.GetSize().second);
+        }
     }
 }
 
@@ -69,7 +75,20 @@ std::string_view UIObject::GetName()
 
 void UIObject::SetName(std::string_view aName)
 {
-    mName = aName;
+    if (aName != mName) {
+        mName  = aName;
+        mDirty = true;
+    }
+}
+
+bool UIObject::IsDirty() const
+{
+    return mDirty;
+}
+
+void UIObject::SetDirty(bool aDirty)
+{
+    mDirty = aDirty;
 }
 
 bool UIObject::IsSelectable() const
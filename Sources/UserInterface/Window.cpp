@@ -1,5 +1,6 @@
 #include "../../Includes/UserInterface/Window.h"
 
+#include <algorithm>
 #include <iostream>
 
 #include "../../Includes/Logger.h"
@@ -14,7 +15,8 @@ Window::Window(WindowModel&                       aModel,
                bool                               aVisible) :
     mModel{aModel},
     mTitle{aTitle}, mScaleCalculation(aCalculation), mNCursesWindow{nullptr}, mHeight{0}, mWidth{0},
-    mDrawBorder(aDrawBorder), mExclusive{aExclusive}, mVisible{aVisible}, mSelectedObject{0}, mObjects{}
+    mDrawBorder(aDrawBorder), mExclusive{aExclusive}, mVisible{aVisible}, mSelectedObject{0}, mObjects{},
+    mDirty{true}
 {
     Dimensions lWindowParameters{aCalculation()};
     mHeight        = lWindowParameters.at(0);
@@ -56,6 +58,11 @@ bool Window::HandleKey(unsigned int aKeyCode)
     return lReturn;
 }
 
+void Window::Update()
+{
+    // Base window only shows its objects, which mark themselves dirty.
+}
+
 void Window::Draw()
 {
     if (mDrawBorder) {
@@ -67,16 +74,31 @@ void Window::Draw()
         if (lObject->IsVisible()) {
             lObject->Draw();
         }
+        lObject->SetDirty(false);
     }
 
+    mDirty = false;
     Refresh();
 }
 
+bool Window::IsDirty()
+{
+    return mDirty || std::any_of(mObjects.begin(), mObjects.end(), [](const std::shared_ptr<IUIObject>& aObject) {
+               return aObject->IsDirty();
+           });
+}
+
+void Window::SetDirty(bool aDirty)
+{
+    mDirty = aDirty;
+}
+
 void Window::ClearLine(int aYCoord, int aLength)
 {
     std::string lEmptySpace;
     lEmptySpace.resize(aLength, ' ');
     DrawString(aYCoord, 0, 1, lEmptySpace);
+    mDirty = true;
 }
 
 void Window::DrawString(int aYCoord, int aXCoord, int aColorPair, std::string_view aString)
@@ -93,7 +115,7 @@ void Window::AddObject(std::shared_ptr<IUIObject> aObject)
 
 void Window::Refresh()
 {
-    wrefresh(mNCursesWindow.get());
+    wnoutrefresh(mNCursesWindow.get());
 }
 
 bool Window::Move(int aYCoord, int aXCoord)
@@ -101,7 +123,7 @@ bool Window::Move(int aYCoord, int aXCoord)
     bool lReturn{true};
 
     if (mvwin(mNCursesWindow.get(), aYCoord, aXCoord) == ERR) {
-        Logger::GetInstance().Log("Could not move window to desired spot", Logger::Level::TRACE);
+        Logger::GetInstance().Log<Logger::Level::TRACE>("Could not move window to desired spot");
         lReturn = false;
     }
 
@@ -150,7 +172,7 @@ bool Window::Resize(int aLines, int aColumns)
     bool lReturn{true};
 
     if (wresize(mNCursesWindow.get(), aLines, aColumns) == ERR) {
-        Logger::GetInstance().Log("Could not resize window to desired size", Logger::Level::TRACE);
+        Logger::GetInstance().Log<Logger::Level::TRACE>("Could not resize window to desired size");
         lReturn = false;
     } else {
         // Clear window as to not have artifacts.
@@ -339,6 +361,13 @@ void Window::SetVisible(bool aVisible)
     mVisible = aVisible;
 }
 
+bool Window::IsSelectable()
+{
+    return std::any_of(mObjects.begin(), mObjects.end(), [](const std::shared_ptr<IUIObject>& aObject) {
+        return aObject->IsVisible() && aObject->IsSelectable();
+    });
+}
+
 void Window::ClearWindow()
 {
     std::pair<int, int> lSize{GetSize()};
@@ -4,20 +4,43 @@
 
 #undef MOUSE_MOVED
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
+
+#if not defined(_MSC_VER) && not defined(__MINGW32__)
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#include "../../Includes/Logger.h"
 
 #include "../../Includes/UserInterface/NCursesKeys.h"
 #include "../../Includes/UserInterface/NetworkingWindow.h"
+#include "../../Includes/UserInterface/StatisticsWindow.h"
 #include "../../Includes/UserInterface/XLinkWindow.h"
 
+// The statistics pane has a fixed height, the networking and XLink Kai panes share what is left.
+static int GetNetworkingWindowHeight(const int& aMaxHeight)
+{
+    return static_cast<int>(ceil((aMaxHeight - StatisticsWindow_Constants::cWindowHeight) / 2.0));
+}
+
 Dimensions ScaleNetworkingWindow(const int& aMaxHeight, const int& aMaxWidth)
 {
-    return {0, 0, static_cast<int>(floor(aMaxHeight / 2.0)), aMaxWidth};
+    return {0, 0, GetNetworkingWindowHeight(aMaxHeight), aMaxWidth};
+}
+
+Dimensions ScaleStatisticsWindow(const int& aMaxHeight, const int& aMaxWidth)
+{
+    return {GetNetworkingWindowHeight(aMaxHeight), 0, StatisticsWindow_Constants::cWindowHeight, aMaxWidth};
 }
 
 Dimensions ScaleXLinkWindow(const int& aMaxHeight, const int& aMaxWidth)
 {
-    return {static_cast<int>(floor(aMaxHeight / 2.0)), 0, static_cast<int>(floor(aMaxHeight / 2.0)), aMaxWidth};
+    int lStartY{GetNetworkingWindowHeight(aMaxHeight) + StatisticsWindow_Constants::cWindowHeight};
+    return {lStartY, 0, aMaxHeight - lStartY, aMaxWidth};
 }
 
 Dimensions ScaleSSIDSelectWindow(const int& aMaxHeight, const int& aMaxWidth)
@@ -26,9 +49,21 @@ Dimensions ScaleSSIDSelectWindow(const int& aMaxHeight, const int& aMaxWidth)
 }
 
 WindowController::WindowController(WindowModel& aModel) :
-    mMainCanvas{nullptr}, mHeight{0}, mWidth{0}, mDimensionsChanged{false}, mWindows{}, mExclusiveWindow{false},
-    mWindowSelector{0, nullptr}, mModel{aModel}
-{}
+    mMainCanvas{nullptr}, mHeight{0}, mWidth{0}, mRepaint{false}, mWindows{}, mExclusiveWindow{false},
+    mWindowSelector{0, nullptr}, mModel{aModel}, mEventPipe{-1, -1}
+{
+#if not defined(_MSC_VER) && not defined(__MINGW32__)
+    // Created here instead of in SetUp, so other threads can notify as soon as the controller exists.
+    if (pipe(mEventPipe.data()) == 0) {
+        for (int lDescriptor : mEventPipe) {
+            fcntl(lDescriptor, F_SETFL, fcntl(lDescriptor, F_GETFL) | O_NONBLOCK);
+        }
+    } else {
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Could not create event pipe, only keys wake the interface up");
+        mEventPipe = {-1, -1};
+    }
+#endif
+}
 
 bool WindowController::SetUp()
 {
@@ -57,6 +92,9 @@ bool WindowController::SetUp()
     mWindows.emplace_back(std::make_shared<NetworkingWindow>(
         mModel, "Networking pane:", [&] { return ScaleNetworkingWindow(mHeight, mWidth); }));
 
+    mWindows.emplace_back(std::make_shared<StatisticsWindow>(
+        mModel, "Statistics pane:", [&] { return ScaleStatisticsWindow(mHeight, mWidth); }));
+
     mWindows.emplace_back(
         std::make_shared<XLinkWindow>(mModel, "XLink Kai pane:", [&] { return ScaleXLinkWindow(mHeight, mWidth); }));
 
@@ -68,6 +106,7 @@ bool WindowController::SetUp()
 
     mWindowSelector.second->DeSelect();
     mWindowSelector.second->AdvanceSelectionVertical();
+    mRepaint = true;
 
     return true;
 }
@@ -85,7 +124,7 @@ void WindowController::AdvanceWindow()
                 lIndex = 0;
             }
 
-            if (mWindows.at(lIndex)->IsVisible()) {
+            if (mWindows.at(lIndex)->IsVisible() && mWindows.at(lIndex)->IsSelectable()) {
                 mWindowSelector.second->DeSelect();
                 mWindowSelector = {lIndex, mWindows.at(lIndex)};
                 mWindowSelector.second->DeSelect();
@@ -99,58 +138,89 @@ void WindowController::AdvanceWindow()
     }
 }
 
-bool WindowController::Process()
+bool WindowController::Process(std::chrono::milliseconds aTimeout)
 {
     bool lReturn{true};
-    int  mLastKeyPressed = getch();
-    switch (mLastKeyPressed) {
-        case 'q':
-            lReturn = false;
-            break;
-        case cKeyTab:
-            AdvanceWindow();
-            break;
-        default:
-            mWindowSelector.second->HandleKey(mLastKeyPressed);
-            break;
-    }
-
-    int lHeight{0};
-    int lWidth{0};
+
+    Render();
+    WaitForEvent(aTimeout);
+
+    // Handle every key that came in while waiting, so pasting or key repeat does not lag behind.
+    int lKey{getch()};
+    while (lReturn && lKey != ERR) {
+        switch (lKey) {
+            case 'q':
+                lReturn = false;
+                break;
+            case cKeyTab:
+                AdvanceWindow();
+                break;
+            default:
+                mWindowSelector.second->HandleKey(lKey);
+                break;
+        }
+
+        if (lReturn) {
+            lKey = getch();
+        }
+    }
+
+    return lReturn;
+}
+
+void WindowController::Notify()
+{
+#if not defined(_MSC_VER) && not defined(__MINGW32__)
+    if (mEventPipe.at(1) != -1) {
+        // When the pipe is full Process is going to wake up anyway.
+        char lEvent{0};
+        [[maybe_unused]] ssize_t lWritten{write(mEventPipe.at(1), &lEvent, 1)};
+    }
+#endif
+}
+
+void WindowController::SetDirty()
+{
+    for (auto& lWindow : mWindows) {
+        lWindow->SetDirty(true);
+    }
+}
+
+void WindowController::Render()
+{
+    bool lDrawn{false};
+    int  lHeight{0};
+    int  lWidth{0};
     getmaxyx(mMainCanvas.get(), lHeight, lWidth);
 
     if ((lHeight != mHeight) || (lWidth != mWidth)) {
-        mHeight            = lHeight;
-        mWidth             = lWidth;
-        mDimensionsChanged = true;
+        mHeight  = lHeight;
+        mWidth   = lWidth;
+        mRepaint = true;
     }
 
-    wrefresh(mMainCanvas.get());
+    if (mExclusiveWindow && (!mWindowSelector.second->IsVisible() || !(mWindowSelector.second->IsExclusive()))) {
+        // Whatever the exclusive window was covering has to be drawn again.
+        mExclusiveWindow = false;
+        mRepaint         = true;
+    }
 
-    if (mExclusiveWindow) {
-        if (!mWindowSelector.second->IsVisible() || !(mWindowSelector.second->IsExclusive())) {
-            mExclusiveWindow = false;
-        } else {
-            if (mDimensionsChanged) {
-                mWindowSelector.second->Scale();
-            }
-            mWindowSelector.second->Draw();
-        }
+    if (mRepaint) {
+        // Clear the screen once, every window draws itself again after scaling. The standard screen gets refreshed by
+        // getch, so it is brought up to date here as well, otherwise that would blank the screen afterwards.
+        werase(mMainCanvas.get());
+        wnoutrefresh(stdscr);
+        wnoutrefresh(mMainCanvas.get());
+        lDrawn = true;
     }
 
-    if (!mExclusiveWindow) {
+    if (mExclusiveWindow) {
+        lDrawn = RenderWindow(*mWindowSelector.second) || lDrawn;
+    } else {
         int lIndex{0};
         for (auto& lWindow : mWindows) {
             if (lWindow->IsVisible()) {
-                if (mDimensionsChanged) {
-                    for (int lCount = 0; lCount < mHeight; lCount++) {
-                        std::string lString{};
-                        lString.resize(mWidth, ' ');
-                        mvwaddstr(mMainCanvas.get(), lCount, 0, lString.c_str());
-                    }
-                    lWindow->Scale();
-                }
-                lWindow->Draw();
+                lDrawn = RenderWindow(*lWindow) || lDrawn;
                 if (lWindow->IsExclusive()) {
                     mWindowSelector.first  = lIndex;
                     mWindowSelector.second = lWindow;
@@ -160,13 +230,64 @@ bool WindowController::Process()
         }
     }
 
-    mDimensionsChanged = false;
+    if (lDrawn) {
+        doupdate();
+    }
+
+    mRepaint = false;
     curs_set(0);
+}
+
+bool WindowController::RenderWindow(IWindow& aWindow)
+{
+    bool lReturn{false};
+
+    if (mRepaint) {
+        aWindow.Scale();
+        aWindow.SetDirty(true);
+    }
+
+    aWindow.Update();
+    if (aWindow.IsDirty()) {
+        aWindow.Draw();
+        lReturn = true;
+    }
 
     return lReturn;
 }
 
+void WindowController::WaitForEvent(std::chrono::milliseconds aTimeout)
+{
+    int lTimeout{static_cast<int>(std::clamp<int64_t>(aTimeout.count(), 0, std::numeric_limits<int>::max()))};
+
+#if not defined(_MSC_VER) && not defined(__MINGW32__)
+    std::array<pollfd, 2> lDescriptors{{{STDIN_FILENO, POLLIN, 0}, {mEventPipe.at(0), POLLIN, 0}}};
+
+    // Interrupted by a signal (such as a resize) is just as good as an event.
+    if (poll(lDescriptors.data(), lDescriptors.size(), lTimeout) > 0 && (lDescriptors.at(1).revents & POLLIN) != 0) {
+        std::array<char, 64> lEvents{};
+        while (read(mEventPipe.at(0), lEvents.data(), lEvents.size()) > 0) {}
+    }
+#else
+    // The console has no descriptor to wait on, so wait for a key instead and leave it for Process to handle.
+    wtimeout(stdscr, lTimeout);
+    int lKey{getch()};
+    nodelay(stdscr, true);
+    if (lKey != ERR) {
+        ungetch(lKey);
+    }
+#endif
+}
+
 WindowController::~WindowController()
 {
     endwin();
+
+#if not defined(_MSC_VER) && not defined(__MINGW32__)
+    for (int lDescriptor : mEventPipe) {
+        if (lDescriptor != -1) {
+            close(lDescriptor);
+        }
+    }
+#endif
 }
\ No newline at end of file
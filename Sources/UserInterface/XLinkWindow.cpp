@@ -154,7 +154,7 @@ void XLinkWindow::SetUp()
         *this, cQuitMessage, [&] { return ScaleQQuitString(GetHeightReference(), GetWidthReference()); }));
 }
 
-void XLinkWindow::Draw()
+void XLinkWindow::Update()
 {
     // TODO: Add hiding checkbox object, which allows hiding groups of objects
     // Autodiscover checkbox
@@ -170,12 +170,15 @@ void XLinkWindow::Draw()
     //    }
 
     // TODO: Make some kind of live-updating string or add status string as member variable?
-    // Status field
-    GetObjects().at(6)->SetName(
+    // Status field, only moved when it changes so the window is not drawn again for nothing.
+    std::string lStatus{
         std::string(cStatusPrefix) +
         WindowModel_Constants::cEngineStatusTexts.at(static_cast<unsigned long>(GetModel().mEngineStatus)).data() +
-        " ");
-    GetObjects().at(6)->Scale();
+        " "};
+    if (lStatus != GetObjects().at(6)->GetName()) {
+        GetObjects().at(6)->SetName(lStatus);
+        GetObjects().at(6)->Scale();
+    }
 
     // TODO: Don't have 2 overlapping buttons, instead update name of button and make button action lambda settable.
     // TODO: Also add as member variable maybe?
@@ -194,6 +197,4 @@ void XLinkWindow::Draw()
         }
         mOldEngineStatus = GetModel().mEngineStatus;
     }
-
-    Window::Draw();
 }
\ No newline at end of file
@@ -0,0 +1,250 @@
+#include "../Includes/VirtualMonitorDevice.h"
+
+/* Copyright (c) 2020 [Rick de Bondt] - VirtualMonitorDevice.cpp */
+
+#include <chrono>
+
+#include "../Includes/Logger.h"
+#include "../Includes/Statistics.h"
+
+using namespace MonitorFrameHandler_Constants;
+using namespace Statistics_Constants;
+
+VirtualMonitorDevice::~VirtualMonitorDevice()
+{
+    Close();
+}
+
+bool VirtualMonitorDevice::Open(std::string_view aName, std::vector<std::string>& aSSIDFilter, uint16_t aFrequency)
+{
+    bool lReturn{true};
+    mFrameHandler.SetSSIDFilter(aSSIDFilter);
+    mFrameHandler.SetFrequency(aFrequency);
+
+    if (!aName.empty()) {
+        // Opening again starts the capture file over, so it can be replayed in a loop.
+        if (mHandler != nullptr) {
+            pcap_close(mHandler);
+            mData   = nullptr;
+            mHeader = nullptr;
+        }
+
+        std::array<char, PCAP_ERRBUF_SIZE> lErrorBuffer{};
+        mHandler = pcap_open_offline(std::string(aName).c_str(), lErrorBuffer.data());
+        if (mHandler == nullptr) {
+            lReturn = false;
+            Logger::GetInstance().Log<Logger::Level::ERROR>("pcap_open_offline failed, {}", lErrorBuffer.data());
+        }
+    }
+
+    return lReturn;
+}
+
+void VirtualMonitorDevice::Close()
+{
+    if (mHandler != nullptr) {
+        pcap_close(mHandler);
+        mHandler = nullptr;
+    }
+
+    std::lock_guard<std::mutex> lLock{mInjectionMutex};
+    if (mInjectionDumper != nullptr) {
+        pcap_dump_close(mInjectionDumper);
+        mInjectionDumper = nullptr;
+    }
+
+    if (mInjectionHandler != nullptr) {
+        pcap_close(mInjectionHandler);
+        mInjectionHandler = nullptr;
+    }
+
+    mData   = nullptr;
+    mHeader = nullptr;
+}
+
+bool VirtualMonitorDevice::ReadNextData()
+{
+    bool lReturn{false};
+
+    if (mHandler != nullptr) {
+        if (pcap_next_ex(mHandler, &mHeader, &mData) >= 0) {
+            Receive(std::string_view(reinterpret_cast<const char*>(mData), mHeader->caplen));
+            lReturn = true;
+        }
+    }
+
+    return lReturn;
+}
+
+bool VirtualMonitorDevice::Receive(std::string_view aData)
+{
+    bool lReturn{false};
+    auto lArrival{std::chrono::system_clock::now()};
+
+    // Handled the same way as by WirelessMonitorDevice, minus acknowledgements.
+    if (mFrameHandler.Classify(aData) == FrameType::Data) {
+        if (mFrameHandler.Forward(aData, lArrival)) {
+            mForwardedCount++;
+        }
+        lReturn = true;
+    }
+
+    return lReturn;
+}
+
+const unsigned char* VirtualMonitorDevice::GetData()
+{
+    return mData;
+}
+
+const pcap_pkthdr* VirtualMonitorDevice::GetHeader()
+{
+    return mHeader;
+}
+
+std::string VirtualMonitorDevice::DataToString(const unsigned char* aData, const pcap_pkthdr* aHeader)
+{
+    std::string lData{};
+
+    if ((aData != nullptr) && (aHeader != nullptr)) {
+        lData.assign(reinterpret_cast<const char*>(aData), aHeader->caplen);
+    }
+
+    return lData;
+}
+
+std::string VirtualMonitorDevice::LastDataToString()
+{
+    return DataToString(mData, mHeader);
+}
+
+bool VirtualMonitorDevice::Send(std::string_view aData, IPCapDevice_Constants::WiFiBeaconInformation& aWiFiInformation)
+{
+    return Send(aData, aWiFiInformation, std::chrono::system_clock::time_point{});
+}
+
+bool VirtualMonitorDevice::Send(std::string_view aData, std::chrono::system_clock::time_point aArrival)
+{
+    // Called from the XLink Kai side, while frames may be handled on another thread.
+    IPCapDevice_Constants::WiFiBeaconInformation lWifiInformation{mFrameHandler.GetWifiInformation()};
+    return Send(aData, lWifiInformation, aArrival);
+}
+
+bool VirtualMonitorDevice::Send(std::string_view                              aData,
+                                IPCapDevice_Constants::WiFiBeaconInformation& aWiFiInformation,
+                                std::chrono::system_clock::time_point         aArrival)
+{
+    bool        lReturn{false};
+    std::string lData{mSendConverter.ConvertPacketTo80211(
+        aData, aWiFiInformation.BSSID, aWiFiInformation.Frequency, aWiFiInformation.MaxRate)};
+
+    if (!lData.empty()) {
+        std::lock_guard<std::mutex> lLock{mInjectionMutex};
+        Statistics::GetInstance().Add(Counter::Converted);
+
+        if (aArrival != std::chrono::system_clock::time_point{}) {
+            Statistics::GetInstance().AddLatency(Latency::XLinkKaiToMonitor, aArrival);
+        }
+
+        if (mInjectionDumper != nullptr) {
+            auto        lNow{std::chrono::system_clock::now().time_since_epoch()};
+            pcap_pkthdr lHeader{};
+            lHeader.caplen     = lData.size();
+            lHeader.len        = lData.size();
+            lHeader.ts.tv_sec  = std::chrono::duration_cast<std::chrono::seconds>(lNow).count();
+            lHeader.ts.tv_usec = std::chrono::duration_cast<std::chrono::microseconds>(lNow).count() % 1000000;
+            pcap_dump(reinterpret_cast<u_char*>(mInjectionDumper),
+                      &lHeader,
+                      reinterpret_cast<const u_char*>(lData.data()));
+        }
+
+        if (mInjectCallback != nullptr) {
+            mInjectCallback(lData);
+        }
+
+        mInjectedCount++;
+        Statistics::GetInstance().Add(Counter::Injected);
+        Statistics::GetInstance().Add(Counter::BytesToMonitor, lData.size());
+        lReturn = true;
+
+        if (mFlightRecorder != nullptr) {
+            mFlightRecorder->Record(SessionRecorder_Constants::Direction::ToMonitor, lData);
+        }
+
+        if (mSessionRecorder != nullptr) {
+            mSessionRecorder->Record(SessionRecorder_Constants::Direction::ToMonitor, std::move(lData));
+        }
+    } else {
+        Statistics::GetInstance().Add(Counter::ConversionFailures);
+    }
+
+    return lReturn;
+}
+
+bool VirtualMonitorDevice::Send(std::string_view aData)
+{
+    IPCapDevice_Constants::WiFiBeaconInformation lWifiInformation{mFrameHandler.GetWifiInformation()};
+    return Send(aData, lWifiInformation);
+}
+
+void VirtualMonitorDevice::SetSendReceiveDevice(std::shared_ptr<ISendReceiveDevice> aDevice)
+{
+    mFrameHandler.SetSendReceiveDevice(std::move(aDevice));
+}
+
+void VirtualMonitorDevice::SetBSSID(uint64_t aBSSID)
+{
+    mFrameHandler.SetBSSID(aBSSID);
+}
+
+bool VirtualMonitorDevice::SetInjectionFile(std::string_view aPath)
+{
+    bool                        lReturn{true};
+    std::lock_guard<std::mutex> lLock{mInjectionMutex};
+
+    if (mInjectionHandler == nullptr) {
+        mInjectionHandler = pcap_open_dead(DLT_IEEE802_11_RADIO, 65535);
+    }
+
+    // Setting another file finishes the previous one.
+    if (mInjectionDumper != nullptr) {
+        pcap_dump_close(mInjectionDumper);
+        mInjectionDumper = nullptr;
+    }
+
+    mInjectionDumper = pcap_dump_open(mInjectionHandler, std::string(aPath).c_str());
+    if (mInjectionDumper == nullptr) {
+        Logger::GetInstance().Log<Logger::Level::ERROR>("pcap_dump_open failed, {}", pcap_geterr(mInjectionHandler));
+        lReturn = false;
+    }
+
+    return lReturn;
+}
+
+void VirtualMonitorDevice::SetInjectCallback(VirtualMonitorDevice_Constants::InjectCallback aCallback)
+{
+    std::lock_guard<std::mutex> lLock{mInjectionMutex};
+    mInjectCallback = std::move(aCallback);
+}
+
+void VirtualMonitorDevice::SetSessionRecorder(std::shared_ptr<SessionRecorder> aRecorder)
+{
+    mFrameHandler.SetSessionRecorder(aRecorder);
+    mSessionRecorder = std::move(aRecorder);
+}
+
+void VirtualMonitorDevice::SetFlightRecorder(std::shared_ptr<FlightRecorder> aRecorder)
+{
+    mFrameHandler.SetFlightRecorder(aRecorder);
+    mFlightRecorder = std::move(aRecorder);
+}
+
+uint64_t VirtualMonitorDevice::GetForwardedCount() const
+{
+    return mForwardedCount;
+}
+
+uint64_t VirtualMonitorDevice::GetInjectedCount() const
+{
+    return mInjectedCount;
+}
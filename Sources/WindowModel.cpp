@@ -2,7 +2,10 @@
 
 /* Copyright (c) 2020 [Rick de Bondt] - WindowModel.cpp */
 
+#include <boost/program_options.hpp>
+
 using namespace WindowModel_Constants;
+namespace po = boost::program_options;
 #include <iostream>
 std::string BoolToString(bool aBool)
 {
@@ -37,17 +40,20 @@ bool WindowModel::SaveToFile(std::string_view aPath) const
         lFile << cSaveXLinkPort << ": \"" << mXLinkPort << "\"" << std::endl;
         lFile << cSaveAcknowledgeDataFrames << ": " << BoolToString(mAcknowledgeDataFrames) << std::endl;
         lFile << cSaveOnlyAcceptFromMac << ": \"" << mOnlyAcceptFromMac << "\"" << std::endl;
+        lFile << cSaveAdditionalSessions << ": \"" << mAdditionalSessions << "\"" << std::endl;
+        lFile << cSaveRecordSession << ": " << BoolToString(mRecordSession) << std::endl;
+        lFile << cSaveRecordingPath << ": \"" << mRecordingPath << "\"" << std::endl;
+        lFile << cSaveCompressRecording << ": " << BoolToString(mCompressRecording) << std::endl;
         lFile.close();
 
         if (lFile.good()) {
             lFile.close();
             lReturn = true;
         } else {
-            Logger::GetInstance().Log("Could not save config", Logger::Level::ERROR);
+            Logger::GetInstance().Log<Logger::Level::ERROR>("Could not save config");
         }
     } else {
-        Logger::GetInstance().Log(std::string("Could not open/create config file: ") + aPath.data(),
-                                  Logger::Level::ERROR);
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Could not open/create config file: {}", aPath.data());
     }
 
     return lReturn;
@@ -92,17 +98,22 @@ bool WindowModel::LoadFromFile(std::string_view aPath)
                             mAcknowledgeDataFrames = StringToBool(lResult);
                         } else if (lOption == cSaveOnlyAcceptFromMac) {
                             mOnlyAcceptFromMac = lResult.substr(1, lResult.size() - 2);
+                        } else if (lOption == cSaveAdditionalSessions) {
+                            mAdditionalSessions = lResult.substr(1, lResult.size() - 2);
+                        } else if (lOption == cSaveRecordSession) {
+                            mRecordSession = StringToBool(lResult);
+                        } else if (lOption == cSaveRecordingPath) {
+                            mRecordingPath = lResult.substr(1, lResult.size() - 2);
+                        } else if (lOption == cSaveCompressRecording) {
+                            mCompressRecording = StringToBool(lResult);
                         } else {
-                            Logger::GetInstance().Log(std::string("Option:") + lOption + " unknown",
-                                                      Logger::Level::DEBUG);
+                            Logger::GetInstance().Log<Logger::Level::DEBUG>("Option:{} unknown", lOption);
                         }
                     } else {
-                        Logger::GetInstance().Log(std::string("Option:") + lOption + " has no parameter set",
-                                                  Logger::Level::ERROR);
+                        Logger::GetInstance().Log<Logger::Level::ERROR>("Option:{} has no parameter set", lOption);
                     }
                 } catch (std::exception& aException) {
-                    Logger::GetInstance().Log(std::string("Option could not be read: ") + aException.what(),
-                                              Logger::Level::ERROR);
+                    Logger::GetInstance().Log<Logger::Level::ERROR>("Option could not be read: {}", aException.what());
                 }
             } else {
                 lContinue = false;
@@ -113,12 +124,71 @@ bool WindowModel::LoadFromFile(std::string_view aPath)
         if (lFile.eof()) {
             lReturn = true;
         } else {
-            Logger::GetInstance().Log("Could not save config", Logger::Level::ERROR);
+            Logger::GetInstance().Log<Logger::Level::ERROR>("Could not save config");
         }
     } else {
-        Logger::GetInstance().Log(std::string("Could not open/create config file: ") + aPath.data(),
-                                  Logger::Level::ERROR);
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Could not open/create config file: {}", aPath.data());
+    }
+
+    return lReturn;
+}
+
+std::vector<SessionSetting> WindowModel::GetAdditionalSessions() const
+{
+    std::vector<SessionSetting> lReturn{};
+    std::stringstream           lSessions{mAdditionalSessions};
+    std::string                 lSession{};
+
+    while (std::getline(lSessions, lSession, cSessionSeparator)) {
+        std::stringstream        lFields{lSession};
+        std::string              lField{};
+        std::vector<std::string> lFieldList{};
+
+        while (std::getline(lFields, lField, cSessionFieldSeparator)) {
+            lFieldList.emplace_back(lField);
+        }
+
+        if ((lFieldList.size() >= 2) && !lFieldList.at(0).empty() && !lFieldList.at(1).empty()) {
+            SessionSetting lSetting{lFieldList.at(0), lFieldList.at(1)};
+            if (lFieldList.size() >= 3 && !lFieldList.at(2).empty()) {
+                lSetting.Channel = lFieldList.at(2);
+            }
+            lReturn.emplace_back(lSetting);
+        } else if (!lSession.empty()) {
+            Logger::GetInstance().Log<Logger::Level::ERROR>("Malformed session setting skipped: {}", lSession);
+        }
     }
 
     return lReturn;
 }
+
+void WindowModel::AddCommandLineOptions(po::options_description& aDescription)
+{
+    // No default values, those would overwrite whatever came from the config file.
+    // clang-format off
+    aDescription.add_options()
+        ("log-level", po::value<std::string>()->notifier([this](const std::string& aLevel) {
+            mLogLevel = Logger::ConvertLogLevelStringToLevel(aLevel);
+        }), "Log level: Trace, Debug, Info, Warning or Error")
+        ("auto-discover-psp-vita", po::value<bool>(&mAutoDiscoverPSPVitaNetworks)->implicit_value(true),
+         "Follow PSP and PS Vita networks")
+        ("auto-discover-xlink-kai", po::value<bool>(&mAutoDiscoverXLinkKaiInstance)->implicit_value(true),
+         "Find the XLink Kai instance by broadcasting")
+        ("xlink-kai-hints", po::value<bool>(&mXLinkKaiHints)->implicit_value(true), "Use XLink Kai hints")
+        ("wifi-adapter", po::value<std::string>(&mWifiAdapter), "Wifi adapter to put in monitor mode")
+        ("channel", po::value<std::string>(&mChannel), "Channel to listen on")
+        ("xlink-ip", po::value<std::string>(&mXLinkIp), "IP address of XLink Kai")
+        ("xlink-port", po::value<std::string>(&mXLinkPort), "Port of XLink Kai")
+        ("acknowledge-data-frames", po::value<bool>(&mAcknowledgeDataFrames)->implicit_value(true),
+         "Acknowledge data frames sent to the monitor device")
+        ("only-accept-from-mac", po::value<std::string>(&mOnlyAcceptFromMac),
+         "Only accept frames from this MAC address")
+        ("additional-sessions", po::value<std::string>(&mAdditionalSessions),
+         "Extra sessions as name,adapter,channel entries separated by ;")
+        ("record-session", po::value<bool>(&mRecordSession)->implicit_value(true),
+         "Record the traffic through the bridge")
+        ("recording-path", po::value<std::string>(&mRecordingPath), "Path and prefix of the recordings")
+        ("compress-recording", po::value<bool>(&mCompressRecording)->implicit_value(true),
+         "Compress the recordings with zstd");
+    // clang-format on
+}
@@ -12,14 +12,18 @@
 #include <boost/thread.hpp>
 
 #include "../Includes/Logger.h"
+#include "../Includes/Statistics.h"
+#include "../Includes/ThreadName.h"
 
+using namespace MonitorFrameHandler_Constants;
+using namespace Statistics_Constants;
 using namespace std::chrono;
 
 bool WirelessMonitorDevice::Open(std::string_view aName, std::vector<std::string>& aSSIDFilter, uint16_t aFrequency)
 {
     bool lReturn{true};
-    mSSIDFilter                = std::move(aSSIDFilter);
-    mWifiInformation.Frequency = aFrequency;
+    mFrameHandler.SetSSIDFilter(std::move(aSSIDFilter));
+    mFrameHandler.SetFrequency(aFrequency);
     std::array<char, PCAP_ERRBUF_SIZE> lErrorBuffer{};
 
     mHandler = pcap_create(aName.data(), lErrorBuffer.data());
@@ -33,8 +37,7 @@ bool WirelessMonitorDevice::Open(std::string_view aName, std::vector<std::string
         mConnected = true;
     } else {
         lReturn = false;
-        Logger::GetInstance().Log("pcap_activate failed, " + std::string(pcap_statustostr(lStatus)),
-                                  Logger::Level::ERROR);
+        Logger::GetInstance().Log<Logger::Level::ERROR>("pcap_activate failed, {}", pcap_statustostr(lStatus));
     }
     return lReturn;
 }
@@ -47,22 +50,29 @@ void WirelessMonitorDevice::Close()
         pcap_breakloop(mHandler);
     }
 
-    if (mReceiverThread->joinable()) {
+    if ((mReceiverThread != nullptr) && mReceiverThread->joinable()) {
         mReceiverThread->join();
     }
 
     if (mHandler != nullptr) {
+        UpdateKernelDrops();
         pcap_close(mHandler);
     }
 
-    mHandler               = nullptr;
-    mData                  = nullptr;
-    mHeader                = nullptr;
-    mReceiverThread        = nullptr;
-    mWifiInformation.SSID  = "";
-    mWifiInformation.BSSID = 0;
-    mSourceMACToFilter     = 0;
-    mAcknowledgePackets    = false;
+    mHandler            = nullptr;
+    mData               = nullptr;
+    mHeader             = nullptr;
+    mReceiverThread     = nullptr;
+    mAcknowledgePackets = false;
+    mSessionRecorder    = nullptr;
+    mFlightRecorder     = nullptr;
+    mLastPCapStatistics = {};
+
+    mFrameHandler.SetSourceMACToFilter(0);
+    mFrameHandler.SetSessionRecorder(nullptr);
+    mFrameHandler.SetFlightRecorder(nullptr);
+    mFrameHandler.SetSSID("");
+    mFrameHandler.SetBSSID(0);
 }
 
 bool WirelessMonitorDevice::ReadNextData()
@@ -73,12 +83,14 @@ bool WirelessMonitorDevice::ReadNextData()
     if (lSuccess == 1) {
         lReturn = ReadCallback(mData, mHeader);
     } else if (lSuccess == 0) {
-        Logger::GetInstance().Log("Packet Timeout", Logger::Level::DEBUG);
+        // Happens every read timeout when there is no traffic.
+        static Logger::RateLimit lLimit{};
+        Logger::GetInstance().LogLimited<Logger::Level::DEBUG>(lLimit, "Packet Timeout");
     } else if (lSuccess == -1) {
-        Logger::GetInstance().Log("Error occurred while reading packet: " + std::string(pcap_geterr(mHandler)),
-                                  Logger::Level::DEBUG);
+        Logger::GetInstance().Log<Logger::Level::DEBUG>("Error occurred while reading packet: {}",
+                                                        pcap_geterr(mHandler));
     } else {
-        Logger::GetInstance().Log("Unknown error occurred while reading packet", Logger::Level::DEBUG);
+        Logger::GetInstance().Log<Logger::Level::DEBUG>("Unknown error occurred while reading packet");
     }
 
     return lReturn;
@@ -86,78 +98,60 @@ bool WirelessMonitorDevice::ReadNextData()
 
 bool WirelessMonitorDevice::ReadCallback(const unsigned char* aData, const pcap_pkthdr* aHeader)
 {
-    bool lReturn{false};
-
-    std::string lData = DataToString(aData, aHeader);
-
-    // Load information about this packet into the packet converter
-    mPacketConverter.Update(lData);
+    bool        lReturn{false};
+    Statistics& lStatistics{Statistics::GetInstance()};
 
-    if (mPacketConverter.Is80211Beacon(lData)) {
-        // Try to match SSID to filter list
-        std::string lSSID = mPacketConverter.GetBeaconSSID(lData);
+    std::string              lData = DataToString(aData, aHeader);
+    system_clock::time_point lCaptured{seconds(aHeader->ts.tv_sec) + microseconds(aHeader->ts.tv_usec)};
 
-        for (auto& lFilter : mSSIDFilter) {
-            if (lSSID.find(lFilter) != std::string::npos) {
-                if (lSSID != mWifiInformation.SSID) {
-                    mPacketConverter.FillWiFiInformation(lData, mWifiInformation);
-                    Logger::GetInstance().Log("SSID switched:" + lSSID, Logger::Level::DEBUG);
-                }
-            }
-        }
-    } else if (mPacketConverter.Is80211Data(lData) && mPacketConverter.IsForBSSID(lData, mWifiInformation.BSSID) &&
-               (mSourceMACToFilter == 0 || mPacketConverter.IsFromMac(lData, mSourceMACToFilter))) {
+    if (mFrameHandler.Classify(lData) == FrameType::Data) {
         ++mPacketCount;
 
-        // Don't even bother setting up these strings if loglevel is not trace.
-        if (Logger::GetInstance().GetLogLevel() == Logger::Level::TRACE) {
-            Logger::GetInstance().Log("Packet # " + std::to_string(mPacketCount), Logger::Level::TRACE);
+        Logger::GetInstance().Log<Logger::Level::TRACE>("Packet # {}", mPacketCount);
 
-            // Show the size in bytes of the packet
-            Logger::GetInstance().Log("Packet size: " + std::to_string(aHeader->len) + " bytes", Logger::Level::TRACE);
+        // Show the size in bytes of the packet
+        Logger::GetInstance().Log<Logger::Level::TRACE>("Packet size: {} bytes", aHeader->len);
 
-            // Show Epoch Time
-            Logger::GetInstance().Log(
-                "Epoch time: " + std::to_string(aHeader->ts.tv_sec) + ":" + std::to_string(aHeader->ts.tv_usec),
-                Logger::Level::TRACE);
+        // Show Epoch Time
+        Logger::GetInstance().Log<Logger::Level::TRACE>("Epoch time: {}:{}", aHeader->ts.tv_sec, aHeader->ts.tv_usec);
 
-            // Show a warning if the length captured is different
-            if (aHeader->len != aHeader->caplen) {
-                Logger::GetInstance().Log(
-                    "Capture size different than packet size:" + std::to_string(aHeader->len) + " bytes",
-                    Logger::Level::TRACE);
-            }
+        // Show a warning if the length captured is different
+        if (aHeader->len != aHeader->caplen) {
+            Logger::GetInstance().Log<Logger::Level::TRACE>("Capture size different than packet size:{} bytes",
+                                                            aHeader->len);
         }
 
         // Data is good so save as member
         mData   = aData;
         mHeader = aHeader;
 
-
         if (mAcknowledgePackets) {
+            PacketConverter& lConverter{mFrameHandler.GetConverter()};
+
             // If it's not a broadcast frame, acknowledge the packet.
-            if (mPacketConverter.GetDestinationMac(lData) != 0xFFFFFFFFFFFF) {
-                uint64_t               lUnconvertedSourceMac{mPacketConverter.GetSourceMac(lData)};
+            if (lConverter.GetDestinationMac(lData) != 0xFFFFFFFFFFFF) {
+                uint64_t               lUnconvertedSourceMac{lConverter.GetSourceMac(lData)};
                 // Big- to Little endian
-                lUnconvertedSourceMac = mPacketConverter.SwapMacEndian(lUnconvertedSourceMac);
+                lUnconvertedSourceMac = PacketConverter::SwapMacEndian(lUnconvertedSourceMac);
 
                 std::array<uint8_t, 6> lSourceMac{};
                 memcpy(reinterpret_cast<char*>(lSourceMac.data()), &lUnconvertedSourceMac, sizeof(uint8_t) * 6);
 
-                std::string lAcknowledgementFrame{mPacketConverter.ConstructAcknowledgementFrame(
-                    lSourceMac, mWifiInformation.Frequency, mWifiInformation.MaxRate)};
-                Send(lAcknowledgementFrame, mWifiInformation, false);
+                IPCapDevice_Constants::WiFiBeaconInformation lWifiInformation{mFrameHandler.GetWifiInformation()};
+                std::string lAcknowledgementFrame{lConverter.ConstructAcknowledgementFrame(
+                    lSourceMac, lWifiInformation.Frequency, lWifiInformation.MaxRate)};
+                auto lHandedOver{system_clock::now()};
+                if (Send(lAcknowledgementFrame, lWifiInformation, false)) {
+                    lStatistics.Add(Counter::AcknowledgementsSent);
+                    lStatistics.AddLatency(Latency::Acknowledgement, lHandedOver - lCaptured);
+                }
             }
         }
 
-        if (mSendReceivedData && (mSendReceiveDevice != nullptr) && !mPacketConverter.Is80211QOSRetry(lData)) {
-            std::string lConvertedData = mPacketConverter.ConvertPacketTo8023(lData);
-            if (!lConvertedData.empty()) {
-                mSendReceiveDevice->Send(lConvertedData);
-            }
+        if (mSendReceivedData) {
+            mFrameHandler.Forward(lData, lCaptured);
         }
 
-
         lReturn = true;
     }
 
@@ -196,37 +190,62 @@ std::string WirelessMonitorDevice::LastDataToString()
 
 void WirelessMonitorDevice::SetSSID(std::string_view aSSID)
 {
-    mWifiInformation.SSID = aSSID;
+    mFrameHandler.SetSSID(aSSID);
+}
+
+IPCapDevice_Constants::WiFiBeaconInformation WirelessMonitorDevice::GetWifiInformation()
+{
+    return mFrameHandler.GetWifiInformation();
 }
 
 bool WirelessMonitorDevice::Send(std::string_view                              aData,
                                  IPCapDevice_Constants::WiFiBeaconInformation& aWiFiInformation,
-                                 bool                                          aConvertData)
+                                 bool                                          aConvertData,
+                                 system_clock::time_point                      aArrival)
 {
     bool lReturn{false};
     if (mHandler != nullptr) {
         std::string lData{};
 
         if (aConvertData) {
-            lData = mPacketConverter.ConvertPacketTo80211(
+            lData = mSendConverter.ConvertPacketTo80211(
                 aData, aWiFiInformation.BSSID, aWiFiInformation.Frequency, aWiFiInformation.MaxRate);
+            Statistics::GetInstance().Add(lData.empty() ? Counter::ConversionFailures : Counter::Converted);
         } else {
             lData = aData;
         }
 
         if (!lData.empty()) {
-            Logger::GetInstance().Log("Sent: " + lData, Logger::Level::TRACE);
+            Logger::GetInstance().Log<Logger::Level::TRACE>("Sent: {}", lData);
+
+            if (aArrival != system_clock::time_point{}) {
+                Statistics::GetInstance().AddLatency(Latency::XLinkKaiToMonitor, aArrival);
+            }
 
             if (pcap_sendpacket(mHandler, reinterpret_cast<const unsigned char*>(lData.c_str()), lData.size()) == 0) {
                 lReturn = true;
+
+                // Acknowledgements are counted by the caller.
+                if (aConvertData) {
+                    Statistics::GetInstance().Add(Counter::Injected);
+                    Statistics::GetInstance().Add(Counter::BytesToMonitor, lData.size());
+                }
+
+                if (mFlightRecorder != nullptr) {
+                    mFlightRecorder->Record(SessionRecorder_Constants::Direction::ToMonitor, lData);
+                }
+
+                if (mSessionRecorder != nullptr) {
+                    mSessionRecorder->Record(SessionRecorder_Constants::Direction::ToMonitor, std::move(lData));
+                }
             } else {
-                Logger::GetInstance().Log("pcap_sendpacket failed, " + std::string(pcap_geterr(mHandler)),
-                                          Logger::Level::ERROR);
+                Statistics::GetInstance().Add(Counter::InjectFailures);
+                Logger::GetInstance().Log<Logger::Level::ERROR>("pcap_sendpacket failed, {}", pcap_geterr(mHandler));
             }
         }
     } else {
-        Logger::GetInstance().Log("Cannot send packets on a device that has not been opened yet!",
-                                  Logger::Level::ERROR);
+        Logger::GetInstance().Log<Logger::Level::ERROR>(
+            "Cannot send packets on a device that has not been opened yet!");
     }
 
     return lReturn;
@@ -234,17 +253,37 @@ bool WirelessMonitorDevice::Send(std::string_view                              a
 
 bool WirelessMonitorDevice::Send(std::string_view aData, IPCapDevice_Constants::WiFiBeaconInformation& aWiFiInformation)
 {
-    return Send(aData, mWifiInformation, true);
+    return Send(aData, aWiFiInformation, true);
 }
 
 bool WirelessMonitorDevice::Send(std::string_view aData)
 {
-    return Send(aData, mWifiInformation);
+    // Called from the XLink Kai side, while the receiver thread may be following a new beacon.
+    IPCapDevice_Constants::WiFiBeaconInformation lWifiInformation{GetWifiInformation()};
+    return Send(aData, lWifiInformation);
+}
+
+bool WirelessMonitorDevice::Send(std::string_view aData, system_clock::time_point aArrival)
+{
+    IPCapDevice_Constants::WiFiBeaconInformation lWifiInformation{GetWifiInformation()};
+    return Send(aData, lWifiInformation, true, aArrival);
 }
 
 void WirelessMonitorDevice::SetSendReceiveDevice(std::shared_ptr<ISendReceiveDevice> aDevice)
 {
-    mSendReceiveDevice = aDevice;
+    mFrameHandler.SetSendReceiveDevice(std::move(aDevice));
+}
+
+void WirelessMonitorDevice::SetSessionRecorder(std::shared_ptr<SessionRecorder> aRecorder)
+{
+    mFrameHandler.SetSessionRecorder(aRecorder);
+    mSessionRecorder = std::move(aRecorder);
+}
+
+void WirelessMonitorDevice::SetFlightRecorder(std::shared_ptr<FlightRecorder> aRecorder)
+{
+    mFrameHandler.SetFlightRecorder(aRecorder);
+    mFlightRecorder = std::move(aRecorder);
 }
 
 bool WirelessMonitorDevice::StartReceiverThread()
@@ -254,6 +293,7 @@ bool WirelessMonitorDevice::StartReceiverThread()
         // Run
         if (mReceiverThread == nullptr) {
             mReceiverThread = std::make_shared<boost::thread>([&] {
+                ThreadName_Constants::SetCurrentThreadName("monitor");
                 // If we're receiving data from the receiver thread, send it off as well.
                 bool lSendReceivedDataOld = mSendReceivedData;
                 mSendReceivedData         = true;
@@ -264,31 +304,49 @@ bool WirelessMonitorDevice::StartReceiverThread()
                         lThis->ReadCallback(aPacket, aHeader);
                     };
 
+                auto lLastKernelDropsUpdate{steady_clock::now()};
+
                 while (mConnected && (mHandler != nullptr)) {
                     // Use pcap_dispatch instead of pcap_next_ex so that as many packets as possible will be processed
                     // in a single cycle.
                     if (pcap_dispatch(mHandler, -1, lCallbackFunction, reinterpret_cast<u_char*>(this)) == -1) {
-                        Logger::GetInstance().Log(
-                            "Error occurred while reading packet: " + std::string(pcap_geterr(mHandler)),
-                            Logger::Level::DEBUG);
+                        Logger::GetInstance().Log<Logger::Level::DEBUG>("Error occurred while reading packet: {}",
+                                                                        pcap_geterr(mHandler));
                     }
                     std::this_thread::sleep_for(std::chrono::microseconds(1));
+
+                    if (steady_clock::now() - lLastKernelDropsUpdate > cKernelDropsInterval) {
+                        UpdateKernelDrops();
+                        lLastKernelDropsUpdate = steady_clock::now();
+                    }
                 }
 
                 mSendReceivedData = lSendReceivedDataOld;
             });
         }
     } else {
-        Logger::GetInstance().Log("Can't start receiving without a handler!", Logger::Level::ERROR);
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Can't start receiving without a handler!");
         lReturn = false;
     }
 
     return lReturn;
 }
 
+void WirelessMonitorDevice::UpdateKernelDrops()
+{
+    pcap_stat lStatistics{};
+
+    // The counts from pcap_stats are totals since opening, only what was added since last time gets counted.
+    if (pcap_stats(mHandler, &lStatistics) == 0) {
+        Statistics::GetInstance().Add(Counter::KernelDrops, lStatistics.ps_drop - mLastPCapStatistics.ps_drop);
+        Statistics::GetInstance().Add(Counter::InterfaceDrops, lStatistics.ps_ifdrop - mLastPCapStatistics.ps_ifdrop);
+        mLastPCapStatistics = lStatistics;
+    }
+}
+
 void WirelessMonitorDevice::SetSourceMACToFilter(uint64_t aMac)
 {
-    mSourceMACToFilter = aMac;
+    mFrameHandler.SetSourceMACToFilter(aMac);
 }
 
 void WirelessMonitorDevice::SetAcknowledgePackets(bool aAcknowledge)
@@ -7,8 +7,15 @@
 #include <utility>
 
 #include "../Includes/Logger.h"
+#include "../Includes/Statistics.h"
+#include "../Includes/ThreadName.h"
 
 using namespace boost::asio;
+using namespace Statistics_Constants;
+
+XLinkKaiConnection::XLinkKaiConnection(std::shared_ptr<boost::asio::io_service> aIoService) :
+    mSharedIoService{true}, mIoService{std::move(aIoService)}
+{}
 
 XLinkKaiConnection::~XLinkKaiConnection()
 {
@@ -45,7 +52,7 @@ bool XLinkKaiConnection::Open(std::string_view aIp, unsigned int aPort)
         mIp   = aIp;
         mPort = aPort;
     } catch (const boost::system::system_error& lException) {
-        Logger::GetInstance().Log("Failed to open socket: " + std::string(lException.what()), Logger::Level::ERROR);
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Failed to open socket: {}", lException.what());
         lReturn = false;
     }
 
@@ -56,9 +63,9 @@ bool XLinkKaiConnection::Connect()
 {
     bool lReturn{true};
 
-    if (Send(cConnectString, "")) {
+    if (Send(mConnectString, "")) {
         // Start the timer for receiving a confirmation from XLink Kai.
-        mConnectInitiated = true;
+        mState.store(ConnectionState::Connecting, std::memory_order_release);
         mConnectionTimerStart += (std::chrono::system_clock::now() - mConnectionTimerStart);
     } else {
         // Logging in send function
@@ -68,37 +75,117 @@ bool XLinkKaiConnection::Connect()
 }
 
 bool XLinkKaiConnection::Send(std::string_view aCommand, std::string_view aData)
+{
+    return Send(aCommand, aData, std::chrono::system_clock::time_point{});
+}
+
+bool XLinkKaiConnection::Send(std::string_view                      aCommand,
+                              std::string_view                      aData,
+                              std::chrono::system_clock::time_point aArrival)
 {
     bool lReturn{true};
 
     // We only allow connection/disconnection requests to be sent, when XLink Kai has not confirmed the connection yet.
     if (mSocket.is_open()) {
-        if ((mConnected || aCommand == cConnectString || aCommand == cDisconnectString)) {
-            try {
-                Logger::GetInstance().Log("Sent: " + std::string(aCommand) + std::string(aData), Logger::Level::TRACE);
-                mSocket.send_to(buffer(std::string(aCommand) + std::string(aData)), mRemote);
-            } catch (const boost::system::system_error& lException) {
-                Logger::GetInstance().Log(
-                    "Could not send message! " + std::string(aData) + std::string(lException.what()),
-                    Logger::Level::ERROR);
-                lReturn = false;
-            }
+        if ((mState.load(std::memory_order_acquire) == ConnectionState::Connected) || aCommand == mConnectString ||
+            aCommand == cDisconnectString) {
+            lReturn = SendToSocket(aCommand, aData, aArrival);
+        } else if (aCommand == cEthernetDataString) {
+            lReturn = QueuePreConnectFrame(aData, aArrival);
         } else {
-            Logger::GetInstance().Log("No other messages before Xlink Kai has connected!", Logger::Level::DEBUG);
+            static Logger::RateLimit lLimit{};
+            Logger::GetInstance().LogLimited<Logger::Level::DEBUG>(lLimit,
+                                                                   "No other messages before Xlink Kai has connected!");
             lReturn = false;
         }
     } else {
-        Logger::GetInstance().Log("Could not send message on closed socket.", Logger::Level::DEBUG);
+        static Logger::RateLimit lLimit{};
+        Logger::GetInstance().LogLimited<Logger::Level::DEBUG>(lLimit, "Could not send message on closed socket.");
         lReturn = false;
     }
     return lReturn;
 }
 
+bool XLinkKaiConnection::SendToSocket(std::string_view                      aCommand,
+                                      std::string_view                      aData,
+                                      std::chrono::system_clock::time_point aArrival)
+{
+    bool lReturn{true};
+
+    try {
+        Logger::GetInstance().Log<Logger::Level::TRACE>("Sent: {}{}", aCommand, aData);
+        if (aArrival != std::chrono::system_clock::time_point{}) {
+            Statistics::GetInstance().AddLatency(Latency::MonitorToXLinkKai, aArrival);
+        }
+        mSocket.send_to(buffer(std::string(aCommand) + std::string(aData)), mRemote);
+    } catch (const boost::system::system_error& lException) {
+        static Logger::RateLimit lLimit{};
+        Logger::GetInstance().LogLimited<Logger::Level::ERROR>(
+            lLimit, "Could not send message! {}{}", aData, lException.what());
+        lReturn = false;
+    }
+
+    return lReturn;
+}
+
+bool XLinkKaiConnection::QueuePreConnectFrame(std::string_view aData, std::chrono::system_clock::time_point aArrival)
+{
+    bool                        lReturn{true};
+    std::lock_guard<std::mutex> lLock{mPreConnectQueueMutex};
+
+    // The connection may have come up since the caller checked. It is only marked connected once the queue has been
+    // flushed under this lock, so sending right away cannot overtake queued frames.
+    ConnectionState lState{mState.load(std::memory_order_acquire)};
+    if (lState == ConnectionState::Connected) {
+        lReturn = Send(cEthernetDataString, aData, aArrival);
+    } else if (lState == ConnectionState::Closing) {
+        Statistics::GetInstance().Add(Counter::QueueDrops);
+        static Logger::RateLimit lLimit{};
+        Logger::GetInstance().LogLimited<Logger::Level::DEBUG>(lLimit,
+                                                               "Dropped frame, connection to XLink Kai is closing");
+        lReturn = false;
+    } else {
+        if (mPreConnectQueue.size() >= cPreConnectQueueSize) {
+            mPreConnectQueue.pop_front();
+            Statistics::GetInstance().Add(Counter::QueueDrops);
+            static Logger::RateLimit lLimit{};
+            Logger::GetInstance().LogLimited<Logger::Level::DEBUG>(lLimit,
+                                                                   "Pre-connect queue full, dropped oldest frame");
+        }
+        mPreConnectQueue.emplace_back(aData, aArrival);
+    }
+
+    return lReturn;
+}
+
+void XLinkKaiConnection::FlushPreConnectQueue()
+{
+    std::lock_guard<std::mutex> lLock{mPreConnectQueueMutex};
+
+    if (!mPreConnectQueue.empty()) {
+        Logger::GetInstance().Log<Logger::Level::DEBUG>("Sending {} frames queued while connecting",
+                                                        mPreConnectQueue.size());
+    }
+
+    for (auto& [lFrame, lArrival] : mPreConnectQueue) {
+        SendToSocket(cEthernetDataString, lFrame, lArrival);
+    }
+    mPreConnectQueue.clear();
+
+    // Until now frames kept being queued behind the ones just sent, from here on they are sent right away.
+    mState.store(ConnectionState::Connected, std::memory_order_release);
+}
+
 bool XLinkKaiConnection::Send(std::string_view aData)
 {
     return Send(cEthernetDataString, aData);
 }
 
+bool XLinkKaiConnection::Send(std::string_view aData, std::chrono::system_clock::time_point aArrival)
+{
+    return Send(cEthernetDataString, aData, aArrival);
+}
+
 bool XLinkKaiConnection::HandleKeepAlive()
 {
     bool lReturn{true};
@@ -124,55 +211,65 @@ bool XLinkKaiConnection::ReadNextData()
 
 void XLinkKaiConnection::ReceiveCallback(const boost::system::error_code& aError, size_t aBytesReceived)
 {
-    std::string lData{mData.begin(), mData.begin() + aBytesReceived};
+    std::string_view lData{mData.data(), aBytesReceived};
+    auto             lArrival{std::chrono::system_clock::now()};
 
     // If we actually received anything useful, react.
     if (!lData.empty()) {
-        Logger::GetInstance().Log("Received: " + lData, Logger::Level::TRACE);
-        std::size_t lFirstSeparator{lData.find(cSeparator)};
-        std::string lCommand{lData.substr(0, lFirstSeparator + 1)};
-
-
-        if (!mConnected && (lCommand == std::string(cConnectedFormat) + cSeparator.data())) {
-            lCommand = lData.substr(0, cConnectedString.size());
-            if (lCommand == cConnectedString) {
-                Logger::GetInstance().Log("XLink Kai succesfully connected: " + lCommand, Logger::Level::INFO);
-                mConnectInitiated = false;
-                mConnected        = true;
-            }
-        }
-
-        // If no connection confirmation has been sent on XLink Kai's side, Don't care about any other message yet
-        if (mConnected) {
-            if (lCommand == cKeepAliveString) {
-                HandleKeepAlive();
-            } else if (lCommand == std::string(cEthernetDataFormat) + cSeparator.data()) {
-                // For data XLink Kai uses e;e; which doesn't filter all that well, so if we find e; just check if this
-                // is e;e;
-                lCommand = lData.substr(0, cEthernetDataString.size());
-                if (lCommand == cEthernetDataString) {
-                    if (mSendReceiveDevice != nullptr) {
-                        // Strip e;e;
-                        lData =
-                            lData.substr(cEthernetDataString.length(), lData.length() - cEthernetDataString.length());
-                        mEthernetData = lData;
-                        mSendReceiveDevice->Send(lData);
+        Logger::GetInstance().Log<Logger::Level::TRACE>("Received: {}", lData);
+
+        // Until XLink Kai has confirmed the connection, only the connection confirmation is of interest
+        switch (ParseCommand(lData)) {
+            case Command::EthernetData:
+                if ((mState.load(std::memory_order_acquire) == ConnectionState::Connected) &&
+                    (mSendReceiveDevice != nullptr)) {
+                    // Strip e;e;
+                    lData.remove_prefix(GetCommandPrefix(Command::EthernetData).size());
+                    mEthernetData.assign(lData);
+                    Statistics::GetInstance().Add(Counter::ReceivedFromXLinkKai);
+                    mSendReceiveDevice->Send(lData, lArrival);
+                }
+                break;
+            case Command::KeepAlive:
+                if (mState.load(std::memory_order_acquire) == ConnectionState::Connected) {
+                    HandleKeepAlive();
+                }
+                break;
+            case Command::Connected:
+                if ((mState.load(std::memory_order_acquire) == ConnectionState::Connecting) &&
+                    lData.starts_with(mConnectedString)) {
+                    Logger::GetInstance().Log<Logger::Level::INFO>("XLink Kai succesfully connected: {}",
+                                                                   mConnectedString);
+                    if (mConnectedBefore) {
+                        Statistics::GetInstance().Add(Counter::XLinkKaiReconnects);
                     }
+                    mConnectedBefore = true;
+                    FlushPreConnectQueue();
                 }
-            } else if (lCommand == std::string(cDisconnectedFormat) + cSeparator.data()) {
-                lCommand = lData.substr(0, cDisconnectedString.size());
-                if (lCommand == cDisconnectedString) {
-                    Logger::GetInstance().Log("Xlink Kai has disconnected us! " + lCommand, Logger::Level::ERROR);
-                    mConnected = false;
+                break;
+            case Command::Disconnected:
+                if ((mState.load(std::memory_order_acquire) == ConnectionState::Connected) &&
+                    lData.starts_with(mDisconnectedString)) {
+                    Logger::GetInstance().Log<Logger::Level::ERROR>("Xlink Kai has disconnected us! {}",
+                                                                    mDisconnectedString);
+                    mState.store(ConnectionState::Disconnected, std::memory_order_release);
                 }
-            }
+                break;
+            case Command::Setting:
+            case Command::Chat:
+            case Command::Unknown:
+                // Not supported (yet).
+                break;
         }
     }
 
-    StartReceiverThread();
+    // When the socket gets closed the pending receive is aborted, don't queue a new one then.
+    if (aError != boost::asio::error::operation_aborted) {
+        StartReceiving();
+    }
 }
 
-bool XLinkKaiConnection::StartReceiverThread()
+bool XLinkKaiConnection::StartReceiving()
 {
     bool lReturn{true};
     if (mSocket.is_open()) {
@@ -181,48 +278,71 @@ bool XLinkKaiConnection::StartReceiverThread()
             mRemote,
             boost::bind(
                 &XLinkKaiConnection::ReceiveCallback, this, placeholders::error, placeholders::bytes_transferred));
-        // Run
-        if (mReceiverThread == nullptr) {
-            mReceiverThread = std::make_shared<boost::thread>([&] {
-                mIoService.restart();
-                while (!mIoService.stopped()) {
-                    if ((!mConnected && !mConnectInitiated)) {
-                        // Lost connection somewhere, reconnect.
-                        Connect();
-                        std::this_thread::sleep_for(std::chrono::seconds(1));
-                    } else if ((!mConnected) && mConnectInitiated &&
-                               (std::chrono::system_clock::now() > (mConnectionTimerStart + cConnectionTimeout))) {
-                        Logger::GetInstance().Log("Timeout waiting for XLink Kai to connect", Logger::Level::ERROR);
-                        mIoService.stop();
-                        mConnectInitiated = false;
-                        mConnected        = false;
-                    } else {
-                        mIoService.poll();
-                        std::this_thread::sleep_for(std::chrono::microseconds(1));
-                    }
-                }
-            });
-        }
     } else {
-        Logger::GetInstance().Log("Can't start receiving without an opened socket!", Logger::Level::ERROR);
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Can't start receiving without an opened socket!");
         lReturn = false;
     }
 
     return lReturn;
 }
 
+bool XLinkKaiConnection::UpdateConnectionState()
+{
+    bool lReturn{true};
+    auto lNow{std::chrono::system_clock::now()};
+
+    ConnectionState lState{mState.load(std::memory_order_acquire)};
+
+    if (lState == ConnectionState::Disconnected) {
+        // Lost connection somewhere, reconnect.
+        if (lNow > (mLastConnectAttempt + cReconnectInterval)) {
+            mLastConnectAttempt = lNow;
+            Logger::GetInstance().Log<Logger::Level::DEBUG>("Connecting to XLink Kai as {}", mLocallyUniqueName);
+            Connect();
+        }
+    } else if ((lState == ConnectionState::Connecting) && (lNow > (mConnectionTimerStart + cConnectionTimeout))) {
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Timeout waiting for XLink Kai to connect");
+        mState.store(ConnectionState::Disconnected, std::memory_order_release);
+        lReturn = false;
+    }
+
+    return lReturn;
+}
+
+bool XLinkKaiConnection::StartReceiverThread()
+{
+    bool lReturn{StartReceiving()};
+
+    // A shared event loop is run by whoever owns it.
+    if (lReturn && !mSharedIoService && (mReceiverThread == nullptr)) {
+        mReceiverThread = std::make_shared<boost::thread>([&] {
+            ThreadName_Constants::SetCurrentThreadName("xlink-kai");
+            mIoService->restart();
+            while (!mIoService->stopped()) {
+                if (UpdateConnectionState()) {
+                    mIoService->poll();
+                    std::this_thread::sleep_for(std::chrono::microseconds(1));
+                } else {
+                    mIoService->stop();
+                }
+            }
+        });
+    }
+
+    return lReturn;
+}
+
 void XLinkKaiConnection::Close()
 {
     try {
-        if (mConnected || mConnectInitiated) {
+        ConnectionState lState{mState.exchange(ConnectionState::Closing, std::memory_order_acq_rel)};
+        if ((lState == ConnectionState::Connected) || (lState == ConnectionState::Connecting)) {
             Send(cDisconnectString, "");
-            mConnected        = false;
-            mConnectInitiated = false;
         }
 
         if (mReceiverThread != nullptr) {
-            if (!mIoService.stopped()) {
-                mIoService.stop();
+            if (!mIoService->stopped()) {
+                mIoService->stop();
             }
             mReceiverThread->join();
             mReceiverThread = nullptr;
@@ -231,6 +351,12 @@ void XLinkKaiConnection::Close()
         if (mSocket.is_open()) {
             mSocket.close();
         }
+
+        {
+            std::lock_guard<std::mutex> lLock{mPreConnectQueueMutex};
+            mPreConnectQueue.clear();
+        }
+        mState.store(ConnectionState::Disconnected, std::memory_order_release);
     } catch (...) {
         std::cout << "Failed to disconnect :( " + boost::current_exception_diagnostic_information() << std::endl;
     }
@@ -251,6 +377,26 @@ void XLinkKaiConnection::SetPort(unsigned int aPort)
     mPort = aPort;
 }
 
+void XLinkKaiConnection::SetLocallyUniqueName(std::string_view aLocallyUniqueName, std::string_view aEmulatorName)
+{
+    mLocallyUniqueName = aLocallyUniqueName;
+
+    mConnectString = std::string(cConnectFormat) + cSeparator.data() + mLocallyUniqueName + cSeparator.data() +
+                     std::string(aEmulatorName) + cSeparator.data();
+    mConnectedString    = std::string(cConnectedFormat) + cSeparator.data() + mLocallyUniqueName;
+    mDisconnectedString = std::string(cDisconnectedFormat) + cSeparator.data() + mLocallyUniqueName;
+}
+
+ConnectionState XLinkKaiConnection::GetConnectionState() const
+{
+    return mState.load(std::memory_order_acquire);
+}
+
+const std::string& XLinkKaiConnection::GetLocallyUniqueName() const
+{
+    return mLocallyUniqueName;
+}
+
 void XLinkKaiConnection::SetSendReceiveDevice(std::shared_ptr<ISendReceiveDevice> aDevice)
 {
     mSendReceiveDevice = aDevice;
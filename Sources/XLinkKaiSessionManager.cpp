@@ -0,0 +1,99 @@
+#include "../Includes/XLinkKaiSessionManager.h"
+
+/* Copyright (c) 2020 [Rick de Bondt] - XLinkKaiSessionManager.cpp */
+
+#include <algorithm>
+
+#include "../Includes/Logger.h"
+#include "../Includes/ThreadName.h"
+
+using namespace XLinkKaiSessionManager_Constants;
+
+XLinkKaiSessionManager::~XLinkKaiSessionManager()
+{
+    Close();
+}
+
+std::shared_ptr<XLinkKaiConnection> XLinkKaiSessionManager::AddSession(std::string_view aLocallyUniqueName)
+{
+    std::shared_ptr<XLinkKaiConnection> lReturn{nullptr};
+
+    bool lNameInUse{std::any_of(mSessions.begin(), mSessions.end(), [&](const auto& aSession) {
+        return aSession->GetLocallyUniqueName() == aLocallyUniqueName;
+    })};
+
+    if (mReceiverThread != nullptr) {
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Cannot add sessions while the receiver thread is running");
+    } else if (lNameInUse) {
+        Logger::GetInstance().Log<Logger::Level::ERROR>("XLink Kai session name already in use: {}",
+                                                        aLocallyUniqueName);
+    } else {
+        lReturn = std::make_shared<XLinkKaiConnection>(mIoService);
+        lReturn->SetLocallyUniqueName(aLocallyUniqueName);
+        mSessions.emplace_back(lReturn);
+    }
+
+    return lReturn;
+}
+
+const std::vector<std::shared_ptr<XLinkKaiConnection>>& XLinkKaiSessionManager::GetSessions() const
+{
+    return mSessions;
+}
+
+bool XLinkKaiSessionManager::StartReceiverThread()
+{
+    bool lReturn{true};
+
+    if (mReceiverThread == nullptr) {
+        mIoService->restart();
+
+        for (auto& lSession : mSessions) {
+            if (!lSession->StartReceiving()) {
+                lReturn = false;
+            }
+        }
+
+        mReceiverThread = std::make_shared<boost::thread>([&] {
+            ThreadName_Constants::SetCurrentThreadName("xlink-sessions");
+            // Keep the event loop alive, even when no receive is pending for a short moment.
+            auto lWorkGuard{boost::asio::make_work_guard(*mIoService)};
+
+            while (!mIoService->stopped()) {
+                // A timed out session will simply try to reconnect on the next pass, the others are unaffected.
+                for (auto& lSession : mSessions) {
+                    lSession->UpdateConnectionState();
+                }
+                mIoService->run_for(cStateCheckInterval);
+            }
+        });
+    }
+
+    return lReturn;
+}
+
+void XLinkKaiSessionManager::Close()
+{
+    try {
+        if (mReceiverThread != nullptr) {
+            if (!mIoService->stopped()) {
+                mIoService->stop();
+            }
+            mReceiverThread->join();
+            mReceiverThread = nullptr;
+        }
+
+        for (auto& lSession : mSessions) {
+            lSession->Close();
+        }
+
+        // Let the aborted receives finish while the sessions are still around.
+        mIoService->restart();
+        mIoService->poll();
+
+        mSessions.clear();
+    } catch (...) {
+        Logger::GetInstance().Log<Logger::Level::ERROR>("Failed to close XLink Kai sessions: {}",
+                                                        boost::current_exception_diagnostic_information());
+    }
+}
@@ -0,0 +1,179 @@
+#include "../Includes/ZstdStream.h"
+
+/* Copyright (c) 2020 [Rick de Bondt] - ZstdStream.cpp */
+
+#include <algorithm>
+
+#if defined(HAVE_ZSTD)
+#include <zstd.h>
+#endif
+
+#include "../Includes/Logger.h"
+
+ZstdCompressor::~ZstdCompressor()
+{
+    Close();
+}
+
+bool ZstdCompressor::IsAvailable()
+{
+#if defined(HAVE_ZSTD)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool ZstdCompressor::IsCompressedPath(std::string_view aPath)
+{
+    return aPath.ends_with(ZstdStream_Constants::cExtension);
+}
+
+bool ZstdCompressor::Open(int aLevel)
+{
+    bool lReturn{false};
+
+#if defined(HAVE_ZSTD)
+    if (mContext == nullptr) {
+        mContext = ZSTD_createCCtx();
+    } else {
+        ZSTD_CCtx_reset(mContext, ZSTD_reset_session_only);
+    }
+
+    lReturn = (mContext != nullptr) &&
+              !ZSTD_isError(ZSTD_CCtx_setParameter(mContext, ZSTD_c_compressionLevel, aLevel));
+#else
+    (void) aLevel;
+    Logger::GetInstance().Log<Logger::Level::ERROR>("Built without zstd support, cannot compress");
+#endif
+
+    return lReturn;
+}
+
+void ZstdCompressor::Close()
+{
+#if defined(HAVE_ZSTD)
+    ZSTD_freeCCtx(mContext);
+#endif
+    mContext = nullptr;
+}
+
+bool ZstdCompressor::Compress(std::string_view aData, std::string& aOutput, bool aFinish)
+{
+    bool lReturn{mContext != nullptr};
+
+#if defined(HAVE_ZSTD)
+    ZSTD_inBuffer     lInput{aData.data(), aData.size(), 0};
+    ZSTD_EndDirective lMode{aFinish ? ZSTD_e_end : ZSTD_e_flush};
+    std::size_t       lRemaining{1};
+
+    // With flush and end zstd reports how much it still has to write out, 0 means all input has been written.
+    while (lReturn && (lRemaining != 0)) {
+        std::size_t lStart{aOutput.size()};
+        aOutput.resize(lStart + ZSTD_CStreamOutSize());
+
+        ZSTD_outBuffer lOutput{aOutput.data() + lStart, ZSTD_CStreamOutSize(), 0};
+        lRemaining = ZSTD_compressStream2(mContext, &lOutput, &lInput, lMode);
+        aOutput.resize(lStart + lOutput.pos);
+
+        if (ZSTD_isError(lRemaining)) {
+            Logger::GetInstance().Log<Logger::Level::ERROR>("zstd compression failed, {}",
+                                                            ZSTD_getErrorName(lRemaining));
+            lReturn = false;
+        }
+    }
+#else
+    (void) aData;
+    (void) aOutput;
+    (void) aFinish;
+#endif
+
+    return lReturn;
+}
+
+ZstdDecompressor::~ZstdDecompressor()
+{
+    Close();
+}
+
+bool ZstdDecompressor::Open(std::string_view aInput)
+{
+    bool lReturn{false};
+
+    mInput         = aInput;
+    mInputPosition = 0;
+    mFrameDone     = true;
+
+#if defined(HAVE_ZSTD)
+    if (mContext == nullptr) {
+        mContext = ZSTD_createDCtx();
+    } else {
+        ZSTD_DCtx_reset(mContext, ZSTD_reset_session_only);
+    }
+    lReturn = mContext != nullptr;
+#else
+    Logger::GetInstance().Log<Logger::Level::ERROR>("Built without zstd support, cannot decompress");
+#endif
+
+    return lReturn;
+}
+
+void ZstdDecompressor::Close()
+{
+#if defined(HAVE_ZSTD)
+    ZSTD_freeDCtx(mContext);
+#endif
+    mContext       = nullptr;
+    mInput         = {};
+    mInputPosition = 0;
+    mFrameDone     = true;
+}
+
+bool ZstdDecompressor::Decompress(char* aOutput, std::size_t aCapacity, std::size_t& aProduced)
+{
+    bool lReturn{mContext != nullptr};
+
+    aProduced = 0;
+
+#if defined(HAVE_ZSTD)
+    ZSTD_inBuffer  lInput{mInput.data(), mInput.size(), mInputPosition};
+    ZSTD_outBuffer lOutput{aOutput, aCapacity, 0};
+
+    // A call can take input without giving output yet, so keep going until the output is full or the data ends.
+    while (lReturn && (lOutput.pos < lOutput.size) && !((lInput.pos == lInput.size) && mFrameDone)) {
+        std::size_t lInputBefore{lInput.pos};
+        std::size_t lOutputBefore{lOutput.pos};
+        std::size_t lResult{ZSTD_decompressStream(mContext, &lOutput, &lInput)};
+
+        if (ZSTD_isError(lResult)) {
+            Logger::GetInstance().Log<Logger::Level::ERROR>("zstd decompression failed, {}",
+                                                            ZSTD_getErrorName(lResult));
+            lReturn = false;
+        } else {
+            mFrameDone = (lResult == 0);
+
+            if ((lInput.pos == lInputBefore) && (lOutput.pos == lOutputBefore)) {
+                Logger::GetInstance().Log<Logger::Level::WARNING>("Compressed data ends in the middle of a frame");
+                mInputPosition = lInput.size;
+                mFrameDone     = true;
+                break;
+            }
+        }
+    }
+
+    if (lReturn) {
+        mInputPosition = std::max(mInputPosition, lInput.pos);
+        aProduced      = lOutput.pos;
+    }
+#else
+    (void) aOutput;
+    (void) aCapacity;
+#endif
+
+    return lReturn;
+}
+
+bool ZstdDecompressor::IsFinished() const
+{
+    return (mInputPosition >= mInput.size()) && mFrameDone;
+}
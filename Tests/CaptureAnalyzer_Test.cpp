@@ -0,0 +1,138 @@
+/* Copyright (c) 2020 [Rick de Bondt] - CaptureAnalyzer_Test.cpp
+ * This file contains tests for the CaptureAnalyzer class.
+ **/
+
+#include "../Includes/CaptureAnalyzer.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include "../Includes/PCapNGWriter.h"
+
+using namespace CaptureAnalyzer_Constants;
+using namespace std::chrono;
+
+namespace
+{
+    // Radiotap header with only an antenna signal, followed by a data frame to the access point.
+    std::string MakeDataFrame(uint16_t aSequence, bool aRetry)
+    {
+        std::string lReturn{"\x00\x00\x09\x00\x20\x00\x00\x00\xd8", 9};
+        lReturn += std::string{"\x08\x01\x00\x00", 4};  // Data, to DS
+        lReturn[10] = static_cast<char>(aRetry ? 0x09 : 0x01);
+        lReturn += std::string{"\x62\x58\xc5\x07\x95\x5e", 6};  // BSSID
+        lReturn += std::string{"\x01\x23\x45\x67\xab\xcd", 6};  // Transmitter
+        lReturn += std::string{"\xff\xff\xff\xff\xff\xff", 6};  // Destination
+        lReturn += static_cast<char>(aSequence & 0xffU);
+        lReturn += static_cast<char>(aSequence >> 8U);
+        lReturn += "payload";
+        return lReturn;
+    }
+}  // namespace
+
+// Everything that crosses chunk boundaries has to come out the same as when the capture is scanned in one go.
+TEST(CaptureAnalyzerTest, ChunksMatchSingleThread)
+{
+    Settings lSettings{};
+    lSettings.Threads   = 1;
+    lSettings.ChunkSize = 1000;
+
+    CaptureAnalyzer lSingle{lSettings};
+    ASSERT_TRUE(lSingle.Analyze("../Tests/Input/MonitorHelloWorld.pcapng"));
+
+    lSettings.Threads   = 4;
+    lSettings.ChunkSize = 3;
+
+    CaptureAnalyzer lChunked{lSettings};
+    ASSERT_TRUE(lChunked.Analyze("../Tests/Input/MonitorHelloWorld.pcapng"));
+
+    const Report& lExpected{lSingle.GetReport()};
+    const Report& lResult{lChunked.GetReport()};
+    EXPECT_EQ(lExpected.Chunks, 1);
+    EXPECT_EQ(lResult.Chunks, (305 + 2) / 3);
+    EXPECT_EQ(lResult.Frames, 305);
+    EXPECT_EQ(lResult.Frames, lExpected.Frames);
+    EXPECT_EQ(lResult.Bytes, lExpected.Bytes);
+    EXPECT_EQ(lResult.WirelessFrames, lExpected.WirelessFrames);
+    EXPECT_EQ(lResult.Retries, lExpected.Retries);
+    EXPECT_EQ(lResult.Duplicates, lExpected.Duplicates);
+    EXPECT_EQ(lResult.MaxInterval, lExpected.MaxInterval);
+    EXPECT_EQ(lResult.Intervals, lExpected.Intervals);
+    EXPECT_EQ(lResult.Signals, lExpected.Signals);
+    EXPECT_EQ(lResult.Stations.size(), lExpected.Stations.size());
+    EXPECT_EQ(lResult.BSSIDs.size(), lExpected.BSSIDs.size());
+    EXPECT_EQ(lResult.Gaps.size(), lExpected.Gaps.size());
+    EXPECT_GT(lResult.FrameTypes.count(Net_80211_Constants::cBeaconType >> 4U), 0);
+}
+
+TEST(CaptureAnalyzerTest, Promiscuous)
+{
+    CaptureAnalyzer lAnalyzer{Settings{}};
+    ASSERT_TRUE(lAnalyzer.Analyze("../Tests/Input/PromiscuousHelloWorld.pcapng"));
+
+    const Report& lReport{lAnalyzer.GetReport()};
+    uint64_t      lFrames{0};
+    for (const auto& [lFrameType, lCounters] : lReport.FrameTypes) {
+        EXPECT_NE(lFrameType & cEtherTypeFlag, 0);
+        lFrames += lCounters.Frames;
+    }
+
+    EXPECT_EQ(lReport.Frames, 12);
+    EXPECT_EQ(lFrames, lReport.Frames);
+    EXPECT_EQ(lReport.WirelessFrames, 0);
+    EXPECT_TRUE(lReport.BSSIDs.empty());
+    EXPECT_EQ(CaptureAnalyzer::GetFrameTypeName(cEtherTypeFlag | 0x0800), "EtherType 0x0800");
+}
+
+// A retry of a frame in the chunk before is a duplicate, and so is the silence that starts in the chunk before a gap.
+TEST(CaptureAnalyzerTest, DuplicatesAndGapsAcrossChunks)
+{
+    std::string lCapture{};
+    PCapNGWriter::AppendSectionHeader(lCapture);
+    PCapNGWriter::AppendInterface(lCapture, DLT_IEEE802_11_RADIO, UINT16_MAX, "wlan0");
+
+    std::vector<std::pair<nanoseconds, std::string>> lFrames{{milliseconds(0), MakeDataFrame(0x10, false)},
+                                                             {milliseconds(1), MakeDataFrame(0x20, false)},
+                                                             {milliseconds(2), MakeDataFrame(0x20, true)},
+                                                             {milliseconds(3), MakeDataFrame(0x30, true)},
+                                                             {milliseconds(503), MakeDataFrame(0x40, false)},
+                                                             {milliseconds(504), MakeDataFrame(0x40, true)}};
+    for (auto& [lTimeStamp, lData] : lFrames) {
+        PCapNGWriter::AppendPacket(lCapture, 0, seconds(1000) + lTimeStamp, lData, lData.size());
+    }
+
+    std::string lPath{"../Tests/Output/AnalyzerDuplicates.pcapng"};
+    std::ofstream(lPath, std::ios::binary | std::ios::trunc).write(lCapture.data(), lCapture.size());
+
+    Settings lSettings{};
+    lSettings.Threads   = 2;
+    lSettings.ChunkSize = 2;
+
+    CaptureAnalyzer lAnalyzer{lSettings};
+    ASSERT_TRUE(lAnalyzer.Analyze(lPath));
+    std::filesystem::remove(lPath);
+
+    const Report& lReport{lAnalyzer.GetReport()};
+    EXPECT_EQ(lReport.Chunks, 3);
+    EXPECT_EQ(lReport.WirelessFrames, 6);
+    EXPECT_EQ(lReport.Retries, 3);
+    EXPECT_EQ(lReport.Duplicates, 2);
+    EXPECT_EQ(lReport.MaxInterval, milliseconds(500));
+    ASSERT_EQ(lReport.Gaps.size(), 1);
+    EXPECT_EQ(lReport.Gaps.front().Start, seconds(1000) + milliseconds(3));
+    EXPECT_EQ(lReport.Gaps.front().Length, milliseconds(500));
+    // Percentiles are as precise as the buckets they are kept in.
+    EXPECT_NEAR(CaptureAnalyzer::GetIntervalPercentile(lReport, 50).count(), nanoseconds(milliseconds(1)).count(),
+                nanoseconds(milliseconds(1)).count() / 16);
+    EXPECT_EQ(CaptureAnalyzer::GetSignalPercentile(lReport, 50), -40);
+
+    ASSERT_EQ(lReport.BSSIDs.size(), 1);
+    EXPECT_EQ(PacketConverter::IntToMac(lReport.BSSIDs.begin()->first), "62:58:c5:07:95:5e");
+    ASSERT_EQ(lReport.Stations.size(), 1);
+    EXPECT_EQ(lReport.Stations.begin()->second.Retries, 3);
+    EXPECT_EQ(lReport.Stations.begin()->second.SignalFrames, 6);
+    EXPECT_EQ(lReport.FrameTypes.at(0x20).Frames, 6);
+    EXPECT_EQ(CaptureAnalyzer::GetFrameTypeName(0x20), "Data");
+}
@@ -0,0 +1,102 @@
+/* Copyright (c) 2020 [Rick de Bondt] - CaptureConverter_Test.cpp
+ * This file contains tests for the CaptureConverter class.
+ **/
+
+#include "../Includes/CaptureConverter.h"
+
+#include <gtest/gtest.h>
+
+using namespace CaptureConverter_Constants;
+
+namespace
+{
+    std::vector<std::pair<std::string, std::chrono::nanoseconds>> ReadFrames(std::string_view aPath)
+    {
+        std::vector<std::pair<std::string, std::chrono::nanoseconds>> lReturn{};
+        MappedPCapReader                                              lReader{};
+
+        if (lReader.Open(aPath, 2412)) {
+            while (lReader.ReadNextData()) {
+                lReturn.emplace_back(lReader.GetFrame().Data, lReader.GetFrame().TimeStamp);
+            }
+            lReader.Close();
+        }
+
+        return lReturn;
+    }
+}  // namespace
+
+// Same conversion as PacketConverterTest.MonitorToPromiscuous, split over several threads in small chunks.
+TEST(CaptureConverterTest, MonitorToPromiscuous)
+{
+    Settings lSettings{};
+    lSettings.ConversionDirection = Direction::MonitorTo8023;
+    lSettings.BSSID               = PacketConverter::MacToInt("62:58:c5:07:95:5e");
+    lSettings.Threads             = 4;
+    lSettings.ChunkSize           = 7;
+
+    CaptureConverter lConverter{lSettings};
+    ASSERT_TRUE(lConverter.Convert("../Tests/Input/MonitorHelloWorld.pcapng", "../Tests/Output/Converted8023.pcap"));
+    EXPECT_EQ(lConverter.GetStatistics().FramesRead, 305);
+    EXPECT_EQ(lConverter.GetStatistics().Chunks, (305 + 6) / 7);
+
+    auto lExpected{ReadFrames("../Tests/Input/MonitorToPromiscuousOutput_Expected.pcap")};
+    auto lConverted{ReadFrames("../Tests/Output/Converted8023.pcap")};
+    ASSERT_FALSE(lExpected.empty());
+    EXPECT_EQ(lConverter.GetStatistics().FramesWritten, lExpected.size());
+    EXPECT_EQ(lConverted, lExpected);
+}
+
+TEST(CaptureConverterTest, PromiscuousToMonitor)
+{
+    Settings lSettings{};
+    lSettings.ConversionDirection = Direction::PromiscuousTo80211;
+    lSettings.BSSID               = PacketConverter::MacToInt("01:23:45:67:AB:CD");
+    lSettings.Threads             = 3;
+    lSettings.ChunkSize           = 2;
+
+    CaptureConverter lConverter{lSettings};
+    ASSERT_TRUE(
+        lConverter.Convert("../Tests/Input/PromiscuousHelloWorld.pcapng", "../Tests/Output/Converted80211.pcap"));
+
+    auto lExpected{ReadFrames("../Tests/Input/PromiscuousToMonitorOutput_Expected.pcap")};
+    ASSERT_FALSE(lExpected.empty());
+    EXPECT_EQ(ReadFrames("../Tests/Output/Converted80211.pcap"), lExpected);
+}
+
+// The BSSID comes from a beacon, which usually ends up in another chunk than the data it applies to.
+TEST(CaptureConverterTest, BeaconStateAcrossChunks)
+{
+    Settings lSettings{};
+    lSettings.SSIDFilter = {"T#STNET"};
+    lSettings.Threads    = 1;
+    lSettings.ChunkSize  = 1000;
+
+    CaptureConverter lSingleChunk{lSettings};
+    ASSERT_TRUE(lSingleChunk.Convert("../Tests/Input/MonitorHelloWorld.pcapng", "../Tests/Output/SingleChunk.pcap"));
+    EXPECT_EQ(lSingleChunk.GetStatistics().Chunks, 1);
+
+    lSettings.Threads   = 4;
+    lSettings.ChunkSize = 3;
+    CaptureConverter lManyChunks{lSettings};
+    ASSERT_TRUE(lManyChunks.Convert("../Tests/Input/MonitorHelloWorld.pcapng", "../Tests/Output/ManyChunks.pcap"));
+
+    // Every data frame that made it into MonitorBeaconChange_Expected.pcap should be converted.
+    auto lSingleChunkFrames{ReadFrames("../Tests/Output/SingleChunk.pcap")};
+    EXPECT_EQ(lSingleChunkFrames.size(), ReadFrames("../Tests/Input/MonitorBeaconChange_Expected.pcap").size());
+    EXPECT_EQ(ReadFrames("../Tests/Output/ManyChunks.pcap"), lSingleChunkFrames);
+}
+
+// Ethernet frames have no radiotap header, so they should be skipped instead of being read as if they had one.
+TEST(CaptureConverterTest, SkipsOtherLinkTypes)
+{
+    Settings lSettings{};
+    lSettings.ConversionDirection = Direction::MonitorTo8023;
+    lSettings.SSIDFilter          = {"HelloWorld"};
+
+    CaptureConverter lConverter{lSettings};
+    ASSERT_TRUE(lConverter.Convert("../Tests/Input/PromiscuousHelloWorld.pcapng",
+                                   "../Tests/Output/ConvertedOtherLinkType.pcap"));
+    EXPECT_GT(lConverter.GetStatistics().FramesRead, 0);
+    EXPECT_EQ(lConverter.GetStatistics().FramesWritten, 0);
+}
@@ -0,0 +1,152 @@
+/* Copyright (c) 2020 [Rick de Bondt] - CaptureIndex_Test.cpp
+ * This file contains tests for the CaptureIndex class and seeking in the PCapReader class.
+ **/
+
+#include "../Includes/CaptureIndex.h"
+
+#include <cstdio>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include "../Includes/PCapReader.h"
+
+using namespace CaptureIndex_Constants;
+
+namespace
+{
+    constexpr std::string_view cCapture{"../Tests/Input/MonitorHelloWorld.pcapng"};
+    constexpr std::string_view cIndex{"../Tests/Output/MonitorHelloWorld.pcapng.idx"};
+    constexpr uint32_t         cInterval{16};
+    constexpr uint64_t         cPackets{305};
+}  // namespace
+
+class CaptureIndexTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(mReader.Open(cCapture, 2412));
+        while (mReader.ReadNextData()) {
+            mFrames.emplace_back(mReader.GetFrame());
+        }
+    }
+
+    void TearDown() override
+    {
+        mReader.Close();
+    }
+
+    MappedPCapReader                               mReader{};
+    std::vector<MappedPCapReader_Constants::Frame> mFrames{};
+};
+
+TEST_F(CaptureIndexTest, BuildSaveLoad)
+{
+    CaptureIndex lIndex{};
+    ASSERT_TRUE(lIndex.Build(cCapture, cInterval));
+    EXPECT_EQ(lIndex.GetPacketCount(), cPackets);
+    EXPECT_EQ(lIndex.GetEntries().size(), (cPackets + cInterval - 1) / cInterval);
+    EXPECT_FALSE(lIndex.GetBSSIDs().empty());
+    EXPECT_FALSE(lIndex.GetMacs().empty());
+
+    auto lFirstBSSID{lIndex.GetBSSIDs().begin()};
+    ASSERT_TRUE(lIndex.FindBSSID(lFirstBSSID->first).has_value());
+    EXPECT_EQ(lIndex.FindBSSID(lFirstBSSID->first)->Offset, lFirstBSSID->second.Offset);
+    EXPECT_FALSE(lIndex.FindMac(0x0123456789ab).has_value());
+
+    ASSERT_TRUE(lIndex.Save(cIndex));
+
+    CaptureIndex             lLoadedIndex{};
+    std::chrono::nanoseconds lTime{CaptureIndex::GetModificationTime(cCapture)};
+    EXPECT_EQ(lIndex.GetCaptureTime(), lTime);
+    // An index for a capture of another size or one that was written again is outdated.
+    EXPECT_FALSE(lLoadedIndex.Load(cIndex, lIndex.GetCaptureSize() + 1, lTime));
+    EXPECT_FALSE(lLoadedIndex.Load(cIndex, lIndex.GetCaptureSize(), lTime + std::chrono::seconds(1)));
+    ASSERT_TRUE(lLoadedIndex.Load(cIndex, lIndex.GetCaptureSize(), lTime));
+    EXPECT_EQ(lLoadedIndex.GetPacketCount(), cPackets);
+    ASSERT_EQ(lLoadedIndex.GetEntries().size(), lIndex.GetEntries().size());
+    EXPECT_EQ(lLoadedIndex.GetEntries().back().Offset, lIndex.GetEntries().back().Offset);
+    EXPECT_EQ(lLoadedIndex.GetEntries().back().TimeStamp, lIndex.GetEntries().back().TimeStamp);
+    EXPECT_EQ(lLoadedIndex.GetBSSIDs().size(), lIndex.GetBSSIDs().size());
+    EXPECT_EQ(lLoadedIndex.GetMacs().size(), lIndex.GetMacs().size());
+}
+
+// A damaged index should be rejected so it gets built again, not read with the counts it claims.
+TEST_F(CaptureIndexTest, LoadDamaged)
+{
+    CaptureIndex lIndex{};
+    ASSERT_TRUE(lIndex.Build(cCapture, cInterval));
+    ASSERT_TRUE(lIndex.Save(cIndex));
+
+    std::string lContents{};
+    {
+        std::ifstream lFile{std::string(cIndex), std::ios::binary};
+        lContents.assign(std::istreambuf_iterator<char>(lFile), std::istreambuf_iterator<char>());
+    }
+    ASSERT_GT(lContents.size(), cIndexMagic.size() + 28);
+
+    auto lLoadModified = [&](std::size_t aOffset, std::string_view aReplacement, std::size_t aSize) {
+        std::string lModified{lContents.substr(0, aSize)};
+        lModified.replace(aOffset, aReplacement.size(), aReplacement);
+        std::ofstream{std::string(cIndex), std::ios::binary | std::ios::trunc} << lModified;
+
+        CaptureIndex lLoadedIndex{};
+        return lLoadedIndex.Load(cIndex, lIndex.GetCaptureSize(), lIndex.GetCaptureTime());
+    };
+
+    // Magic, capture size, capture time, interval and packet count come before the section count.
+    std::size_t lSectionCount{cIndexMagic.size() + 28};
+    EXPECT_TRUE(lLoadModified(0, "", lContents.size()));
+    EXPECT_FALSE(lLoadModified(lSectionCount, "\xff\xff\xff\xff", lContents.size()));
+    EXPECT_FALSE(lLoadModified(lSectionCount + 5, "\xff\xff\xff\xff", lContents.size()));
+    // The packet count no longer matches the entries.
+    EXPECT_FALSE(lLoadModified(lSectionCount - 8, "\xff", lContents.size()));
+    EXPECT_FALSE(lLoadModified(0, "", lContents.size() - 1));
+}
+
+TEST_F(CaptureIndexTest, Find)
+{
+    CaptureIndex lIndex{};
+    ASSERT_TRUE(lIndex.Build(cCapture, cInterval));
+
+    auto lPosition{lIndex.FindPacket(100)};
+    ASSERT_TRUE(lPosition.has_value());
+    EXPECT_EQ(lPosition->Packet, 96);
+    EXPECT_EQ(lPosition->Offset, mFrames.at(96).Offset);
+    EXPECT_FALSE(lIndex.FindPacket(cPackets).has_value());
+
+    lPosition = lIndex.FindTime(mFrames.at(200).TimeStamp);
+    ASSERT_TRUE(lPosition.has_value());
+    EXPECT_LE(lPosition->TimeStamp, mFrames.at(200).TimeStamp);
+    EXPECT_GT(lPosition->Packet + cInterval, 200);
+
+    // Before the start of the capture gives the start.
+    EXPECT_EQ(lIndex.FindTime(std::chrono::nanoseconds(0))->Packet, 0);
+}
+
+TEST_F(CaptureIndexTest, PCapReaderSeek)
+{
+    PCapReader lPCapReader{};
+    ASSERT_TRUE(lPCapReader.Open(cCapture, 2412));
+    ASSERT_TRUE(lPCapReader.LoadIndex());
+
+    ASSERT_TRUE(lPCapReader.SeekToPacket(150));
+    ASSERT_TRUE(lPCapReader.ReadNextData());
+    EXPECT_EQ(lPCapReader.LastDataToString(), mFrames.at(150).Data);
+
+    ASSERT_TRUE(lPCapReader.SeekToTime(mFrames.at(42).TimeStamp));
+    ASSERT_TRUE(lPCapReader.ReadNextData());
+    EXPECT_EQ(lPCapReader.LastDataToString(), mFrames.at(42).Data);
+
+    // Going back also works.
+    ASSERT_TRUE(lPCapReader.SeekToPacket(0));
+    ASSERT_TRUE(lPCapReader.ReadNextData());
+    EXPECT_EQ(lPCapReader.LastDataToString(), mFrames.at(0).Data);
+
+    EXPECT_FALSE(lPCapReader.SeekToPacket(cPackets));
+    lPCapReader.Close();
+
+    // LoadIndex saved the index next to the capture, do not leave it in the input folder.
+    std::remove(CaptureIndex::GetIndexPath(cCapture).c_str());
+}
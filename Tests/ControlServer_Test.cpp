@@ -0,0 +1,102 @@
+/* Copyright (c) 2020 [Rick de Bondt] - ControlServer_Test.cpp
+ * This file contains tests for the ControlServer class.
+ **/
+
+#include "../Includes/ControlServer.h"
+
+#include <filesystem>
+
+#include <gtest/gtest.h>
+
+using namespace ControlServer_Constants;
+using boost::asio::local::stream_protocol;
+
+class ControlServerTest : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        ASSERT_TRUE(mServer.Open(mPath));
+        ASSERT_TRUE(mServer.StartThread());
+        mSocket.connect(stream_protocol::endpoint(mPath));
+    }
+
+    // Sends a request and reads the reply up to and including the line with the result.
+    std::string Request(std::string_view aRequest)
+    {
+        boost::asio::write(mSocket, boost::asio::buffer(aRequest));
+
+        std::string lReturn{};
+        std::string lLine{};
+        while (lLine.rfind(cOk, 0) != 0 && lLine.rfind(cError, 0) != 0) {
+            std::size_t lLength{boost::asio::read_until(mSocket, boost::asio::dynamic_buffer(mReceived), cLineEnd)};
+            lLine = mReceived.substr(0, lLength);
+            mReceived.erase(0, lLength);
+            lReturn += lLine;
+        }
+
+        return lReturn;
+    }
+
+    // Echoes the arguments after the first word, and fails when asked to.
+    std::string              mPath{"../Tests/Output/control.socket"};
+    std::vector<std::string> mRequests{};
+    ControlServer            mServer{[this](const std::vector<std::string>& aArguments) {
+        mRequests.emplace_back(aArguments.front());
+        Reply lReply{aArguments.front() != "fail", {}};
+        lReply.Lines.assign(aArguments.begin() + 1, aArguments.end());
+        return lReply;
+    }};
+    boost::asio::io_service  mIoService{};
+    stream_protocol::socket  mSocket{mIoService};
+    std::string              mReceived{};
+};
+
+TEST_F(ControlServerTest, Requests)
+{
+    // Only the user running the program may control it.
+    EXPECT_EQ(std::filesystem::status(mPath).permissions(),
+              std::filesystem::perms::owner_read | std::filesystem::perms::owner_write);
+    // It was created that way in a private directory, which is gone again.
+    for (const auto& lEntry : std::filesystem::directory_iterator(std::filesystem::path(mPath).parent_path())) {
+        EXPECT_EQ(lEntry.path().filename().string().rfind(".control.socket.", 0), std::string::npos);
+    }
+
+    EXPECT_EQ(Request("echo  a b\n"), "a\nb\nOK\n");
+    EXPECT_EQ(Request("fail why\r\n"), "ERROR why\n");
+    EXPECT_EQ(Request("\n"), "ERROR Empty request\n");
+    // Requests sent at once are answered in order, the second reply is still waiting to be read.
+    EXPECT_EQ(Request("first\nsecond\n"), "OK\n");
+    EXPECT_EQ(Request(""), "OK\n");
+    EXPECT_EQ(mRequests, std::vector<std::string>({"echo", "fail", "first", "second"}));
+
+    // The socket is gone once the server closes.
+    mServer.Close();
+    EXPECT_FALSE(std::filesystem::exists(mPath));
+}
+
+// A request longer than the buffer can not be told apart from the next one, so the connection is closed.
+TEST_F(ControlServerTest, RequestTooLong)
+{
+    EXPECT_EQ(Request(std::string(cMaxLineLength + 10, 'a')), "ERROR Request too long\n");
+
+    boost::system::error_code lError{};
+    std::array<char, 1>       lBuffer{};
+    mSocket.read_some(boost::asio::buffer(lBuffer), lError);
+    // Closing with part of the request unread resets the connection instead of ending it.
+    EXPECT_TRUE(lError == boost::asio::error::eof || lError == boost::asio::error::connection_reset);
+    EXPECT_TRUE(mRequests.empty());
+}
+
+TEST(ControlServer, FormatSnapshot)
+{
+    Statistics_Constants::Snapshot lSnapshot{};
+    lSnapshot.Counters.at(static_cast<std::size_t>(Statistics_Constants::Counter::QueueDrops)) = 12;
+    lSnapshot.Latencies.at(0).Count                                                           = 3;
+
+    std::vector<std::string> lLines{ControlServer::FormatSnapshot(lSnapshot)};
+    ASSERT_EQ(lLines.size(), Statistics_Constants::cCounterCount + 5 * Statistics_Constants::cLatencyCount);
+    EXPECT_NE(std::find(lLines.begin(), lLines.end(), "queue_drops 12"), lLines.end());
+    EXPECT_NE(std::find(lLines.begin(), lLines.end(), "monitor_to_xlink_kai_latency_count 3"), lLines.end());
+    EXPECT_EQ(ControlServer::SplitRequest(" set  channel 6 "), std::vector<std::string>({"set", "channel", "6"}));
+}
@@ -0,0 +1,147 @@
+/* Copyright (c) 2020 [Rick de Bondt] - FlightRecorder_Test.cpp
+ * This file contains tests for the FlightRecorder class.
+ **/
+
+#include "../Includes/FlightRecorder.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "../Includes/MappedPCapReader.h"
+
+using namespace FlightRecorder_Constants;
+using namespace SessionRecorder_Constants;
+
+class FlightRecorderTest : public ::testing::Test
+{
+public:
+    void TearDown() override
+    {
+        for (auto& lDump : mDumps) {
+            std::remove(lDump.c_str());
+            std::remove(GetEventLog(lDump).c_str());
+        }
+    }
+
+    static std::string GetEventLog(const std::string& aDump)
+    {
+        return std::filesystem::path(aDump).replace_extension(cEventExtension).string();
+    }
+
+    std::vector<std::string> mDumps{};
+};
+
+// Only the newest frames are kept, and frames that are too long are cut off.
+TEST_F(FlightRecorderTest, KeepLastFrames)
+{
+    FlightRecorder_Constants::Settings lSettings{"../Tests/Output/KeepLastFrames"};
+    lSettings.FramesPerDirection = 4;
+    FlightRecorder lRecorder{lSettings};
+
+    for (int lCount = 0; lCount < 10; lCount++) {
+        lRecorder.Record(Direction::ToXLinkKai, "ethernet" + std::to_string(lCount));
+        lRecorder.Record(Direction::ToMonitor, "80211_" + std::to_string(lCount));
+    }
+    lRecorder.Record(Direction::ToMonitor, std::string(3000, 'x'));
+
+    std::string lDump{lRecorder.Dump("test")};
+    ASSERT_FALSE(lDump.empty());
+    mDumps.emplace_back(lDump);
+    EXPECT_EQ(lRecorder.GetDumpCount(), 1);
+
+    MappedPCapReader lReader{};
+    ASSERT_TRUE(lReader.Open(lDump, 0));
+
+    std::vector<std::string> lToXLinkKai{};
+    std::vector<std::string> lToMonitor{};
+    while (lReader.ReadNextData()) {
+        const MappedPCapReader_Constants::Frame& lFrame{lReader.GetFrame()};
+        if (lFrame.Interface == static_cast<uint32_t>(Direction::ToXLinkKai)) {
+            lToXLinkKai.emplace_back(lFrame.Data);
+        } else if (lFrame.Data.size() == cMaxFrameLength) {
+            EXPECT_EQ(lFrame.Length, 3000);
+        } else {
+            lToMonitor.emplace_back(lFrame.Data);
+        }
+    }
+
+    ASSERT_EQ(lReader.GetInterfaces().size(), 2);
+    EXPECT_EQ(lToXLinkKai, (std::vector<std::string>{"ethernet6", "ethernet7", "ethernet8", "ethernet9"}));
+    EXPECT_EQ(lToMonitor, (std::vector<std::string>{"80211_7", "80211_8", "80211_9"}));
+}
+
+// A burst of triggers only results in one dump, with the recent events and the reason in the event log.
+TEST_F(FlightRecorderTest, TriggerOnce)
+{
+    FlightRecorder_Constants::Settings lSettings{"../Tests/Output/TriggerOnce"};
+    lSettings.Events = 3;
+    FlightRecorder lRecorder{lSettings};
+
+    for (int lCount = 0; lCount < 5; lCount++) {
+        lRecorder.RecordEvent("event" + std::to_string(lCount), Logger::Level::DEBUG);
+    }
+
+    lRecorder.Trigger("first");
+    lRecorder.Trigger("second");
+    ASSERT_EQ(lRecorder.GetDumpCount(), 1);
+
+    for (auto& lEntry : std::filesystem::directory_iterator("../Tests/Output")) {
+        if (lEntry.path().filename().string().starts_with("TriggerOnce") &&
+            (lEntry.path().extension() == cExtension)) {
+            mDumps.emplace_back(lEntry.path().string());
+        }
+    }
+    ASSERT_EQ(mDumps.size(), 1);
+
+    std::ifstream            lEventLog{GetEventLog(mDumps.front())};
+    std::vector<std::string> lLines{};
+    std::string              lLine{};
+    while (std::getline(lEventLog, lLine)) {
+        lLines.emplace_back(lLine);
+    }
+
+    ASSERT_EQ(lLines.size(), 4);
+    EXPECT_TRUE(lLines.at(0).ends_with("Debug: event2"));
+    EXPECT_TRUE(lLines.at(2).ends_with("Debug: event4"));
+    EXPECT_TRUE(lLines.at(3).ends_with("reason: first"));
+}
+
+// Errors logged anywhere end up as a dump written by the dump thread.
+TEST_F(FlightRecorderTest, DumpOnLoggedError)
+{
+    FlightRecorder lRecorder{FlightRecorder_Constants::Settings{"../Tests/Output/DumpOnLoggedError"}};
+    ASSERT_TRUE(lRecorder.StartDumpThread());
+
+    Logger::GetInstance().SetObserver([&lRecorder](std::string_view aText, Logger::Level aLevel) {
+        lRecorder.RecordEvent(aText, aLevel);
+        if (aLevel == Logger::Level::ERROR) {
+            lRecorder.Trigger(aText);
+        }
+    });
+
+    Logger::GetInstance().Log<Logger::Level::ERROR>("Something went wrong");
+    for (int lWait = 0; (lWait < 100) && (lRecorder.GetDumpCount() == 0); lWait++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    Logger::GetInstance().SetObserver(nullptr);
+    lRecorder.Close();
+
+    for (auto& lEntry : std::filesystem::directory_iterator("../Tests/Output")) {
+        if (lEntry.path().filename().string().starts_with("DumpOnLoggedError") &&
+            (lEntry.path().extension() == cExtension)) {
+            mDumps.emplace_back(lEntry.path().string());
+        }
+    }
+
+    EXPECT_EQ(lRecorder.GetDumpCount(), 1);
+    ASSERT_EQ(mDumps.size(), 1);
+
+    std::ifstream lEventLog{GetEventLog(mDumps.front())};
+    std::string   lFirstLine{};
+    std::getline(lEventLog, lFirstLine);
+    EXPECT_TRUE(lFirstLine.ends_with("Error: Something went wrong"));
+}
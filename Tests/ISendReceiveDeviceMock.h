@@ -0,0 +1,19 @@
+#pragma once
+
+/* Copyright (c) 2020 [Rick de Bondt] - ISendReceiveDeviceMock.h
+ * This file contains a mock for the ISendReceiveDevice interface.
+ **/
+
+#include <gmock/gmock.h>
+
+#include "../Includes/ISendReceiveDevice.h"
+
+class ISendReceiveDeviceMock : public ISendReceiveDevice
+{
+public:
+    MOCK_METHOD(void, Close, ());
+    MOCK_METHOD(std::string, LastDataToString, ());
+    MOCK_METHOD(bool, ReadNextData, ());
+    MOCK_METHOD(bool, Send, (std::string_view aData));
+    MOCK_METHOD(void, SetSendReceiveDevice, (std::shared_ptr<ISendReceiveDevice> aDevice));
+};
@@ -0,0 +1,167 @@
+/* Copyright (c) 2020 [Rick de Bondt] - Logger_Test.cpp
+ * This file contains tests for the Logger class.
+ **/
+
+#include "../Includes/Logger.h"
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+    constexpr std::string_view cLogPath{"../Tests/Output/Logger.txt"};
+
+    std::vector<std::string> ReadLines()
+    {
+        std::vector<std::string> lReturn{};
+        std::ifstream            lFile{std::string(cLogPath)};
+        std::string              lLine{};
+
+        while (std::getline(lFile, lLine)) {
+            lReturn.push_back(lLine);
+        }
+
+        return lReturn;
+    }
+
+    // Counts how often it is formatted.
+    struct Counted
+    {
+        int& Count;
+    };
+
+    std::ostream& operator<<(std::ostream& aStream, const Counted& aCounted)
+    {
+        return aStream << "counted " << ++aCounted.Count;
+    }
+
+    // Puts the singleton back in the state the other tests expect.
+    void ResetLogger()
+    {
+        Logger::GetInstance().Close();
+        Logger::GetInstance().SetLogToDisk(false);
+        Logger::GetInstance().SetLogLevel(Logger::Level::ERROR);
+        std::filesystem::remove(cLogPath);
+    }
+}  // namespace
+
+// Every thread logs less than fits in the queue, so nothing may be dropped and each thread's messages stay in order.
+TEST(LoggerTest, ConcurrentLogging)
+{
+    constexpr int cThreads{4};
+    constexpr int cMessages{500};
+
+    Logger::GetInstance().Init(Logger::Level::DEBUG, true, std::string(cLogPath));
+
+    std::vector<std::thread> lThreads{};
+    for (int lThread = 0; lThread < cThreads; lThread++) {
+        lThreads.emplace_back([lThread] {
+            for (int lMessage = 0; lMessage < cMessages; lMessage++) {
+                Logger::GetInstance().Log<Logger::Level::INFO>("Thread {} message {}", lThread, lMessage);
+            }
+        });
+    }
+    for (auto& lThread : lThreads) {
+        lThread.join();
+    }
+    Logger::GetInstance().Flush();
+
+    auto               lLines{ReadLines()};
+    std::map<int, int> lNextMessage{};
+    ASSERT_EQ(lLines.size(), cThreads * cMessages);
+    EXPECT_EQ(Logger::GetInstance().GetDroppedCount(), 0);
+
+    for (const auto& lLine : lLines) {
+        ASSERT_NE(lLine.find(": Info: "), std::string::npos) << lLine;
+        EXPECT_NE(lLine.find("Logger_Test.cpp:"), std::string::npos) << lLine;
+
+        std::size_t lText{lLine.find("Thread ")};
+        ASSERT_NE(lText, std::string::npos) << lLine;
+        int lThread{std::stoi(lLine.substr(lText + 7))};
+        int lMessage{std::stoi(lLine.substr(lLine.find("message ", lText) + 8))};
+        EXPECT_EQ(lMessage, lNextMessage[lThread]++);
+    }
+
+    ResetLogger();
+}
+
+TEST(LoggerTest, BelowLogLevel)
+{
+    Logger::GetInstance().Init(Logger::Level::WARNING, true, std::string(cLogPath));
+
+    Logger::GetInstance().Log<Logger::Level::DEBUG>("Not written");
+    Logger::GetInstance().Log<Logger::Level::WARNING>("Written");
+    Logger::GetInstance().Flush();
+
+    auto lLines{ReadLines()};
+    ASSERT_EQ(lLines.size(), 1);
+    EXPECT_TRUE(lLines.front().ends_with(":Written"));
+
+    ResetLogger();
+}
+
+// After Close the writer thread is gone and messages are written right away.
+TEST(LoggerTest, WritesAfterClose)
+{
+    Logger::GetInstance().Init(Logger::Level::INFO, true, std::string(cLogPath));
+    Logger::GetInstance().Log<Logger::Level::INFO>("Queued");
+    Logger::GetInstance().Close();
+    Logger::GetInstance().Log<Logger::Level::INFO>("Direct");
+
+    auto lLines{ReadLines()};
+    ASSERT_EQ(lLines.size(), 2);
+    EXPECT_TRUE(lLines.at(0).ends_with(":Queued"));
+    EXPECT_TRUE(lLines.at(1).ends_with(":Direct"));
+
+    ResetLogger();
+}
+
+// Arguments are only formatted for messages that are logged.
+TEST(LoggerTest, Format)
+{
+    int lFormatted{0};
+
+    Logger::GetInstance().Init(Logger::Level::INFO, true, std::string(cLogPath));
+
+    Logger::GetInstance().Log<Logger::Level::INFO>(
+        "{} of {} {{braces}} {}", 1, std::string_view("2"), Counted{lFormatted});
+    Logger::GetInstance().Log<Logger::Level::INFO>("Missing {} {}", 'x');
+    Logger::GetInstance().Log<Logger::Level::DEBUG>("Below the log level {}", Counted{lFormatted});
+    Logger::GetInstance().Flush();
+
+    auto lLines{ReadLines()};
+    ASSERT_EQ(lLines.size(), 2);
+    EXPECT_TRUE(lLines.at(0).ends_with(":1 of 2 {braces} counted 1")) << lLines.at(0);
+    EXPECT_TRUE(lLines.at(1).ends_with(":Missing x {}")) << lLines.at(1);
+    EXPECT_EQ(lFormatted, 1);
+
+    ResetLogger();
+}
+
+// A burst gets through, the rest is counted and reported with the first message that is allowed again.
+TEST(LoggerTest, RateLimited)
+{
+    Logger::RateLimit lLimit{std::chrono::milliseconds(200), 2};
+
+    Logger::GetInstance().Init(Logger::Level::DEBUG, true, std::string(cLogPath));
+
+    for (int lMessage = 0; lMessage < 10; lMessage++) {
+        Logger::GetInstance().LogLimited<Logger::Level::DEBUG>(lLimit, "Repeated {}", lMessage);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    Logger::GetInstance().LogLimited<Logger::Level::DEBUG>(lLimit, "Repeated {}", 10);
+    Logger::GetInstance().Flush();
+
+    auto lLines{ReadLines()};
+    ASSERT_EQ(lLines.size(), 3);
+    EXPECT_TRUE(lLines.at(0).ends_with(":Repeated 0")) << lLines.at(0);
+    EXPECT_TRUE(lLines.at(1).ends_with(":Repeated 1")) << lLines.at(1);
+    EXPECT_TRUE(lLines.at(2).ends_with(":Repeated 10 (suppressed 8 similar messages)")) << lLines.at(2);
+
+    ResetLogger();
+}
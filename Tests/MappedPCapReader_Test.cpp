@@ -0,0 +1,165 @@
+/* Copyright (c) 2020 [Rick de Bondt] - MappedPCapReader_Test.cpp
+ * This file contains tests for the MappedPCapReader class.
+ **/
+
+#include "../Includes/MappedPCapReader.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+using namespace MappedPCapReader_Constants;
+
+TEST(MappedPCapReaderTest, ReadPCapNG)
+{
+    MappedPCapReader lReader{};
+    ASSERT_TRUE(lReader.Open("../Tests/Input/PromiscuousHelloWorld.pcapng", 2412));
+    EXPECT_EQ(lReader.GetFormat(), Format::PCapNG);
+
+    unsigned int             lFrames{0};
+    std::chrono::nanoseconds lFirstTimeStamp{0};
+    while (lReader.ReadNextData()) {
+        if (lFrames == 0) {
+            lFirstTimeStamp = lReader.GetFrame().TimeStamp;
+        }
+        EXPECT_EQ(lReader.GetFrame().Data.size(), lReader.GetHeader()->caplen);
+        lFrames++;
+    }
+
+    EXPECT_EQ(lFrames, 12);
+    ASSERT_EQ(lReader.GetInterfaces().size(), 1);
+    EXPECT_EQ(lReader.GetInterfaces().front().LinkType, DLT_EN10MB);
+    // This capture has nanosecond timestamps.
+    EXPECT_EQ(lFirstTimeStamp, std::chrono::nanoseconds(1599920655886139192));
+    EXPECT_EQ(lReader.GetFrame().TimeStamp - lFirstTimeStamp, std::chrono::nanoseconds(5124352558));
+
+    lReader.Close();
+}
+
+// Big endian captures have to be read the same as little endian ones.
+TEST(MappedPCapReaderTest, ReadSwappedPCap)
+{
+    const std::string lFileName{"../Tests/Output/SwappedNano.pcap"};
+    // clang-format off
+    const std::string lCapture{
+        "\xa1\xb2\x3c\x4d" "\x00\x02\x00\x04" "\x00\x00\x00\x00" "\x00\x00\x00\x00" "\x00\x00\xff\xff" "\x00\x00\x00\x01"
+        "\x00\x00\x00\x02" "\x00\x00\x00\x05" "\x00\x00\x00\x04" "\x00\x00\x00\x08" "\xde\xad\xbe\xef", 44};
+    // clang-format on
+    std::ofstream(lFileName, std::ios::binary) << lCapture;
+
+    MappedPCapReader lReader{};
+    ASSERT_TRUE(lReader.Open(lFileName, 2412));
+    EXPECT_EQ(lReader.GetFormat(), Format::PCap);
+    EXPECT_EQ(lReader.GetInterfaces().front().LinkType, DLT_EN10MB);
+
+    ASSERT_TRUE(lReader.ReadNextData());
+    EXPECT_EQ(lReader.GetFrame().Data, std::string_view("\xde\xad\xbe\xef", 4));
+    EXPECT_EQ(lReader.GetFrame().Length, 8);
+    EXPECT_EQ(lReader.GetFrame().TimeStamp, std::chrono::nanoseconds(2000000005));
+    EXPECT_FALSE(lReader.ReadNextData());
+
+    // Going back to a frame that was read before gives the same frame again.
+    ASSERT_TRUE(lReader.SetOffset(cPCapHeaderLength));
+    ASSERT_TRUE(lReader.ReadNextData());
+    EXPECT_EQ(lReader.LastDataToString(), std::string("\xde\xad\xbe\xef", 4));
+
+    lReader.Close();
+}
+
+// A timestamp resolution too fine for 64 bits is ignored, as it would overflow converting timestamps.
+TEST(MappedPCapReaderTest, IgnoreInvalidTimeStampResolution)
+{
+    const std::string lFileName{"../Tests/Output/InvalidResolution.pcapng"};
+    // clang-format off
+    const std::string lCapture{
+        // Section header block.
+        "\x0a\x0d\x0d\x0a" "\x1c\x00\x00\x00" "\x4d\x3c\x2b\x1a" "\x01\x00\x00\x00" "\xff\xff\xff\xff" "\xff\xff\xff\xff"
+        "\x1c\x00\x00\x00"
+        // Interface description blocks with if_tsresol 10^-73 and 2^-94.
+        "\x01\x00\x00\x00" "\x20\x00\x00\x00" "\x01\x00\x00\x00" "\xff\xff\x00\x00" "\x09\x00\x01\x00" "\x49\x00\x00\x00"
+        "\x00\x00\x00\x00" "\x20\x00\x00\x00"
+        "\x01\x00\x00\x00" "\x20\x00\x00\x00" "\x01\x00\x00\x00" "\xff\xff\x00\x00" "\x09\x00\x01\x00" "\xde\x00\x00\x00"
+        "\x00\x00\x00\x00" "\x20\x00\x00\x00"
+        // Enhanced packet blocks on both interfaces.
+        "\x06\x00\x00\x00" "\x24\x00\x00\x00" "\x00\x00\x00\x00" "\x00\x00\x00\x00" "\x05\x00\x00\x00" "\x04\x00\x00\x00"
+        "\x04\x00\x00\x00" "\xde\xad\xbe\xef" "\x24\x00\x00\x00"
+        "\x06\x00\x00\x00" "\x24\x00\x00\x00" "\x01\x00\x00\x00" "\x00\x00\x00\x00" "\x05\x00\x00\x00" "\x04\x00\x00\x00"
+        "\x04\x00\x00\x00" "\xde\xad\xbe\xef" "\x24\x00\x00\x00", 164};
+    // clang-format on
+    std::ofstream(lFileName, std::ios::binary) << lCapture;
+
+    MappedPCapReader lReader{};
+    ASSERT_TRUE(lReader.Open(lFileName, 2412));
+    EXPECT_EQ(lReader.GetFormat(), Format::PCapNG);
+
+    for (uint32_t lInterface = 0; lInterface < 2; lInterface++) {
+        ASSERT_TRUE(lReader.ReadNextData());
+        EXPECT_EQ(lReader.GetFrame().Interface, lInterface);
+        EXPECT_EQ(lReader.GetFrame().Data, std::string_view("\xde\xad\xbe\xef", 4));
+        // Read with the default resolution of microseconds.
+        EXPECT_EQ(lReader.GetFrame().TimeStamp, std::chrono::nanoseconds(5000));
+    }
+    EXPECT_FALSE(lReader.ReadNextData());
+
+    ASSERT_EQ(lReader.GetInterfaces().size(), 2);
+    EXPECT_EQ(lReader.GetInterfaces().at(0).TimeStampResolution, cDefaultTimeStampResolution);
+    EXPECT_EQ(lReader.GetInterfaces().at(1).TimeStampResolution, cDefaultTimeStampResolution);
+
+    lReader.Close();
+    std::remove(lFileName.c_str());
+}
+
+TEST(MappedPCapReaderTest, RejectUnknownFormat)
+{
+    MappedPCapReader lReader{};
+    EXPECT_FALSE(lReader.Open("../Tests/Input/config_expected.txt", 2412));
+    EXPECT_FALSE(lReader.Open("../Tests/Input/DoesNotExist.pcap", 2412));
+    EXPECT_FALSE(lReader.ReadNextData());
+}
+
+#if defined(HAVE_ZSTD)
+// A compressed capture reads the same as the original, also when it consists of several frames.
+TEST(MappedPCapReaderTest, ReadCompressed)
+{
+    std::ifstream     lInput{"../Tests/Input/PromiscuousHelloWorld.pcapng", std::ios::binary};
+    std::stringstream lCapture{};
+    lCapture << lInput.rdbuf();
+
+    std::string      lOriginal{lCapture.str()};
+    std::string      lCompressed{};
+    std::string_view lHalf{std::string_view(lOriginal).substr(0, lOriginal.size() / 2)};
+    ZstdCompressor   lCompressor{};
+    ASSERT_TRUE(lCompressor.Open());
+    ASSERT_TRUE(lCompressor.Compress(lHalf, lCompressed, true));
+    ASSERT_TRUE(lCompressor.Open());
+    ASSERT_TRUE(lCompressor.Compress(std::string_view(lOriginal).substr(lHalf.size()), lCompressed, true));
+
+    std::string   lPath{"../Tests/Output/ReadCompressed.pcapng.zst"};
+    std::ofstream lOutput{lPath, std::ios::binary};
+    lOutput.write(lCompressed.data(), lCompressed.size());
+    lOutput.close();
+
+    MappedPCapReader lReader{};
+    MappedPCapReader lExpectedReader{};
+    ASSERT_TRUE(lReader.Open(lPath, 2412));
+    ASSERT_TRUE(lExpectedReader.Open("../Tests/Input/PromiscuousHelloWorld.pcapng", 2412));
+    EXPECT_TRUE(lReader.IsCompressed());
+    EXPECT_FALSE(lExpectedReader.IsCompressed());
+
+    unsigned int lFrames{0};
+    while (lExpectedReader.ReadNextData()) {
+        ASSERT_TRUE(lReader.ReadNextData());
+        EXPECT_EQ(lReader.GetFrame().Data, lExpectedReader.GetFrame().Data);
+        EXPECT_EQ(lReader.GetFrame().TimeStamp, lExpectedReader.GetFrame().TimeStamp);
+        EXPECT_EQ(lReader.GetFrame().Offset, lExpectedReader.GetFrame().Offset);
+        lFrames++;
+    }
+    EXPECT_FALSE(lReader.ReadNextData());
+    EXPECT_EQ(lFrames, 12);
+
+    lReader.Close();
+    std::remove(lPath.c_str());
+}
+#endif
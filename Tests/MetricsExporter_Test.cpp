@@ -0,0 +1,162 @@
+/* Copyright (c) 2020 [Rick de Bondt] - MetricsExporter_Test.cpp
+ * This file contains tests for the MetricsExporter class.
+ **/
+
+#include "../Includes/MetricsExporter.h"
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using namespace MetricsExporter_Constants;
+using namespace Statistics_Constants;
+using boost::asio::ip::tcp;
+
+// Checks text against the Prometheus text format: every sample belongs to a metric with a HELP and TYPE line before
+// it, and histogram buckets only go up and end with +Inf holding the count.
+static void ValidateFormat(const std::string& aText)
+{
+    static const std::regex cHelp{R"(# HELP ([a-zA-Z_:][a-zA-Z0-9_:]*) \S.*)"};
+    static const std::regex cType{R"(# TYPE ([a-zA-Z_:][a-zA-Z0-9_:]*) (counter|gauge|histogram))"};
+    static const std::regex cSample{
+        R"(([a-zA-Z_:][a-zA-Z0-9_:]*)(\{([a-zA-Z_][a-zA-Z0-9_]*="[^"]*")(,[a-zA-Z_][a-zA-Z0-9_]*="[^"]*")*\})? (\S+))"};
+
+    std::map<std::string, std::string> lTypes{};
+    std::map<std::string, double>       lLastBucket{};
+    std::map<std::string, std::string>  lLastBound{};
+    std::set<std::string>               lHelps{};
+    std::istringstream                  lStream{aText};
+    std::string                         lLine{};
+    std::smatch                         lMatch{};
+
+    ASSERT_FALSE(aText.empty());
+    ASSERT_EQ(aText.back(), '\n');
+    while (std::getline(lStream, lLine)) {
+        if (std::regex_match(lLine, lMatch, cHelp)) {
+            EXPECT_TRUE(lHelps.insert(lMatch[1]).second) << lLine;
+        } else if (std::regex_match(lLine, lMatch, cType)) {
+            EXPECT_TRUE(lHelps.contains(lMatch[1])) << lLine;
+            EXPECT_TRUE(lTypes.emplace(lMatch[1], lMatch[2]).second) << lLine;
+        } else if (std::regex_match(lLine, lMatch, cSample)) {
+            std::string lName{lMatch[1]};
+            std::string lLabels{lMatch[3]};
+            double      lValue{std::stod(lMatch[5])};
+            EXPECT_GE(lValue, 0) << lLine;
+
+            if (lTypes.contains(lName)) {
+                EXPECT_EQ(lTypes.at(lName), "counter") << lLine;
+                EXPECT_TRUE(lName.ends_with("_total")) << lLine;
+            } else {
+                std::string lFamily{lName.substr(0, lName.rfind('_'))};
+                ASSERT_TRUE(lTypes.contains(lFamily)) << lLine;
+                EXPECT_EQ(lTypes.at(lFamily), "histogram") << lLine;
+
+                if (lName.ends_with("_bucket")) {
+                    EXPECT_GE(lValue, lLastBucket[lLabels]) << lLine;
+                    lLastBucket[lLabels] = lValue;
+                    lLastBound[lLabels]  = lLine.substr(lLine.find("le=\""));
+                } else if (lName.ends_with("_count")) {
+                    EXPECT_EQ(lValue, lLastBucket[lLabels]) << lLine;
+                    EXPECT_EQ(lLastBound[lLabels].rfind("le=\"+Inf\"", 0), 0) << lLine;
+                }
+            }
+        } else {
+            ADD_FAILURE() << "Malformed line: " << lLine;
+        }
+    }
+}
+
+TEST(MetricsExporterTest, Format)
+{
+    Snapshot lSnapshot{};
+    lSnapshot.Counters.at(static_cast<std::size_t>(Counter::ForwardedToXLinkKai)) = 7;
+    lSnapshot.Counters.at(static_cast<std::size_t>(Counter::KernelDrops))         = 3;
+    lSnapshot.Counters.at(static_cast<std::size_t>(Counter::XLinkKaiReconnects))  = 2;
+
+    // 100 latencies of 1 microsecond, 1 of 1 millisecond and 1 longer than any bucket but +Inf.
+    LatencyHistogram& lHistogram{lSnapshot.Latencies.at(static_cast<std::size_t>(Latency::XLinkKaiToMonitor))};
+    lHistogram.Buckets.at(Histogram_Constants::GetBucket(1000))    = 100;
+    lHistogram.Buckets.at(Histogram_Constants::GetBucket(1000000)) = 1;
+    lHistogram.Buckets.back()                                       = 1;
+    lHistogram.Count                                                = 102;
+    lHistogram.Sum = std::chrono::microseconds(100) + std::chrono::milliseconds(1) + std::chrono::seconds(80);
+
+    std::string lText{MetricsExporter::Format(lSnapshot)};
+    ValidateFormat(lText);
+
+    EXPECT_NE(lText.find("mondevtopromisc_frames_total{direction=\"to_xlink_kai\"} 7\n"), std::string::npos);
+    EXPECT_NE(lText.find("mondevtopromisc_dropped_frames_total{reason=\"kernel\"} 3\n"), std::string::npos);
+    EXPECT_NE(lText.find("mondevtopromisc_xlink_kai_reconnects_total 2\n"), std::string::npos);
+    EXPECT_NE(lText.find("mondevtopromisc_bssid_switches_total 0\n"), std::string::npos);
+
+    // 1000 nanoseconds is below the first bound of 1024, a millisecond below 2^20.
+    std::string lBucket{"mondevtopromisc_latency_seconds_bucket{path=\"xlink_kai_to_monitor\",le=\""};
+    EXPECT_NE(lText.find(lBucket + "1.024e-06\"} 100\n"), std::string::npos);
+    EXPECT_NE(lText.find(lBucket + "0.000524288\"} 100\n"), std::string::npos);
+    EXPECT_NE(lText.find(lBucket + "0.001048576\"} 101\n"), std::string::npos);
+    // The last bucket holds everything too long for the histogram, so it does not count towards the last bound.
+    EXPECT_NE(lText.find(lBucket + "68.719476736\"} 101\n"), std::string::npos);
+    EXPECT_NE(lText.find(lBucket + "+Inf\"} 102\n"), std::string::npos);
+    EXPECT_NE(lText.find("mondevtopromisc_latency_seconds_sum{path=\"xlink_kai_to_monitor\"} 80.0011\n"),
+              std::string::npos);
+}
+
+TEST(MetricsExporterTest, Listen)
+{
+    MetricsExporter lExporter{};
+    ASSERT_TRUE(lExporter.Listen(0));
+    ASSERT_NE(lExporter.GetPort(), 0);
+    ASSERT_TRUE(lExporter.StartThread());
+
+    auto lRequest{[&](std::string_view aRequest) {
+        boost::asio::io_service   lIoService{};
+        tcp::socket               lSocket{lIoService};
+        std::string               lReturn{};
+        boost::system::error_code lError{};
+
+        lSocket.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), lExporter.GetPort()));
+        boost::asio::write(lSocket, boost::asio::buffer(aRequest));
+        boost::asio::read(lSocket, boost::asio::dynamic_buffer(lReturn), lError);
+        EXPECT_EQ(lError, boost::asio::error::eof);
+        return lReturn;
+    }};
+
+    std::string lResponse{lRequest("GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n")};
+    ASSERT_EQ(lResponse.rfind("HTTP/1.0 200 OK\r\n", 0), 0);
+    EXPECT_NE(lResponse.find(std::string("Content-Type: ") + std::string(cContentType)), std::string::npos);
+
+    std::string lBody{lResponse.substr(lResponse.find("\r\n\r\n") + 4)};
+    EXPECT_NE(lResponse.find("Content-Length: " + std::to_string(lBody.size()) + "\r\n"), std::string::npos);
+    ValidateFormat(lBody);
+
+    EXPECT_EQ(lRequest("GET /other HTTP/1.1\r\n\r\n").rfind("HTTP/1.0 404", 0), 0);
+    lExporter.Close();
+}
+
+TEST(MetricsExporterTest, TextFile)
+{
+    std::string lPath{"../Tests/Output/metrics.prom"};
+    std::filesystem::remove(lPath);
+
+    MetricsExporter lExporter{};
+    lExporter.SetTextFile(lPath);
+    ASSERT_TRUE(lExporter.StartThread());
+
+    // The first write happens right away.
+    for (int lTry = 0; lTry < 200 && !std::filesystem::exists(lPath); lTry++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    lExporter.Close();
+
+    std::ifstream     lFile{lPath};
+    std::stringstream lText{};
+    lText << lFile.rdbuf();
+    ValidateFormat(lText.str());
+    EXPECT_FALSE(std::filesystem::exists(lPath + ".tmp"));
+}
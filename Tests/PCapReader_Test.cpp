@@ -0,0 +1,81 @@
+/* Copyright (c) 2020 [Rick de Bondt] - PCapReader_Test.cpp
+ * This file contains tests for the PCapReader class.
+ **/
+
+#include "../Includes/PCapReader.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "ISendReceiveDeviceMock.h"
+
+using namespace PCapReader_Constants;
+using namespace std::chrono;
+using ::testing::_;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+namespace
+{
+    // PromiscuousHelloWorld.pcapng holds 12 packets spread over about 5.1 seconds.
+    constexpr unsigned int cHelloWorldPackets{12};
+    constexpr milliseconds cHelloWorldDuration{5124};
+}  // namespace
+
+class PCapReaderTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ON_CALL(*mSendReceiveDeviceMock, Send(_)).WillByDefault(Return(true));
+        ASSERT_TRUE(mPCapReader.Open("../Tests/Input/PromiscuousHelloWorld.pcapng", 2412));
+        mPCapReader.SetSendReceiveDevice(mSendReceiveDeviceMock);
+    }
+
+    void TearDown() override
+    {
+        mPCapReader.Close();
+    }
+
+    std::shared_ptr<NiceMock<ISendReceiveDeviceMock>> mSendReceiveDeviceMock{
+        std::make_shared<NiceMock<ISendReceiveDeviceMock>>()};
+    PCapReader mPCapReader{};
+};
+
+TEST_F(PCapReaderTest, ReplayWithSpeedMultiplier)
+{
+    ReplaySettings lSettings{};
+    lSettings.Speed = 10.0;
+
+    auto lStart{steady_clock::now()};
+    auto lResult{mPCapReader.ReplayPackets(false, false, lSettings)};
+    auto lElapsed{steady_clock::now() - lStart};
+
+    EXPECT_TRUE(lResult.first);
+    EXPECT_EQ(lResult.second, cHelloWorldPackets);
+
+    // Only lower bounds on time, a busy machine can always make the replay late.
+    const ReplayStatistics& lStatistics{mPCapReader.GetReplayStatistics()};
+    EXPECT_EQ(lStatistics.Packets, cHelloWorldPackets);
+    EXPECT_GE(lStatistics.Duration, cHelloWorldDuration / 10);
+    EXPECT_LE(lStatistics.Duration, lElapsed);
+    EXPECT_GE(lStatistics.MeanError.count(), 0);
+    EXPECT_GE(lStatistics.MaxError, lStatistics.MeanError);
+    // Lateness does not add up over the capture, so without the latest packet the replay is still sped up.
+    EXPECT_LT(lStatistics.Duration - lStatistics.MaxError, cHelloWorldDuration);
+}
+
+TEST_F(PCapReaderTest, ReplayMaxThroughput)
+{
+    ReplaySettings lSettings{};
+    lSettings.MaxThroughput = true;
+
+    auto lStart{steady_clock::now()};
+    auto lResult{mPCapReader.ReplayPackets(false, false, lSettings)};
+
+    // Not paced at all, so far below the duration of the capture even on a busy machine.
+    EXPECT_LT(steady_clock::now() - lStart, cHelloWorldDuration);
+    EXPECT_TRUE(lResult.first);
+    EXPECT_EQ(lResult.second, cHelloWorldPackets);
+    EXPECT_EQ(mPCapReader.GetReplayStatistics().Packets, cHelloWorldPackets);
+}
@@ -8,16 +8,8 @@
 #include <gtest/gtest.h>
 
 #include "../Includes/PCapReader.h"
+#include "ISendReceiveDeviceMock.h"
 
-class ISendReceiveDeviceMock : public ISendReceiveDevice
-{
-public:
-    MOCK_METHOD(void, Close, ());
-    MOCK_METHOD(std::string, LastDataToString, ());
-    MOCK_METHOD(bool, ReadNextData, ());
-    MOCK_METHOD(bool, Send, (std::string_view aData));
-    MOCK_METHOD(void, SetSendReceiveDevice, (std::shared_ptr<ISendReceiveDevice> aDevice));
-};
 class PacketConverterTest : public ::testing::Test
 {
 protected:
@@ -31,6 +23,17 @@ TEST_F(PacketConverterTest, MacToInt)
     ASSERT_EQ(aResult, 0x01234567abcd);
 }
 
+// Tests whether channels and frequencies convert back and forth, and anything outside 2.4GHz is refused.
+TEST_F(PacketConverterTest, FrequencyToChannel)
+{
+    for (int lChannel = 1; lChannel <= 13; lChannel++) {
+        EXPECT_EQ(PacketConverter::ConvertFrequencyToChannel(PacketConverter::ConvertChannelToFrequency(lChannel)),
+                  lChannel);
+    }
+    EXPECT_EQ(PacketConverter::ConvertFrequencyToChannel(2413), -1);
+    EXPECT_EQ(PacketConverter::ConvertFrequencyToChannel(5180), -1);
+}
+
 TEST_F(PacketConverterTest, PromiscuousToMonitor)
 {
     PCapReader        lPCapReader{};
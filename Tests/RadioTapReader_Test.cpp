@@ -0,0 +1,80 @@
+/* Copyright (c) 2020 [Rick de Bondt] - RadioTapReader_Test.cpp
+ * This file contains tests for the RadioTapReader class.
+ **/
+
+#include "../Includes/RadioTapReader.h"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+    // TSFT, flags, rate, channel and antenna signal, followed by another present word in the radiotap namespace.
+    constexpr uint32_t cPresentWithExtension{0xa000002f};
+    constexpr uint16_t cFrequency{2437};
+    constexpr uint16_t cChannelFlags{0x00a0};
+    constexpr int8_t   cSignal{-42};
+
+    void Append16(std::string& aBuffer, uint16_t aValue)
+    {
+        aBuffer += static_cast<char>(aValue & 0xffU);
+        aBuffer += static_cast<char>(aValue >> 8U);
+    }
+
+    void Append32(std::string& aBuffer, uint32_t aValue)
+    {
+        Append16(aBuffer, static_cast<uint16_t>(aValue & 0xffffU));
+        Append16(aBuffer, static_cast<uint16_t>(aValue >> 16U));
+    }
+}  // namespace
+
+// With two present words the TSFT field starts at 12, but has to be aligned to 16. Reading it from 12 makes the
+// flags, rate and channel come from the timestamp instead.
+TEST(RadioTapReaderTest, TSFTAfterExtendedPresentFlags)
+{
+    std::string lHeader{};
+    lHeader += '\0';  // Version
+    lHeader += '\0';  // Pad
+    Append16(lHeader, 31);
+    Append32(lHeader, cPresentWithExtension);
+    Append32(lHeader, 0);
+    lHeader.append(4, '\x55');  // Alignment padding, an offset of 12 would read this as the start of TSFT
+    lHeader.append(8, '\x11');  // TSFT
+    lHeader += '\x10';          // Flags, FCS at the end
+    lHeader += '\x0c';          // Rate
+    Append16(lHeader, cFrequency);
+    Append16(lHeader, cChannelFlags);
+    lHeader += static_cast<char>(cSignal);
+    ASSERT_EQ(lHeader.size(), 31);
+
+    RadioTapReader lReader{};
+    lReader.FillRadioTapParameters(lHeader);
+    EXPECT_EQ(lReader.GetLength(), 31);
+    EXPECT_EQ(lReader.GetFlags(), 0x10);
+    EXPECT_EQ(lReader.GetDataRate(), 0x0c);
+    EXPECT_EQ(lReader.GetFrequency(), cFrequency);
+    EXPECT_EQ(lReader.GetChannelFlags(), cChannelFlags);
+    ASSERT_TRUE(lReader.HasSignal());
+    EXPECT_EQ(lReader.GetSignal(), cSignal);
+}
+
+// The channel is aligned to 2 bytes, so after the flags alone there is a byte of padding.
+TEST(RadioTapReaderTest, ChannelAfterFlags)
+{
+    std::string lHeader{};
+    lHeader += '\0';  // Version
+    lHeader += '\0';  // Pad
+    Append16(lHeader, 14);
+    Append32(lHeader, 0x0000000a);
+    lHeader += '\x10';  // Flags, FCS at the end
+    lHeader += '\x55';  // Alignment padding
+    Append16(lHeader, cFrequency);
+    Append16(lHeader, cChannelFlags);
+    ASSERT_EQ(lHeader.size(), 14);
+
+    RadioTapReader lReader{};
+    lReader.FillRadioTapParameters(lHeader);
+    EXPECT_EQ(lReader.GetFlags(), 0x10);
+    EXPECT_EQ(lReader.GetFrequency(), cFrequency);
+    EXPECT_EQ(lReader.GetChannelFlags(), cChannelFlags);
+    EXPECT_FALSE(lReader.HasSignal());
+}
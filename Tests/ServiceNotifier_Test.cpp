@@ -0,0 +1,99 @@
+/* Copyright (c) 2020 [Rick de Bondt] - ServiceNotifier_Test.cpp
+ * This file contains tests for the ServiceNotifier class.
+ **/
+
+#include "../Includes/ServiceNotifier.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace ServiceNotifier_Constants;
+
+class ServiceNotifierTest : public ::testing::Test
+{
+public:
+    // Binds a datagram socket like the one a service manager listens on, names starting with @ are abstract.
+    void Bind(const std::string& aName)
+    {
+        mSocket = socket(AF_UNIX, SOCK_DGRAM, 0);
+        ASSERT_NE(mSocket, -1);
+
+        sockaddr_un lAddress{};
+        lAddress.sun_family = AF_UNIX;
+        std::memcpy(lAddress.sun_path, aName.data(), aName.size());
+        if (lAddress.sun_path[0] == '@') {
+            lAddress.sun_path[0] = '\0';
+        }
+
+        unlink(aName.c_str());
+        ASSERT_EQ(bind(mSocket,
+                       reinterpret_cast<sockaddr*>(&lAddress),
+                       static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + aName.size())),
+                  0);
+        setenv(cSocketVariable.data(), aName.c_str(), 1);
+    }
+
+    std::string Receive() const
+    {
+        std::array<char, 256> lBuffer{};
+        ssize_t               lReceived{recv(mSocket, lBuffer.data(), lBuffer.size(), MSG_DONTWAIT)};
+        return lReceived > 0 ? std::string(lBuffer.data(), lReceived) : "";
+    }
+
+    void TearDown() override
+    {
+        unsetenv(cSocketVariable.data());
+        if (mSocket != -1) {
+            close(mSocket);
+        }
+        unlink(mPath.c_str());
+    }
+
+    int         mSocket{-1};
+    std::string mPath{"../Tests/Output/notify.socket"};
+};
+
+TEST_F(ServiceNotifierTest, Disabled)
+{
+    unsetenv(cSocketVariable.data());
+    ServiceNotifier lNotifier{};
+
+    EXPECT_FALSE(lNotifier.IsEnabled());
+    EXPECT_FALSE(lNotifier.NotifyReady());
+}
+
+TEST_F(ServiceNotifierTest, Notify)
+{
+    Bind(mPath);
+    ServiceNotifier lNotifier{};
+    ASSERT_TRUE(lNotifier.IsEnabled());
+
+    EXPECT_TRUE(lNotifier.NotifyReady("Running"));
+    EXPECT_EQ(Receive(), "READY=1\nSTATUS=Running");
+
+    // A reload carries the time it started on the monotonic clock.
+    EXPECT_TRUE(lNotifier.NotifyReloading());
+    std::string lReloading{Receive()};
+    EXPECT_EQ(lReloading.rfind(std::string(cReloading) + "\n" + std::string(cMonotonicTime), 0), 0);
+    EXPECT_GT(std::stoull(lReloading.substr(lReloading.find('=', cReloading.size()) + 1)), 0);
+
+    EXPECT_TRUE(lNotifier.NotifyStopping());
+    EXPECT_EQ(Receive(), cStopping);
+}
+
+TEST_F(ServiceNotifierTest, AbstractSocket)
+{
+    Bind("@mondevtopromisc_test_" + std::to_string(getpid()));
+    ServiceNotifier lNotifier{};
+
+    EXPECT_TRUE(lNotifier.NotifyStatus("Bridging"));
+    EXPECT_EQ(Receive(), "STATUS=Bridging");
+}
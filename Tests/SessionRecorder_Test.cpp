@@ -0,0 +1,171 @@
+/* Copyright (c) 2020 [Rick de Bondt] - SessionRecorder_Test.cpp
+ * This file contains tests for the SessionRecorder class.
+ **/
+
+#include "../Includes/SessionRecorder.h"
+
+#include <cstdio>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "../Includes/MappedPCapReader.h"
+
+using namespace SessionRecorder_Constants;
+
+class SessionRecorderTest : public ::testing::Test
+{
+public:
+    void TearDown() override
+    {
+        for (auto& lFile : mFiles) {
+            std::remove(lFile.c_str());
+        }
+    }
+
+    std::vector<std::string> mFiles{};
+};
+
+// Both directions end up in the same file, each on an interface of its own.
+TEST_F(SessionRecorderTest, RecordBothDirections)
+{
+    SessionRecorder lRecorder{Settings{"../Tests/Output/RecordBothDirections"}};
+    ASSERT_TRUE(lRecorder.Open());
+
+    // Two threads recording at the same time, like the capture thread and the XLink Kai receiver thread.
+    std::thread lToXLinkKai{[&] {
+        for (int lCount = 0; lCount < 100; lCount++) {
+            lRecorder.Record(Direction::ToXLinkKai, "ethernet" + std::to_string(lCount));
+        }
+    }};
+    for (int lCount = 0; lCount < 100; lCount++) {
+        lRecorder.Record(Direction::ToMonitor, "80211_" + std::to_string(lCount));
+    }
+    lToXLinkKai.join();
+    lRecorder.Close();
+
+    mFiles = lRecorder.GetFiles();
+    ASSERT_EQ(mFiles.size(), 1);
+    EXPECT_EQ(lRecorder.GetRecordedCount(), 200);
+    EXPECT_EQ(lRecorder.GetDroppedCount(), 0);
+
+    MappedPCapReader lReader{};
+    ASSERT_TRUE(lReader.Open(mFiles.front(), 0));
+    EXPECT_EQ(lReader.GetFormat(), MappedPCapReader_Constants::Format::PCapNG);
+
+    std::array<int, 2> lNext{0, 0};
+    while (lReader.ReadNextData()) {
+        const MappedPCapReader_Constants::Frame& lFrame{lReader.GetFrame()};
+        ASSERT_LT(lFrame.Interface, 2);
+
+        // Order within a direction is kept, and timestamps are in nanoseconds.
+        std::string lExpected{(lFrame.Interface == 0 ? "ethernet" : "80211_") +
+                              std::to_string(lNext.at(lFrame.Interface)++)};
+        EXPECT_EQ(lFrame.Data, lExpected);
+        EXPECT_GT(lFrame.TimeStamp, std::chrono::hours(24 * 365 * 50));
+    }
+
+    ASSERT_EQ(lReader.GetInterfaces().size(), 2);
+    EXPECT_EQ(lReader.GetInterfaces().at(0).LinkType, DLT_EN10MB);
+    EXPECT_EQ(lReader.GetInterfaces().at(1).LinkType, DLT_IEEE802_11_RADIO);
+    EXPECT_EQ(lNext.at(0), 100);
+    EXPECT_EQ(lNext.at(1), 100);
+}
+
+TEST_F(SessionRecorderTest, RotateAndRemoveOldFiles)
+{
+    Settings lSettings{"../Tests/Output/RotateAndRemoveOldFiles"};
+    lSettings.MaxFileSize = 1024;
+    lSettings.MaxFiles    = 3;
+
+    SessionRecorder lRecorder{lSettings};
+    ASSERT_TRUE(lRecorder.Open());
+    for (int lCount = 0; lCount < 100; lCount++) {
+        lRecorder.Record(Direction::ToXLinkKai, std::string(100, static_cast<char>(lCount)));
+    }
+    lRecorder.Close();
+
+    mFiles = lRecorder.GetFiles();
+    ASSERT_EQ(mFiles.size(), 3);
+
+    // Every file is a complete capture of its own, with the newest frames in the last one.
+    int lLast{0};
+    for (auto& lFile : mFiles) {
+        MappedPCapReader lReader{};
+        ASSERT_TRUE(lReader.Open(lFile, 0));
+        ASSERT_TRUE(lReader.ReadNextData());
+        EXPECT_EQ(lReader.GetInterfaces().size(), 2);
+        EXPECT_LE(lReader.GetSize(), lSettings.MaxFileSize + 256);
+
+        do {
+            lLast = static_cast<uint8_t>(lReader.GetFrame().Data.front());
+        } while (lReader.ReadNextData());
+    }
+    EXPECT_EQ(lLast, 99);
+}
+
+// A full queue drops frames instead of blocking, and nothing is recorded while closed.
+TEST_F(SessionRecorderTest, DropWhenFull)
+{
+    Settings lSettings{"../Tests/Output/DropWhenFull"};
+    lSettings.QueueSize = 4;
+
+    SessionRecorder lRecorder{lSettings};
+    EXPECT_FALSE(lRecorder.Record(Direction::ToMonitor, "closed"));
+
+    ASSERT_TRUE(lRecorder.Open());
+    uint64_t lRecorded{0};
+    for (int lCount = 0; lCount < 10000; lCount++) {
+        lRecorded += lRecorder.Record(Direction::ToMonitor, std::string(64, 'x')) ? 1 : 0;
+    }
+    lRecorder.Close();
+    mFiles = lRecorder.GetFiles();
+
+    EXPECT_EQ(lRecorder.GetRecordedCount(), lRecorded);
+    EXPECT_EQ(lRecorder.GetRecordedCount() + lRecorder.GetDroppedCount(), 10000);
+
+    uint64_t         lRead{0};
+    MappedPCapReader lReader{};
+    ASSERT_TRUE(lReader.Open(mFiles.front(), 0));
+    while (lReader.ReadNextData()) {
+        lRead++;
+    }
+    EXPECT_EQ(lRead, lRecorded);
+}
+
+#if defined(HAVE_ZSTD)
+// Compressed recordings are several times the size of the read window, and read back the same as uncompressed ones.
+TEST_F(SessionRecorderTest, RecordCompressed)
+{
+    Settings lSettings{"../Tests/Output/RecordCompressed"};
+    lSettings.Compress  = true;
+    lSettings.QueueSize = 16384;
+
+    SessionRecorder lRecorder{lSettings};
+    ASSERT_TRUE(lRecorder.Open());
+    for (int lCount = 0; lCount < 12000; lCount++) {
+        std::string lFrame{std::to_string(lCount)};
+        lFrame.resize(1000, static_cast<char>(lCount));
+        lRecorder.Record(Direction::ToMonitor, lFrame);
+    }
+    lRecorder.Close();
+
+    mFiles = lRecorder.GetFiles();
+    ASSERT_EQ(mFiles.size(), 1);
+    EXPECT_TRUE(mFiles.front().ends_with(".pcapng.zst"));
+    EXPECT_EQ(lRecorder.GetDroppedCount(), 0);
+
+    MappedPCapReader lReader{};
+    ASSERT_TRUE(lReader.Open(mFiles.front(), 0));
+    EXPECT_TRUE(lReader.IsCompressed());
+    EXPECT_LT(lReader.GetSize(), 12000 * 1000 / 4);
+
+    int lRead{0};
+    while (lReader.ReadNextData()) {
+        EXPECT_TRUE(lReader.GetFrame().Data.starts_with(std::to_string(lRead)));
+        EXPECT_EQ(lReader.GetFrame().Data.size(), 1000);
+        lRead++;
+    }
+    EXPECT_EQ(lRead, 12000);
+}
+#endif
@@ -0,0 +1,132 @@
+/* Copyright (c) 2020 [Rick de Bondt] - Statistics_Test.cpp
+ * This file contains tests for the Statistics class.
+ **/
+
+#include "../Includes/Statistics.h"
+
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../Includes/TrafficGenerator.h"
+#include "../Includes/VirtualMonitorDevice.h"
+#include "ISendReceiveDeviceMock.h"
+
+using namespace Statistics_Constants;
+using namespace std::chrono;
+using ::testing::_;
+using ::testing::Return;
+
+// The registry is shared by the whole program, so tests only look at what changed while they ran.
+TEST(StatisticsTest, ConcurrentAdds)
+{
+    constexpr int cThreads{4};
+    constexpr int cAdds{10000};
+
+    Snapshot                 lBefore{Statistics::GetInstance().GetSnapshot()};
+    std::vector<std::thread> lThreads{};
+    for (int lThread = 0; lThread < cThreads; lThread++) {
+        lThreads.emplace_back([] {
+            for (int lAdd = 0; lAdd < cAdds; lAdd++) {
+                Statistics::GetInstance().Add(Counter::QueueDrops);
+                Statistics::GetInstance().Add(Counter::BytesToMonitor, 3);
+            }
+        });
+    }
+
+    // Taking snapshots while the threads count should not disturb them.
+    for (int lSnapshot = 0; lSnapshot < 100; lSnapshot++) {
+        EXPECT_GE(Statistics::GetInstance().GetSnapshot().Get(Counter::QueueDrops), lBefore.Get(Counter::QueueDrops));
+    }
+
+    for (auto& lThread : lThreads) {
+        lThread.join();
+    }
+
+    // Threads that have exited keep their counts.
+    Snapshot lAfter{Statistics::GetInstance().GetSnapshot()};
+    EXPECT_EQ(lAfter.Get(Counter::QueueDrops) - lBefore.Get(Counter::QueueDrops), cThreads * cAdds);
+    EXPECT_EQ(lAfter.Get(Counter::BytesToMonitor) - lBefore.Get(Counter::BytesToMonitor), cThreads * cAdds * 3);
+    EXPECT_GE(lAfter.TimeStamp, lBefore.TimeStamp);
+}
+
+// A new thread reuses the counters of one that has exited, without losing what was counted before.
+TEST(StatisticsTest, ThreadsComeAndGo)
+{
+    Snapshot lBefore{Statistics::GetInstance().GetSnapshot()};
+
+    for (int lThread = 0; lThread < 50; lThread++) {
+        std::thread([] { Statistics::GetInstance().Add(Counter::InjectFailures); }).join();
+    }
+
+    EXPECT_EQ(Statistics::GetInstance().GetSnapshot().Get(Counter::InjectFailures) -
+                  lBefore.Get(Counter::InjectFailures),
+              50);
+    EXPECT_EQ(std::set<std::string_view>(cCounterNames.begin(), cCounterNames.end()).size(), cCounterCount);
+}
+
+TEST(StatisticsTest, Latencies)
+{
+    // Nothing else in the tests acknowledges frames.
+    Snapshot lBefore{Statistics::GetInstance().GetSnapshot()};
+    ASSERT_EQ(lBefore.Get(Latency::Acknowledgement).Count, 0);
+
+    for (int lLatency = 1; lLatency <= 1000; lLatency++) {
+        Statistics::GetInstance().AddLatency(Latency::Acknowledgement, microseconds(lLatency));
+    }
+    Statistics::GetInstance().AddLatency(Latency::Acknowledgement, microseconds(-5));
+
+    Snapshot                lAfter{Statistics::GetInstance().GetSnapshot()};
+    const LatencyHistogram& lHistogram{lAfter.Get(Latency::Acknowledgement)};
+    EXPECT_EQ(lHistogram.Count, 1001);
+    EXPECT_EQ(lHistogram.Sum, microseconds(1000 * 1001 / 2));
+    EXPECT_EQ(lHistogram.Max, microseconds(1000));
+    EXPECT_EQ(lHistogram.GetPercentile(0), nanoseconds(0));
+    EXPECT_NEAR(lHistogram.GetPercentile(50).count(), nanoseconds(microseconds(500)).count(), 500 * 1000 / 16);
+    EXPECT_NEAR(lHistogram.GetPercentile(99).count(), nanoseconds(microseconds(990)).count(), 990 * 1000 / 16);
+    EXPECT_LE(lHistogram.GetPercentile(100), lHistogram.Max);
+    EXPECT_EQ(lBefore.Get(Latency::MonitorToXLinkKai).GetPercentile(99.9), nanoseconds(0));
+}
+
+TEST(StatisticsTest, VirtualMonitorDevice)
+{
+    TrafficGenerator_Constants::Settings    lSettings{};
+    TrafficGenerator                        lGenerator{lSettings};
+    VirtualMonitorDevice                    lDevice{};
+    std::shared_ptr<ISendReceiveDeviceMock> lMock{std::make_shared<ISendReceiveDeviceMock>()};
+    std::vector<std::string>                lSSIDFilter{};
+
+    ASSERT_TRUE(lDevice.Open("", lSSIDFilter, lSettings.Frequency));
+    lDevice.SetSendReceiveDevice(lMock);
+    EXPECT_CALL(*lMock, Send(_)).WillOnce(Return(true)).WillOnce(Return(false));
+
+    Snapshot    lBefore{Statistics::GetInstance().GetSnapshot()};
+    auto        lTimeStamp{steady_clock::now()};
+    std::string lFrame{lGenerator.Generate80211Frame(lTimeStamp)};
+
+    // Without a BSSID set the frame is not ours.
+    EXPECT_FALSE(lDevice.Receive(lFrame));
+    lDevice.SetBSSID(lSettings.BSSID);
+    EXPECT_TRUE(lDevice.Receive(lFrame));
+    EXPECT_TRUE(lDevice.Send(lGenerator.Generate8023Frame(lTimeStamp), system_clock::now() - milliseconds(5)));
+
+    Snapshot lAfter{Statistics::GetInstance().GetSnapshot()};
+    auto     lDifference{[&](Counter aCounter) { return lAfter.Get(aCounter) - lBefore.Get(aCounter); }};
+    EXPECT_EQ(lDifference(Counter::FramesCaptured), 2);
+    EXPECT_EQ(lDifference(Counter::DataFrames), 2);
+    EXPECT_EQ(lDifference(Counter::FilteredBSSID), 1);
+    EXPECT_EQ(lDifference(Counter::Converted), 2);
+    EXPECT_EQ(lDifference(Counter::ForwardedToXLinkKai), 1);
+    EXPECT_GT(lDifference(Counter::BytesToXLinkKai), 0);
+    EXPECT_EQ(lDifference(Counter::Injected), 1);
+    EXPECT_GT(lDifference(Counter::BytesToMonitor), 0);
+    EXPECT_EQ(lAfter.Get(Latency::XLinkKaiToMonitor).Count - lBefore.Get(Latency::XLinkKaiToMonitor).Count, 1);
+    EXPECT_GE(lAfter.Get(Latency::XLinkKaiToMonitor).Max, milliseconds(5));
+
+    // A frame the send/receive device failed to send is not counted as forwarded.
+    EXPECT_EQ(lDevice.GetForwardedCount(), 1);
+    EXPECT_TRUE(lDevice.Receive(lFrame));
+    EXPECT_EQ(lDevice.GetForwardedCount(), 1);
+}
@@ -0,0 +1,90 @@
+/* Copyright (c) 2020 [Rick de Bondt] - TrafficGenerator_Test.cpp
+ * This file contains tests for the TrafficGenerator class.
+ **/
+
+#include "../Includes/TrafficGenerator.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "../Includes/VirtualMonitorDevice.h"
+#include "ISendReceiveDeviceMock.h"
+
+using namespace TrafficGenerator_Constants;
+using ::testing::_;
+
+class TrafficGeneratorTest : public ::testing::Test
+{
+protected:
+    Settings mSettings{};
+};
+
+TEST_F(TrafficGeneratorTest, FrameInformation)
+{
+    mSettings.Consoles = 2;
+    TrafficGenerator lGenerator{mSettings};
+    auto             lTimeStamp{std::chrono::steady_clock::now()};
+
+    for (uint32_t lCount = 0; lCount < 4; lCount++) {
+        std::string      lFrame{lGenerator.Generate8023Frame(lTimeStamp)};
+        FrameInformation lInformation{TrafficGenerator::ReadFrameInformation(lFrame, c8023PayloadIndex)};
+
+        ASSERT_TRUE(lInformation.Valid);
+        EXPECT_EQ(lInformation.Console, lCount % 2);
+        EXPECT_EQ(lInformation.Sequence, lCount / 2);
+        EXPECT_EQ(lInformation.TimeStamp, lTimeStamp);
+        EXPECT_GE(lFrame.size(), mSettings.MinSize);
+        EXPECT_LE(lFrame.size(), mSettings.MaxSize);
+    }
+
+    EXPECT_EQ(lGenerator.GetFramesGenerated(), 4);
+    EXPECT_FALSE(TrafficGenerator::ReadFrameInformation("not a generated frame", 0).Valid);
+}
+
+TEST_F(TrafficGeneratorTest, SameSeedSameTraffic)
+{
+    TrafficGenerator lFirst{mSettings};
+    TrafficGenerator lSecond{mSettings};
+    auto             lTimeStamp{std::chrono::steady_clock::now()};
+
+    for (int lCount = 0; lCount < 16; lCount++) {
+        EXPECT_EQ(lFirst.Generate8023Frame(lTimeStamp), lSecond.Generate8023Frame(lTimeStamp));
+    }
+}
+
+// Generated 802.11 frames should make it through the conversion of the bridge in both directions.
+TEST_F(TrafficGeneratorTest, ThroughVirtualMonitorDevice)
+{
+    TrafficGenerator                        lGenerator{mSettings};
+    VirtualMonitorDevice                    lDevice{};
+    std::shared_ptr<ISendReceiveDeviceMock> lMock{std::make_shared<ISendReceiveDeviceMock>()};
+    std::vector<std::string>                lSSIDFilter{};
+    std::string                             lForwarded{};
+    std::string                             lInjected{};
+
+    ASSERT_TRUE(lDevice.Open("", lSSIDFilter, mSettings.Frequency));
+    lDevice.SetBSSID(mSettings.BSSID);
+    lDevice.SetSendReceiveDevice(lMock);
+    lDevice.SetInjectCallback([&](std::string_view aData) { lInjected = aData; });
+
+    EXPECT_CALL(*lMock, Send(_)).WillOnce([&](std::string_view aData) {
+        lForwarded = aData;
+        return true;
+    });
+
+    auto lTimeStamp{std::chrono::steady_clock::now()};
+    EXPECT_TRUE(lDevice.Receive(lGenerator.Generate80211Frame(lTimeStamp)));
+
+    FrameInformation lInformation{TrafficGenerator::ReadFrameInformation(lForwarded, c8023PayloadIndex)};
+    ASSERT_TRUE(lInformation.Valid);
+    EXPECT_EQ(lInformation.TimeStamp, lTimeStamp);
+    EXPECT_EQ(lDevice.GetForwardedCount(), 1);
+
+    EXPECT_TRUE(lDevice.Send(lForwarded));
+    lInformation = TrafficGenerator::ReadFrameInformation(lInjected, c80211PayloadIndex);
+    ASSERT_TRUE(lInformation.Valid);
+    EXPECT_EQ(lInformation.TimeStamp, lTimeStamp);
+    EXPECT_EQ(lDevice.GetInjectedCount(), 1);
+
+    lDevice.Close();
+}
@@ -4,10 +4,14 @@
 
 #include "../Includes/WindowModel.h"
 
+#include <array>
 #include <fstream>
 
+#include <boost/program_options.hpp>
 #include <gtest/gtest.h>
 
+namespace po = boost::program_options;
+
 class WindowModelTest : public ::testing::Test
 {
 public:
@@ -64,4 +68,50 @@ TEST_F(WindowModelTest, LoadModel)
     EXPECT_EQ(mWindowModel.mWifiAdapter, WindowModel_Constants::cDefaultWifiAdapter);
     EXPECT_EQ(mWindowModel.mXLinkIp, WindowModel_Constants::cDefaultXLinkIp);
     EXPECT_EQ(mWindowModel.mXLinkPort, WindowModel_Constants::cDefaultXLinkPort);
-}
\ No newline at end of file
+    EXPECT_EQ(mWindowModel.mRecordSession, WindowModel_Constants::cDefaultRecordSession);
+    EXPECT_EQ(mWindowModel.mRecordingPath, WindowModel_Constants::cDefaultRecordingPath);
+    EXPECT_EQ(mWindowModel.mCompressRecording, WindowModel_Constants::cDefaultCompressRecording);
+}
+TEST_F(WindowModelTest, AdditionalSessions)
+{
+    mWindowModel.mAdditionalSessions = "PSP2,wlan1,6;PSP3,wlan2;broken;;PSP4,,11";
+
+    std::vector<WindowModel_Constants::SessionSetting> lSessions{mWindowModel.GetAdditionalSessions()};
+
+    // Sessions without a name or adapter are skipped, the channel falls back to the default.
+    ASSERT_EQ(lSessions.size(), 2);
+    EXPECT_EQ(lSessions.at(0).LocallyUniqueName, "PSP2");
+    EXPECT_EQ(lSessions.at(0).WifiAdapter, "wlan1");
+    EXPECT_EQ(lSessions.at(0).Channel, "6");
+    EXPECT_EQ(lSessions.at(1).LocallyUniqueName, "PSP3");
+    EXPECT_EQ(lSessions.at(1).WifiAdapter, "wlan2");
+    EXPECT_EQ(lSessions.at(1).Channel, WindowModel_Constants::cDefaultChannel);
+}
+
+// The command line only overrides the settings it names, the rest keeps what the config file said.
+TEST_F(WindowModelTest, CommandLineOptions)
+{
+    ASSERT_TRUE(mWindowModel.LoadFromFile("../Tests/Input/config_expected.txt"));
+
+    po::options_description lDescription{};
+    mWindowModel.AddCommandLineOptions(lDescription);
+
+    std::array<const char*, 7> lArguments{
+        "mondevtopromisc", "--log-level", "Warning", "--channel", "11", "--record-session", "--xlink-kai-hints=false"};
+    po::variables_map lVariables{};
+    po::store(po::parse_command_line(static_cast<int>(lArguments.size()), lArguments.data(), lDescription),
+              lVariables);
+    po::notify(lVariables);
+
+    EXPECT_EQ(mWindowModel.mLogLevel, Logger::Level::WARNING);
+    EXPECT_EQ(mWindowModel.mChannel, "11");
+    EXPECT_TRUE(mWindowModel.mRecordSession);
+    EXPECT_FALSE(mWindowModel.mXLinkKaiHints);
+    EXPECT_TRUE(mWindowModel.mAutoDiscoverXLinkKaiInstance);
+    EXPECT_EQ(mWindowModel.mXLinkPort, WindowModel_Constants::cDefaultXLinkPort);
+
+    // Notifying again after reloading the config puts the command line back on top.
+    mWindowModel.mChannel = "6";
+    po::notify(lVariables);
+    EXPECT_EQ(mWindowModel.mChannel, "11");
+}
@@ -0,0 +1,145 @@
+/* Copyright (c) 2020 [Rick de Bondt] - XLinkKaiConnection_Test.cpp
+ * This file contains tests for the XLinkKaiConnection class.
+ **/
+
+#include "../Includes/XLinkKaiConnection.h"
+
+#include <future>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "../Includes/FakeXLinkKaiEngine.h"
+#include "ISendReceiveDeviceMock.h"
+
+using namespace FakeXLinkKaiEngine_Constants;
+using ::testing::InvokeWithoutArgs;
+
+namespace
+{
+    constexpr std::chrono::milliseconds cWaitTime{3000};
+
+    // The connection state is updated after the message has been sent, so it can lag behind what the engine has seen.
+    bool WaitForState(const XLinkKaiConnection& aConnection, ConnectionState aState)
+    {
+        auto lDeadline{std::chrono::steady_clock::now() + cWaitTime};
+        while (aConnection.GetConnectionState() != aState && std::chrono::steady_clock::now() < lDeadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return aConnection.GetConnectionState() == aState;
+    }
+}  // namespace
+
+class XLinkKaiConnectionEngineTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(mEngine.Open());
+        ASSERT_TRUE(mEngine.StartReceiverThread());
+        ASSERT_TRUE(mConnection.Open(cIp, mEngine.GetPort()));
+    }
+
+    void TearDown() override
+    {
+        mConnection.Close();
+        mEngine.Close();
+    }
+
+    FakeXLinkKaiEngine mEngine{};
+    XLinkKaiConnection mConnection{};
+};
+
+// Tests whether every message type XLink Kai sends is recognized by its prefix.
+TEST(XLinkKaiConnectionTest, ParseCommand)
+{
+    EXPECT_EQ(ParseCommand("e;e;\x01\x02\x03"), Command::EthernetData);
+    EXPECT_EQ(ParseCommand(cKeepAliveString), Command::KeepAlive);
+    EXPECT_EQ(ParseCommand(cConnectedString), Command::Connected);
+    EXPECT_EQ(ParseCommand(cDisconnectedString), Command::Disconnected);
+    EXPECT_EQ(ParseCommand("setting;ddns;1"), Command::Setting);
+    EXPECT_EQ(ParseCommand("chat;hello"), Command::Chat);
+}
+
+// Tests whether partial or unknown messages are not mistaken for a known command.
+TEST(XLinkKaiConnectionTest, ParseCommandUnknown)
+{
+    EXPECT_EQ(ParseCommand(""), Command::Unknown);
+    EXPECT_EQ(ParseCommand("e;"), Command::Unknown);
+    EXPECT_EQ(ParseCommand("e;d;"), Command::Unknown);
+    EXPECT_EQ(ParseCommand("connected"), Command::Unknown);
+    EXPECT_EQ(ParseCommand("info;"), Command::Unknown);
+}
+
+// Tests whether the connection handshake completes against the engine.
+TEST_F(XLinkKaiConnectionEngineTest, Connect)
+{
+    ASSERT_TRUE(mConnection.StartReceiverThread());
+    ASSERT_TRUE(mEngine.WaitForConnection(cWaitTime));
+    EXPECT_EQ(mEngine.GetClientName(), cLocallyUniqueName);
+    EXPECT_TRUE(WaitForState(mConnection, ConnectionState::Connected));
+}
+
+// Tests whether frames and keepalives flow in both directions once connected.
+TEST_F(XLinkKaiConnectionEngineTest, ExchangeData)
+{
+    std::shared_ptr<ISendReceiveDeviceMock> lDevice{std::make_shared<ISendReceiveDeviceMock>()};
+    std::promise<void>                      lFrameForwarded{};
+    EXPECT_CALL(*lDevice, Send(std::string_view("frame"))).WillOnce(InvokeWithoutArgs([&] {
+        lFrameForwarded.set_value();
+        return true;
+    }));
+    mConnection.SetSendReceiveDevice(lDevice);
+
+    ASSERT_TRUE(mConnection.StartReceiverThread());
+    ASSERT_TRUE(mEngine.WaitForConnection(cWaitTime));
+
+    ASSERT_TRUE(mEngine.SendKeepAlive());
+    ASSERT_TRUE(mEngine.WaitForMessages(ClientCommand::KeepAlive, 1, cWaitTime));
+
+    ASSERT_TRUE(mEngine.SendEthernetData("frame"));
+    ASSERT_EQ(lFrameForwarded.get_future().wait_for(cWaitTime), std::future_status::ready);
+
+    ASSERT_TRUE(mConnection.Send("reply"));
+    ASSERT_TRUE(mEngine.WaitForMessages(ClientCommand::EthernetData, 1, cWaitTime));
+    EXPECT_EQ(mEngine.GetReceivedMessages().back().Data, cEthernetDataString + "reply");
+}
+
+// Tests whether frames sent before the connection was confirmed are delivered once it is, in the order they were sent.
+TEST_F(XLinkKaiConnectionEngineTest, PreConnectQueue)
+{
+    // Confirming late leaves room to send frames while the connection is still being set up.
+    mEngine.SetConnectDelay(std::chrono::milliseconds(200));
+    ASSERT_TRUE(mConnection.StartReceiverThread());
+    ASSERT_TRUE(mEngine.WaitForMessages(ClientCommand::Connect, 1, cWaitTime));
+
+    ASSERT_TRUE(WaitForState(mConnection, ConnectionState::Connecting));
+    ASSERT_TRUE(mConnection.Send("first"));
+    ASSERT_TRUE(mConnection.Send("second"));
+    EXPECT_EQ(mEngine.GetReceivedCount(ClientCommand::EthernetData), 0);
+
+    // The confirmation is on its way now, so this frame races the queue being flushed.
+    ASSERT_TRUE(mEngine.WaitForConnection(cWaitTime));
+    ASSERT_TRUE(mConnection.Send("third"));
+
+    ASSERT_TRUE(mEngine.WaitForMessages(ClientCommand::EthernetData, 3, cWaitTime));
+    std::vector<std::string> lFrames{};
+    for (const auto& lMessage : mEngine.GetReceivedMessages()) {
+        if (lMessage.Type == ClientCommand::EthernetData) {
+            lFrames.emplace_back(lMessage.Data.substr(cEthernetDataString.size()));
+        }
+    }
+    EXPECT_EQ(lFrames, (std::vector<std::string>{"first", "second", "third"}));
+}
+
+// Tests whether the connection comes back after the engine has disconnected it.
+TEST_F(XLinkKaiConnectionEngineTest, Reconnect)
+{
+    ASSERT_TRUE(mConnection.StartReceiverThread());
+    ASSERT_TRUE(mEngine.WaitForConnection(cWaitTime));
+    ASSERT_TRUE(mEngine.WaitForMessages(ClientCommand::Connect, 1, cWaitTime));
+
+    ASSERT_TRUE(mEngine.SendDisconnected());
+    ASSERT_TRUE(mEngine.WaitForMessages(ClientCommand::Connect, 2, cWaitTime));
+    ASSERT_TRUE(mEngine.WaitForConnection(cWaitTime));
+}
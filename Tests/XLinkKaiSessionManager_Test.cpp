@@ -0,0 +1,124 @@
+/* Copyright (c) 2020 [Rick de Bondt] - XLinkKaiSessionManager_Test.cpp
+ * This file contains tests for the XLinkKaiSessionManager class.
+ **/
+
+#include "../Includes/XLinkKaiSessionManager.h"
+
+#include <future>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "../Includes/FakeXLinkKaiEngine.h"
+#include "ISendReceiveDeviceMock.h"
+
+using namespace FakeXLinkKaiEngine_Constants;
+using ::testing::_;
+using ::testing::InvokeWithoutArgs;
+
+namespace
+{
+    constexpr std::chrono::milliseconds cWaitTime{3000};
+    constexpr std::chrono::milliseconds cReconnectDelay{1000};
+    constexpr std::chrono::milliseconds cExchangeTime{500};
+    constexpr std::string_view          cFirstName{"first"};
+    constexpr std::string_view          cSecondName{"second"};
+}  // namespace
+
+class XLinkKaiSessionManagerTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(mEngine.Open());
+        ASSERT_TRUE(mEngine.StartReceiverThread());
+
+        mFirst  = mManager.AddSession(cFirstName);
+        mSecond = mManager.AddSession(cSecondName);
+        ASSERT_NE(mFirst, nullptr);
+        ASSERT_NE(mSecond, nullptr);
+        ASSERT_TRUE(mFirst->Open(cIp, mEngine.GetPort()));
+        ASSERT_TRUE(mSecond->Open(cIp, mEngine.GetPort()));
+        mFirst->SetSendReceiveDevice(mFirstDevice);
+        mSecond->SetSendReceiveDevice(mSecondDevice);
+    }
+
+    void TearDown() override
+    {
+        mManager.Close();
+        mEngine.Close();
+    }
+
+    FakeXLinkKaiEngine                      mEngine{};
+    XLinkKaiSessionManager                  mManager{};
+    std::shared_ptr<XLinkKaiConnection>     mFirst{nullptr};
+    std::shared_ptr<XLinkKaiConnection>     mSecond{nullptr};
+    std::shared_ptr<ISendReceiveDeviceMock> mFirstDevice{std::make_shared<ISendReceiveDeviceMock>()};
+    std::shared_ptr<ISendReceiveDeviceMock> mSecondDevice{std::make_shared<ISendReceiveDeviceMock>()};
+};
+
+// Tests whether a name can only be used by one session, and sessions can't be added while running.
+TEST_F(XLinkKaiSessionManagerTest, AddSession)
+{
+    EXPECT_EQ(mManager.AddSession(cFirstName), nullptr);
+    EXPECT_EQ(mManager.GetSessions().size(), 2);
+
+    ASSERT_TRUE(mManager.StartReceiverThread());
+    EXPECT_EQ(mManager.AddSession("third"), nullptr);
+    EXPECT_EQ(mManager.GetSessions().size(), 2);
+}
+
+// Tests whether both sessions connect under their own name and frames end up at the right session.
+TEST_F(XLinkKaiSessionManagerTest, ExchangeData)
+{
+    std::promise<void> lFrameForwarded{};
+    EXPECT_CALL(*mFirstDevice, Send(_)).Times(0);
+    EXPECT_CALL(*mSecondDevice, Send(std::string_view("to second"))).WillOnce(InvokeWithoutArgs([&] {
+        lFrameForwarded.set_value();
+        return true;
+    }));
+
+    ASSERT_TRUE(mManager.StartReceiverThread());
+    ASSERT_TRUE(mEngine.WaitForConnection(cWaitTime, cFirstName));
+    ASSERT_TRUE(mEngine.WaitForConnection(cWaitTime, cSecondName));
+    EXPECT_EQ(mEngine.GetConnectedClients(), (std::vector<std::string>{"first", "second"}));
+
+    ASSERT_TRUE(mFirst->Send("from first"));
+    ASSERT_TRUE(mEngine.WaitForMessages(ClientCommand::EthernetData, 1, cWaitTime, cFirstName));
+    EXPECT_EQ(mEngine.GetReceivedCount(ClientCommand::EthernetData, cSecondName), 0);
+    EXPECT_EQ(mEngine.GetReceivedMessages().back().Data, cEthernetDataString + "from first");
+    EXPECT_EQ(mEngine.GetReceivedMessages().back().Client, cFirstName);
+
+    ASSERT_TRUE(mEngine.SendEthernetData("to second", cSecondName));
+    ASSERT_EQ(lFrameForwarded.get_future().wait_for(cWaitTime), std::future_status::ready);
+}
+
+// Tests whether one session reconnecting does not hold up traffic of the other session.
+TEST_F(XLinkKaiSessionManagerTest, ReconnectDoesNotStall)
+{
+    std::promise<void> lFrameForwarded{};
+    EXPECT_CALL(*mSecondDevice, Send(std::string_view("to second"))).WillOnce(InvokeWithoutArgs([&] {
+        lFrameForwarded.set_value();
+        return true;
+    }));
+
+    ASSERT_TRUE(mManager.StartReceiverThread());
+    ASSERT_TRUE(mEngine.WaitForConnection(cWaitTime, cFirstName));
+    ASSERT_TRUE(mEngine.WaitForConnection(cWaitTime, cSecondName));
+
+    // The first session gets disconnected and is kept waiting for a while when it comes back.
+    mEngine.SetConnectDelay(cReconnectDelay);
+    ASSERT_TRUE(mEngine.SendDisconnected(cFirstName));
+    ASSERT_TRUE(mEngine.WaitForMessages(ClientCommand::Connect, 2, cWaitTime, cFirstName));
+
+    // Meanwhile the second session keeps exchanging frames in both directions.
+    ASSERT_TRUE(mSecond->Send("from second"));
+    ASSERT_TRUE(mEngine.WaitForMessages(ClientCommand::EthernetData, 1, cExchangeTime, cSecondName));
+    ASSERT_TRUE(mEngine.SendEthernetData("to second", cSecondName));
+    ASSERT_EQ(lFrameForwarded.get_future().wait_for(cExchangeTime), std::future_status::ready);
+    EXPECT_EQ(mFirst->GetConnectionState(), ConnectionState::Connecting);
+    EXPECT_EQ(mSecond->GetConnectionState(), ConnectionState::Connected);
+
+    ASSERT_TRUE(mEngine.WaitForConnection(cWaitTime, cFirstName));
+    EXPECT_EQ(mEngine.GetConnectedClients(), (std::vector<std::string>{"first", "second"}));
+}
@@ -0,0 +1,186 @@
+/* Copyright (c) 2020 [Rick de Bondt] - CaptureAnalyzer.cpp
+ *
+ * Prints a summary of a capture file: who sent what, how much, how often it had to be retried and where it went quiet.
+ *
+ * */
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "../Includes/CaptureAnalyzer.h"
+#include "../Includes/Logger.h"
+
+namespace po = boost::program_options;
+using namespace CaptureAnalyzer_Constants;
+using namespace std::chrono;
+
+namespace
+{
+    double ToMilliseconds(nanoseconds aDuration)
+    {
+        return duration<double, std::milli>(aDuration).count();
+    }
+
+    double GetRatio(uint64_t aPart, uint64_t aTotal)
+    {
+        return aTotal > 0 ? 100.0 * static_cast<double>(aPart) / static_cast<double>(aTotal) : 0.0;
+    }
+
+    // Entries of a map sorted by frame count, most first.
+    template<typename Map> std::vector<typename Map::const_iterator> GetTop(const Map& aMap, unsigned int aCount)
+    {
+        std::vector<typename Map::const_iterator> lReturn{};
+        for (auto lIterator = aMap.begin(); lIterator != aMap.end(); lIterator++) {
+            lReturn.push_back(lIterator);
+        }
+
+        std::stable_sort(lReturn.begin(), lReturn.end(), [](const auto& aFirst, const auto& aSecond) {
+            return aFirst->second.Frames > aSecond->second.Frames;
+        });
+        lReturn.resize(std::min<std::size_t>(lReturn.size(), aCount));
+
+        return lReturn;
+    }
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    Settings                           lSettings{};
+    std::string                        lInput{};
+    unsigned int                       lGapThreshold{static_cast<unsigned int>(cDefaultGapThreshold.count())};
+    unsigned int                       lRateInterval{static_cast<unsigned int>(cDefaultRateInterval.count())};
+    unsigned int                       lTop{10};
+    po::options_description            lDescription{"Capture analyzer options"};
+    po::positional_options_description lPositional{};
+
+    // clang-format off
+    lDescription.add_options()
+        ("help,h", "Show this help")
+        ("input,i", po::value<std::string>(&lInput)->required(),
+         "Capture file to read, pcap or pcapng, optionally zstd compressed (.zst)")
+        ("gap", po::value<unsigned int>(&lGapThreshold)->default_value(lGapThreshold),
+         "Report silences longer than this, in milliseconds")
+        ("interval", po::value<unsigned int>(&lRateInterval)->default_value(lRateInterval),
+         "Length of the intervals rates are shown for, in milliseconds")
+        ("top", po::value<unsigned int>(&lTop)->default_value(lTop), "Amount of BSSIDs, stations and gaps to show")
+        ("threads,t", po::value<unsigned int>(&lSettings.Threads)->default_value(lSettings.Threads),
+         "Worker threads, 0 uses all cores")
+        ("chunk-size", po::value<unsigned int>(&lSettings.ChunkSize)->default_value(lSettings.ChunkSize),
+         "Frames scanned per work item");
+    // clang-format on
+    lPositional.add("input", 1);
+
+    po::variables_map lVariables{};
+    try {
+        po::store(po::command_line_parser(argc, argv).options(lDescription).positional(lPositional).run(), lVariables);
+        if (lVariables.count("help") > 0) {
+            std::cout << lDescription << std::endl;
+            return 0;
+        }
+        po::notify(lVariables);
+    } catch (const po::error& lException) {
+        std::cerr << lException.what() << std::endl << lDescription << std::endl;
+        return 1;
+    }
+
+    lSettings.GapThreshold = milliseconds(lGapThreshold);
+    lSettings.RateInterval = milliseconds(std::max(lRateInterval, 1U));
+
+    Logger::GetInstance().Init(Logger::Level::ERROR, false, "");
+    Logger::GetInstance().SetLogToScreen(true);
+
+    CaptureAnalyzer lAnalyzer{lSettings};
+    if (!lAnalyzer.Analyze(lInput)) {
+        return 1;
+    }
+
+    const Report& lReport{lAnalyzer.GetReport()};
+    double        lSpan{duration<double>(lReport.LastTimeStamp - lReport.FirstTimeStamp).count()};
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << lInput << ": " << lReport.Frames << " frames, " << lReport.Bytes << " bytes over " << lSpan
+              << "s, analyzed in " << duration<double>(lReport.Duration).count() << "s using " << lReport.Chunks
+              << " chunks" << std::endl;
+    if (lReport.Malformed > 0) {
+        std::cout << lReport.Malformed << " frames too short to read" << std::endl;
+    }
+
+    std::cout << std::endl << "Frame types:" << std::endl;
+    for (const auto& lEntry : GetTop(lReport.FrameTypes, UINT32_MAX)) {
+        std::cout << "  " << std::left << std::setw(32) << CaptureAnalyzer::GetFrameTypeName(lEntry->first)
+                  << std::right << std::setw(10) << lEntry->second.Frames << " frames " << std::setw(12)
+                  << lEntry->second.Bytes << " bytes" << std::endl;
+    }
+
+    if (!lReport.BSSIDs.empty()) {
+        std::cout << std::endl << "BSSIDs:" << std::endl;
+        for (const auto& lEntry : GetTop(lReport.BSSIDs, lTop)) {
+            std::cout << "  " << PacketConverter::IntToMac(lEntry->first) << std::setw(10) << lEntry->second.Frames
+                      << " frames " << std::setw(12) << lEntry->second.Bytes << " bytes" << std::endl;
+        }
+    }
+
+    std::cout << std::endl << "Stations:" << std::endl;
+    for (const auto& lEntry : GetTop(lReport.Stations, lTop)) {
+        const Station& lStation{lEntry->second};
+        std::cout << "  " << PacketConverter::IntToMac(lEntry->first) << std::setw(10) << lStation.Frames
+                  << " frames " << std::setw(12) << lStation.Bytes << " bytes " << std::setprecision(1)
+                  << std::setw(5) << GetRatio(lStation.Retries, lStation.Frames) << "% retries";
+        if (lStation.SignalFrames > 0) {
+            std::cout << ", average signal " << static_cast<double>(lStation.SignalSum) / lStation.SignalFrames
+                      << " dBm";
+        }
+        std::cout << std::setprecision(3) << std::endl;
+    }
+
+    double lInterval{duration<double>(lSettings.RateInterval).count()};
+    std::cout << std::endl
+              << "Rates per " << duration_cast<milliseconds>(lSettings.RateInterval).count() << "ms:" << std::endl;
+    for (const auto& [lIndex, lCounters] : lReport.Rates) {
+        std::cout << "  " << std::setw(12) << lIndex * lInterval << "s " << std::setw(12)
+                  << lCounters.Frames / lInterval << " frames/s " << std::setw(14) << lCounters.Bytes / lInterval
+                  << " bytes/s" << std::endl;
+    }
+
+    if (lReport.WirelessFrames > 0) {
+        std::cout << std::endl
+                  << "Retries: " << lReport.Retries << " (" << GetRatio(lReport.Retries, lReport.WirelessFrames)
+                  << "%), duplicates: " << lReport.Duplicates << " ("
+                  << GetRatio(lReport.Duplicates, lReport.WirelessFrames) << "%)" << std::endl;
+    }
+
+    std::cout << std::endl << "Inter-arrival times:";
+    for (double lPercentile : {50.0, 90.0, 99.0, 99.9}) {
+        std::cout << " p" << std::setprecision(lPercentile == 99.9 ? 1 : 0) << lPercentile << " "
+                  << std::setprecision(3)
+                  << ToMilliseconds(CaptureAnalyzer::GetIntervalPercentile(lReport, lPercentile)) << "ms";
+    }
+    std::cout << " max " << ToMilliseconds(lReport.MaxInterval) << "ms" << std::endl;
+
+    if (std::any_of(lReport.Signals.begin(), lReport.Signals.end(), [](uint64_t aCount) { return aCount > 0; })) {
+        std::cout << "Signal:";
+        for (double lPercentile : {1.0, 10.0, 50.0, 90.0, 99.0}) {
+            std::cout << " p" << std::setprecision(0) << lPercentile << " "
+                      << CaptureAnalyzer::GetSignalPercentile(lReport, lPercentile) << "dBm";
+        }
+        std::cout << std::setprecision(3) << std::endl;
+    }
+
+    std::cout << std::endl << lReport.Gaps.size() << " gaps longer than " << lGapThreshold << "ms";
+    std::cout << (lReport.Gaps.empty() ? "" : ", longest:") << std::endl;
+    std::vector<Gap> lGaps{lReport.Gaps};
+    std::stable_sort(lGaps.begin(), lGaps.end(), [](const Gap& aFirst, const Gap& aSecond) {
+        return aFirst.Length > aSecond.Length;
+    });
+    lGaps.resize(std::min<std::size_t>(lGaps.size(), lTop));
+    for (const auto& lGap : lGaps) {
+        std::cout << "  at " << std::setw(12) << duration<double>(lGap.Start - lReport.FirstTimeStamp).count() << "s "
+                  << std::setw(12) << ToMilliseconds(lGap.Length) << "ms" << std::endl;
+    }
+
+    return 0;
+}
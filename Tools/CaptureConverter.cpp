@@ -0,0 +1,92 @@
+/* Copyright (c) 2020 [Rick de Bondt] - CaptureConverter.cpp
+ *
+ * Converts capture files between monitor mode and promiscuous mode formats offline, using all cores.
+ *
+ * */
+
+#include <iomanip>
+#include <iostream>
+
+#include <boost/program_options.hpp>
+
+#include "../Includes/CaptureConverter.h"
+#include "../Includes/Logger.h"
+
+namespace po = boost::program_options;
+using namespace CaptureConverter_Constants;
+
+int main(int argc, char* argv[])
+{
+    Settings                           lSettings{};
+    std::string                        lInput{};
+    std::string                        lOutput{};
+    std::string                        lDirection{"to-8023"};
+    std::string                        lBSSID{};
+    po::options_description            lDescription{"Capture converter options"};
+    po::positional_options_description lPositional{};
+
+    // clang-format off
+    lDescription.add_options()
+        ("help,h", "Show this help")
+        ("input,i", po::value<std::string>(&lInput)->required(),
+         "Capture file to read, pcap or pcapng, optionally zstd compressed (.zst)")
+        ("output,o", po::value<std::string>(&lOutput)->required(), "Capture file to write, pcap")
+        ("direction", po::value<std::string>(&lDirection)->default_value(lDirection),
+         "Conversion: to-8023 (monitor to promiscuous) or to-80211 (promiscuous to monitor)")
+        ("bssid", po::value<std::string>(&lBSSID),
+         "BSSID to use, when converting to 802.3 it is taken from beacons matching --ssid if not given")
+        ("ssid", po::value<std::vector<std::string>>(&lSettings.SSIDFilter)->composing(),
+         "SSID filter for beacons, can be given more than once")
+        ("frequency", po::value<uint16_t>(&lSettings.Frequency)->default_value(lSettings.Frequency),
+         "Frequency in MHz written in converted 802.11 frames")
+        ("threads,t", po::value<unsigned int>(&lSettings.Threads)->default_value(lSettings.Threads),
+         "Worker threads, 0 uses all cores")
+        ("chunk-size", po::value<unsigned int>(&lSettings.ChunkSize)->default_value(lSettings.ChunkSize),
+         "Frames converted per work item");
+    // clang-format on
+    lPositional.add("input", 1).add("output", 1);
+
+    po::variables_map lVariables{};
+    try {
+        po::store(po::command_line_parser(argc, argv).options(lDescription).positional(lPositional).run(), lVariables);
+        if (lVariables.count("help") > 0) {
+            std::cout << lDescription << std::endl;
+            return 0;
+        }
+        po::notify(lVariables);
+    } catch (const po::error& lException) {
+        std::cerr << lException.what() << std::endl << lDescription << std::endl;
+        return 1;
+    }
+
+    if (lDirection == "to-8023") {
+        lSettings.ConversionDirection = Direction::MonitorTo8023;
+    } else if (lDirection == "to-80211") {
+        lSettings.ConversionDirection = Direction::PromiscuousTo80211;
+    } else {
+        std::cerr << "Unknown direction: " << lDirection << std::endl << lDescription << std::endl;
+        return 1;
+    }
+
+    if (!lBSSID.empty()) {
+        lSettings.BSSID = PacketConverter::MacToInt(lBSSID);
+    } else if ((lSettings.ConversionDirection == Direction::MonitorTo8023) && lSettings.SSIDFilter.empty()) {
+        std::cerr << "Either --bssid or --ssid is needed to know which frames to convert" << std::endl;
+        return 1;
+    }
+
+    Logger::GetInstance().Init(Logger::Level::ERROR, false, "");
+    Logger::GetInstance().SetLogToScreen(true);
+
+    CaptureConverter lConverter{lSettings};
+    bool             lSuccess{lConverter.Convert(lInput, lOutput)};
+    const auto&      lStatistics{lConverter.GetStatistics()};
+    double           lSeconds{std::chrono::duration<double>(lStatistics.Duration).count()};
+
+    std::cout << std::fixed << std::setprecision(3) << "Read " << lStatistics.FramesRead << " frames, wrote "
+              << lStatistics.FramesWritten << " frames in " << lStatistics.Chunks << " chunks, " << lSeconds << "s ("
+              << std::setprecision(0) << (lSeconds > 0 ? static_cast<double>(lStatistics.FramesRead) / lSeconds : 0.0)
+              << " frames/s)" << std::endl;
+
+    return lSuccess ? 0 : 1;
+}
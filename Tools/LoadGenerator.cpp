@@ -0,0 +1,531 @@
+/* Copyright (c) 2020 [Rick de Bondt] - LoadGenerator.cpp
+ *
+ * Load generator for the bridge, synthesises traffic of a group of virtual consoles, or replays a capture, and sends it
+ * through the bridge in both directions. XLink Kai and the monitor device are replaced by stand-ins so this runs
+ * without network or radios, but over real UDP on the loopback interface with the threads the bridge uses.
+ *
+ * */
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#if not defined(_MSC_VER) && not defined(__MINGW32__)
+#include <ctime>
+#include <unistd.h>
+#endif
+
+#include <boost/program_options.hpp>
+
+#include "../Includes/FakeXLinkKaiEngine.h"
+#include "../Includes/Logger.h"
+#include "../Includes/Statistics.h"
+#include "../Includes/ThreadName.h"
+#include "../Includes/TrafficGenerator.h"
+#include "../Includes/VirtualMonitorDevice.h"
+#include "../Includes/XLinkKaiConnection.h"
+
+namespace po = boost::program_options;
+using namespace FakeXLinkKaiEngine_Constants;
+using namespace Statistics_Constants;
+using namespace TrafficGenerator_Constants;
+using namespace std::chrono;
+
+namespace
+{
+    constexpr milliseconds cConnectTimeout{5000};
+    const std::size_t      cPrefixSize{cEthernetDataString.size()};
+    // Time given to the bridge to deliver frames still in flight after sending stopped.
+    constexpr milliseconds cDrainTime{500};
+
+    /**
+     * Results for one direction through the bridge.
+     */
+    struct DirectionResult
+    {
+        uint64_t                 Sent{0};
+        uint64_t                 Received{0};
+        uint64_t                 Bytes{0};
+        LatencyHistogram         Latencies{}; /**< End to end, only known for generated frames. */
+        steady_clock::time_point Start{};
+        steady_clock::time_point End{};
+        nanoseconds              CpuTime{0}; /**< Of the thread sending into the bridge. */
+        std::size_t              MinFrameSize{0}; /**< Only known towards the monitor device. */
+        std::size_t              MaxFrameSize{0};
+    };
+
+    /**
+     * A thread of the bridge, by the name the part of the bridge that started it gave it.
+     */
+    struct BridgeThread
+    {
+        std::string Name{};
+        std::string Id{};
+        nanoseconds StartCpuTime{0};
+        nanoseconds CpuTime{0}; /**< During the run. */
+    };
+
+    // CPU time used by the calling thread so far.
+    nanoseconds GetCurrentThreadCpuTime()
+    {
+        nanoseconds lReturn{0};
+
+#if not defined(_MSC_VER) && not defined(__MINGW32__)
+        timespec lTime{};
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &lTime) == 0) {
+            lReturn = seconds(lTime.tv_sec) + nanoseconds(lTime.tv_nsec);
+        }
+#endif
+
+        return lReturn;
+    }
+
+    // Gets the threads the bridge started, every part of the bridge names its threads, see ThreadName.h.
+    std::vector<BridgeThread> GetBridgeThreads()
+    {
+        std::vector<BridgeThread> lReturn{};
+
+#if defined(__linux__)
+        std::string     lMainThread{std::to_string(getpid())};
+        std::error_code lError{};
+        for (const auto& lEntry : std::filesystem::directory_iterator("/proc/self/task", lError)) {
+            std::string   lId{lEntry.path().filename().string()};
+            std::ifstream lFile{lEntry.path() / "comm"};
+            std::string   lName{};
+
+            if (lId != lMainThread && std::getline(lFile, lName)) {
+                lReturn.push_back({lName, lId});
+            }
+        }
+        std::sort(lReturn.begin(), lReturn.end(), [](const BridgeThread& aFirst, const BridgeThread& aSecond) {
+            return aFirst.Name < aSecond.Name;
+        });
+#endif
+
+        return lReturn;
+    }
+
+    // CPU time used by a thread of this process so far, user and system time together.
+    nanoseconds GetThreadCpuTime(std::string_view aId)
+    {
+        nanoseconds lReturn{0};
+
+#if defined(__linux__)
+        std::ifstream lFile{"/proc/self/task/" + std::string(aId) + "/stat"};
+        std::string   lStat{};
+        std::getline(lFile, lStat);
+
+        // The thread name can contain spaces, so count fields from the end of the name. It is field 2, the times are
+        // fields 14 and 15.
+        std::size_t lNameEnd{lStat.rfind(')')};
+        if (lNameEnd != std::string::npos) {
+            std::istringstream lFields{lStat.substr(lNameEnd + 1)};
+            std::string        lField{};
+            uint64_t           lUserTicks{0};
+            uint64_t           lSystemTicks{0};
+
+            for (int lIndex = 3; lIndex < 14; lIndex++) {
+                lFields >> lField;
+            }
+            if (lFields >> lUserTicks >> lSystemTicks) {
+                lReturn = duration_cast<nanoseconds>(duration<double>(static_cast<double>(lUserTicks + lSystemTicks) /
+                                                                      static_cast<double>(sysconf(_SC_CLK_TCK))));
+            }
+        }
+#endif
+
+        return lReturn;
+    }
+
+    void PrintCpuTime(std::string_view aName, nanoseconds aCpuTime, nanoseconds aRunTime)
+    {
+        std::cout << std::fixed << std::setprecision(1) << "  " << aName << ": "
+                  << duration<double, std::milli>(aCpuTime).count() << " ms ("
+                  << (aRunTime.count() > 0 ? 100.0 * duration<double>(aCpuTime) / duration<double>(aRunTime) : 0.0)
+                  << "%)" << std::endl;
+    }
+
+    void PrintResult(std::string_view        aDirection,
+                     const DirectionResult&  aResult,
+                     const LatencyHistogram& aBridgeLatency)
+    {
+        double lSeconds{duration<double>(aResult.End - aResult.Start).count()};
+        double lDropped{aResult.Sent > 0 ?
+                            100.0 * static_cast<double>(aResult.Sent - std::min(aResult.Sent, aResult.Received)) /
+                                static_cast<double>(aResult.Sent) :
+                            0.0};
+
+        auto lMicroseconds = [](nanoseconds aValue) { return duration<double, std::micro>(aValue).count(); };
+
+        std::cout << std::fixed << std::setprecision(1) << aDirection << ":" << std::endl
+                  << "  sent: " << aResult.Sent << " received: " << aResult.Received << " dropped: " << lDropped
+                  << "%" << std::endl
+                  << "  throughput: " << (lSeconds > 0 ? static_cast<double>(aResult.Received) / lSeconds : 0.0)
+                  << " packets/s, " << (lSeconds > 0 ? static_cast<double>(aResult.Bytes) * 8 / lSeconds / 1e6 : 0.0)
+                  << " Mbit/s" << std::endl;
+
+        if (aResult.Latencies.Count > 0) {
+            std::cout << "  latency (us): p50 " << lMicroseconds(aResult.Latencies.GetPercentile(50)) << " p99 "
+                      << lMicroseconds(aResult.Latencies.GetPercentile(99)) << " p99.9 "
+                      << lMicroseconds(aResult.Latencies.GetPercentile(99.9)) << " max "
+                      << lMicroseconds(aResult.Latencies.Max) << std::endl;
+        }
+
+        // From arrival at the bridge until handed to the other side, as the statistics of the bridge measure it.
+        std::cout << "  latency in the bridge (us): p50 " << lMicroseconds(aBridgeLatency.GetPercentile(50))
+                  << " p99 " << lMicroseconds(aBridgeLatency.GetPercentile(99)) << " p99.9 "
+                  << lMicroseconds(aBridgeLatency.GetPercentile(99.9)) << " max "
+                  << lMicroseconds(aBridgeLatency.Max) << std::endl;
+    }
+
+    // Calls aSend at the rate of the generator until aDuration has passed, against absolute deadlines.
+    template<typename Function> uint64_t RunPaced(nanoseconds aInterval, seconds aDuration, Function aSend)
+    {
+        uint64_t lSent{0};
+        auto     lStart{steady_clock::now()};
+        auto     lDeadline{lStart};
+
+        while (steady_clock::now() < lStart + aDuration) {
+            aSend(steady_clock::now());
+            lSent++;
+            lDeadline += aInterval;
+            std::this_thread::sleep_until(lDeadline);
+        }
+
+        return lSent;
+    }
+
+    // Writes synthetic 802.11 traffic to a capture file, so it can be replayed against a real bridge.
+    int WritePCap(Settings& aSettings, seconds aDuration, const std::string& aPath)
+    {
+        int              lReturn{0};
+        TrafficGenerator lGenerator{aSettings};
+        pcap_t*          lHandler{pcap_open_dead(DLT_IEEE802_11_RADIO, 65535)};
+        pcap_dumper_t*   lDumper{pcap_dump_open(lHandler, aPath.c_str())};
+
+        if (lDumper != nullptr) {
+            auto     lTimeStamp{system_clock::now().time_since_epoch()};
+            uint64_t lFrames{static_cast<uint64_t>(duration_cast<nanoseconds>(aDuration) / lGenerator.GetInterval())};
+
+            for (uint64_t lCount = 0; lCount < lFrames; lCount++) {
+                std::string lFrame{lGenerator.Generate80211Frame(steady_clock::now())};
+                pcap_pkthdr lHeader{};
+                lHeader.caplen     = lFrame.size();
+                lHeader.len        = lFrame.size();
+                lHeader.ts.tv_sec  = duration_cast<seconds>(lTimeStamp).count();
+                lHeader.ts.tv_usec = duration_cast<microseconds>(lTimeStamp).count() % 1000000;
+                pcap_dump(reinterpret_cast<u_char*>(lDumper), &lHeader, reinterpret_cast<const u_char*>(lFrame.data()));
+                lTimeStamp += lGenerator.GetInterval();
+            }
+
+            pcap_dump_close(lDumper);
+            std::cout << "Wrote " << lFrames << " frames to " << aPath << std::endl;
+        } else {
+            std::cerr << "Could not open " << aPath << ": " << pcap_geterr(lHandler) << std::endl;
+            lReturn = 1;
+        }
+        pcap_close(lHandler);
+
+        return lReturn;
+    }
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    Settings                  lSettings{};
+    unsigned int              lDuration{10};
+    double                    lToXLinkRate{0.0};
+    double                    lToMonitorRate{0.0};
+    std::string               lDistribution{cSizeDistributionTexts.at(static_cast<int>(lSettings.Distribution))};
+    std::string               lDirection{"both"};
+    std::string               lPCapPath{};
+    std::string               lRecordPath{};
+    std::string               lReplayPath{};
+    std::string               lSSID{};
+    std::string               lInjectionPath{};
+    po::options_description   lDescription{"Load generator options"};
+
+    // clang-format off
+    lDescription.add_options()
+        ("help,h", "Show this help")
+        ("consoles,c", po::value<unsigned int>(&lSettings.Consoles)->default_value(lSettings.Consoles),
+         "Amount of virtual consoles")
+        ("rate,r", po::value<double>(&lSettings.PacketsPerSecond)->default_value(lSettings.PacketsPerSecond),
+         "Packets per second per console, per direction")
+        ("to-xlink-rate", po::value<double>(&lToXLinkRate),
+         "Packets per second per console towards XLink Kai, instead of --rate")
+        ("to-monitor-rate", po::value<double>(&lToMonitorRate),
+         "Packets per second per console towards the monitor device, instead of --rate")
+        ("duration,d", po::value<unsigned int>(&lDuration)->default_value(lDuration), "Duration in seconds")
+        ("min-size", po::value<unsigned int>(&lSettings.MinSize)->default_value(lSettings.MinSize),
+         "Minimum ethernet frame size")
+        ("max-size", po::value<unsigned int>(&lSettings.MaxSize)->default_value(lSettings.MaxSize),
+         "Maximum ethernet frame size")
+        ("distribution", po::value<std::string>(&lDistribution)->default_value(lDistribution),
+         "Frame size distribution: fixed, uniform or bimodal")
+        ("broadcast-ratio", po::value<double>(&lSettings.BroadcastRatio)->default_value(lSettings.BroadcastRatio),
+         "Fraction of frames sent to the broadcast address")
+        ("direction", po::value<std::string>(&lDirection)->default_value(lDirection),
+         "Direction to load: both, to-xlink or to-monitor")
+        ("replay", po::value<std::string>(&lReplayPath),
+         "Capture the traffic towards XLink Kai from this capture file instead of generating it, over and over")
+        ("ssid", po::value<std::string>(&lSSID),
+         "SSID to follow in the replayed capture, any by default")
+        ("write-injected", po::value<std::string>(&lInjectionPath),
+         "Write the frames the monitor device would inject to this capture file")
+        ("write-pcap", po::value<std::string>(&lPCapPath),
+         "Only write the 802.11 traffic to this capture file instead of running it through the bridge")
+        ("record", po::value<std::string>(&lRecordPath),
+         "Record the traffic through the bridge with the session recorder, to measure its overhead")
+        ("seed", po::value<unsigned int>(&lSettings.Seed)->default_value(lSettings.Seed), "Random seed");
+    // clang-format on
+
+    po::variables_map lVariables{};
+    try {
+        po::store(po::parse_command_line(argc, argv, lDescription), lVariables);
+        po::notify(lVariables);
+    } catch (const po::error& lException) {
+        std::cerr << lException.what() << std::endl << lDescription << std::endl;
+        return 1;
+    }
+
+    if (lVariables.count("help") > 0) {
+        std::cout << lDescription << std::endl;
+        return 0;
+    }
+
+    // Before the settings get copied for each direction, so both generators use it.
+    lSettings.Distribution = TrafficGenerator::ConvertStringToSizeDistribution(lDistribution);
+
+    Settings lToXLinkSettings{lSettings};
+    Settings lToMonitorSettings{lSettings};
+    lToMonitorSettings.Seed++;
+    if (lVariables.count("to-xlink-rate") > 0) {
+        lToXLinkSettings.PacketsPerSecond = lToXLinkRate;
+    }
+    if (lVariables.count("to-monitor-rate") > 0) {
+        lToMonitorSettings.PacketsPerSecond = lToMonitorRate;
+    }
+
+    // Frames are paced at an interval derived from the rate, which is 0 when the rate is 0 or out of range.
+    if (TrafficGenerator(lSettings).GetInterval().count() <= 0 ||
+        TrafficGenerator(lToXLinkSettings).GetInterval().count() <= 0 ||
+        TrafficGenerator(lToMonitorSettings).GetInterval().count() <= 0) {
+        std::cerr << "Rates have to be above 0 and at most 1e9 packets/s for all consoles together" << std::endl;
+        return 1;
+    }
+
+    Logger::GetInstance().Init(Logger::Level::ERROR, false, "");
+    Logger::GetInstance().SetLogToScreen(true);
+
+    if (!lPCapPath.empty()) {
+        return WritePCap(lSettings, seconds(lDuration), lPCapPath);
+    }
+
+    // Wire the bridge up the same way main does, with stand-ins on both ends.
+    FakeXLinkKaiEngine                    lEngine{};
+    std::shared_ptr<XLinkKaiConnection>   lConnection{std::make_shared<XLinkKaiConnection>()};
+    std::shared_ptr<VirtualMonitorDevice> lMonitorDevice{std::make_shared<VirtualMonitorDevice>()};
+    std::vector<std::string>              lSSIDFilter{};
+
+    // An empty filter matches every SSID, so a replayed capture is followed from the first beacon in it.
+    if (!lReplayPath.empty()) {
+        lSSIDFilter.emplace_back(lSSID);
+    }
+
+    lMonitorDevice->SetSendReceiveDevice(lConnection);
+    lConnection->SetSendReceiveDevice(lMonitorDevice);
+    lMonitorDevice->SetBSSID(lSettings.BSSID);
+
+    if (!lInjectionPath.empty() && !lMonitorDevice->SetInjectionFile(lInjectionPath)) {
+        std::cerr << "Failed to open " << lInjectionPath << std::endl;
+        return 1;
+    }
+
+    std::shared_ptr<SessionRecorder> lSessionRecorder{nullptr};
+    if (!lRecordPath.empty()) {
+        lSessionRecorder = std::make_shared<SessionRecorder>(SessionRecorder_Constants::Settings{lRecordPath});
+        if (!lSessionRecorder->Open()) {
+            std::cerr << "Failed to start recording to " << lRecordPath << std::endl;
+            return 1;
+        }
+        lMonitorDevice->SetSessionRecorder(lSessionRecorder);
+    }
+
+    DirectionResult lToXLink{};
+    DirectionResult lToMonitor{};
+    std::mutex      lToMonitorMutex{};
+
+    // Frames arriving at the monitor side are measured as they would be injected.
+    lMonitorDevice->SetInjectCallback([&](std::string_view aData) {
+        auto             lNow{steady_clock::now()};
+        FrameInformation lInformation{TrafficGenerator::ReadFrameInformation(aData, c80211PayloadIndex)};
+        if (lInformation.Valid) {
+            std::lock_guard<std::mutex> lLock{lToMonitorMutex};
+            lToMonitor.MinFrameSize = (lToMonitor.Received > 0) ? std::min(lToMonitor.MinFrameSize, aData.size()) :
+                                                                  aData.size();
+            lToMonitor.MaxFrameSize = std::max(lToMonitor.MaxFrameSize, aData.size());
+            lToMonitor.Received++;
+            lToMonitor.Bytes += aData.size();
+            lToMonitor.Latencies.Add(lNow - lInformation.TimeStamp);
+        }
+    });
+
+    // Frames arriving at the engine are only counted and measured, keeping them would grow with the run.
+    lEngine.SetMessageLogSize(0);
+    // Replayed frames carry no usable send time, even when the capture was made by a generator.
+    if (lReplayPath.empty()) {
+        lEngine.SetTimeStampReader([](std::string_view aFrame) -> std::optional<steady_clock::time_point> {
+            FrameInformation lInformation{TrafficGenerator::ReadFrameInformation(aFrame, c8023PayloadIndex)};
+            return lInformation.Valid ? std::optional(lInformation.TimeStamp) : std::nullopt;
+        });
+    }
+
+    if (!lEngine.Open() || !lEngine.StartReceiverThread()) {
+        std::cerr << "Failed to start the XLink Kai stand-in" << std::endl;
+        return 1;
+    }
+
+    if (!lConnection->Open(cIp, lEngine.GetPort()) ||
+        !lMonitorDevice->Open(lReplayPath, lSSIDFilter, lSettings.Frequency) || !lConnection->StartReceiverThread()) {
+        std::cerr << "Failed to set up the bridge" << std::endl;
+        return 1;
+    }
+
+    auto lConnectDeadline{steady_clock::now() + cConnectTimeout};
+    while ((lConnection->GetConnectionState() != ConnectionState::Connected) &&
+           (steady_clock::now() < lConnectDeadline)) {
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+
+    if (lConnection->GetConnectionState() != ConnectionState::Connected) {
+        std::cerr << "Bridge did not connect to the XLink Kai stand-in" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Running " << lSettings.Consoles << " consoles at " << lToXLinkSettings.PacketsPerSecond << "/"
+              << lToMonitorSettings.PacketsPerSecond << " packets/s each (to XLink Kai/to monitor) for " << lDuration
+              << "s, direction: " << lDirection << std::endl;
+
+    std::vector<BridgeThread> lBridgeThreads{GetBridgeThreads()};
+    for (auto& lThread : lBridgeThreads) {
+        lThread.StartCpuTime = GetThreadCpuTime(lThread.Id);
+    }
+    auto     lRunStart{steady_clock::now()};
+    uint64_t lReplayed{0};
+
+    // Monitor -> XLink Kai: 802.11 frames get "captured" and should arrive at the engine as ethernet data.
+    boost::thread lToXLinkThread{[&] {
+        ThreadName_Constants::SetCurrentThreadName("gen-to-xlink");
+        if (lDirection == "both" || lDirection == "to-xlink") {
+            TrafficGenerator lGenerator{lToXLinkSettings};
+            lToXLink.Start = steady_clock::now();
+
+            if (lReplayPath.empty()) {
+                lToXLink.Sent = RunPaced(
+                    lGenerator.GetInterval(), seconds(lDuration), [&](steady_clock::time_point aNow) {
+                        lMonitorDevice->Receive(lGenerator.Generate80211Frame(aNow));
+                    });
+            } else {
+                // Paced at the same rate as generated frames would be, whatever the timestamps in the capture say.
+                lReplayed = RunPaced(lGenerator.GetInterval(), seconds(lDuration), [&](steady_clock::time_point) {
+                    // Start the capture over when it runs out.
+                    if (!lMonitorDevice->ReadNextData()) {
+                        lMonitorDevice->Open(lReplayPath, lSSIDFilter, lSettings.Frequency);
+                        lMonitorDevice->ReadNextData();
+                    }
+                });
+                lToXLink.Sent = lMonitorDevice->GetForwardedCount();
+            }
+            lToXLink.CpuTime = GetCurrentThreadCpuTime();
+        }
+    }};
+
+    // XLink Kai -> monitor: the engine sends ethernet data, which should come out as injected 802.11 frames.
+    boost::thread lToMonitorThread{[&] {
+        ThreadName_Constants::SetCurrentThreadName("gen-to-monitor");
+        if (lDirection == "both" || lDirection == "to-monitor") {
+            TrafficGenerator lGenerator{lToMonitorSettings};
+            lToMonitor.Start = steady_clock::now();
+            lToMonitor.Sent  = RunPaced(
+                lGenerator.GetInterval(), seconds(lDuration), [&](steady_clock::time_point aNow) {
+                    lEngine.SendEthernetData(lGenerator.Generate8023Frame(aNow));
+                });
+            lToMonitor.CpuTime = GetCurrentThreadCpuTime();
+        }
+    }};
+
+    lToXLinkThread.join();
+    lToMonitorThread.join();
+    std::this_thread::sleep_for(cDrainTime);
+    lToXLink.End   = steady_clock::now() - cDrainTime;
+    lToMonitor.End = lToXLink.End;
+
+    nanoseconds lRunTime{steady_clock::now() - lRunStart};
+    for (auto& lThread : lBridgeThreads) {
+        lThread.CpuTime = GetThreadCpuTime(lThread.Id) - lThread.StartCpuTime;
+    }
+
+    // The engine counted and measured the frames as they arrived, its byte count includes the protocol prefix.
+    lToXLink.Received  = lEngine.GetReceivedCount(ClientCommand::EthernetData);
+    lToXLink.Bytes     = lEngine.GetReceivedBytes(ClientCommand::EthernetData) - lToXLink.Received * cPrefixSize;
+    lToXLink.Latencies = lEngine.GetLatencies();
+
+    lConnection->Close();
+    lMonitorDevice->Close();
+    lEngine.Close();
+
+    if (lSessionRecorder != nullptr) {
+        lSessionRecorder->Close();
+        std::cout << "Recorded " << lSessionRecorder->GetRecordedCount() << " frames, dropped "
+                  << lSessionRecorder->GetDroppedCount() << std::endl;
+    }
+
+    Snapshot lSnapshot{Statistics::GetInstance().GetSnapshot()};
+
+    if (lReplayed > 0) {
+        std::cout << "Replayed " << lReplayed << " frames, " << lToXLink.Sent << " of them data frames for the network"
+                  << std::endl;
+    }
+
+    if (lToXLink.Sent > 0) {
+        PrintResult("Monitor -> XLink Kai", lToXLink, lSnapshot.Get(Latency::MonitorToXLinkKai));
+    }
+
+    {
+        std::lock_guard<std::mutex> lLock{lToMonitorMutex};
+        if (lToMonitor.Sent > 0) {
+            PrintResult("XLink Kai -> Monitor", lToMonitor, lSnapshot.Get(Latency::XLinkKaiToMonitor));
+        }
+    }
+
+    std::cout << "CPU time per thread:" << std::endl;
+    PrintCpuTime("capture (to XLink Kai sender)", lToXLink.CpuTime, lRunTime);
+    PrintCpuTime("to monitor sender", lToMonitor.CpuTime, lRunTime);
+    for (const auto& lThread : lBridgeThreads) {
+        PrintCpuTime(lThread.Name, lThread.CpuTime, lRunTime);
+    }
+
+    int lReturn{0};
+
+    // With a fixed size every frame should have come through the bridge at the minimum size, in both directions.
+    if (lSettings.Distribution == SizeDistribution::Fixed) {
+        uint64_t lFrameSize{std::clamp(lSettings.MinSize, cMinFrameSize, cMaxFrameSize)};
+
+        if (lReplayPath.empty() && lToXLink.Bytes != lToXLink.Received * lFrameSize) {
+            std::cerr << "Frames towards XLink Kai were not all " << lFrameSize << " bytes" << std::endl;
+            lReturn = 1;
+        }
+        if (lToMonitor.MinFrameSize != lToMonitor.MaxFrameSize) {
+            std::cerr << "Frames towards the monitor device differed in size" << std::endl;
+            lReturn = 1;
+        }
+    }
+
+    return lReturn;
+}
@@ -1,3 +1,7 @@
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -8,10 +12,18 @@
 #include <curses.h>
 #undef timeout
 
+#include "Includes/ControlServer.h"
+#include "Includes/FlightRecorder.h"
 #include "Includes/Logger.h"
+#include "Includes/MetricsExporter.h"
+#include "Includes/ServiceNotifier.h"
+#include "Includes/SessionRecorder.h"
 #include "Includes/UserInterface/WindowController.h"
 #include "Includes/WirelessMonitorDevice.h"
 #include "Includes/XLinkKaiConnection.h"
+#include "Includes/XLinkKaiSessionManager.h"
+
+namespace po = boost::program_options;
 
 namespace
 {
@@ -20,117 +32,364 @@ namespace
     constexpr std::string_view cVitaSSIDFilterName{"SCE_"};
     constexpr bool             cLogToDisk{true};
     constexpr std::string_view cConfigFileName{"config.txt"};
+    constexpr std::string_view cFlightRecorderName{"flightrecorder"};
+
+    // How long the control socket waits for the main thread to handle a request.
+    constexpr std::chrono::seconds cControlTimeout{5};
 
     // Indicates if the program should be running or not, used to gracefully exit the program.
     bool gRunning{true};
+    // Set from the signal thread when the user asks for a flight recorder dump.
+    std::atomic<bool> gDumpFlightRecorder{false};
 }  // namespace
 
 
-static void SignalHandler(const boost::system::error_code& aError, int aSignalNumber)
+static void SignalHandler(boost::asio::signal_set&        aSignals,
+                          WindowController&                aWindowController,
+                          const boost::system::error_code& aError,
+                          int                              aSignalNumber)
 {
     if (!aError) {
         if (aSignalNumber == SIGINT || aSignalNumber == SIGTERM) {
             // Quit gracefully.
             gRunning = false;
+        } else {
+            gDumpFlightRecorder = true;
+            aSignals.async_wait([&aSignals, &aWindowController](const boost::system::error_code& aNextError,
+                                                                int                              aNextSignalNumber) {
+                SignalHandler(aSignals, aWindowController, aNextError, aNextSignalNumber);
+            });
         }
+
+        // The main loop may be waiting on the user interface.
+        aWindowController.Notify();
     }
 }
 
-int main(int argc, char* argv[])
+// Everything that runs while the engine is started, every XLink Kai session is bridged to a monitor device of its own
+// and all sessions share one event loop.
+struct Engine
 {
-    std::string lProgramPath{"./"};
+    XLinkKaiSessionManager                              SessionManager{};
+    std::vector<std::shared_ptr<WirelessMonitorDevice>> MonitorDevices{};
+    std::shared_ptr<SessionRecorder>                    Recorder{nullptr};
+};
 
-#if not defined(_MSC_VER) && not defined(__MINGW32__)
-    // Make robust against sudo path change.
-    std::array<char, PATH_MAX> lResolvedPath{};
-    if (realpath(argv[0], lResolvedPath.data()) != nullptr) {
-        lProgramPath = std::string(lResolvedPath.begin(), lResolvedPath.end());
+// Closes all XLink Kai sessions and the monitor devices bridged to them, and finishes the session recording.
+static void StopEngine(Engine& aEngine)
+{
+    aEngine.SessionManager.Close();
+    for (auto& lMonitorDevice : aEngine.MonitorDevices) {
+        lMonitorDevice->Close();
+    }
+    aEngine.MonitorDevices.clear();
 
-        // Remove excecutable name from path
-        size_t lExcecutableNameIndex{lProgramPath.rfind('/')};
-        if (lExcecutableNameIndex != std::string::npos) {
-            lProgramPath.erase(lExcecutableNameIndex + 1, lProgramPath.length() - lExcecutableNameIndex - 1);
+    if (aEngine.Recorder != nullptr) {
+        aEngine.Recorder->Close();
+        aEngine.Recorder = nullptr;
+    }
+}
+
+// Opens the sessions and monitor devices in the model and starts bridging them, the engine status is set accordingly.
+static bool StartEngine(WindowModel&                           aModel,
+                        Engine&                                aEngine,
+                        const std::string&                     aProgramPath,
+                        const std::shared_ptr<FlightRecorder>& aFlightRecorder)
+{
+    bool                     lSuccess{true};
+    std::vector<std::string> lSSIDFilters{};
+
+    if (aModel.mLogLevel != Logger::GetInstance().GetLogLevel()) {
+        Logger::GetInstance().SetLogLevel(aModel.mLogLevel);
+    }
+
+    // If we are auto discovering PSP/VITA networks add those to the filter list
+    if (aModel.mAutoDiscoverPSPVitaNetworks) {
+        lSSIDFilters.emplace_back(cPSPSSIDFilterName.data());
+        lSSIDFilters.emplace_back(cVitaSSIDFilterName.data());
+    }
+
+    // The main session uses the settings from the window, additional ones come from the config.
+    std::vector<WindowModel_Constants::SessionSetting> lSessionSettings{
+        {std::string(cLocallyUniqueName), aModel.mWifiAdapter, aModel.mChannel}};
+    for (auto& lSetting : aModel.GetAdditionalSessions()) {
+        lSessionSettings.emplace_back(lSetting);
+    }
+
+    // All sessions record into the same files, failing to record does not stop the engine.
+    if (aModel.mRecordSession) {
+        SessionRecorder_Constants::Settings lRecorderSettings{};
+        lRecorderSettings.Path     = std::filesystem::path(aModel.mRecordingPath).is_absolute() ?
+                                         aModel.mRecordingPath :
+                                         aProgramPath + aModel.mRecordingPath;
+        lRecorderSettings.Compress = aModel.mCompressRecording;
+        aEngine.Recorder           = std::make_shared<SessionRecorder>(lRecorderSettings);
+        if (!aEngine.Recorder->Open()) {
+            aEngine.Recorder = nullptr;
         }
     }
-#endif
 
-    // Handle quit signals gracefully.
+    for (auto& lSetting : lSessionSettings) {
+        std::shared_ptr<XLinkKaiConnection> lXLinkKaiConnection{
+            aEngine.SessionManager.AddSession(lSetting.LocallyUniqueName)};
+        std::shared_ptr<WirelessMonitorDevice> lMonitorDevice{std::make_shared<WirelessMonitorDevice>()};
+
+        // Set the XLink Kai connection up, if we are autodiscovering we don't need to provide an IP
+        if (lXLinkKaiConnection == nullptr) {
+            lSuccess = false;
+        } else if (!aModel.mAutoDiscoverXLinkKaiInstance) {
+            lSuccess = lXLinkKaiConnection->Open(aModel.mXLinkIp, std::stoi(aModel.mXLinkPort));
+        } else {
+            lSuccess = lXLinkKaiConnection->Open();
+        }
+
+        if (!lSuccess) {
+            Logger::GetInstance().Log<Logger::Level::ERROR>("Failed to open connection to XLink Kai for session {}",
+                                                            lSetting.LocallyUniqueName);
+            break;
+        }
+
+        // Now set up the wifi interface, the filter list gets consumed by the device.
+        std::vector<std::string> lDeviceSSIDFilters{lSSIDFilters};
+        if (!lMonitorDevice->Open(lSetting.WifiAdapter,
+                                  lDeviceSSIDFilters,
+                                  PacketConverter::ConvertChannelToFrequency(std::stoi(lSetting.Channel)))) {
+            Logger::GetInstance().Log<Logger::Level::ERROR>("Failed to activate monitor interface {}",
+                                                            lSetting.WifiAdapter);
+            lSuccess = false;
+            break;
+        }
+
+        lMonitorDevice->SetSourceMACToFilter(PacketConverter::MacToInt(aModel.mOnlyAcceptFromMac));
+        lMonitorDevice->SetAcknowledgePackets(aModel.mAcknowledgeDataFrames);
+        lMonitorDevice->SetSendReceiveDevice(lXLinkKaiConnection);
+        lMonitorDevice->SetSessionRecorder(aEngine.Recorder);
+        lMonitorDevice->SetFlightRecorder(aFlightRecorder);
+        lXLinkKaiConnection->SetSendReceiveDevice(lMonitorDevice);
+        aEngine.MonitorDevices.emplace_back(lMonitorDevice);
+    }
+
+    if (lSuccess) {
+        lSuccess = aEngine.SessionManager.StartReceiverThread();
+        for (auto& lMonitorDevice : aEngine.MonitorDevices) {
+            lSuccess = lMonitorDevice->StartReceiverThread() && lSuccess;
+        }
+
+        if (!lSuccess) {
+            Logger::GetInstance().Log<Logger::Level::ERROR>("Failed to start receiver threads");
+        }
+    } else {
+        // Clean up the sessions that did open, so the engine can be started again.
+        StopEngine(aEngine);
+    }
+
+    aModel.mEngineStatus =
+        lSuccess ? WindowModel_Constants::EngineStatus::Running : WindowModel_Constants::EngineStatus::Error;
+
+    return lSuccess;
+}
+
+// Copies the network followed by the main monitor device and the state of the main session into the model.
+static void UpdateStatuses(WindowModel& aModel, const Engine& aEngine)
+{
+    if (!aEngine.MonitorDevices.empty() && !aEngine.SessionManager.GetSessions().empty()) {
+        IPCapDevice_Constants::WiFiBeaconInformation lInformation{aEngine.MonitorDevices.front()->GetWifiInformation()};
+        XLinkKai_Constants::ConnectionState lState{aEngine.SessionManager.GetSessions().front()->GetConnectionState()};
+
+        aModel.mCurrentSSID    = lInformation.SSID;
+        aModel.mCurrentBSSID   = lInformation.BSSID != 0 ? PacketConverter::IntToMac(lInformation.BSSID) : "";
+        aModel.mCurrentChannel = PacketConverter::ConvertFrequencyToChannel(lInformation.Frequency);
+        aModel.mXLinkKaiConnectionState =
+            XLinkKai_Constants::cConnectionStateTexts.at(static_cast<std::size_t>(lState));
+    } else {
+        aModel.mCurrentSSID             = "";
+        aModel.mCurrentBSSID            = "";
+        aModel.mCurrentChannel          = -1;
+        aModel.mXLinkKaiConnectionState = "";
+    }
+    aModel.mStatusUpdates++;
+}
+
+// Handles a request from the control socket on the main thread, see README.md for the requests.
+static ControlServer_Constants::Reply HandleControlRequest(const std::vector<std::string>&       aArguments,
+                                                          WindowModel&                           aModel,
+                                                          Engine&                                aEngine,
+                                                          const std::string&                     aProgramPath,
+                                                          const std::string&                     aConfigPath,
+                                                          const std::shared_ptr<FlightRecorder>& aFlightRecorder)
+{
+    ControlServer_Constants::Reply lReply{};
+    const std::string&             lCommand{aArguments.front()};
+    bool                           lRunning{aModel.mEngineStatus == WindowModel_Constants::EngineStatus::Running};
+
+    if (lCommand == "start") {
+        if (lRunning) {
+            lReply = {false, {"Engine already running"}};
+        } else {
+            StopEngine(aEngine);
+            if (!StartEngine(aModel, aEngine, aProgramPath, aFlightRecorder)) {
+                lReply = {false, {"Engine failed to start, see the log"}};
+            }
+        }
+    } else if (lCommand == "stop") {
+        StopEngine(aEngine);
+        aModel.mEngineStatus = WindowModel_Constants::EngineStatus::Idle;
+    } else if (lCommand == "save") {
+        if (!aModel.SaveToFile(aConfigPath)) {
+            lReply = {false, {"Could not save the config"}};
+        }
+    } else if (lCommand == "set" && aArguments.size() < 3) {
+        lReply = {false, {"Usage: set <setting> <value>"}};
+    } else if (lCommand == "set") {
+        // Settings have the same names as on the command line, values may contain spaces.
+        std::string lOption{"--" + aArguments.at(1) + "="};
+        for (std::size_t lIndex = 2; lIndex < aArguments.size(); lIndex++) {
+            lOption.append(lIndex > 2 ? " " : "").append(aArguments.at(lIndex));
+        }
+
+        try {
+            po::options_description lDescription{};
+            po::variables_map       lVariables{};
+            aModel.AddCommandLineOptions(lDescription);
+            po::store(po::command_line_parser(std::vector<std::string>{lOption}).options(lDescription).run(),
+                      lVariables);
+            po::notify(lVariables);
+
+            // The log level applies right away, everything else the next time the engine starts.
+            Logger::GetInstance().SetLogLevel(aModel.mLogLevel);
+            if (lRunning && aArguments.at(1) != "log-level") {
+                lReply.Lines.emplace_back("Applied when the engine starts again");
+            }
+        } catch (const po::error& lException) {
+            lReply = {false, {lException.what()}};
+        }
+    } else if (lCommand == "status") {
+        UpdateStatuses(aModel, aEngine);
+        std::string_view lStatus{
+            WindowModel_Constants::cEngineStatusTexts.at(static_cast<std::size_t>(aModel.mEngineStatus))};
+        lReply.Lines = {"engine " + std::string(lStatus),
+                        "ssid " + aModel.mCurrentSSID,
+                        "bssid " + aModel.mCurrentBSSID,
+                        "channel " + std::to_string(aModel.mCurrentChannel),
+                        "xlink_kai " + aModel.mXLinkKaiConnectionState};
+    } else {
+        lReply = {false, {"Unknown request: " + lCommand}};
+    }
+
+    return lReply;
+}
+
+// Opens the control socket. Statistics and flight recorder dumps are served right away on the thread of the control
+// server, so scraping never waits for the main thread. Every other request is handed to the main thread.
+static std::shared_ptr<ControlServer>
+    StartControlServer(const std::string&                                                            aPath,
+                       boost::asio::io_service&                                                      aMainIoService,
+                       const std::function<void()>&                                                  aWakeUp,
+                       const std::function<ControlServer_Constants::Reply(const std::vector<std::string>&)>& aHandler,
+                       const std::shared_ptr<FlightRecorder>&                                        aFlightRecorder)
+{
+    auto lReturn{std::make_shared<ControlServer>(
+        [&aMainIoService, aWakeUp, aHandler, aFlightRecorder](const std::vector<std::string>& aArguments) {
+            ControlServer_Constants::Reply lReply{};
+
+            if (aArguments.front() == "stats") {
+                lReply.Lines = ControlServer::FormatSnapshot(Statistics::GetInstance().GetSnapshot());
+            } else if (aArguments.front() == "dump") {
+                aFlightRecorder->Trigger("Requested on the control socket");
+            } else {
+                auto lPromise{std::make_shared<std::promise<ControlServer_Constants::Reply>>()};
+                auto lFuture{lPromise->get_future()};
+                aMainIoService.post([lPromise, aHandler, aArguments] { lPromise->set_value(aHandler(aArguments)); });
+                aWakeUp();
+
+                if (lFuture.wait_for(cControlTimeout) == std::future_status::ready) {
+                    lReply = lFuture.get();
+                } else {
+                    lReply = {false, {"Timed out"}};
+                }
+            }
+
+            return lReply;
+        })};
+
+    if (!lReturn->Open(aPath) || !lReturn->StartThread()) {
+        lReturn = nullptr;
+    }
+
+    return lReturn;
+}
+
+// Runs the user interface until the user or a signal quits, the engine is started and stopped from the interface.
+static void RunInteractive(WindowModel&                           aModel,
+                           Engine&                                aEngine,
+                           const std::string&                     aProgramPath,
+                           const std::string&                     aConfigPath,
+                           const std::string&                     aControlSocketPath,
+                           const std::shared_ptr<FlightRecorder>& aFlightRecorder)
+{
+    WindowController lWindowController(aModel);
+
+    // Requests from the control socket are handled between key presses.
+    boost::asio::io_service        lControlIoService{};
+    auto                           lWorkGuard{boost::asio::make_work_guard(lControlIoService)};
+    std::shared_ptr<ControlServer> lControlServer{nullptr};
+    if (!aControlSocketPath.empty()) {
+        lControlServer = StartControlServer(
+            aControlSocketPath,
+            lControlIoService,
+            [&lWindowController] { lWindowController.Notify(); },
+            [&](const std::vector<std::string>& aArguments) {
+                return HandleControlRequest(aArguments, aModel, aEngine, aProgramPath, aConfigPath, aFlightRecorder);
+            },
+            aFlightRecorder);
+    }
+
+    // Handle quit signals gracefully, SIGUSR1 dumps the flight recorder.
     boost::asio::io_service lSignalIoService{};
     boost::asio::signal_set lSignals(lSignalIoService, SIGINT, SIGTERM);
-    lSignals.async_wait(&SignalHandler);
+#if not defined(_MSC_VER) && not defined(__MINGW32__)
+    lSignals.add(SIGUSR1);
+#endif
+    lSignals.async_wait(
+        [&lSignals, &lWindowController](const boost::system::error_code& aError, int aSignalNumber) {
+            SignalHandler(lSignals, lWindowController, aError, aSignalNumber);
+        });
     boost::thread lThread{[lIoService = &lSignalIoService] { lIoService->run(); }};
-    WindowModel   mWindowModel{};
-    mWindowModel.LoadFromFile(lProgramPath + cConfigFileName.data());
-
-    Logger::GetInstance().Init(mWindowModel.mLogLevel, cLogToDisk, lProgramPath + cLogFileName.data());
 
-    std::vector<std::string> lSSIDFilters{};
-    WindowController         lWindowController(mWindowModel);
     lWindowController.SetUp();
 
-    std::shared_ptr<WirelessMonitorDevice> lMonitorDevice{std::make_shared<WirelessMonitorDevice>()};
-    std::shared_ptr<XLinkKaiConnection>    lXLinkKaiConnection{std::make_shared<XLinkKaiConnection>()};
-
-    lMonitorDevice->SetSendReceiveDevice(lXLinkKaiConnection);
-    lXLinkKaiConnection->SetSendReceiveDevice(lMonitorDevice);
-
-    bool lSuccess{false};
+    WindowModel_Constants::EngineStatus   lEngineStatus{aModel.mEngineStatus};
+    std::chrono::steady_clock::time_point lNextStatusUpdate{};
 
     while (gRunning) {
-        if (lWindowController.Process()) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
-            switch (mWindowModel.mCommand) {
-                case WindowModel_Constants::Command::StartEngine:
-                    if (mWindowModel.mLogLevel != Logger::GetInstance().GetLogLevel()) {
-                        Logger::GetInstance().SetLogLevel(mWindowModel.mLogLevel);
-                    }
-
-                    // If we are auto discovering PSP/VITA networks add those to the filter list
-                    if (mWindowModel.mAutoDiscoverPSPVitaNetworks) {
-                        lSSIDFilters.emplace_back(cPSPSSIDFilterName.data());
-                        lSSIDFilters.emplace_back(cVitaSSIDFilterName.data());
-                    }
+        if (gDumpFlightRecorder.exchange(false)) {
+            aFlightRecorder->Trigger("Requested by signal");
+        }
 
-                    // Set the XLink Kai connection up, if we are autodiscovering we don't need to provide an IP
-                    if (!mWindowModel.mAutoDiscoverXLinkKaiInstance) {
-                        lSuccess = lXLinkKaiConnection->Open(mWindowModel.mXLinkIp, std::stoi(mWindowModel.mXLinkPort));
-                    } else {
-                        lSuccess = lXLinkKaiConnection->Open();
-                    }
+        if ((aModel.mEngineStatus != lEngineStatus) &&
+            (aModel.mEngineStatus == WindowModel_Constants::EngineStatus::Error)) {
+            aFlightRecorder->Trigger("Engine status changed to error");
+        }
+        lEngineStatus = aModel.mEngineStatus;
 
-                    // Now set up the wifi interface
-                    if (lSuccess) {
-                        if (lMonitorDevice->Open(
-                                mWindowModel.mWifiAdapter,
-                                lSSIDFilters,
-                                PacketConverter::ConvertChannelToFrequency(std::stoi(mWindowModel.mChannel)))) {
-                            lMonitorDevice->SetSourceMACToFilter(
-                                PacketConverter::MacToInt(mWindowModel.mOnlyAcceptFromMac));
-                            lMonitorDevice->SetAcknowledgePackets(mWindowModel.mAcknowledgeDataFrames);
-                            if (lMonitorDevice->StartReceiverThread() && lXLinkKaiConnection->StartReceiverThread()) {
-                                mWindowModel.mEngineStatus = WindowModel_Constants::EngineStatus::Running;
-                            } else {
-                                Logger::GetInstance().Log("Failed to start receiver threads", Logger::Level::ERROR);
-                                mWindowModel.mEngineStatus = WindowModel_Constants::EngineStatus::Error;
-                            }
-                        } else {
-                            Logger::GetInstance().Log("Failed to activate monitor interface", Logger::Level::ERROR);
-                            mWindowModel.mEngineStatus = WindowModel_Constants::EngineStatus::Error;
-                        }
-                    } else {
-                        Logger::GetInstance().Log("Failed to open connection to XLink Kai", Logger::Level::ERROR);
-                        mWindowModel.mEngineStatus = WindowModel_Constants::EngineStatus::Error;
-                    }
+        if (std::chrono::steady_clock::now() >= lNextStatusUpdate) {
+            UpdateStatuses(aModel, aEngine);
+            lNextStatusUpdate = std::chrono::steady_clock::now() + WindowModel_Constants::cStatusInterval;
+        }
 
-                    mWindowModel.mCommand = WindowModel_Constants::Command::NoCommand;
+        // Sleeps until a key is pressed, a signal comes in or the statuses have to be updated again.
+        if (lWindowController.Process(
+                std::chrono::ceil<std::chrono::milliseconds>(lNextStatusUpdate - std::chrono::steady_clock::now()))) {
+            switch (aModel.mCommand) {
+                case WindowModel_Constants::Command::StartEngine:
+                    StartEngine(aModel, aEngine, aProgramPath, aFlightRecorder);
+                    aModel.mCommand = WindowModel_Constants::Command::NoCommand;
                     break;
                 case WindowModel_Constants::Command::StopEngine:
-                    lXLinkKaiConnection->Close();
-                    lMonitorDevice->Close();
-                    lSSIDFilters.clear();
+                    StopEngine(aEngine);
 
-                    mWindowModel.mEngineStatus = WindowModel_Constants::EngineStatus::Idle;
-                    mWindowModel.mCommand      = WindowModel_Constants::Command::NoCommand;
+                    aModel.mEngineStatus = WindowModel_Constants::EngineStatus::Idle;
+                    aModel.mCommand      = WindowModel_Constants::Command::NoCommand;
                     break;
                 case WindowModel_Constants::Command::StartSearchNetworks:
                     // TODO: implement.
@@ -139,18 +398,214 @@ int main(int argc, char* argv[])
                     // TODO: implement.
                     break;
                 case WindowModel_Constants::Command::SaveSettings:
-                    mWindowModel.SaveToFile(cConfigFileName);
+                    aModel.SaveToFile(aConfigPath);
                     break;
                 case WindowModel_Constants::Command::NoCommand:
                     break;
             }
+            // Text fields and check boxes show the model directly, but only get drawn again when they are changed
+            // through the user interface, so show whatever the control requests changed.
+            if (lControlIoService.poll() > 0) {
+                lWindowController.SetDirty();
+            }
         } else {
             gRunning = false;
         }
     }
 
+    if (lControlServer != nullptr) {
+        lControlServer->Close();
+    }
+    StopEngine(aEngine);
+
     lSignalIoService.stop();
     if (lThread.joinable()) {
         lThread.join();
     }
 }
+
+// Starts the engine right away and keeps it running without a user interface, the main thread only waits for
+// signals. SIGHUP reloads the config file with the command line on top of it, the service manager is told about it.
+static int RunHeadless(WindowModel&                           aModel,
+                       Engine&                                aEngine,
+                       const std::string&                     aProgramPath,
+                       const std::string&                     aConfigPath,
+                       const std::string&                     aControlSocketPath,
+                       po::variables_map&                     aVariables,
+                       const std::shared_ptr<FlightRecorder>& aFlightRecorder)
+{
+    int             lReturn{0};
+    ServiceNotifier lNotifier{};
+
+    if (StartEngine(aModel, aEngine, aProgramPath, aFlightRecorder)) {
+        boost::asio::io_service lIoService{};
+        boost::asio::signal_set lSignals(lIoService, SIGINT, SIGTERM);
+#if not defined(_MSC_VER) && not defined(__MINGW32__)
+        lSignals.add(SIGHUP);
+        lSignals.add(SIGUSR1);
+#endif
+
+        std::function<void(const boost::system::error_code&, int)> lHandler{};
+        lHandler = [&](const boost::system::error_code& aError, int aSignalNumber) {
+            if (!aError) {
+                if (aSignalNumber == SIGINT || aSignalNumber == SIGTERM) {
+                    // Nothing is waited for anymore, so the io service returns.
+                    lNotifier.NotifyStopping();
+                } else {
+#if not defined(_MSC_VER) && not defined(__MINGW32__)
+                    if (aSignalNumber == SIGHUP) {
+                        lNotifier.NotifyReloading();
+                        StopEngine(aEngine);
+                        aModel.LoadFromFile(aConfigPath);
+                        po::notify(aVariables);
+                        // A failed start is logged, the next reload can try again with a fixed config.
+                        StartEngine(aModel, aEngine, aProgramPath, aFlightRecorder);
+                        lNotifier.NotifyReady(WindowModel_Constants::cEngineStatusTexts.at(
+                            static_cast<std::size_t>(aModel.mEngineStatus)));
+                    } else {
+                        aFlightRecorder->Trigger("Requested by signal");
+                    }
+#endif
+                    lSignals.async_wait(lHandler);
+                }
+            }
+        };
+        lSignals.async_wait(lHandler);
+
+        std::shared_ptr<ControlServer> lControlServer{nullptr};
+        if (!aControlSocketPath.empty()) {
+            lControlServer = StartControlServer(
+                aControlSocketPath,
+                lIoService,
+                [] {},
+                [&](const std::vector<std::string>& aArguments) {
+                    return HandleControlRequest(
+                        aArguments, aModel, aEngine, aProgramPath, aConfigPath, aFlightRecorder);
+                },
+                aFlightRecorder);
+        }
+
+        lNotifier.NotifyReady(
+            WindowModel_Constants::cEngineStatusTexts.at(static_cast<std::size_t>(aModel.mEngineStatus)));
+        lIoService.run();
+
+        if (lControlServer != nullptr) {
+            lControlServer->Close();
+        }
+    } else {
+        lReturn = 1;
+    }
+
+    StopEngine(aEngine);
+
+    return lReturn;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string lProgramPath{"./"};
+    int         lReturn{0};
+
+#if not defined(_MSC_VER) && not defined(__MINGW32__)
+    // Make robust against sudo path change.
+    std::array<char, PATH_MAX> lResolvedPath{};
+    if (realpath(argv[0], lResolvedPath.data()) != nullptr) {
+        lProgramPath = std::string(lResolvedPath.begin(), lResolvedPath.end());
+
+        // Remove excecutable name from path
+        size_t lExcecutableNameIndex{lProgramPath.rfind('/')};
+        if (lExcecutableNameIndex != std::string::npos) {
+            lProgramPath.erase(lExcecutableNameIndex + 1, lProgramPath.length() - lExcecutableNameIndex - 1);
+        }
+    }
+#endif
+
+    WindowModel             mWindowModel{};
+    po::options_description lDescription{"Options"};
+
+    // The settings of the model are only applied after the config file has been loaded, so they take precedence.
+    // clang-format off
+    lDescription.add_options()
+        ("help,h", "Show this help")
+        ("headless", po::bool_switch(), "Start the engine right away, without a user interface")
+        ("config", po::value<std::string>()->default_value(lProgramPath + cConfigFileName.data()),
+         "Config file to load the settings from, and save them to")
+        ("control-socket", po::value<std::string>()->default_value(""),
+         "Unix domain socket to control the engine and read its statistics through, none if empty")
+        ("metrics-port", po::value<unsigned short>()->default_value(0),
+         "Port on the loopback interface to serve Prometheus metrics on, none if 0")
+        ("metrics-file", po::value<std::string>()->default_value(""),
+         "File to write Prometheus metrics to for the textfile collector, none if empty")
+        ("metrics-interval",
+         po::value<unsigned int>()->default_value(
+             static_cast<unsigned int>(MetricsExporter_Constants::cDefaultInterval.count())),
+         "Seconds between writes of the metrics file");
+    // clang-format on
+    mWindowModel.AddCommandLineOptions(lDescription);
+
+    po::variables_map lVariables{};
+    try {
+        po::store(po::parse_command_line(argc, argv, lDescription), lVariables);
+    } catch (const po::error& lException) {
+        std::cerr << lException.what() << std::endl << lDescription << std::endl;
+        return 1;
+    }
+
+    if (lVariables.count("help") > 0) {
+        std::cout << lDescription << std::endl;
+        return 0;
+    }
+
+    bool        lHeadless{lVariables["headless"].as<bool>()};
+    std::string lConfigPath{lVariables["config"].as<std::string>()};
+    std::string lControlSocketPath{lVariables["control-socket"].as<std::string>()};
+    mWindowModel.LoadFromFile(lConfigPath);
+    po::notify(lVariables);
+
+    Logger::GetInstance().Init(mWindowModel.mLogLevel, cLogToDisk, lProgramPath + cLogFileName.data());
+    // Without a terminal to draw on, the output is the log of the service.
+    Logger::GetInstance().SetLogToScreen(lHeadless);
+
+    // Always keeps the last frames and events, and writes them out when an error gets logged. Events from INFO up are
+    // kept, whatever the log level, so the dump shows what led up to an error. Messages below the lowest of both levels
+    // are never formatted, so DEBUG messages stay free unless DEBUG gets logged.
+    FlightRecorder_Constants::Settings lFlightRecorderSettings{lProgramPath + cFlightRecorderName.data()};
+    std::shared_ptr<FlightRecorder>    lFlightRecorder{std::make_shared<FlightRecorder>(lFlightRecorderSettings)};
+    lFlightRecorder->StartDumpThread();
+    Logger::GetInstance().SetObserver(
+        [&lFlightRecorder](std::string_view aText, Logger::Level aLevel) {
+            lFlightRecorder->RecordEvent(aText, aLevel);
+            if (aLevel == Logger::Level::ERROR) {
+                lFlightRecorder->Trigger(aText);
+            }
+        },
+        Logger::Level::INFO);
+
+    // Exports are taken from snapshots of the statistics, whether the engine runs or not.
+    MetricsExporter lMetricsExporter{};
+    auto            lMetricsPort{lVariables["metrics-port"].as<unsigned short>()};
+    std::string     lMetricsFile{lVariables["metrics-file"].as<std::string>()};
+    if (lMetricsPort != 0) {
+        lMetricsExporter.Listen(lMetricsPort);
+    }
+    if (!lMetricsFile.empty()) {
+        lMetricsExporter.SetTextFile(lMetricsFile,
+                                     std::chrono::seconds(lVariables["metrics-interval"].as<unsigned int>()));
+    }
+    lMetricsExporter.StartThread();
+
+    Engine lEngine{};
+    if (lHeadless) {
+        lReturn = RunHeadless(
+            mWindowModel, lEngine, lProgramPath, lConfigPath, lControlSocketPath, lVariables, lFlightRecorder);
+    } else {
+        RunInteractive(mWindowModel, lEngine, lProgramPath, lConfigPath, lControlSocketPath, lFlightRecorder);
+    }
+
+    lMetricsExporter.Close();
+    // The dump thread logs as well, stop it before the observer goes.
+    lFlightRecorder->Close();
+    Logger::GetInstance().SetObserver(nullptr);
+
+    return lReturn;
+}